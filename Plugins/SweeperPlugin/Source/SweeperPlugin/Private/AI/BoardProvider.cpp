@@ -0,0 +1,158 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/BoardProvider.h"
+
+#include "AI/GeminiBoardProvider.h"
+#include "AI/MockBoardProvider.h"
+#include "AI/OpenAIBoardProvider.h"
+#include "SweeperPluginStats.h"
+
+const FString IBoardProvider::NOT_RELATED_RESPONSE = TEXT("[]");
+
+TSharedRef<IBoardProvider> IBoardProvider::Create()
+{
+	return Create(UAISettings::Get()->GetProviderType());
+}
+
+TSharedRef<IBoardProvider> IBoardProvider::Create(EBoardProviderType Type)
+{
+	switch (Type)
+	{
+	case EBoardProviderType::OpenAICompatible: return MakeShared<FOpenAIBoardProvider>();
+	case EBoardProviderType::Mock: return MakeShared<FMockBoardProvider>();
+	default: return MakeShared<FGeminiBoardProvider>();
+	}
+}
+
+void IBoardProvider::RequestBoard(const FString& Prompt, FOnBoardProviderResponse OnResponse)
+{
+	RequestBoards(Prompt, GetBoardsPerRequest(), MoveTemp(OnResponse));
+}
+
+FBoardProviderBase::FBoardProviderBase(EBoardProviderType InType)
+	: Type(InType)
+{
+}
+
+FBoardProviderBase::~FBoardProviderBase()
+{
+	// Responses never come back to a destroyed provider (callbacks are bound weakly), give back the stat
+	DEC_DWORD_STAT_BY(STAT_SweeperRequestsInFlight, Running.Num());
+}
+
+void FBoardProviderBase::RequestBoards(const FString& Prompt, int32 NumBoards, FOnBoardProviderResponse OnResponse)
+{
+	Queued.Add({ NextRequestId++, Prompt, FMath::Max(1, NumBoards), MoveTemp(OnResponse), 0.0 });
+	StartQueued();
+}
+
+int32 FBoardProviderBase::GetBoardsPerRequest() const
+{
+	return FMath::Max(1, GetSettings().BoardsPerRequest);
+}
+
+int32 FBoardProviderBase::GetNumPending() const
+{
+	return Queued.Num() + Running.Num();
+}
+
+FString FBoardProviderBase::MakeBatchPrompt(const FString& Prompt, int32 NumBoards)
+{
+	if (NumBoards <= 1)
+	{
+		return Prompt;
+	}
+
+	return FString::Printf(TEXT("%s\nGenerate %d different fields."), *Prompt, NumBoards);
+}
+
+void FBoardProviderBase::SplitBoards(FStringView ResponseText, TArray<FString>& OutBoards)
+{
+	OutBoards.Reset();
+
+	int32 Start = 0;
+	for (int32 i = 0; i <= ResponseText.Len(); ++i)
+	{
+		if (i < ResponseText.Len() && ResponseText[i] != BOARD_SEPARATOR)
+		{
+			continue;
+		}
+
+		FStringView Board = ResponseText.Mid(Start, i - Start).TrimStartAndEnd();
+		if (!Board.IsEmpty())
+		{
+			OutBoards.Emplace(Board);
+		}
+		Start = i + 1;
+	}
+}
+
+void FBoardProviderBase::FinishRequest(uint32 RequestId, const FString& ResponseText, double ConnectSendMs)
+{
+	FBoardProviderResponse Response;
+	Response.ConnectSendMs = ConnectSendMs;
+	SplitBoards(ResponseText, Response.Boards);
+	Response.bSuccess = Response.Boards.Num() > 0;
+	if (!Response.bSuccess)
+	{
+		Response.Error = NSLOCTEXT("FSweeperPluginModule", "ProviderEmptyResponse", "Empty response, no board generated.");
+	}
+
+	CompleteRequest(RequestId, MoveTemp(Response));
+}
+
+void FBoardProviderBase::FailRequest(uint32 RequestId, const FText& Error)
+{
+	FBoardProviderResponse Response;
+	Response.Error = Error;
+	CompleteRequest(RequestId, MoveTemp(Response));
+}
+
+const FBoardProviderSettings& FBoardProviderBase::GetSettings() const
+{
+	return UAISettings::Get()->GetProviderSettings(Type);
+}
+
+void FBoardProviderBase::CompleteRequest(uint32 RequestId, FBoardProviderResponse&& Response)
+{
+	check(IsInGameThread());
+
+	const int32 Index = Running.IndexOfByPredicate([RequestId](const FPendingRequest& Request) { return Request.Id == RequestId; });
+	if (!ensure(Index != INDEX_NONE))
+	{
+		return;
+	}
+
+	FPendingRequest Request = MoveTemp(Running[Index]);
+	Running.RemoveAt(Index, 1, EAllowShrinking::No);
+
+	Response.LatencyMs = (FPlatformTime::Seconds() - Request.StartTime) * 1000.0;
+	TRACE_END_REGION(TEXT("Sweeper Board Request"));
+	DEC_DWORD_STAT(STAT_SweeperRequestsInFlight);
+	SET_FLOAT_STAT(STAT_SweeperLastRequestMs, Response.LatencyMs);
+	UE_LOG(LogSlate, Display, TEXT("[Minesweeper] - AI Request completed in %.1fms, %d board(s)"), Response.LatencyMs, Response.Boards.Num());
+
+	// Free the slot first, the callback may queue the next prompt
+	StartQueued();
+	Request.OnResponse.ExecuteIfBound(Response);
+}
+
+void FBoardProviderBase::StartQueued()
+{
+	const int32 MaxConcurrentRequests = FMath::Max(1, GetSettings().MaxConcurrentRequests);
+	while (Queued.Num() > 0 && Running.Num() < MaxConcurrentRequests)
+	{
+		FPendingRequest& Request = Running.Add_GetRef(MoveTemp(Queued[0]));
+		Queued.RemoveAt(0, 1, EAllowShrinking::No);
+
+		Request.StartTime = FPlatformTime::Seconds();
+		INC_DWORD_STAT(STAT_SweeperRequestsInFlight);
+		TRACE_BEGIN_REGION(TEXT("Sweeper Board Request"));
+
+		// Copy: StartRequest may finish synchronously and invalidate the reference
+		const uint32 RequestId = Request.Id;
+		const FString Prompt = Request.Prompt;
+		StartRequest(RequestId, Prompt, Request.NumBoards);
+	}
+}
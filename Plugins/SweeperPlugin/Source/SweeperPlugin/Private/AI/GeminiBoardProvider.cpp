@@ -0,0 +1,124 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/GeminiBoardProvider.h"
+
+#include "HttpModule.h"
+#include "AI/GeminiConnection.h"
+#include "AI/GeminiContextCache.h"
+#include "AI/GeminiRequestBody.h"
+#include "AI/GeminiResponseReader.h"
+#include "Interfaces/IHttpResponse.h"
+#include "SweeperPluginStats.h"
+
+#define LOCTEXT_NAMESPACE "FSweeperPluginModule"
+
+FGeminiBoardProvider::FGeminiBoardProvider()
+	: FBoardProviderBase(EBoardProviderType::Gemini)
+	, Connection(MakeShared<FGeminiConnection>())
+{
+	if (UAISettings::Get()->IsContextCacheEnabled())
+	{
+		ContextCache = MakeShared<FGeminiContextCache>();
+	}
+}
+
+FText FGeminiBoardProvider::GetDisplayName() const
+{
+	return LOCTEXT("GeminiProviderName", "Gemini");
+}
+
+void FGeminiBoardProvider::WarmUp()
+{
+	Connection->Warm();
+	if (ContextCache.IsValid())
+	{
+		ContextCache->Warm();
+	}
+}
+
+void FGeminiBoardProvider::CoolDown()
+{
+	Connection->Stop();
+}
+
+void FGeminiBoardProvider::StartRequest(uint32 RequestId, const FString& Prompt, int32 NumBoards)
+{
+	SendRequest(RequestId, MakeBatchPrompt(Prompt, NumBoards), true);
+}
+
+void FGeminiBoardProvider::SendRequest(uint32 RequestId, const FString& Prompt, bool bAllowCachedContent)
+{
+	SWEEPER_SCOPE(BuildRequest);
+
+	const UAISettings* Settings = UAISettings::Get();
+	const FString CachedContentName = (bAllowCachedContent && ContextCache.IsValid())? ContextCache->GetCachedContentName() : FString();
+
+	const FString Url = Settings->MakeGeminiUrl(FString::Printf(TEXT("models/%s:generateContent"), *Settings->GetGeminiModel()));
+	TArray<uint8> RequestBody;
+	FGeminiRequestBody::Build(Prompt, RequestBody, CachedContentName);
+
+	TSharedRef<IHttpRequest> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(Url);
+	Request->SetVerb("POST");
+	Request->SetHeader("User-Agent", "X-UnrealEngine-Agent");
+	Request->SetHeader("Content-Type", "application/json; charset=utf-8");
+	Request->SetContent(MoveTemp(RequestBody));
+	Request->SetTimeout(GetSettings().TimeoutSeconds);
+
+	TSharedRef<FHttpPhaseTimings> Timings = FHttpPhaseTimings::Track(Request);
+	Request->OnProcessRequestComplete().BindSP(this, &FGeminiBoardProvider::OnRequestCompleted, RequestId, Prompt, CachedContentName, Timings);
+
+	UE_LOG(LogSlate, Display, TEXT("[Minesweeper] - AI Request: %s%s"), *Prompt, CachedContentName.IsEmpty()? TEXT("") : TEXT(" (cached context)"));
+	Connection->NotifyActivity();
+	Request->ProcessRequest();
+}
+
+void FGeminiBoardProvider::OnRequestCompleted(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful,
+	uint32 RequestId, FString Prompt, FString CachedContentName, TSharedRef<FHttpPhaseTimings> Timings)
+{
+	check(IsInGameThread());
+
+	Connection->NotifyActivity();
+	Timings->Finish();
+	Timings->Log(TEXT("AI Request"));
+
+	SWEEPER_SCOPE(ParseResponse);
+
+	const int32 ResponseCode = Response.IsValid()? Response->GetResponseCode() : 0;
+	if (!CachedContentName.IsEmpty() && ResponseCode >= EHttpResponseCodes::BadRequest && ResponseCode < EHttpResponseCodes::ServerError)
+	{
+		// Cache expired or deleted server side: drop it and send the same prompt inline
+		UE_LOG(LogSlate, Warning, TEXT("[Minesweeper] - Context cache %s rejected (%d), retrying with the full prompt"), *CachedContentName, ResponseCode);
+		ContextCache->Invalidate();
+		SendRequest(RequestId, Prompt, false);
+		return;
+	}
+
+	if (!bWasSuccessful || !Response.IsValid() || ResponseCode > EHttpResponseCodes::PartialContent)
+	{
+		UE_LOG(LogSlate, Error, TEXT("[Minesweeper] - Error contacting Gemini: %d"), ResponseCode);
+		FailRequest(RequestId, FText::Format(LOCTEXT("GeminiGenericError", "Error contacting Gemini: {0}"), ResponseCode));
+		return;
+	}
+
+	// Only candidates[0].content.parts[0].text matters, read it straight from the UTF-8 body without building a DOM
+	FString ResponseText;
+	const EGeminiResponseResult Result = FGeminiResponseReader::ExtractFirstCandidateText(Response->GetContent(), ResponseText);
+	if (Result == EGeminiResponseResult::InvalidJson)
+	{
+		UE_LOG(LogSlate, Error, TEXT("[Minesweeper] - AI response not valid, no JSON"));
+		FailRequest(RequestId, FText::Format(LOCTEXT("GeminiJsonFailed", "Failed to deserialize Gemini response: {0}"), FText::FromString(Response->GetContentAsString())));
+		return;
+	}
+
+	if (Result == EGeminiResponseResult::MissingText)
+	{
+		FailRequest(RequestId, LOCTEXT("GeminiMalformedResponseText", "Gemini response malformed."));
+		return;
+	}
+
+	FinishRequest(RequestId, ResponseText, Timings->GetConnectSendMs());
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,127 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/GeminiConnection.h"
+
+#include "HttpModule.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Settings/AISettings.h"
+
+TSharedRef<FHttpPhaseTimings> FHttpPhaseTimings::Track(const TSharedRef<IHttpRequest>& Request)
+{
+	TSharedRef<FHttpPhaseTimings> Timings = MakeShared<FHttpPhaseTimings>();
+	Timings->StartTime = FPlatformTime::Seconds();
+
+	const uint64 ContentLength = Request->GetContentLength();
+	Request->OnRequestProgress64().BindLambda([Timings, ContentLength](FHttpRequestPtr, uint64 BytesSent, uint64 BytesReceived)
+	{
+		if (Timings->SentTime == 0.0 && BytesSent >= ContentLength)
+		{
+			Timings->SentTime = FPlatformTime::Seconds();
+		}
+	});
+	Request->OnHeaderReceived().BindLambda([Timings](FHttpRequestPtr, const FString&, const FString&)
+	{
+		if (Timings->FirstByteTime == 0.0)
+		{
+			Timings->FirstByteTime = FPlatformTime::Seconds();
+		}
+	});
+
+	return Timings;
+}
+
+void FHttpPhaseTimings::Finish()
+{
+	EndTime = FPlatformTime::Seconds();
+
+	// Missing stamps collapse into the next phase
+	FirstByteTime = FirstByteTime == 0.0? EndTime : FirstByteTime;
+	SentTime = SentTime == 0.0? FirstByteTime : SentTime;
+}
+
+void FHttpPhaseTimings::Log(const TCHAR* Label) const
+{
+	UE_LOG(LogSlate, Display, TEXT("[Minesweeper] - %s: connect+send %.1fms, TTFB %.1fms, download %.1fms, total %.1fms"), Label,
+		GetConnectSendMs(), (FirstByteTime - SentTime) * 1000.0, (EndTime - FirstByteTime) * 1000.0, (EndTime - StartTime) * 1000.0);
+}
+
+FGeminiConnection::~FGeminiConnection()
+{
+	Stop();
+}
+
+void FGeminiConnection::Warm()
+{
+	const UAISettings* Settings = UAISettings::Get();
+	if (!Settings->IsConnectionWarmUpEnabled() || Settings->GetGeminiApiKey().IsEmpty())
+	{
+		return;
+	}
+
+	if (!TickerHandle.IsValid() && Settings->GetKeepAliveSeconds() > 0)
+	{
+		TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FGeminiConnection::Tick), 1.f);
+	}
+
+	SendPing(TEXT("Connection warm-up"));
+}
+
+void FGeminiConnection::Stop()
+{
+	if (TickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+		TickerHandle.Reset();
+	}
+}
+
+void FGeminiConnection::NotifyActivity()
+{
+	LastActivityTime = FPlatformTime::Seconds();
+}
+
+bool FGeminiConnection::Tick(float DeltaTime)
+{
+	const int32 KeepAliveSeconds = UAISettings::Get()->GetKeepAliveSeconds();
+	if (!bPingPending && KeepAliveSeconds > 0 && FPlatformTime::Seconds() - LastActivityTime >= KeepAliveSeconds)
+	{
+		SendPing(TEXT("Connection keep-alive"));
+	}
+
+	return true;
+}
+
+void FGeminiConnection::SendPing(const TCHAR* Label)
+{
+	// The key may have been cleared since Warm
+	const UAISettings* Settings = UAISettings::Get();
+	if (bPingPending || Settings->GetGeminiApiKey().IsEmpty())
+	{
+		return;
+	}
+
+	// Model metadata: a valid, tiny response from the same host as board requests
+	TSharedRef<IHttpRequest> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(Settings->MakeGeminiUrl(FString::Printf(TEXT("models/%s"), *Settings->GetGeminiModel())));
+	Request->SetVerb(TEXT("GET"));
+	Request->SetHeader("User-Agent", "X-UnrealEngine-Agent");
+
+	TSharedRef<FHttpPhaseTimings> Timings = FHttpPhaseTimings::Track(Request);
+	Request->OnProcessRequestComplete().BindSPLambda(this, [this, Timings, Label](FHttpRequestPtr, FHttpResponsePtr Response, bool bWasSuccessful)
+	{
+		bPingPending = false;
+		Timings->Finish();
+		if (!bWasSuccessful || !Response.IsValid())
+		{
+			UE_LOG(LogSlate, Warning, TEXT("[Minesweeper] - %s failed, endpoint not reachable"), Label);
+			return;
+		}
+
+		Timings->Log(Label);
+	});
+
+	bPingPending = true;
+	NotifyActivity();
+	Request->ProcessRequest();
+}
@@ -0,0 +1,194 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/GeminiContextCache.h"
+
+#include "HttpModule.h"
+#include "AI/GeminiRequestBody.h"
+#include "Dom/JsonObject.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+#include "Settings/AISettings.h"
+
+FGeminiContextCache::~FGeminiContextCache()
+{
+	if (TickerHandle.IsValid())
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+	}
+}
+
+void FGeminiContextCache::Warm()
+{
+	if (!TickerHandle.IsValid())
+	{
+		TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSP(this, &FGeminiContextCache::Tick), TICK_INTERVAL_SECONDS);
+	}
+
+	Tick(0.f);
+}
+
+void FGeminiContextCache::Invalidate()
+{
+	if (!Name.IsEmpty())
+	{
+		UE_LOG(LogSlate, Display, TEXT("[Minesweeper] - Context cache %s dropped"), *Name);
+	}
+
+	Name.Reset();
+	ExpireTime = FDateTime();
+}
+
+FString FGeminiContextCache::GetCachedContentName() const
+{
+	if (Name.IsEmpty() || FDateTime::UtcNow() + FTimespan::FromSeconds(REFRESH_MARGIN_SECONDS / 2) >= ExpireTime)
+	{
+		return FString();
+	}
+
+	return Name;
+}
+
+bool FGeminiContextCache::Tick(float DeltaTime)
+{
+	if (bRequestPending)
+	{
+		return true;
+	}
+
+	const FDateTime Now = FDateTime::UtcNow();
+	if (Name.IsEmpty())
+	{
+		if (Now >= RetryTime)
+		{
+			SendCreate();
+		}
+	}
+	else if (Now + FTimespan::FromSeconds(REFRESH_MARGIN_SECONDS) >= ExpireTime)
+	{
+		SendRefresh();
+	}
+
+	return true;
+}
+
+void FGeminiContextCache::SendCreate()
+{
+	const UAISettings* Settings = UAISettings::Get();
+
+	// The server would reject it anyway, stay inline without a round trip
+	const int32 PrefixTokens = FGeminiRequestBody::EstimatePrefixTokens();
+	if (PrefixTokens < Settings->GetContextCacheMinTokens())
+	{
+		RetryTime = FDateTime::MaxValue();
+		UE_LOG(LogSlate, Display, TEXT("[Minesweeper] - Context cache skipped: about %d tokens to cache, the model needs %d. Requests send the full prompt"),
+			PrefixTokens, Settings->GetContextCacheMinTokens());
+		return;
+	}
+
+	TArray<uint8> Body;
+	FGeminiRequestBody::BuildCacheCreate(Settings->GetGeminiModel(), Settings->GetContextCacheTtlSeconds(), Body);
+
+	TSharedRef<IHttpRequest> Request = CreateRequest(Settings->MakeGeminiUrl(TEXT("cachedContents")), TEXT("POST"), MoveTemp(Body));
+	Request->OnProcessRequestComplete().BindSP(this, &FGeminiContextCache::OnCreateCompleted);
+	bRequestPending = true;
+	Request->ProcessRequest();
+}
+
+void FGeminiContextCache::SendRefresh()
+{
+	const UAISettings* Settings = UAISettings::Get();
+
+	TArray<uint8> Body;
+	FGeminiRequestBody::BuildCacheRefresh(Settings->GetContextCacheTtlSeconds(), Body);
+
+	TSharedRef<IHttpRequest> Request = CreateRequest(Settings->MakeGeminiUrl(Name), TEXT("PATCH"), MoveTemp(Body));
+	Request->OnProcessRequestComplete().BindSP(this, &FGeminiContextCache::OnRefreshCompleted);
+	bRequestPending = true;
+	Request->ProcessRequest();
+}
+
+TSharedRef<IHttpRequest> FGeminiContextCache::CreateRequest(const FString& Url, const FString& Verb, TArray<uint8>&& Body)
+{
+	TSharedRef<IHttpRequest> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(Url);
+	Request->SetVerb(Verb);
+	Request->SetHeader("User-Agent", "X-UnrealEngine-Agent");
+	Request->SetHeader("Content-Type", "application/json; charset=utf-8");
+	Request->SetContent(MoveTemp(Body));
+	return Request;
+}
+
+void FGeminiContextCache::OnCreateCompleted(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+{
+	bRequestPending = false;
+	if (!bWasSuccessful || !ReadCachedContent(Response))
+	{
+		OnCreateFailed(Response);
+		return;
+	}
+
+	UE_LOG(LogSlate, Display, TEXT("[Minesweeper] - Context cache %s created, expires %s"), *Name, *ExpireTime.ToIso8601());
+}
+
+void FGeminiContextCache::OnRefreshCompleted(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+{
+	bRequestPending = false;
+	if (!bWasSuccessful || !ReadCachedContent(Response))
+	{
+		// Gone or not refreshable, a new one is created on the next tick
+		UE_LOG(LogSlate, Warning, TEXT("[Minesweeper] - Context cache %s refresh failed (%d)"), *Name, Response.IsValid()? Response->GetResponseCode() : 0);
+		Invalidate();
+		return;
+	}
+
+	UE_LOG(LogSlate, Verbose, TEXT("[Minesweeper] - Context cache %s refreshed, expires %s"), *Name, *ExpireTime.ToIso8601());
+}
+
+bool FGeminiContextCache::ReadCachedContent(const FHttpResponsePtr& Response)
+{
+	if (!Response.IsValid() || !EHttpResponseCodes::IsOk(Response->GetResponseCode()))
+	{
+		return false;
+	}
+
+	TSharedPtr<FJsonObject> CachedContent;
+	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Response->GetContentAsString());
+	if (!FJsonSerializer::Deserialize(Reader, CachedContent) || !CachedContent.IsValid())
+	{
+		return false;
+	}
+
+	FString NewName;
+	if (!CachedContent->TryGetStringField(TEXT("name"), NewName) || NewName.IsEmpty())
+	{
+		return false;
+	}
+
+	// Unparsable expiration: trust the ttl we asked for
+	FString ExpireString;
+	FDateTime NewExpireTime;
+	if (!CachedContent->TryGetStringField(TEXT("expireTime"), ExpireString) || !FDateTime::ParseIso8601(*ExpireString, NewExpireTime))
+	{
+		NewExpireTime = FDateTime::UtcNow() + FTimespan::FromSeconds(UAISettings::Get()->GetContextCacheTtlSeconds());
+	}
+
+	Name = MoveTemp(NewName);
+	ExpireTime = NewExpireTime;
+	return true;
+}
+
+void FGeminiContextCache::OnCreateFailed(const FHttpResponsePtr& Response)
+{
+	const int32 ResponseCode = Response.IsValid()? Response->GetResponseCode() : 0;
+
+	// Client errors other than throttling won't fix themselves (e.g. contents below the model's minimum cacheable size):
+	// stay inline for the rest of the session. Anything else is retried later.
+	const bool bPermanent = ResponseCode >= EHttpResponseCodes::BadRequest && ResponseCode < EHttpResponseCodes::ServerError
+		&& ResponseCode != EHttpResponseCodes::TooManyRequests;
+	RetryTime = bPermanent? FDateTime::MaxValue() : FDateTime::UtcNow() + FTimespan::FromSeconds(RETRY_DELAY_SECONDS);
+
+	UE_LOG(LogSlate, Warning, TEXT("[Minesweeper] - Context cache creation failed (%d), requests send the full prompt%s"),
+		ResponseCode, bPermanent? TEXT("") : TEXT(" until the next attempt"));
+}
@@ -0,0 +1,232 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/GeminiRequestBody.h"
+
+#include "AI/BoardProvider.h"
+
+FJsonUtf8Writer::FJsonUtf8Writer(TArray<uint8>& InBuffer)
+	: Buffer(InBuffer)
+{
+}
+
+FJsonUtf8Writer& FJsonUtf8Writer::Raw(const ANSICHAR* Json)
+{
+	Buffer.Append(reinterpret_cast<const uint8*>(Json), FCStringAnsi::Strlen(Json));
+	return *this;
+}
+
+FJsonUtf8Writer& FJsonUtf8Writer::Raw(TArrayView<const uint8> Json)
+{
+	Buffer.Append(Json.GetData(), Json.Num());
+	return *this;
+}
+
+FJsonUtf8Writer& FJsonUtf8Writer::String(FStringView Text)
+{
+	Buffer.Add('"');
+	Escaped(Text);
+	Buffer.Add('"');
+	return *this;
+}
+
+FJsonUtf8Writer& FJsonUtf8Writer::Escaped(FStringView Text)
+{
+	static const ANSICHAR* HexDigits = "0123456789abcdef";
+
+	Buffer.Reserve(Buffer.Num() + Text.Len());
+	for (int32 i = 0; i < Text.Len(); ++i)
+	{
+		uint32 Codepoint = static_cast<uint32>(Text[i]);
+		switch (Codepoint)
+		{
+		case '"': Raw("\\\""); continue;
+		case '\\': Raw("\\\\"); continue;
+		case '\n': Raw("\\n"); continue;
+		case '\r': Raw("\\r"); continue;
+		case '\t': Raw("\\t"); continue;
+		case '\b': Raw("\\b"); continue;
+		case '\f': Raw("\\f"); continue;
+		default: break;
+		}
+
+		if (Codepoint < 0x20)
+		{
+			const uint8 Escape[] = { '\\', 'u', '0', '0', static_cast<uint8>(HexDigits[Codepoint >> 4]), static_cast<uint8>(HexDigits[Codepoint & 0xF]) };
+			Buffer.Append(Escape, UE_ARRAY_COUNT(Escape));
+			continue;
+		}
+
+		// UTF-16 surrogate pair
+		if (Codepoint >= 0xD800 && Codepoint <= 0xDBFF && i + 1 < Text.Len())
+		{
+			const uint32 Low = static_cast<uint32>(Text[i + 1]);
+			if (Low >= 0xDC00 && Low <= 0xDFFF)
+			{
+				Codepoint = 0x10000 + ((Codepoint - 0xD800) << 10) + (Low - 0xDC00);
+				++i;
+			}
+		}
+
+		AppendCodepoint(Codepoint);
+	}
+
+	return *this;
+}
+
+void FJsonUtf8Writer::AppendCodepoint(uint32 Codepoint)
+{
+	if (Codepoint < 0x80)
+	{
+		Buffer.Add(static_cast<uint8>(Codepoint));
+	}
+	else if (Codepoint < 0x800)
+	{
+		Buffer.Add(static_cast<uint8>(0xC0 | (Codepoint >> 6)));
+		Buffer.Add(static_cast<uint8>(0x80 | (Codepoint & 0x3F)));
+	}
+	else if (Codepoint < 0x10000)
+	{
+		// Lone surrogates can't be encoded, replace them
+		if (Codepoint >= 0xD800 && Codepoint <= 0xDFFF)
+		{
+			Codepoint = 0xFFFD;
+		}
+		Buffer.Add(static_cast<uint8>(0xE0 | (Codepoint >> 12)));
+		Buffer.Add(static_cast<uint8>(0x80 | ((Codepoint >> 6) & 0x3F)));
+		Buffer.Add(static_cast<uint8>(0x80 | (Codepoint & 0x3F)));
+	}
+	else
+	{
+		Buffer.Add(static_cast<uint8>(0xF0 | (Codepoint >> 18)));
+		Buffer.Add(static_cast<uint8>(0x80 | ((Codepoint >> 12) & 0x3F)));
+		Buffer.Add(static_cast<uint8>(0x80 | ((Codepoint >> 6) & 0x3F)));
+		Buffer.Add(static_cast<uint8>(0x80 | (Codepoint & 0x3F)));
+	}
+}
+
+FString FGeminiRequestBody::GetSystemInstruction()
+{
+	return FString::Printf(TEXT("You are an assistant specialized in generating grids for the Minesweeper game. "
+		"Respond with only 0 (empty) and 1 (mine), with each cell separated by commas and each row separated by a |. "
+		"No extra text or explanations. Each time, generate a different field. "
+		"When asked for several fields, separate them with a ;. "
+		"If the request is not related to Minesweeper, respond with: %s."), *IBoardProvider::NOT_RELATED_RESPONSE);
+}
+
+TArrayView<const FGeminiRequestBody::FExample> FGeminiRequestBody::GetFewShotExamples()
+{
+	static const FExample Examples[] = {
+		{ TEXT("A 3x3 board with 2 mines"), TEXT("0,1,0|0,0,0|1,0,0") },
+		{ TEXT("Small 4x5 field, easy"), TEXT("0,0,0,0,0|0,1,0,0,0|0,0,0,0,1|0,0,0,0,0") },
+		{ TEXT("Two 3x3 boards with 1 mine"), TEXT("0,0,0|0,1,0|0,0,0;1,0,0|0,0,0|0,0,0") },
+		{ TEXT("What's the weather like today?"), nullptr },
+	};
+
+	return Examples;
+}
+
+const TArray<uint8>& FGeminiRequestBody::GetPrefix()
+{
+	static const TArray<uint8> Prefix = []()
+	{
+		TArray<uint8> Bytes;
+		FJsonUtf8Writer Writer(Bytes);
+		Writer.Raw("{");
+		WriteSystemInstruction(Writer);
+		Writer.Raw(", \"contents\": [");
+		WriteFewShotContents(Writer);
+		Writer.Raw("{\"role\": \"user\", \"parts\": [{\"text\": \"");
+		return Bytes;
+	}();
+
+	return Prefix;
+}
+
+const TArray<uint8>& FGeminiRequestBody::GetSuffix()
+{
+	static const TArray<uint8> Suffix = []()
+	{
+		TArray<uint8> Bytes;
+		FJsonUtf8Writer(Bytes).Raw("\"}]}]}");
+		return Bytes;
+	}();
+
+	return Suffix;
+}
+
+int32 FGeminiRequestBody::EstimatePrefixTokens()
+{
+	return GetPrefix().Num() / 4;
+}
+
+void FGeminiRequestBody::Build(FStringView Prompt, TArray<uint8>& OutBody, FStringView CachedContentName)
+{
+	const TArray<uint8>& Suffix = GetSuffix();
+
+	if (!CachedContentName.IsEmpty())
+	{
+		OutBody.Reset(CachedContentName.Len() + Prompt.Len() + Suffix.Num() + 64);
+		FJsonUtf8Writer(OutBody)
+			.Raw("{\"cachedContent\": ")
+			.String(CachedContentName)
+			.Raw(", \"contents\": [{\"role\": \"user\", \"parts\": [{\"text\": \"")
+			.Escaped(Prompt)
+			.Raw(Suffix);
+		return;
+	}
+
+	const TArray<uint8>& Prefix = GetPrefix();
+
+	OutBody.Reset(Prefix.Num() + Prompt.Len() + Suffix.Num());
+	FJsonUtf8Writer(OutBody)
+		.Raw(Prefix)
+		.Escaped(Prompt)
+		.Raw(Suffix);
+}
+
+void FGeminiRequestBody::BuildCacheCreate(FStringView Model, int32 TtlSeconds, TArray<uint8>& OutBody)
+{
+	OutBody.Reset();
+	FJsonUtf8Writer Writer(OutBody);
+	Writer.Raw("{\"model\": ")
+		.String(FString(TEXT("models/")) + Model)
+		.Raw(", \"ttl\": ")
+		.String(FString::Printf(TEXT("%ds"), TtlSeconds))
+		.Raw(", ");
+	WriteSystemInstruction(Writer);
+	Writer.Raw(", \"contents\": [");
+	WriteFewShotContents(Writer);
+
+	// Drop the trailing ", ", the cached contents end with the last example
+	OutBody.SetNum(OutBody.Num() - 2, EAllowShrinking::No);
+	Writer.Raw("]}");
+}
+
+void FGeminiRequestBody::BuildCacheRefresh(int32 TtlSeconds, TArray<uint8>& OutBody)
+{
+	OutBody.Reset();
+	FJsonUtf8Writer(OutBody)
+		.Raw("{\"ttl\": ")
+		.String(FString::Printf(TEXT("%ds"), TtlSeconds))
+		.Raw("}");
+}
+
+void FGeminiRequestBody::WriteSystemInstruction(FJsonUtf8Writer& Writer)
+{
+	Writer.Raw("\"systemInstruction\": {\"parts\": [{\"text\": ")
+		.String(GetSystemInstruction())
+		.Raw("}]}");
+}
+
+void FGeminiRequestBody::WriteFewShotContents(FJsonUtf8Writer& Writer)
+{
+	for (const FExample& Example : GetFewShotExamples())
+	{
+		Writer.Raw("{\"role\": \"user\", \"parts\": [{\"text\": ")
+			.String(Example.Request)
+			.Raw("}]}, {\"role\": \"model\", \"parts\": [{\"text\": ")
+			.String(Example.Board != nullptr? FStringView(Example.Board) : FStringView(IBoardProvider::NOT_RELATED_RESPONSE))
+			.Raw("}]}, ");
+	}
+}
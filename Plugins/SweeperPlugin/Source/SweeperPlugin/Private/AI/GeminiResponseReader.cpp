@@ -0,0 +1,440 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/GeminiResponseReader.h"
+
+EGeminiResponseResult FGeminiResponseReader::ExtractFirstCandidateText(TArrayView<const uint8> Utf8, FString& OutText)
+{
+	return ExtractFirstCandidateText(Utf8.GetData(), Utf8.Num(), OutText);
+}
+
+EGeminiResponseResult FGeminiResponseReader::ExtractFirstCandidateText(const uint8* Utf8, int64 Size, FString& OutText)
+{
+	OutText.Reset();
+	FCursor Cursor;
+	if (!Begin(Utf8, Size, Cursor))
+	{
+		return EGeminiResponseResult::InvalidJson;
+	}
+
+	// candidates[0].content.parts[0].text
+	bool bError = false;
+	const bool bFound = FindMember(Cursor, "candidates", bError)
+		&& EnterFirstElement(Cursor)
+		&& FindMember(Cursor, "content", bError)
+		&& FindMember(Cursor, "parts", bError)
+		&& EnterFirstElement(Cursor)
+		&& FindMember(Cursor, "text", bError);
+
+	return Finish(Cursor, bFound, bError, OutText);
+}
+
+EGeminiResponseResult FGeminiResponseReader::ExtractFirstChoiceContent(TArrayView<const uint8> Utf8, FString& OutText)
+{
+	OutText.Reset();
+	FCursor Cursor;
+	if (!Begin(Utf8.GetData(), Utf8.Num(), Cursor))
+	{
+		return EGeminiResponseResult::InvalidJson;
+	}
+
+	// choices[0].message.content
+	bool bError = false;
+	const bool bFound = FindMember(Cursor, "choices", bError)
+		&& EnterFirstElement(Cursor)
+		&& FindMember(Cursor, "message", bError)
+		&& FindMember(Cursor, "content", bError);
+
+	return Finish(Cursor, bFound, bError, OutText);
+}
+
+bool FGeminiResponseReader::Begin(const uint8* Utf8, int64 Size, FCursor& OutCursor)
+{
+	if (Utf8 == nullptr || Size <= 0)
+	{
+		return false;
+	}
+
+	OutCursor = FCursor{Utf8, Utf8 + Size};
+
+	// UTF-8 BOM
+	if (Size >= 3 && Utf8[0] == 0xEF && Utf8[1] == 0xBB && Utf8[2] == 0xBF)
+	{
+		OutCursor.Ptr += 3;
+	}
+
+	SkipWhitespace(OutCursor);
+	return OutCursor.Ptr < OutCursor.End && *OutCursor.Ptr == '{';
+}
+
+EGeminiResponseResult FGeminiResponseReader::Finish(FCursor& Cursor, bool bFound, bool bError, FString& OutText)
+{
+	if (bError)
+	{
+		return EGeminiResponseResult::InvalidJson;
+	}
+
+	if (!bFound || Cursor.Ptr >= Cursor.End || *Cursor.Ptr != '"')
+	{
+		return EGeminiResponseResult::MissingText;
+	}
+
+	return DecodeString(Cursor, OutText)? EGeminiResponseResult::Success : EGeminiResponseResult::InvalidJson;
+}
+
+void FGeminiResponseReader::SkipWhitespace(FCursor& Cursor)
+{
+	while (Cursor.Ptr < Cursor.End && (*Cursor.Ptr == ' ' || *Cursor.Ptr == '\n' || *Cursor.Ptr == '\r' || *Cursor.Ptr == '\t'))
+	{
+		++Cursor.Ptr;
+	}
+}
+
+bool FGeminiResponseReader::Consume(FCursor& Cursor, uint8 Char)
+{
+	SkipWhitespace(Cursor);
+	if (Cursor.Ptr < Cursor.End && *Cursor.Ptr == Char)
+	{
+		++Cursor.Ptr;
+		return true;
+	}
+
+	return false;
+}
+
+bool FGeminiResponseReader::SkipString(FCursor& Cursor)
+{
+	// Cursor on the opening quote
+	++Cursor.Ptr;
+	while (Cursor.Ptr < Cursor.End)
+	{
+		const uint8 Char = *Cursor.Ptr;
+		if (Char == '\\')
+		{
+			// A trailing backslash escapes nothing, stepping over it would leave the buffer
+			if (Cursor.End - Cursor.Ptr < 2)
+			{
+				return false;
+			}
+			Cursor.Ptr += 2;
+		}
+		else if (Char == '"')
+		{
+			++Cursor.Ptr;
+			return true;
+		}
+		else
+		{
+			++Cursor.Ptr;
+		}
+	}
+
+	return false;
+}
+
+bool FGeminiResponseReader::SkipValue(FCursor& Cursor)
+{
+	SkipWhitespace(Cursor);
+	if (Cursor.Ptr >= Cursor.End)
+	{
+		return false;
+	}
+
+	const uint8 First = *Cursor.Ptr;
+	if (First == '"')
+	{
+		return SkipString(Cursor);
+	}
+
+	if (First == '{' || First == '[')
+	{
+		// Containers are skipped by depth, strings inside them may hold brackets
+		int32 Depth = 0;
+		while (Cursor.Ptr < Cursor.End)
+		{
+			const uint8 Char = *Cursor.Ptr;
+			if (Char == '"')
+			{
+				if (!SkipString(Cursor))
+				{
+					return false;
+				}
+				continue;
+			}
+
+			if (Char == '{' || Char == '[')
+			{
+				Depth++;
+			}
+			else if (Char == '}' || Char == ']')
+			{
+				Depth--;
+				if (Depth == 0)
+				{
+					++Cursor.Ptr;
+					return true;
+				}
+			}
+			++Cursor.Ptr;
+		}
+
+		return false;
+	}
+
+	// Number, true, false, null
+	const uint8* Start = Cursor.Ptr;
+	while (Cursor.Ptr < Cursor.End && *Cursor.Ptr != ',' && *Cursor.Ptr != '}' && *Cursor.Ptr != ']'
+		&& *Cursor.Ptr != ' ' && *Cursor.Ptr != '\n' && *Cursor.Ptr != '\r' && *Cursor.Ptr != '\t')
+	{
+		++Cursor.Ptr;
+	}
+
+	return Cursor.Ptr != Start;
+}
+
+bool FGeminiResponseReader::FindMember(FCursor& Cursor, const ANSICHAR* Key, bool& bOutError)
+{
+	if (!Consume(Cursor, '{'))
+	{
+		// Not an object, the path doesn't exist
+		return false;
+	}
+
+	if (Consume(Cursor, '}'))
+	{
+		return false;
+	}
+
+	const int32 KeyLength = FCStringAnsi::Strlen(Key);
+	while (true)
+	{
+		SkipWhitespace(Cursor);
+		if (Cursor.Ptr >= Cursor.End || *Cursor.Ptr != '"')
+		{
+			bOutError = true;
+			return false;
+		}
+
+		// Keys are compared raw, the ones we look for have nothing to unescape
+		const uint8* KeyStart = Cursor.Ptr + 1;
+		if (!SkipString(Cursor))
+		{
+			bOutError = true;
+			return false;
+		}
+		const int64 Length = (Cursor.Ptr - 1) - KeyStart;
+		const bool bMatch = Length == KeyLength && FMemory::Memcmp(KeyStart, Key, KeyLength) == 0;
+
+		if (!Consume(Cursor, ':'))
+		{
+			bOutError = true;
+			return false;
+		}
+
+		SkipWhitespace(Cursor);
+		if (bMatch)
+		{
+			return true;
+		}
+
+		if (!SkipValue(Cursor))
+		{
+			bOutError = true;
+			return false;
+		}
+
+		if (Consume(Cursor, ','))
+		{
+			continue;
+		}
+
+		if (!Consume(Cursor, '}'))
+		{
+			bOutError = true;
+		}
+		return false;
+	}
+}
+
+bool FGeminiResponseReader::EnterFirstElement(FCursor& Cursor)
+{
+	if (!Consume(Cursor, '['))
+	{
+		return false;
+	}
+
+	SkipWhitespace(Cursor);
+	return Cursor.Ptr < Cursor.End && *Cursor.Ptr != ']';
+}
+
+bool FGeminiResponseReader::DecodeString(FCursor& Cursor, FString& OutText)
+{
+	// Size the output once from the raw length, decoding never makes it longer
+	FCursor Probe = Cursor;
+	if (!SkipString(Probe))
+	{
+		return false;
+	}
+	OutText.Reset(static_cast<int32>(Probe.Ptr - Cursor.Ptr));
+
+	++Cursor.Ptr;
+	while (Cursor.Ptr < Cursor.End)
+	{
+		const uint8 Char = *Cursor.Ptr++;
+		if (Char == '"')
+		{
+			OutText.TrimStartAndEndInline();
+			return true;
+		}
+
+		if (Char == '\\')
+		{
+			if (Cursor.Ptr >= Cursor.End)
+			{
+				return false;
+			}
+
+			const uint8 Escaped = *Cursor.Ptr++;
+			switch (Escaped)
+			{
+			case 'n': break; // Rows are split by '|', newlines are only noise for the board parser
+			case '"': OutText.AppendChar(TEXT('"')); break;
+			case '\\': OutText.AppendChar(TEXT('\\')); break;
+			case '/': OutText.AppendChar(TEXT('/')); break;
+			case 'b': OutText.AppendChar(TEXT('\b')); break;
+			case 'f': OutText.AppendChar(TEXT('\f')); break;
+			case 'r': OutText.AppendChar(TEXT('\r')); break;
+			case 't': OutText.AppendChar(TEXT('\t')); break;
+			case 'u':
+			{
+				auto ReadHex = [&Cursor](uint32& OutValue)
+				{
+					if (Cursor.End - Cursor.Ptr < 4)
+					{
+						return false;
+					}
+
+					OutValue = 0;
+					for (int32 i = 0; i < 4; ++i)
+					{
+						const uint8 Hex = *Cursor.Ptr++;
+						if (!FChar::IsHexDigit(Hex))
+						{
+							return false;
+						}
+						OutValue = (OutValue << 4) | FParse::HexDigit(Hex);
+					}
+					return true;
+				};
+
+				uint32 Codepoint = 0;
+				if (!ReadHex(Codepoint))
+				{
+					return false;
+				}
+
+				// Surrogate pair
+				if (Codepoint >= 0xD800 && Codepoint <= 0xDBFF && Cursor.End - Cursor.Ptr >= 6 && Cursor.Ptr[0] == '\\' && Cursor.Ptr[1] == 'u')
+				{
+					Cursor.Ptr += 2;
+					uint32 Low = 0;
+					if (!ReadHex(Low))
+					{
+						return false;
+					}
+
+					if (Low >= 0xDC00 && Low <= 0xDFFF)
+					{
+						Codepoint = 0x10000 + ((Codepoint - 0xD800) << 10) + (Low - 0xDC00);
+					}
+					else
+					{
+						// Unpaired high surrogate, the escape after it stands on its own
+						AppendCodepoint(OutText, 0xFFFD);
+						Codepoint = Low;
+					}
+				}
+
+				if (Codepoint != '\n')
+				{
+					AppendCodepoint(OutText, Codepoint);
+				}
+				break;
+			}
+			default:
+				return false;
+			}
+			continue;
+		}
+
+		if (Char < 0x80)
+		{
+			if (Char != '\n')
+			{
+				OutText.AppendChar(static_cast<TCHAR>(Char));
+			}
+			continue;
+		}
+
+		// Multi byte UTF-8 sequence
+		int32 Extra = 0;
+		uint32 Codepoint = 0;
+		if ((Char & 0xE0) == 0xC0)
+		{
+			Extra = 1;
+			Codepoint = Char & 0x1F;
+		}
+		else if ((Char & 0xF0) == 0xE0)
+		{
+			Extra = 2;
+			Codepoint = Char & 0x0F;
+		}
+		else if ((Char & 0xF8) == 0xF0)
+		{
+			Extra = 3;
+			Codepoint = Char & 0x07;
+		}
+		else
+		{
+			return false;
+		}
+
+		if (Cursor.End - Cursor.Ptr < Extra)
+		{
+			return false;
+		}
+
+		for (int32 i = 0; i < Extra; ++i)
+		{
+			const uint8 Continuation = *Cursor.Ptr++;
+			if ((Continuation & 0xC0) != 0x80)
+			{
+				return false;
+			}
+			Codepoint = (Codepoint << 6) | (Continuation & 0x3F);
+		}
+
+		AppendCodepoint(OutText, Codepoint);
+	}
+
+	return false;
+}
+
+void FGeminiResponseReader::AppendCodepoint(FString& OutText, uint32 Codepoint)
+{
+	// Lone surrogates, from escapes or raw bytes, and values past Unicode can't be represented
+	if ((Codepoint >= 0xD800 && Codepoint <= 0xDFFF) || Codepoint > 0x10FFFF)
+	{
+		Codepoint = 0xFFFD;
+	}
+
+	if (Codepoint > 0xFFFF && sizeof(TCHAR) == 2)
+	{
+		Codepoint -= 0x10000;
+		OutText.AppendChar(static_cast<TCHAR>(0xD800 + (Codepoint >> 10)));
+		OutText.AppendChar(static_cast<TCHAR>(0xDC00 + (Codepoint & 0x3FF)));
+		return;
+	}
+
+	OutText.AppendChar(static_cast<TCHAR>(Codepoint));
+}
@@ -0,0 +1,129 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/MockBoardProvider.h"
+
+#include "Algo/AnyOf.h"
+#include "Board/MinesweeperBoardLibrary.h"
+#include "Containers/Ticker.h"
+
+#define LOCTEXT_NAMESPACE "FSweeperPluginModule"
+
+FMockBoardProvider::FMockBoardProvider()
+	: FBoardProviderBase(EBoardProviderType::Mock)
+{
+}
+
+FText FMockBoardProvider::GetDisplayName() const
+{
+	return LOCTEXT("MockProviderName", "Offline Mock");
+}
+
+FString FMockBoardProvider::GenerateBoardText(const FString& Prompt, int32 Seed, int32 Index)
+{
+	static const TCHAR* Keywords[] = { TEXT("board"), TEXT("field"), TEXT("grid"), TEXT("mine"), TEXT("bomb"), TEXT("sweeper"), TEXT("easy"), TEXT("medium"), TEXT("hard") };
+
+	// Same reading as the board library, whether or not the prompt asks for more than it can serve
+	FMinesweeperBoardQuery Query;
+	FMinesweeperBoardQuery::FromPrompt(Prompt, Query);
+
+	const bool bHasNumber = Algo::AnyOf(Prompt, [](TCHAR Char) { return FChar::IsDigit(Char); });
+	if (!bHasNumber)
+	{
+		const bool bRelated = Algo::AnyOf(Keywords, [&Prompt](const TCHAR* Keyword) { return Prompt.Contains(Keyword); });
+		if (!bRelated)
+		{
+			return NOT_RELATED_RESPONSE;
+		}
+	}
+
+	const int32 Rows = FMath::Clamp(Query.Rows > 0? Query.Rows : DEFAULT_SIZE, 2, MAX_SIZE);
+	const int32 Cols = FMath::Clamp(Query.Cols > 0? Query.Cols : DEFAULT_SIZE, 2, MAX_SIZE);
+	const int32 CellCount = Rows * Cols;
+	int32 Mines = Query.MaxMines > 0? Query.MaxMines : CellCount / 6;
+	if (Query.MaxMines <= 0 && Query.MaxDensity > 0.f)
+	{
+		Mines = FMath::RoundToInt32(CellCount * (Query.MinDensity + Query.MaxDensity) * 0.5f);
+	}
+	Mines = FMath::Clamp(Mines, 1, CellCount - 1);
+
+	// Partial Fisher-Yates: the first Mines cells are the bombs
+	FRandomStream Random(HashCombine(HashCombine(GetTypeHash(Prompt), GetTypeHash(Seed)), GetTypeHash(Index)));
+	TArray<bool> Bombs;
+	Bombs.Init(false, CellCount);
+	TArray<int32> Ids;
+	Ids.Reserve(CellCount);
+	for (int32 Id = 0; Id < CellCount; ++Id)
+	{
+		Ids.Add(Id);
+	}
+	for (int32 i = 0; i < Mines; ++i)
+	{
+		Ids.Swap(i, Random.RandRange(i, CellCount - 1));
+		Bombs[Ids[i]] = true;
+	}
+
+	FString BoardText;
+	BoardText.Reserve(CellCount * 2);
+	for (int32 Row = 0; Row < Rows; ++Row)
+	{
+		for (int32 Col = 0; Col < Cols; ++Col)
+		{
+			BoardText.AppendChar(Bombs[Row * Cols + Col]? TEXT('1') : TEXT('0'));
+			BoardText.AppendChar(Col + 1 < Cols? TEXT(',') : TEXT('|'));
+		}
+	}
+	BoardText.LeftChopInline(1);
+
+	return BoardText;
+}
+
+void FMockBoardProvider::SetSimulatedLatency(float Seconds, float PerBoardSeconds)
+{
+	LatencySeconds = Seconds;
+	LatencyPerBoardSeconds = PerBoardSeconds;
+}
+
+void FMockBoardProvider::StartRequest(uint32 RequestId, const FString& Prompt, int32 NumBoards)
+{
+	const UAISettings* Settings = UAISettings::Get();
+	const float Latency = LatencySeconds.Get(Settings->GetMockLatencySeconds()) + LatencyPerBoardSeconds.Get(Settings->GetMockLatencyPerBoardSeconds()) * NumBoards;
+	const float Timeout = GetSettings().TimeoutSeconds;
+	const bool bTimesOut = Latency >= Timeout;
+
+	// Same text a model would answer, so it goes through the same parsing
+	FString ResponseText;
+	for (int32 i = 0; i < NumBoards && !bTimesOut; ++i)
+	{
+		const FString BoardText = GenerateBoardText(Prompt, Settings->GetMockSeed(), NumGenerated++);
+		if (BoardText.Equals(NOT_RELATED_RESPONSE))
+		{
+			ResponseText = BoardText;
+			break;
+		}
+
+		if (i > 0)
+		{
+			ResponseText.AppendChar(BOARD_SEPARATOR);
+		}
+		ResponseText += BoardText;
+	}
+
+	UE_LOG(LogSlate, Display, TEXT("[Minesweeper] - Mock Request: %s (%d board(s))"), *Prompt, NumBoards);
+
+	// Always answer from the ticker, like a real request would
+	FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateSPLambda(this, [this, RequestId, bTimesOut, ResponseText = MoveTemp(ResponseText)](float)
+	{
+		if (bTimesOut)
+		{
+			FailRequest(RequestId, LOCTEXT("MockTimeoutError", "Mock request timed out."));
+		}
+		else
+		{
+			FinishRequest(RequestId, ResponseText);
+		}
+		return false;
+	}), bTimesOut? Timeout : Latency);
+}
+
+#undef LOCTEXT_NAMESPACE
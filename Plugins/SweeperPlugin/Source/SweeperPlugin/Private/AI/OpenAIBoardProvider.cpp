@@ -0,0 +1,107 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "AI/OpenAIBoardProvider.h"
+
+#include "HttpModule.h"
+#include "AI/GeminiConnection.h"
+#include "AI/GeminiRequestBody.h"
+#include "AI/GeminiResponseReader.h"
+#include "Interfaces/IHttpResponse.h"
+#include "SweeperPluginStats.h"
+
+#define LOCTEXT_NAMESPACE "FSweeperPluginModule"
+
+FOpenAIBoardProvider::FOpenAIBoardProvider()
+	: FBoardProviderBase(EBoardProviderType::OpenAICompatible)
+{
+}
+
+FText FOpenAIBoardProvider::GetDisplayName() const
+{
+	return FText::FromString(UAISettings::Get()->GetLocalModel());
+}
+
+void FOpenAIBoardProvider::BuildBody(FStringView Model, FStringView Prompt, TArray<uint8>& OutBody)
+{
+	OutBody.Reset();
+	FJsonUtf8Writer Writer(OutBody);
+	Writer.Raw("{\"model\": ")
+		.String(Model)
+		.Raw(", \"messages\": [{\"role\": \"system\", \"content\": ")
+		.String(FGeminiRequestBody::GetSystemInstruction())
+		.Raw("}, ");
+
+	for (const FGeminiRequestBody::FExample& Example : FGeminiRequestBody::GetFewShotExamples())
+	{
+		Writer.Raw("{\"role\": \"user\", \"content\": ")
+			.String(Example.Request)
+			.Raw("}, {\"role\": \"assistant\", \"content\": ")
+			.String(Example.Board != nullptr? FStringView(Example.Board) : FStringView(IBoardProvider::NOT_RELATED_RESPONSE))
+			.Raw("}, ");
+	}
+
+	Writer.Raw("{\"role\": \"user\", \"content\": ")
+		.String(Prompt)
+		.Raw("}], \"stream\": false}");
+}
+
+void FOpenAIBoardProvider::StartRequest(uint32 RequestId, const FString& Prompt, int32 NumBoards)
+{
+	SWEEPER_SCOPE(BuildRequest);
+
+	const UAISettings* Settings = UAISettings::Get();
+
+	TArray<uint8> RequestBody;
+	BuildBody(Settings->GetLocalModel(), MakeBatchPrompt(Prompt, NumBoards), RequestBody);
+
+	TSharedRef<IHttpRequest> Request = FHttpModule::Get().CreateRequest();
+	Request->SetURL(Settings->GetLocalBaseUrl() + TEXT("/chat/completions"));
+	Request->SetVerb("POST");
+	Request->SetHeader("User-Agent", "X-UnrealEngine-Agent");
+	Request->SetHeader("Content-Type", "application/json; charset=utf-8");
+	if (!Settings->GetLocalApiKey().IsEmpty())
+	{
+		Request->SetHeader("Authorization", FString::Printf(TEXT("Bearer %s"), *Settings->GetLocalApiKey()));
+	}
+	Request->SetContent(MoveTemp(RequestBody));
+	Request->SetTimeout(GetSettings().TimeoutSeconds);
+
+	TSharedRef<FHttpPhaseTimings> Timings = FHttpPhaseTimings::Track(Request);
+	Request->OnProcessRequestComplete().BindSP(this, &FOpenAIBoardProvider::OnRequestCompleted, RequestId, Timings);
+
+	UE_LOG(LogSlate, Display, TEXT("[Minesweeper] - AI Request (%s): %s"), *Settings->GetLocalBaseUrl(), *Prompt);
+	Request->ProcessRequest();
+}
+
+void FOpenAIBoardProvider::OnRequestCompleted(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful,
+	uint32 RequestId, TSharedRef<FHttpPhaseTimings> Timings)
+{
+	check(IsInGameThread());
+
+	Timings->Finish();
+	Timings->Log(TEXT("AI Request"));
+
+	SWEEPER_SCOPE(ParseResponse);
+
+	const int32 ResponseCode = Response.IsValid()? Response->GetResponseCode() : 0;
+	if (!bWasSuccessful || !Response.IsValid() || ResponseCode > EHttpResponseCodes::PartialContent)
+	{
+		UE_LOG(LogSlate, Error, TEXT("[Minesweeper] - Error contacting the local model: %d"), ResponseCode);
+		FailRequest(RequestId, FText::Format(LOCTEXT("LocalGenericError", "Error contacting the local model: {0}"), ResponseCode));
+		return;
+	}
+
+	FString ResponseText;
+	const EGeminiResponseResult Result = FGeminiResponseReader::ExtractFirstChoiceContent(Response->GetContent(), ResponseText);
+	if (Result != EGeminiResponseResult::Success)
+	{
+		UE_LOG(LogSlate, Error, TEXT("[Minesweeper] - Local model response not valid: %s"), *Response->GetContentAsString());
+		FailRequest(RequestId, LOCTEXT("LocalMalformedResponseText", "Local model response malformed."));
+		return;
+	}
+
+	FinishRequest(RequestId, ResponseText, Timings->GetConnectSendMs());
+}
+
+#undef LOCTEXT_NAMESPACE
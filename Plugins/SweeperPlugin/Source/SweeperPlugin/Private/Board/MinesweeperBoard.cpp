@@ -0,0 +1,590 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Board/MinesweeperBoard.h"
+
+#include "SweeperPluginStats.h"
+#include "SweeperPluginStyle.h"
+
+FMinesweeperCell::FMinesweeperCell(bool _bIsBomb)
+	: bIsBomb(_bIsBomb), bDiscovered(false), bFlagged(false), BombCount(0)
+{
+}
+
+bool FMinesweeperCell::IsBomb() const
+{
+	return bIsBomb;
+}
+
+bool FMinesweeperCell::IsDiscovered() const
+{
+	return bDiscovered;
+}
+
+bool FMinesweeperCell::IsFlagged() const
+{
+	return bFlagged;
+}
+
+void FMinesweeperCell::Discover()
+{
+	bDiscovered = true;
+}
+
+void FMinesweeperCell::IncrementBombCount()
+{
+	BombCount++;
+}
+
+bool FMinesweeperCell::IsEmpty() const
+{
+	return BombCount == 0;
+}
+
+int32 FMinesweeperCell::GetCount() const
+{
+	return BombCount;
+}
+
+FText FMinesweeperCell::GetText() const
+{
+	// Shared texts, cells don't own one: restoring or resetting a board doesn't need to rebuild them
+	static const FText BombText = FText::FromString(TEXT("X"));
+	static const FText FlagText = FText::FromString(TEXT("F"));
+	static const TArray<FText> CountTexts = []()
+	{
+		TArray<FText> Texts;
+		for (int32 Count = 0; Count <= 8; ++Count)
+		{
+			Texts.Add(FText::AsNumber(Count));
+		}
+		return Texts;
+	}();
+
+	if (!IsDiscovered())
+	{
+		return IsFlagged()? FlagText : FText::GetEmpty();
+	}
+
+	if (IsBomb())
+	{
+		return BombText;
+	}
+
+	return CountTexts.IsValidIndex(BombCount)? CountTexts[BombCount] : FText::AsNumber(BombCount);
+}
+
+FMinesweeperBoard::FMinesweeperBoard()
+	: RowCount(0), ColCount(0), CellToDiscover(0), TotalBombCount(0), Stride(2), NeighbourDeltas{}
+{
+	PaddedCells.Empty();
+}
+
+void FMinesweeperBoard::Create(const FString& BoardText)
+{
+	int32 InRowCount = 0;
+	int32 InColCount = 0;
+	TArray<int32> BombIds;
+
+	// Parsing, cells are created once the size is known. Its own stat: the creation below counts under Create
+	{
+		SWEEPER_SCOPE(Parse);
+
+		TArray<Coordinate> BombIndexes;
+		TArray<FString> Rows;
+		BoardText.ParseIntoArray(Rows, TEXT("|"), true);
+
+		InRowCount = Rows.Num();
+		TArray<FString> Elements;
+		for (int32 i = 0; i < Rows.Num(); ++i)
+		{
+			Rows[i].ParseIntoArray(Elements, TEXT(","), true);
+			InColCount = FMath::Max(InColCount, Elements.Num());
+
+			for (int32 j = 0; j < Elements.Num(); ++j)
+			{
+				if (Elements[j].Equals("1"))
+				{
+					BombIndexes.Add(Coordinate(i, j));
+				}
+			}
+		}
+
+		BombIds.Reserve(BombIndexes.Num());
+		for (const Coordinate& BombIndex : BombIndexes)
+		{
+			BombIds.Add(BombIndex.Key * InColCount + BombIndex.Value);
+		}
+	}
+
+	// Board creation and bomb counting
+	Create(InRowCount, InColCount, BombIds);
+
+	// Debug logging, the rows are only formatted when someone reads them
+	if (!UE_LOG_ACTIVE(LogSlate, Display))
+	{
+		return;
+	}
+
+	UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Created board. Rows: %d | Cols: %d | CellToDiscover: %d | BombCount: %d"), RowCount, ColCount, CellToDiscover, TotalBombCount);
+	UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Original string: %s"), *BoardText);
+	for (int32 i = 0; i < RowCount; ++i)
+	{
+		const FMinesweeperCell* RowData = GetRowData(i);
+		FString RowPrint;
+		for (int32 j = 0; j < ColCount; ++j)
+		{
+			FString ElementString = RowData[j].IsBomb() ? TEXT("x") : FString::Printf(TEXT("%d"), RowData[j].GetCount());
+			if (j != ColCount - 1)
+			{
+				ElementString.Append(TEXT(","));
+			}
+			RowPrint.Append(ElementString);
+		}
+
+		UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - [%s]"), *RowPrint);
+	}
+}
+
+void FMinesweeperBoard::Create(const int32 InRows, const int32 InCols, TArrayView<const int32> BombIds)
+{
+	SWEEPER_SCOPE(Create);
+
+	Init(InRows, InCols);
+
+	TotalBombCount = 0;
+	FMinesweeperCell* Cells = PaddedCells.GetData();
+	for (const int32 BombId : BombIds)
+	{
+		if (!Exists(BombId))
+		{
+			continue;
+		}
+
+		const int32 Padded = ToPaddedIndex(BombId);
+		if (Cells[Padded].IsBomb())
+		{
+			continue;
+		}
+
+		Cells[Padded].bIsBomb = true;
+		TotalBombCount++;
+
+		// Border cells count too, nothing reads them
+		for (const int32 Delta : NeighbourDeltas)
+		{
+			Cells[Padded + Delta].IncrementBombCount();
+		}
+	}
+
+	CellToDiscover = RowCount * ColCount - TotalBombCount;
+}
+
+void FMinesweeperBoard::Init(const int32 InRows, const int32 InCols)
+{
+	RowCount = FMath::Max(0, InRows);
+	ColCount = FMath::Max(0, InCols);
+	Stride = ColCount + 2;
+	CellToDiscover = RowCount * ColCount;
+	TotalBombCount = 0;
+
+	const TArray<Coordinate>& AroundOffset = GetAroundOffset();
+	for (int32 i = 0; i < AroundOffset.Num(); ++i)
+	{
+		NeighbourDeltas[i] = AroundOffset[i].Key * Stride + AroundOffset[i].Value;
+	}
+
+	// Keeps its allocation when the size doesn't change, so boards can be recycled game after game
+	PaddedCells.Init(FMinesweeperCell(false), (RowCount + 2) * Stride);
+	ChangedIds.Reserve(FMath::Min(RowCount * ColCount, SCRATCH_RESERVE_CELLS));
+
+	FMinesweeperCell Border(false);
+	Border.bDiscovered = true;
+	FMinesweeperCell* Cells = PaddedCells.GetData();
+	for (int32 j = 0; j < Stride; ++j)
+	{
+		Cells[j] = Border;
+		Cells[(RowCount + 1) * Stride + j] = Border;
+	}
+	for (int32 i = 1; i <= RowCount; ++i)
+	{
+		Cells[i * Stride] = Border;
+		Cells[i * Stride + Stride - 1] = Border;
+	}
+}
+
+void FMinesweeperBoard::Reset()
+{
+	CellToDiscover = 0;
+	for (int32 i = 0; i < RowCount; ++i)
+	{
+		FMinesweeperCell* RowData = GetRowData(i);
+		for (int32 j = 0; j < ColCount; ++j)
+		{
+			RowData[j].bDiscovered = false;
+			RowData[j].bFlagged = false;
+			if (!RowData[j].IsBomb())
+			{
+				CellToDiscover++;
+			}
+		}
+	}
+}
+
+FString FMinesweeperBoard::ToBoardText() const
+{
+	FString BoardText;
+	BoardText.Reserve(RowCount * ColCount * 2);
+	for (int32 i = 0; i < RowCount; ++i)
+	{
+		if (i != 0)
+		{
+			BoardText.AppendChar(TEXT('|'));
+		}
+
+		const FMinesweeperCell* RowData = GetRowData(i);
+		for (int32 j = 0; j < ColCount; ++j)
+		{
+			if (j != 0)
+			{
+				BoardText.AppendChar(TEXT(','));
+			}
+			BoardText.AppendChar(RowData[j].IsBomb()? TEXT('1') : TEXT('0'));
+		}
+	}
+
+	return BoardText;
+}
+
+SIZE_T FMinesweeperBoard::GetAllocatedSize() const
+{
+	return PaddedCells.GetAllocatedSize() + ChangedIds.GetAllocatedSize();
+}
+
+int32 FMinesweeperBoard::Rows() const
+{
+	return RowCount;
+}
+
+int32 FMinesweeperBoard::Cols() const
+{
+	return ColCount;
+}
+
+int32 FMinesweeperBoard::GetTotalBombCount() const
+{
+	return TotalBombCount;
+}
+
+bool FMinesweeperBoard::IsDiscovered(const int32 Row, const int32 Column) const
+{
+	return Exists(Row, Column) && PaddedCells[ToPaddedIndex(Row, Column)].IsDiscovered();
+}
+
+bool FMinesweeperBoard::IsDiscovered(const int32 Index) const
+{
+	return Exists(Index) && PaddedCells[ToPaddedIndex(Index)].IsDiscovered();
+}
+
+bool FMinesweeperBoard::IsBomb(const int32 Index) const
+{
+	return Exists(Index) && PaddedCells[ToPaddedIndex(Index)].IsBomb();
+}
+
+bool FMinesweeperBoard::Exists(const int32 Index) const
+{
+	return static_cast<uint32>(Index) < static_cast<uint32>(RowCount * ColCount);
+}
+
+FText FMinesweeperBoard::GetCellText(const int32 Row, const int32 Column) const
+{
+	if (Exists(Row, Column))
+	{
+		return PaddedCells[ToPaddedIndex(Row, Column)].GetText();
+	}
+
+	return FText::GetEmpty();
+}
+
+FText FMinesweeperBoard::GetCellText(const int32 Index) const
+{
+	if (Exists(Index))
+	{
+		return PaddedCells[ToPaddedIndex(Index)].GetText();
+	}
+
+	return FText::GetEmpty();
+}
+
+FSlateColor FMinesweeperBoard::GetCellColor(const int32 Row, const int32 Column) const
+{
+	const ISlateStyle& Style = FSweeperPluginStyle::Get();
+
+	if (!Exists(Row, Column))
+	{
+		return Style.GetSlateColor(TEXT("SweeperPlugin.NoDangerColor"));
+	}
+
+	const FMinesweeperCell& Cell = PaddedCells[ToPaddedIndex(Row, Column)];
+	if (Cell.IsBomb() || (Cell.IsFlagged() && !Cell.IsDiscovered()))
+	{
+		return Style.GetSlateColor(TEXT("SweeperPlugin.BombColor"));
+	}
+
+	const FSlateColor* Color = GetAvailableCellColors().Find(Cell.BombCount);
+	if (Color == nullptr)
+	{
+		return Style.GetSlateColor(TEXT("SweeperPlugin.HighDangerColor"));
+	}
+	
+	return *Color;
+}
+
+FSlateColor FMinesweeperBoard::GetCellColor(const int32 Index) const
+{
+	const int32 Row = ColCount > 0? Index / ColCount : 0;
+	const int32 Column = ColCount > 0? Index % ColCount : 0;
+	return GetCellColor(Row, Column);
+}
+
+const TArray<FMinesweeperBoard::Coordinate>& FMinesweeperBoard::GetAroundOffset()
+{
+	static TArray<Coordinate> Around{
+		{-1, -1}, //TopLeft
+		{-1, 0}, //Top
+		{-1, 1}, //TopRight
+		{0, 1}, //Right
+		{1, 1}, //BottomRight
+		{1, 0}, //Bottom
+		{1, -1}, //BottomLeft
+		{0, -1}, //Left
+	};
+
+	return Around;
+}
+
+const TMap<int32, FSlateColor>& FMinesweeperBoard::GetAvailableCellColors()
+{
+	static TMap<int32, FSlateColor> AvailableCellColors{
+		{0, FSweeperPluginStyle::Get().GetSlateColor(TEXT("SweeperPlugin.NoDangerColor"))},
+		{1, FSweeperPluginStyle::Get().GetSlateColor(TEXT("SweeperPlugin.LowDangerColor"))},
+		{2, FSweeperPluginStyle::Get().GetSlateColor(TEXT("SweeperPlugin.MediumDangerColor"))},
+		{3, FSweeperPluginStyle::Get().GetSlateColor(TEXT("SweeperPlugin.HighDangerColor"))},
+	};
+
+	return AvailableCellColors;
+}
+
+
+bool FMinesweeperBoard::IsBomb(const int32 Row, const int32 Column) const
+{
+	return Exists(Row, Column) && PaddedCells[ToPaddedIndex(Row, Column)].IsBomb();
+}
+
+int32 FMinesweeperBoard::GetCount(const int32 Row, const int32 Column) const
+{
+	return Exists(Row, Column)? PaddedCells[ToPaddedIndex(Row, Column)].GetCount() : 0;
+}
+
+bool FMinesweeperBoard::IsFlagged(const int32 Row, const int32 Column) const
+{
+	return Exists(Row, Column) && PaddedCells[ToPaddedIndex(Row, Column)].IsFlagged();
+}
+
+bool FMinesweeperBoard::IsFlagged(const int32 Index) const
+{
+	return Exists(Index) && PaddedCells[ToPaddedIndex(Index)].IsFlagged();
+}
+
+bool FMinesweeperBoard::ToggleFlag(const int32 Row, const int32 Column)
+{
+	if (!Exists(Row, Column))
+	{
+		return false;
+	}
+
+	FMinesweeperCell& Cell = PaddedCells[ToPaddedIndex(Row, Column)];
+	if (Cell.IsDiscovered())
+	{
+		return false;
+	}
+
+	Cell.bFlagged = !Cell.bFlagged;
+	return true;
+}
+
+TArrayView<const int32> FMinesweeperBoard::Discover(const int32 Row, const int32 Column)
+{
+	SWEEPER_SCOPE(Discover);
+
+	ChangedIds.Reset();
+	if (!Exists(Row, Column))
+	{
+		return ChangedIds;
+	}
+
+	FMinesweeperCell* Cells = PaddedCells.GetData();
+	const int32 Start = ToPaddedIndex(Row, Column);
+	if (Cells[Start].IsDiscovered() || Cells[Start].IsFlagged())
+	{
+		return ChangedIds;
+	}
+
+	Cells[Start].Discover();
+	ChangedIds.Add(Start);
+	if (Cells[Start].IsBomb())
+	{
+		ChangedIds[0] = ToCellId(Start);
+		return ChangedIds;
+	}
+
+	FloodFillChanged();
+	return ChangedIds;
+}
+
+TArrayView<const int32> FMinesweeperBoard::Chord(const int32 Row, const int32 Column, bool& bOutHitBomb)
+{
+	SWEEPER_SCOPE(Chord);
+
+	bOutHitBomb = false;
+	ChangedIds.Reset();
+	if (!Exists(Row, Column))
+	{
+		return ChangedIds;
+	}
+
+	FMinesweeperCell* Cells = PaddedCells.GetData();
+	const int32 Center = ToPaddedIndex(Row, Column);
+	if (!Cells[Center].IsDiscovered() || Cells[Center].IsBomb() || Cells[Center].IsEmpty())
+	{
+		return ChangedIds;
+	}
+
+	// Only flags on hidden cells count, a discovered cell can't be cleared of a flag anymore
+	int32 Flags = 0;
+	for (const int32 Delta : NeighbourDeltas)
+	{
+		const FMinesweeperCell& Adjacent = Cells[Center + Delta];
+		Flags += !Adjacent.IsDiscovered() && Adjacent.IsFlagged()? 1 : 0;
+	}
+
+	if (Flags != Cells[Center].GetCount())
+	{
+		return ChangedIds;
+	}
+
+	for (const int32 Delta : NeighbourDeltas)
+	{
+		FMinesweeperCell& Adjacent = Cells[Center + Delta];
+		if (Adjacent.IsDiscovered() || Adjacent.IsFlagged())
+		{
+			continue;
+		}
+
+		// A wrong flag: the mine stays hidden, the caller reveals the whole board
+		if (Adjacent.IsBomb())
+		{
+			bOutHitBomb = true;
+			continue;
+		}
+
+		Adjacent.Discover();
+		ChangedIds.Add(Center + Delta);
+	}
+
+	FloodFillChanged();
+	return ChangedIds;
+}
+
+void FMinesweeperBoard::FloodFillChanged()
+{
+	// Flood fill empty cells. ChangedIds doubles as the queue, of padded indexes until the end: cells are discovered when queued, so each one is queued once.
+	// Border cells are discovered and neighbours of an empty cell are never mines, so only discovered and flagged are tested
+	FMinesweeperCell* Cells = PaddedCells.GetData();
+	for (int32 Head = 0; Head < ChangedIds.Num(); ++Head)
+	{
+		const int32 Current = ChangedIds[Head];
+		if (!Cells[Current].IsEmpty())
+		{
+			continue;
+		}
+
+		for (const int32 Delta : NeighbourDeltas)
+		{
+			FMinesweeperCell& Adjacent = Cells[Current + Delta];
+			if (!Adjacent.IsDiscovered() && !Adjacent.IsFlagged())
+			{
+				Adjacent.Discover();
+				ChangedIds.Add(Current + Delta);
+			}
+		}
+	}
+
+	CellToDiscover = FMath::Max(0, CellToDiscover - ChangedIds.Num());
+
+	for (int32& Id : ChangedIds)
+	{
+		Id = ToCellId(Id);
+	}
+}
+
+TArrayView<const int32> FMinesweeperBoard::Reveal()
+{
+	SWEEPER_SCOPE(Reveal);
+
+	ChangedIds.Reset();
+	for (int32 i = 0; i < RowCount; ++i)
+	{
+		FMinesweeperCell* RowData = GetRowData(i);
+		for (int32 j = 0; j < ColCount; ++j)
+		{
+			if (!RowData[j].IsDiscovered())
+			{
+				RowData[j].Discover();
+				ChangedIds.Add(i * ColCount + j);
+			}
+		}
+	}
+
+	return ChangedIds;
+}
+
+bool FMinesweeperBoard::Exists(const int32 Row, const int32 Column) const
+{
+	return static_cast<uint32>(Row) < static_cast<uint32>(RowCount) && static_cast<uint32>(Column) < static_cast<uint32>(ColCount);
+}
+
+bool FMinesweeperBoard::HasWon() const
+{
+	return CellToDiscover <= 0;
+}
+
+FMinesweeperCell FMinesweeperBoard::operator()(const int32 Row, const int32 Column) const
+{
+	return PaddedCells[ToPaddedIndex(Row, Column)];
+}
+
+FMinesweeperCell& FMinesweeperBoard::operator()(const int32 Row, const int32 Column)
+{
+	return PaddedCells[ToPaddedIndex(Row, Column)];
+}
+
+FMinesweeperCell& FMinesweeperBoard::operator()(const int32 Index)
+{
+	return PaddedCells[ToPaddedIndex(Index)];
+}
+
+FMinesweeperCell FMinesweeperBoard::operator()(const int32 Index) const
+{
+	return PaddedCells[ToPaddedIndex(Index)];
+}
+
+FMinesweeperCell* FMinesweeperBoard::GetRowData(const int32 Row)
+{
+	return PaddedCells.GetData() + (Row + 1) * Stride + 1;
+}
+
+const FMinesweeperCell* FMinesweeperBoard::GetRowData(const int32 Row) const
+{
+	return PaddedCells.GetData() + (Row + 1) * Stride + 1;
+}
@@ -0,0 +1,897 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Board/MinesweeperBoardFormats.h"
+
+#include "Board/MinesweeperBoard.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace MinesweeperBoardFormats
+{
+	static constexpr uint8 BIT_PACKED_MAGIC[4] = {'M', 'S', 'B', 'P'};
+	static constexpr uint8 BIT_PACKED_VERSION = 1;
+	static constexpr int32 BIT_PACKED_HEADER_SIZE = 16;
+	// Golly wraps its lines there, some readers expect it
+	static constexpr int32 RLE_LINE_LENGTH = 70;
+
+	static bool IsSpace(const uint8 Char)
+	{
+		return Char == ' ' || Char == '\t' || Char == '\r' || Char == '\n';
+	}
+
+	static bool IsDigit(const uint8 Char)
+	{
+		return Char >= '0' && Char <= '9';
+	}
+
+	/** Reads an unsigned number at Ptr, false when there is none or it overflows the import cap */
+	static bool ReadNumber(const uint8*& Ptr, const uint8* End, int32& OutValue)
+	{
+		if (Ptr >= End || !IsDigit(*Ptr))
+		{
+			return false;
+		}
+
+		int64 Value = 0;
+		while (Ptr < End && IsDigit(*Ptr))
+		{
+			Value = Value * 10 + (*Ptr++ - '0');
+			if (Value > MAX_int32)
+			{
+				return false;
+			}
+		}
+
+		OutValue = static_cast<int32>(Value);
+		return true;
+	}
+
+	static void SkipSpaces(const uint8*& Ptr, const uint8* End)
+	{
+		while (Ptr < End && (*Ptr == ' ' || *Ptr == '\t'))
+		{
+			++Ptr;
+		}
+	}
+
+	static void SkipLine(const uint8*& Ptr, const uint8* End)
+	{
+		while (Ptr < End && *Ptr != '\n')
+		{
+			++Ptr;
+		}
+	}
+
+	static void AppendAnsi(TArray<uint8>& OutBytes, const ANSICHAR* Text)
+	{
+		OutBytes.Append(reinterpret_cast<const uint8*>(Text), FCStringAnsi::Strlen(Text));
+	}
+
+	static void AppendNumber(TArray<uint8>& OutBytes, int32 Value)
+	{
+		uint8 Digits[12];
+		int32 Count = 0;
+		do
+		{
+			Digits[Count++] = static_cast<uint8>('0' + Value % 10);
+			Value /= 10;
+		}
+		while (Value > 0);
+
+		while (Count > 0)
+		{
+			OutBytes.Add(Digits[--Count]);
+		}
+	}
+
+	static void WriteUInt32(uint8* Dest, const uint32 Value)
+	{
+		Dest[0] = static_cast<uint8>(Value);
+		Dest[1] = static_cast<uint8>(Value >> 8);
+		Dest[2] = static_cast<uint8>(Value >> 16);
+		Dest[3] = static_cast<uint8>(Value >> 24);
+	}
+
+	static uint32 ReadUInt32(const uint8* Source)
+	{
+		return static_cast<uint32>(Source[0]) | (static_cast<uint32>(Source[1]) << 8)
+			| (static_cast<uint32>(Source[2]) << 16) | (static_cast<uint32>(Source[3]) << 24);
+	}
+
+	/** Sorts and drops duplicates, exporters rely on ascending ids */
+	static void Normalize(FMinesweeperLayout& Layout)
+	{
+		Layout.MineIds.Sort();
+		int32 Write = 0;
+		for (int32 Read = 0; Read < Layout.MineIds.Num(); ++Read)
+		{
+			if (Write == 0 || Layout.MineIds[Write - 1] != Layout.MineIds[Read])
+			{
+				Layout.MineIds[Write++] = Layout.MineIds[Read];
+			}
+		}
+		Layout.MineIds.SetNum(Write, EAllowShrinking::No);
+	}
+}
+
+bool FMinesweeperBoardFormats::Import(TArrayView<const uint8> Bytes, EMinesweeperBoardFormat Format, FMinesweeperLayout& OutLayout, FString* OutError)
+{
+	OutLayout.Rows = 0;
+	OutLayout.Cols = 0;
+	OutLayout.MineIds.Reset();
+
+	// UTF-8 BOM, text files saved by editors may start with it
+	if (Bytes.Num() >= 3 && Bytes[0] == 0xEF && Bytes[1] == 0xBB && Bytes[2] == 0xBF)
+	{
+		Bytes = Bytes.Slice(3, Bytes.Num() - 3);
+	}
+
+	if (Format == EMinesweeperBoardFormat::Unknown)
+	{
+		Format = Detect(Bytes);
+	}
+
+	FString Error;
+	bool bSuccess = false;
+	switch (Format)
+	{
+	case EMinesweeperBoardFormat::BoardText: bSuccess = ImportBoardText(Bytes, OutLayout, Error); break;
+	case EMinesweeperBoardFormat::Coordinates: bSuccess = ImportCoordinates(Bytes, OutLayout, Error); break;
+	case EMinesweeperBoardFormat::Rle: bSuccess = ImportRle(Bytes, OutLayout, Error); break;
+	case EMinesweeperBoardFormat::BitPacked: bSuccess = ImportBitPacked(Bytes, OutLayout, Error); break;
+	default: Error = TEXT("Unknown board format"); break;
+	}
+
+	if (bSuccess)
+	{
+		MinesweeperBoardFormats::Normalize(OutLayout);
+	}
+	else
+	{
+		OutLayout.Rows = 0;
+		OutLayout.Cols = 0;
+		OutLayout.MineIds.Reset();
+	}
+
+	if (OutError != nullptr)
+	{
+		*OutError = MoveTemp(Error);
+	}
+	return bSuccess;
+}
+
+void FMinesweeperBoardFormats::Export(const FMinesweeperLayout& Layout, EMinesweeperBoardFormat Format, TArray<uint8>& OutBytes)
+{
+	OutBytes.Reset();
+	if (!Layout.IsValid())
+	{
+		return;
+	}
+
+	switch (Format)
+	{
+	case EMinesweeperBoardFormat::Coordinates: ExportCoordinates(Layout, OutBytes); break;
+	case EMinesweeperBoardFormat::Rle: ExportRle(Layout, OutBytes); break;
+	case EMinesweeperBoardFormat::BitPacked: ExportBitPacked(Layout, OutBytes); break;
+	default: ExportBoardText(Layout, OutBytes); break;
+	}
+}
+
+EMinesweeperBoardFormat FMinesweeperBoardFormats::Detect(TArrayView<const uint8> Bytes)
+{
+	using namespace MinesweeperBoardFormats;
+
+	if (Bytes.Num() >= 4 && FMemory::Memcmp(Bytes.GetData(), BIT_PACKED_MAGIC, 4) == 0)
+	{
+		return EMinesweeperBoardFormat::BitPacked;
+	}
+
+	// First meaningful line decides: RLE starts with its "x =" header, coordinates with "RowsxCols"
+	const uint8* Ptr = Bytes.GetData();
+	const uint8* End = Ptr + Bytes.Num();
+	while (Ptr < End)
+	{
+		while (Ptr < End && IsSpace(*Ptr))
+		{
+			++Ptr;
+		}
+		if (Ptr < End && *Ptr == '#')
+		{
+			SkipLine(Ptr, End);
+			continue;
+		}
+		break;
+	}
+
+	if (Ptr >= End)
+	{
+		return EMinesweeperBoardFormat::Unknown;
+	}
+
+	if (*Ptr == 'x' || *Ptr == 'X')
+	{
+		return EMinesweeperBoardFormat::Rle;
+	}
+
+	int32 Value = 0;
+	if (ReadNumber(Ptr, End, Value))
+	{
+		SkipSpaces(Ptr, End);
+		if (Ptr < End && (*Ptr == 'x' || *Ptr == 'X'))
+		{
+			return EMinesweeperBoardFormat::Coordinates;
+		}
+		return EMinesweeperBoardFormat::BoardText;
+	}
+
+	return EMinesweeperBoardFormat::Unknown;
+}
+
+EMinesweeperBoardFormat FMinesweeperBoardFormats::FromExtension(const FString& Path)
+{
+	const FString Extension = FPaths::GetExtension(Path);
+	if (Extension.Equals(TEXT("txt"), ESearchCase::IgnoreCase) || Extension.Equals(TEXT("board"), ESearchCase::IgnoreCase))
+	{
+		return EMinesweeperBoardFormat::BoardText;
+	}
+	if (Extension.Equals(TEXT("mines"), ESearchCase::IgnoreCase))
+	{
+		return EMinesweeperBoardFormat::Coordinates;
+	}
+	if (Extension.Equals(TEXT("rle"), ESearchCase::IgnoreCase))
+	{
+		return EMinesweeperBoardFormat::Rle;
+	}
+	if (Extension.Equals(TEXT("msb"), ESearchCase::IgnoreCase))
+	{
+		return EMinesweeperBoardFormat::BitPacked;
+	}
+
+	return EMinesweeperBoardFormat::Unknown;
+}
+
+EMinesweeperBoardFormat FMinesweeperBoardFormats::FromName(const FString& Name)
+{
+	if (Name.Equals(TEXT("text"), ESearchCase::IgnoreCase) || Name.Equals(TEXT("board"), ESearchCase::IgnoreCase))
+	{
+		return EMinesweeperBoardFormat::BoardText;
+	}
+	if (Name.Equals(TEXT("coordinates"), ESearchCase::IgnoreCase) || Name.Equals(TEXT("mines"), ESearchCase::IgnoreCase))
+	{
+		return EMinesweeperBoardFormat::Coordinates;
+	}
+	if (Name.Equals(TEXT("rle"), ESearchCase::IgnoreCase))
+	{
+		return EMinesweeperBoardFormat::Rle;
+	}
+	if (Name.Equals(TEXT("bits"), ESearchCase::IgnoreCase) || Name.Equals(TEXT("msb"), ESearchCase::IgnoreCase))
+	{
+		return EMinesweeperBoardFormat::BitPacked;
+	}
+
+	return EMinesweeperBoardFormat::Unknown;
+}
+
+const TCHAR* FMinesweeperBoardFormats::GetExtension(EMinesweeperBoardFormat Format)
+{
+	switch (Format)
+	{
+	case EMinesweeperBoardFormat::Coordinates: return TEXT("mines");
+	case EMinesweeperBoardFormat::Rle: return TEXT("rle");
+	case EMinesweeperBoardFormat::BitPacked: return TEXT("msb");
+	default: return TEXT("txt");
+	}
+}
+
+bool FMinesweeperBoardFormats::FromBoardText(const FString& BoardText, FMinesweeperLayout& OutLayout)
+{
+	const FTCHARToUTF8 Utf8(*BoardText, BoardText.Len());
+	return Import(TArrayView<const uint8>(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length()), EMinesweeperBoardFormat::BoardText, OutLayout);
+}
+
+FString FMinesweeperBoardFormats::ToBoardText(const FMinesweeperLayout& Layout)
+{
+	TArray<uint8> Bytes;
+	ExportBoardText(Layout, Bytes);
+	// Board text has no trailing newline
+	if (Bytes.Num() > 0)
+	{
+		Bytes.Pop(EAllowShrinking::No);
+	}
+
+	FString Text;
+	Text.Reserve(Bytes.Num());
+	for (const uint8 Byte : Bytes)
+	{
+		Text.AppendChar(static_cast<TCHAR>(Byte));
+	}
+	return Text;
+}
+
+void FMinesweeperBoardFormats::FromBoard(const FMinesweeperBoard& Board, FMinesweeperLayout& OutLayout)
+{
+	OutLayout.Rows = Board.Rows();
+	OutLayout.Cols = Board.Cols();
+	OutLayout.MineIds.Reset(Board.GetTotalBombCount());
+	for (int32 Row = 0; Row < OutLayout.Rows; ++Row)
+	{
+		const FMinesweeperCell* RowData = Board.GetRowData(Row);
+		for (int32 Col = 0; Col < OutLayout.Cols; ++Col)
+		{
+			if (RowData[Col].IsBomb())
+			{
+				OutLayout.MineIds.Add(Row * OutLayout.Cols + Col);
+			}
+		}
+	}
+}
+
+void FMinesweeperBoardFormats::ToBoard(const FMinesweeperLayout& Layout, FMinesweeperBoard& OutBoard)
+{
+	OutBoard.Create(Layout.Rows, Layout.Cols, Layout.MineIds);
+}
+
+bool FMinesweeperBoardFormats::LoadFromFile(const FString& Path, FMinesweeperLayout& OutLayout, FString* OutError)
+{
+	FString Error;
+	TArray<uint8> Bytes;
+	const bool bRead = FFileHelper::LoadFileToArray(Bytes, *Path);
+	if (!bRead)
+	{
+		Error = TEXT("The file can't be read");
+	}
+
+	if (!bRead || !Import(Bytes, FromExtension(Path), OutLayout, &Error))
+	{
+		UE_LOG(LogSlate, Warning, TEXT("[MineSweeper] - Can't import board file %s: %s"), *Path, *Error);
+		if (OutError != nullptr)
+		{
+			*OutError = MoveTemp(Error);
+		}
+		return false;
+	}
+
+	return true;
+}
+
+bool FMinesweeperBoardFormats::SaveToFile(const FString& Path, const FMinesweeperLayout& Layout, FString* OutError)
+{
+	TArray<uint8> Bytes;
+	Export(Layout, FromExtension(Path), Bytes);
+	if (Bytes.Num() == 0 || !FFileHelper::SaveArrayToFile(Bytes, *Path))
+	{
+		UE_LOG(LogSlate, Warning, TEXT("[MineSweeper] - Can't write board file %s"), *Path);
+		if (OutError != nullptr)
+		{
+			*OutError = Bytes.Num() == 0? TEXT("The board can't be written in this format") : TEXT("The file can't be written");
+		}
+		return false;
+	}
+
+	return true;
+}
+
+bool FMinesweeperBoardFormats::CheckSize(int32 Rows, int32 Cols, FString& OutError)
+{
+	if (Rows <= 0 || Cols <= 0)
+	{
+		OutError = TEXT("Board is empty");
+		return false;
+	}
+
+	if (Rows > MAX_SIDE || Cols > MAX_SIDE)
+	{
+		OutError = FString::Printf(TEXT("Board is %dx%d, sides are limited to %d"), Rows, Cols, MAX_SIDE);
+		return false;
+	}
+
+	return true;
+}
+
+bool FMinesweeperBoardFormats::ImportBoardText(TArrayView<const uint8> Bytes, FMinesweeperLayout& OutLayout, FString& OutError)
+{
+	using namespace MinesweeperBoardFormats;
+
+	// Same reading as FMinesweeperBoard::Create(BoardText): rows split by '|', cells by ',', "1" is a mine, short rows are padded
+	const uint8* Ptr = Bytes.GetData();
+	const uint8* End = Ptr + Bytes.Num();
+	int32 Row = 0;
+	int32 Col = 0;
+	int32 Cols = 0;
+	bool bRowHasCells = false;
+	bool bCellHasValue = false;
+	bool bCellIsMine = false;
+
+	// Ids need the final column count, mines are kept as (row, col) until then
+	TArray<FIntPoint> Mines;
+	auto EndCell = [&]()
+	{
+		if (bCellHasValue)
+		{
+			if (bCellIsMine)
+			{
+				Mines.Add(FIntPoint(Col, Row));
+			}
+			Col++;
+			bRowHasCells = true;
+		}
+		bCellHasValue = false;
+		bCellIsMine = false;
+	};
+	auto EndRow = [&]()
+	{
+		EndCell();
+		if (bRowHasCells)
+		{
+			Cols = FMath::Max(Cols, Col);
+			Row++;
+		}
+		Col = 0;
+		bRowHasCells = false;
+	};
+
+	while (Ptr < End)
+	{
+		const uint8 Char = *Ptr++;
+		if (Char == '|')
+		{
+			EndRow();
+		}
+		else if (Char == ',')
+		{
+			EndCell();
+		}
+		else if (IsDigit(Char))
+		{
+			// "1" only: "10" or "01" are not mines, as with FString::Equals
+			bCellIsMine = !bCellHasValue && Char == '1';
+			bCellHasValue = true;
+		}
+		else if (!IsSpace(Char))
+		{
+			OutError = FString::Printf(TEXT("Unexpected character '%c' in board text"), static_cast<TCHAR>(Char));
+			return false;
+		}
+
+		if (Row > MAX_SIDE || Col > MAX_SIDE)
+		{
+			OutError = FString::Printf(TEXT("Board sides are limited to %d"), MAX_SIDE);
+			return false;
+		}
+	}
+	EndRow();
+
+	if (!CheckSize(Row, Cols, OutError))
+	{
+		return false;
+	}
+
+	OutLayout.Rows = Row;
+	OutLayout.Cols = Cols;
+	OutLayout.MineIds.Reserve(Mines.Num());
+	for (const FIntPoint& Mine : Mines)
+	{
+		OutLayout.MineIds.Add(Mine.Y * Cols + Mine.X);
+	}
+	return true;
+}
+
+bool FMinesweeperBoardFormats::ImportCoordinates(TArrayView<const uint8> Bytes, FMinesweeperLayout& OutLayout, FString& OutError)
+{
+	using namespace MinesweeperBoardFormats;
+
+	const uint8* Ptr = Bytes.GetData();
+	const uint8* End = Ptr + Bytes.Num();
+	int32 Line = 0;
+	bool bHasSize = false;
+	while (Ptr < End)
+	{
+		Line++;
+		SkipSpaces(Ptr, End);
+		if (Ptr >= End || *Ptr == '#' || *Ptr == '\r' || *Ptr == '\n')
+		{
+			SkipLine(Ptr, End);
+			++Ptr;
+			continue;
+		}
+
+		int32 First = 0;
+		int32 Second = 0;
+		bool bValid = ReadNumber(Ptr, End, First);
+		SkipSpaces(Ptr, End);
+		const uint8 Separator = Ptr < End? *Ptr : 0;
+		if (bValid && (bHasSize? Separator == ',' : (Separator == 'x' || Separator == 'X')))
+		{
+			++Ptr;
+			SkipSpaces(Ptr, End);
+			bValid = ReadNumber(Ptr, End, Second);
+		}
+		else
+		{
+			bValid = false;
+		}
+
+		SkipSpaces(Ptr, End);
+		if (!bValid || (Ptr < End && *Ptr != '\r' && *Ptr != '\n' && *Ptr != '#'))
+		{
+			OutError = FString::Printf(TEXT("Line %d: expected %s"), Line, bHasSize? TEXT("\"Row,Col\"") : TEXT("\"RowsxCols\""));
+			return false;
+		}
+
+		if (!bHasSize)
+		{
+			if (!CheckSize(First, Second, OutError))
+			{
+				return false;
+			}
+			OutLayout.Rows = First;
+			OutLayout.Cols = Second;
+			bHasSize = true;
+		}
+		else
+		{
+			if (First >= OutLayout.Rows || Second >= OutLayout.Cols)
+			{
+				OutError = FString::Printf(TEXT("Line %d: mine %d,%d is outside the %dx%d board"), Line, First, Second, OutLayout.Rows, OutLayout.Cols);
+				return false;
+			}
+			OutLayout.MineIds.Add(First * OutLayout.Cols + Second);
+		}
+
+		SkipLine(Ptr, End);
+		++Ptr;
+	}
+
+	if (!bHasSize)
+	{
+		OutError = TEXT("Missing \"RowsxCols\" line");
+		return false;
+	}
+	return true;
+}
+
+bool FMinesweeperBoardFormats::ImportRle(TArrayView<const uint8> Bytes, FMinesweeperLayout& OutLayout, FString& OutError)
+{
+	using namespace MinesweeperBoardFormats;
+
+	const uint8* Ptr = Bytes.GetData();
+	const uint8* End = Ptr + Bytes.Num();
+
+	// Comments, then the "x = Cols, y = Rows[, rule = ...]" header
+	int32 Cols = -1;
+	int32 Rows = -1;
+	while (Ptr < End)
+	{
+		while (Ptr < End && IsSpace(*Ptr))
+		{
+			++Ptr;
+		}
+		if (Ptr < End && *Ptr == '#')
+		{
+			SkipLine(Ptr, End);
+			continue;
+		}
+		break;
+	}
+
+	while (Ptr < End && *Ptr != '\n')
+	{
+		const uint8 Key = *Ptr++;
+		if (Key != 'x' && Key != 'y')
+		{
+			// Other keys (rule) are skipped up to their comma
+			while (Ptr < End && *Ptr != ',' && *Ptr != '\n')
+			{
+				++Ptr;
+			}
+			if (Ptr < End && *Ptr == ',')
+			{
+				++Ptr;
+			}
+			SkipSpaces(Ptr, End);
+			continue;
+		}
+
+		SkipSpaces(Ptr, End);
+		if (Ptr >= End || *Ptr != '=')
+		{
+			OutError = TEXT("Malformed RLE header, expected \"x = Cols, y = Rows\"");
+			return false;
+		}
+		++Ptr;
+		SkipSpaces(Ptr, End);
+
+		int32 Value = 0;
+		if (!ReadNumber(Ptr, End, Value))
+		{
+			OutError = TEXT("Malformed RLE header, expected \"x = Cols, y = Rows\"");
+			return false;
+		}
+		(Key == 'x'? Cols : Rows) = Value;
+
+		SkipSpaces(Ptr, End);
+		if (Ptr < End && *Ptr == ',')
+		{
+			++Ptr;
+		}
+		SkipSpaces(Ptr, End);
+	}
+
+	if (Rows < 0 || Cols < 0)
+	{
+		OutError = TEXT("Missing RLE header, expected \"x = Cols, y = Rows\"");
+		return false;
+	}
+	if (!CheckSize(Rows, Cols, OutError))
+	{
+		return false;
+	}
+
+	OutLayout.Rows = Rows;
+	OutLayout.Cols = Cols;
+
+	// Body: [count]tag, 'b' or '.' is a safe cell, any other letter a mine, '$' ends rows, '!' ends the pattern
+	int32 Row = 0;
+	int32 Col = 0;
+	while (Ptr < End)
+	{
+		if (IsSpace(*Ptr))
+		{
+			++Ptr;
+			continue;
+		}
+
+		int32 Count = 1;
+		if (IsDigit(*Ptr) && !ReadNumber(Ptr, End, Count))
+		{
+			OutError = TEXT("RLE run count overflows");
+			return false;
+		}
+		if (Ptr >= End)
+		{
+			break;
+		}
+
+		const uint8 Tag = *Ptr++;
+		if (Tag == '!')
+		{
+			break;
+		}
+
+		if (Tag == '$')
+		{
+			// Checked before adding, so huge counts can't overflow the row
+			if (Count > Rows - Row)
+			{
+				OutError = FString::Printf(TEXT("RLE row skip goes outside the %dx%d board at row %d"), Rows, Cols, Row);
+				return false;
+			}
+			Row += Count;
+			Col = 0;
+			continue;
+		}
+
+		if (Tag != '.' && !FChar::IsAlpha(Tag))
+		{
+			OutError = FString::Printf(TEXT("Unexpected character '%c' in RLE body"), static_cast<TCHAR>(Tag));
+			return false;
+		}
+
+		if (Row >= Rows || Count > Cols - Col)
+		{
+			OutError = FString::Printf(TEXT("RLE run goes outside the %dx%d board at row %d"), Rows, Cols, Row);
+			return false;
+		}
+
+		if (Tag != 'b' && Tag != '.')
+		{
+			const int32 FirstId = Row * Cols + Col;
+			for (int32 i = 0; i < Count; ++i)
+			{
+				OutLayout.MineIds.Add(FirstId + i);
+			}
+		}
+		Col += Count;
+	}
+
+	return true;
+}
+
+bool FMinesweeperBoardFormats::ImportBitPacked(TArrayView<const uint8> Bytes, FMinesweeperLayout& OutLayout, FString& OutError)
+{
+	using namespace MinesweeperBoardFormats;
+
+	if (Bytes.Num() < BIT_PACKED_HEADER_SIZE || FMemory::Memcmp(Bytes.GetData(), BIT_PACKED_MAGIC, 4) != 0)
+	{
+		OutError = TEXT("Not a bit packed board");
+		return false;
+	}
+	if (Bytes[4] != BIT_PACKED_VERSION)
+	{
+		OutError = FString::Printf(TEXT("Unsupported bit packed version %d"), Bytes[4]);
+		return false;
+	}
+
+	// Clamped before the cast, a corrupt header must not wrap to a valid size
+	const int32 Rows = static_cast<int32>(FMath::Min<uint32>(ReadUInt32(Bytes.GetData() + 8), MAX_SIDE + 1));
+	const int32 Cols = static_cast<int32>(FMath::Min<uint32>(ReadUInt32(Bytes.GetData() + 12), MAX_SIDE + 1));
+	if (!CheckSize(Rows, Cols, OutError))
+	{
+		return false;
+	}
+
+	const int32 CellCount = Rows * Cols;
+	const int32 ByteCount = (CellCount + 7) / 8;
+	if (Bytes.Num() < BIT_PACKED_HEADER_SIZE + ByteCount)
+	{
+		OutError = TEXT("Bit packed board is truncated");
+		return false;
+	}
+
+	OutLayout.Rows = Rows;
+	OutLayout.Cols = Cols;
+
+	// Whole bytes of safe cells are skipped, mines are sparse
+	const uint8* Bits = Bytes.GetData() + BIT_PACKED_HEADER_SIZE;
+	for (int32 ByteIndex = 0; ByteIndex < ByteCount; ++ByteIndex)
+	{
+		uint32 Byte = Bits[ByteIndex];
+		while (Byte != 0)
+		{
+			const int32 Id = ByteIndex * 8 + FMath::CountTrailingZeros(Byte);
+			if (Id < CellCount)
+			{
+				OutLayout.MineIds.Add(Id);
+			}
+			Byte &= Byte - 1;
+		}
+	}
+
+	return true;
+}
+
+void FMinesweeperBoardFormats::ExportBoardText(const FMinesweeperLayout& Layout, TArray<uint8>& OutBytes)
+{
+	// Two bytes per cell: the digit and its separator
+	OutBytes.Reserve(Layout.Rows * Layout.Cols * 2);
+	int32 NextMine = 0;
+	for (int32 Row = 0; Row < Layout.Rows; ++Row)
+	{
+		for (int32 Col = 0; Col < Layout.Cols; ++Col)
+		{
+			const int32 Id = Row * Layout.Cols + Col;
+			const bool bMine = NextMine < Layout.MineIds.Num() && Layout.MineIds[NextMine] == Id;
+			NextMine += bMine? 1 : 0;
+			OutBytes.Add(bMine? '1' : '0');
+			OutBytes.Add(Col + 1 < Layout.Cols? ',' : (Row + 1 < Layout.Rows? '|' : '\n'));
+		}
+	}
+}
+
+void FMinesweeperBoardFormats::ExportCoordinates(const FMinesweeperLayout& Layout, TArray<uint8>& OutBytes)
+{
+	using namespace MinesweeperBoardFormats;
+
+	OutBytes.Reserve(16 + Layout.MineIds.Num() * 10);
+	AppendAnsi(OutBytes, "# Minesweeper board, RowsxCols then one Row,Col line per mine\n");
+	AppendNumber(OutBytes, Layout.Rows);
+	OutBytes.Add('x');
+	AppendNumber(OutBytes, Layout.Cols);
+	OutBytes.Add('\n');
+	for (const int32 Id : Layout.MineIds)
+	{
+		AppendNumber(OutBytes, Id / Layout.Cols);
+		OutBytes.Add(',');
+		AppendNumber(OutBytes, Id % Layout.Cols);
+		OutBytes.Add('\n');
+	}
+}
+
+void FMinesweeperBoardFormats::ExportRle(const FMinesweeperLayout& Layout, TArray<uint8>& OutBytes)
+{
+	using namespace MinesweeperBoardFormats;
+
+	AppendAnsi(OutBytes, "#C Minesweeper board, o is a mine\nx = ");
+	AppendNumber(OutBytes, Layout.Cols);
+	AppendAnsi(OutBytes, ", y = ");
+	AppendNumber(OutBytes, Layout.Rows);
+	OutBytes.Add('\n');
+
+	// Runs are emitted through one buffer so lines can be wrapped without splitting a run
+	int32 LineLength = 0;
+	uint8 Run[16];
+	auto EmitRun = [&](int32 Count, uint8 Tag)
+	{
+		if (Count <= 0)
+		{
+			return;
+		}
+
+		int32 Length = 0;
+		if (Count > 1)
+		{
+			uint8 Digits[12];
+			int32 DigitCount = 0;
+			while (Count > 0)
+			{
+				Digits[DigitCount++] = static_cast<uint8>('0' + Count % 10);
+				Count /= 10;
+			}
+			while (DigitCount > 0)
+			{
+				Run[Length++] = Digits[--DigitCount];
+			}
+		}
+		Run[Length++] = Tag;
+
+		if (LineLength + Length > RLE_LINE_LENGTH)
+		{
+			OutBytes.Add('\n');
+			LineLength = 0;
+		}
+		OutBytes.Append(Run, Length);
+		LineLength += Length;
+	};
+
+	// Trailing safe cells of a row and empty rows are implied, as Golly writes them
+	int32 NextMine = 0;
+	int32 PendingRows = 0;
+	for (int32 Row = 0; Row < Layout.Rows; ++Row)
+	{
+		const int32 RowEnd = (Row + 1) * Layout.Cols;
+		if (NextMine >= Layout.MineIds.Num() || Layout.MineIds[NextMine] >= RowEnd)
+		{
+			PendingRows++;
+			continue;
+		}
+
+		EmitRun(PendingRows, '$');
+		PendingRows = 0;
+
+		int32 Col = 0;
+		while (NextMine < Layout.MineIds.Num() && Layout.MineIds[NextMine] < RowEnd)
+		{
+			const int32 MineCol = Layout.MineIds[NextMine] - Row * Layout.Cols;
+			int32 Count = 1;
+			while (NextMine + Count < Layout.MineIds.Num() && Layout.MineIds[NextMine + Count] == Layout.MineIds[NextMine] + Count
+				&& Layout.MineIds[NextMine + Count] < RowEnd)
+			{
+				Count++;
+			}
+
+			EmitRun(MineCol - Col, 'b');
+			EmitRun(Count, 'o');
+			Col = MineCol + Count;
+			NextMine += Count;
+		}
+		PendingRows = 1;
+	}
+
+	OutBytes.Add('!');
+	OutBytes.Add('\n');
+}
+
+void FMinesweeperBoardFormats::ExportBitPacked(const FMinesweeperLayout& Layout, TArray<uint8>& OutBytes)
+{
+	using namespace MinesweeperBoardFormats;
+
+	const int32 CellCount = Layout.Rows * Layout.Cols;
+	OutBytes.SetNumZeroed(BIT_PACKED_HEADER_SIZE + (CellCount + 7) / 8);
+
+	uint8* Header = OutBytes.GetData();
+	FMemory::Memcpy(Header, BIT_PACKED_MAGIC, 4);
+	Header[4] = BIT_PACKED_VERSION;
+	WriteUInt32(Header + 8, static_cast<uint32>(Layout.Rows));
+	WriteUInt32(Header + 12, static_cast<uint32>(Layout.Cols));
+
+	uint8* Bits = Header + BIT_PACKED_HEADER_SIZE;
+	for (const int32 Id : Layout.MineIds)
+	{
+		if (Id >= 0 && Id < CellCount)
+		{
+			Bits[Id >> 3] |= static_cast<uint8>(1 << (Id & 7));
+		}
+	}
+}
@@ -0,0 +1,762 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Board/MinesweeperBoardLibrary.h"
+
+#include "SweeperPluginStats.h"
+#include "Algo/BinarySearch.h"
+#include "Async/MappedFileHandle.h"
+#include "Board/MinesweeperBoardFormats.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Crc.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace MinesweeperBoardLibrary
+{
+	static constexpr int32 MAX_SIDE = MAX_uint16;
+	// Header of the bit packed format, bits follow
+	static constexpr int32 RECORD_HEADER_SIZE = 16;
+
+	/** Reads an integer at Index, moving past it. 0 if there's no digit there. */
+	static int32 ReadNumber(const FString& Text, int32& Index)
+	{
+		int32 Value = 0;
+		while (Index < Text.Len() && FChar::IsDigit(Text[Index]))
+		{
+			Value = FMath::Min(Value * 10 + (Text[Index] - TEXT('0')), 1 << 20);
+			++Index;
+		}
+		return Value;
+	}
+
+	static void SkipSpaces(const FString& Text, int32& Index)
+	{
+		while (Index < Text.Len() && FChar::IsWhitespace(Text[Index]))
+		{
+			++Index;
+		}
+	}
+
+	/** Words that can surround query terms without asking for anything else */
+	static bool IsQueryFiller(FStringView Word)
+	{
+		static const TCHAR* Fillers[] = {
+			TEXT("a"), TEXT("an"), TEXT("the"), TEXT("one"), TEXT("new"), TEXT("give"), TEXT("me"), TEXT("please"),
+			TEXT("minesweeper"), TEXT("board"), TEXT("boards"), TEXT("field"), TEXT("grid"), TEXT("game"),
+			TEXT("with"), TEXT("and"), TEXT("of"), TEXT("mine"), TEXT("mines"), TEXT("bomb"), TEXT("bombs"), TEXT("density")
+		};
+
+		for (const TCHAR* Filler : Fillers)
+		{
+			if (Word.Equals(Filler, ESearchCase::IgnoreCase))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/** Moves past Word and the spaces after it if the text continues with it */
+	static bool SkipWord(const FString& Text, int32& Index, const TCHAR* Word)
+	{
+		const int32 Length = FCString::Strlen(Word);
+		if (Index + Length <= Text.Len() && FCString::Strnicmp(*Text + Index, Word, Length) == 0)
+		{
+			Index += Length;
+			SkipSpaces(Text, Index);
+			return true;
+		}
+		return false;
+	}
+}
+
+bool FMinesweeperBoardQuery::FromPrompt(const FString& Prompt, FMinesweeperBoardQuery& OutQuery)
+{
+	using namespace MinesweeperBoardLibrary;
+
+	OutQuery = FMinesweeperBoardQuery();
+	bool bOnlyQueryTerms = true;
+	for (int32 i = 0; i < Prompt.Len();)
+	{
+		// "3BV" starts with a digit, it is checked before numbers
+		if (FCString::Strnicmp(*Prompt + i, TEXT("3bv"), 3) == 0)
+		{
+			i += 3;
+			SkipSpaces(Prompt, i);
+			// "3BV: 120", "3BV of 120", "3BV between 120 and 150"
+			for (const TCHAR* Word : { TEXT(":"), TEXT("of"), TEXT("between"), TEXT("from") })
+			{
+				if (SkipWord(Prompt, i, Word))
+				{
+					break;
+				}
+			}
+			if (i < Prompt.Len() && FChar::IsDigit(Prompt[i]))
+			{
+				OutQuery.Min3BV = ReadNumber(Prompt, i);
+				OutQuery.Max3BV = OutQuery.Min3BV;
+
+				int32 Next = i;
+				SkipSpaces(Prompt, Next);
+				if ((SkipWord(Prompt, Next, TEXT("-")) || SkipWord(Prompt, Next, TEXT("to")) || SkipWord(Prompt, Next, TEXT("and")))
+					&& Next < Prompt.Len() && FChar::IsDigit(Prompt[Next]))
+				{
+					OutQuery.Max3BV = ReadNumber(Prompt, Next);
+					i = Next;
+				}
+			}
+			continue;
+		}
+
+		if (FChar::IsAlpha(Prompt[i]))
+		{
+			const int32 WordStart = i;
+			while (i < Prompt.Len() && FChar::IsAlpha(Prompt[i]))
+			{
+				++i;
+			}
+			bOnlyQueryTerms = bOnlyQueryTerms && IsQueryFiller(FStringView(*Prompt + WordStart, i - WordStart));
+			continue;
+		}
+
+		if (!FChar::IsDigit(Prompt[i]))
+		{
+			++i;
+			continue;
+		}
+
+		const int32 Number = ReadNumber(Prompt, i);
+		int32 Next = i;
+		SkipSpaces(Prompt, Next);
+		if (OutQuery.Rows == 0 && Next < Prompt.Len() && (Prompt[Next] == TEXT('x') || Prompt[Next] == TEXT('X')))
+		{
+			++Next;
+			SkipSpaces(Prompt, Next);
+			if (Next < Prompt.Len() && FChar::IsDigit(Prompt[Next]))
+			{
+				OutQuery.Rows = Number;
+				OutQuery.Cols = ReadNumber(Prompt, Next);
+				i = Next;
+				continue;
+			}
+		}
+
+		if (OutQuery.MaxMines == 0 && (FCString::Strnicmp(*Prompt + Next, TEXT("mine"), 4) == 0 || FCString::Strnicmp(*Prompt + Next, TEXT("bomb"), 4) == 0))
+		{
+			OutQuery.MinMines = Number;
+			OutQuery.MaxMines = Number;
+		}
+		else if (OutQuery.MaxDensity <= 0.f && Next < Prompt.Len() && Prompt[Next] == TEXT('%'))
+		{
+			// About the density asked, an exact one is rarely possible on a small board
+			OutQuery.MinDensity = FMath::Max(0.f, Number / 100.f - 0.025f);
+			OutQuery.MaxDensity = Number / 100.f + 0.025f;
+		}
+		else
+		{
+			bOnlyQueryTerms = false;
+		}
+	}
+
+	return bOnlyQueryTerms && OutQuery.Rows > 0 && OutQuery.Cols > 0;
+}
+
+FMinesweeperBoardLibrary::~FMinesweeperBoardLibrary()
+{
+	Close();
+}
+
+FString FMinesweeperBoardLibrary::GetDefaultDirectory()
+{
+	return FPaths::ProjectSavedDir() / TEXT("Minesweeper") / TEXT("Library");
+}
+
+bool FMinesweeperBoardLibrary::Open(const FString& Directory)
+{
+	Close();
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*Directory);
+	DataPath = Directory / TEXT("Boards.dat");
+	IndexPath = Directory / TEXT("Boards.idx");
+
+	if (!PlatformFile.FileExists(*IndexPath))
+	{
+		const FHeader Header = { MAGIC, VERSION, static_cast<uint16>(sizeof(FEntry)), { 0, 0 } };
+		if (!WriteIndex(0, &Header, sizeof(Header)))
+		{
+			UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Unable to create the board library in %s"), *Directory);
+			Close();
+			return false;
+		}
+	}
+
+	if (!MapIndex())
+	{
+		Close();
+		return false;
+	}
+
+	IndexEntries(0);
+
+	UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Board library: %d boards, %d unplayed (%s)"), NumEntries, GetNumUnplayed(), *Directory);
+	return true;
+}
+
+void FMinesweeperBoardLibrary::Close()
+{
+	UnmapIndex();
+	DataWriter.Reset();
+	DataReader.Reset();
+	BySize.Empty();
+	ByChecksum.Empty();
+	NumPlayed = 0;
+	DataPath.Empty();
+	IndexPath.Empty();
+}
+
+bool FMinesweeperBoardLibrary::IsOpen() const
+{
+	return !IndexPath.IsEmpty();
+}
+
+int32 FMinesweeperBoardLibrary::Add(const FMinesweeperLayout& Layout, bool bPlayed)
+{
+	TArray<int32> Indexes;
+	Add(MakeArrayView(&Layout, 1), bPlayed, &Indexes);
+	return Indexes[0];
+}
+
+int32 FMinesweeperBoardLibrary::Add(TArrayView<const FMinesweeperLayout> Layouts, bool bPlayed, TArray<int32>* OutIndexes)
+{
+	using namespace MinesweeperBoardLibrary;
+
+	SWEEPER_SCOPE(LibraryAdd);
+
+	if (OutIndexes != nullptr)
+	{
+		OutIndexes->Init(INDEX_NONE, Layouts.Num());
+	}
+
+	if (!IsOpen())
+	{
+		return 0;
+	}
+
+	if (!DataWriter.IsValid())
+	{
+		DataWriter.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*DataPath, true, true));
+		if (!DataWriter.IsValid())
+		{
+			UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Unable to write the board library %s"), *DataPath);
+			return 0;
+		}
+	}
+
+	const int32 FirstIndex = NumEntries;
+	int64 DataEnd = DataWriter->Size();
+	TArray<FEntry> NewEntries;
+	TArray<int32> PlayedExisting;
+	// Boards of this batch per checksum, duplicates within it are skipped too
+	TMultiMap<uint32, int32> BatchChecksums;
+	TArray<TArray<uint8>> BatchRecords;
+	TArray<uint8> Record;
+
+	for (int32 i = 0; i < Layouts.Num(); ++i)
+	{
+		const FMinesweeperLayout& Layout = Layouts[i];
+		if (!Layout.IsValid() || Layout.Rows > MAX_SIDE || Layout.Cols > MAX_SIDE)
+		{
+			continue;
+		}
+
+		FMinesweeperBoardFormats::Export(Layout, EMinesweeperBoardFormat::BitPacked, Record);
+		const uint32 Checksum = FCrc::MemCrc32(Record.GetData(), Record.Num());
+
+		const int32 Existing = FindRecord(Record, Checksum);
+		if (Existing != INDEX_NONE)
+		{
+			if (bPlayed)
+			{
+				PlayedExisting.Add(Existing);
+			}
+			if (OutIndexes != nullptr)
+			{
+				(*OutIndexes)[i] = Existing;
+			}
+			continue;
+		}
+
+		int32 Duplicate = INDEX_NONE;
+		for (auto It = BatchChecksums.CreateConstKeyIterator(Checksum); It; ++It)
+		{
+			if (BatchRecords[It.Value()] == Record)
+			{
+				Duplicate = It.Value();
+				break;
+			}
+		}
+		if (Duplicate != INDEX_NONE)
+		{
+			if (OutIndexes != nullptr)
+			{
+				(*OutIndexes)[i] = FirstIndex + Duplicate;
+			}
+			continue;
+		}
+
+		// Mines counted from the record: layouts may repeat ids
+		uint32 Mines = 0;
+		for (int32 Byte = RECORD_HEADER_SIZE; Byte < Record.Num(); ++Byte)
+		{
+			Mines += FMath::CountBits(Record[Byte]);
+		}
+
+		if (!DataWriter->Write(Record.GetData(), Record.Num()))
+		{
+			UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Unable to write the board library %s"), *DataPath);
+			break;
+		}
+
+		FEntry& Entry = NewEntries.AddDefaulted_GetRef();
+		Entry.Offset = static_cast<uint64>(DataEnd);
+		Entry.Size = static_cast<uint32>(Record.Num());
+		Entry.Rows = static_cast<uint16>(Layout.Rows);
+		Entry.Cols = static_cast<uint16>(Layout.Cols);
+		Entry.Mines = Mines;
+		Entry.ThreeBV = static_cast<uint32>(Compute3BV(Layout));
+		Entry.Checksum = Checksum;
+		Entry.Flags = bPlayed? PLAYED_FLAG : 0;
+		DataEnd += Record.Num();
+
+		BatchChecksums.Add(Checksum, BatchRecords.Num());
+		BatchRecords.Add(Record);
+		if (OutIndexes != nullptr)
+		{
+			(*OutIndexes)[i] = FirstIndex + NewEntries.Num() - 1;
+		}
+	}
+
+	for (const int32 Index : PlayedExisting)
+	{
+		MarkPlayed(Index);
+	}
+
+	if (NewEntries.Num() == 0 || !IsOpen())
+	{
+		return 0;
+	}
+
+	// Boards reach the disk before the entries pointing at them
+	DataWriter->Flush();
+
+	UnmapIndex();
+	const bool bWritten = WriteIndex(sizeof(FHeader) + static_cast<int64>(FirstIndex) * sizeof(FEntry), NewEntries.GetData(), NewEntries.Num() * sizeof(FEntry));
+	if (!MapIndex())
+	{
+		Close();
+		return 0;
+	}
+
+	if (!bWritten)
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Unable to write the board library index %s"), *IndexPath);
+	}
+
+	IndexEntries(FirstIndex);
+	return NumEntries - FirstIndex;
+}
+
+int32 FMinesweeperBoardLibrary::Find(const FMinesweeperBoardQuery& Query) const
+{
+	SWEEPER_SCOPE(LibraryQuery);
+
+	auto FindInBucket = [this, &Query](const TArray<int32>& Bucket)
+	{
+		const int32 Start = Query.Min3BV > 0? Algo::LowerBoundBy(Bucket, static_cast<uint32>(Query.Min3BV), [this](int32 Index) { return Entries[Index].ThreeBV; }) : 0;
+		for (int32 i = Start; i < Bucket.Num(); ++i)
+		{
+			const FEntry& Entry = Entries[Bucket[i]];
+			if (Query.Max3BV > 0 && Entry.ThreeBV > static_cast<uint32>(Query.Max3BV))
+			{
+				break;
+			}
+
+			if (Matches(Entry, Query))
+			{
+				return Bucket[i];
+			}
+		}
+		return static_cast<int32>(INDEX_NONE);
+	};
+
+	if (Query.Rows > 0 && Query.Cols > 0)
+	{
+		const TArray<int32>* Bucket = BySize.Find(MakeSizeKey(Query.Rows, Query.Cols));
+		return Bucket != nullptr? FindInBucket(*Bucket) : INDEX_NONE;
+	}
+
+	// Any size: the easiest match among every size
+	int32 Best = INDEX_NONE;
+	for (const TPair<uint32, TArray<int32>>& Pair : BySize)
+	{
+		const int32 Rows = static_cast<int32>(Pair.Key >> 16);
+		const int32 Cols = static_cast<int32>(Pair.Key & 0xFFFF);
+		if ((Query.Rows > 0 && Rows != Query.Rows) || (Query.Cols > 0 && Cols != Query.Cols))
+		{
+			continue;
+		}
+
+		const int32 Index = FindInBucket(Pair.Value);
+		if (Index != INDEX_NONE && (Best == INDEX_NONE || Entries[Index].ThreeBV < Entries[Best].ThreeBV))
+		{
+			Best = Index;
+		}
+	}
+
+	return Best;
+}
+
+bool FMinesweeperBoardLibrary::Take(const FMinesweeperBoardQuery& Query, FMinesweeperLayout& OutLayout)
+{
+	const int32 Index = Find(Query);
+	if (Index == INDEX_NONE || !Load(Index, OutLayout))
+	{
+		return false;
+	}
+
+	MarkPlayed(Index);
+	return true;
+}
+
+bool FMinesweeperBoardLibrary::Load(int32 Index, FMinesweeperLayout& OutLayout) const
+{
+	TArray<uint8> Record;
+	return ReadRecord(Index, Record) && FMinesweeperBoardFormats::Import(Record, EMinesweeperBoardFormat::BitPacked, OutLayout);
+}
+
+void FMinesweeperBoardLibrary::MarkPlayed(int32 Index)
+{
+	if (Index < 0 || Index >= NumEntries || IsPlayed(Index))
+	{
+		return;
+	}
+
+	const uint32 Flags = Entries[Index].Flags | PLAYED_FLAG;
+	const int64 Offset = sizeof(FHeader) + static_cast<int64>(Index) * sizeof(FEntry) + STRUCT_OFFSET(FEntry, Flags);
+
+	UnmapIndex();
+	const bool bWritten = WriteIndex(Offset, &Flags, sizeof(Flags));
+	if (!MapIndex())
+	{
+		Close();
+		return;
+	}
+
+	if (bWritten)
+	{
+		NumPlayed++;
+	}
+}
+
+void FMinesweeperBoardLibrary::MarkPlayed(const FMinesweeperLayout& Layout)
+{
+	if (!IsOpen() || !Layout.IsValid())
+	{
+		return;
+	}
+
+	TArray<uint8> Record;
+	FMinesweeperBoardFormats::Export(Layout, EMinesweeperBoardFormat::BitPacked, Record);
+	MarkPlayed(FindRecord(Record, FCrc::MemCrc32(Record.GetData(), Record.Num())));
+}
+
+bool FMinesweeperBoardLibrary::IsPlayed(int32 Index) const
+{
+	return Index >= 0 && Index < NumEntries && (Entries[Index].Flags & PLAYED_FLAG) != 0;
+}
+
+int32 FMinesweeperBoardLibrary::Num() const
+{
+	return NumEntries;
+}
+
+const FMinesweeperBoardLibrary::FEntry& FMinesweeperBoardLibrary::GetEntry(int32 Index) const
+{
+	check(Index >= 0 && Index < NumEntries);
+	return Entries[Index];
+}
+
+int32 FMinesweeperBoardLibrary::GetNumUnplayed() const
+{
+	return NumEntries - NumPlayed;
+}
+
+SIZE_T FMinesweeperBoardLibrary::GetAllocatedSize() const
+{
+	SIZE_T Size = BySize.GetAllocatedSize() + ByChecksum.GetAllocatedSize() + LoadedEntries.GetAllocatedSize();
+	for (const TPair<uint32, TArray<int32>>& Pair : BySize)
+	{
+		Size += Pair.Value.GetAllocatedSize();
+	}
+	return Size;
+}
+
+int32 FMinesweeperBoardLibrary::Compute3BV(const FMinesweeperLayout& Layout)
+{
+	const int32 Rows = Layout.Rows;
+	const int32 Cols = Layout.Cols;
+	if (!Layout.IsValid())
+	{
+		return 0;
+	}
+
+	// Mine bit and count per cell, counts only go up to 8
+	static constexpr uint8 MINE_BIT = 0x10;
+	static constexpr uint8 MARKED_BIT = 0x20;
+	static constexpr uint8 COUNT_MASK = 0x0F;
+	TArray<uint8> Cells;
+	Cells.SetNumZeroed(Rows * Cols);
+	for (const int32 Id : Layout.MineIds)
+	{
+		if (Id < 0 || Id >= Cells.Num() || (Cells[Id] & MINE_BIT) != 0)
+		{
+			continue;
+		}
+
+		Cells[Id] |= MINE_BIT;
+		const int32 Row = Id / Cols;
+		const int32 Col = Id % Cols;
+		for (int32 Neighbour = FMath::Max(0, Row - 1); Neighbour <= FMath::Min(Rows - 1, Row + 1); ++Neighbour)
+		{
+			for (int32 Column = FMath::Max(0, Col - 1); Column <= FMath::Min(Cols - 1, Col + 1); ++Column)
+			{
+				Cells[Neighbour * Cols + Column]++;
+			}
+		}
+	}
+
+	// One click per opening: an empty cell opens its whole region and the numbers around it
+	int32 Clicks = 0;
+	TArray<int32> Stack;
+	for (int32 Id = 0; Id < Cells.Num(); ++Id)
+	{
+		if ((Cells[Id] & (MINE_BIT | MARKED_BIT)) != 0 || (Cells[Id] & COUNT_MASK) != 0)
+		{
+			continue;
+		}
+
+		Clicks++;
+		Cells[Id] |= MARKED_BIT;
+		Stack.Add(Id);
+		while (Stack.Num() > 0)
+		{
+			const int32 Current = Stack.Pop(EAllowShrinking::No);
+			const int32 Row = Current / Cols;
+			const int32 Col = Current % Cols;
+			for (int32 Neighbour = FMath::Max(0, Row - 1); Neighbour <= FMath::Min(Rows - 1, Row + 1); ++Neighbour)
+			{
+				for (int32 Column = FMath::Max(0, Col - 1); Column <= FMath::Min(Cols - 1, Col + 1); ++Column)
+				{
+					const int32 Adjacent = Neighbour * Cols + Column;
+					if ((Cells[Adjacent] & (MINE_BIT | MARKED_BIT)) != 0)
+					{
+						continue;
+					}
+
+					Cells[Adjacent] |= MARKED_BIT;
+					if ((Cells[Adjacent] & COUNT_MASK) == 0)
+					{
+						Stack.Add(Adjacent);
+					}
+				}
+			}
+		}
+	}
+
+	// Then one click per number no opening reveals
+	for (const uint8 Cell : Cells)
+	{
+		Clicks += (Cell & (MINE_BIT | MARKED_BIT)) == 0? 1 : 0;
+	}
+
+	return Clicks;
+}
+
+bool FMinesweeperBoardLibrary::MapIndex()
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	const int64 FileSize = PlatformFile.FileSize(*IndexPath);
+	if (FileSize < static_cast<int64>(sizeof(FHeader)))
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Board library index %s is missing or truncated"), *IndexPath);
+		return false;
+	}
+
+	const uint8* Data = nullptr;
+	MappedIndex.Reset(PlatformFile.OpenMapped(*IndexPath));
+	if (MappedIndex.IsValid())
+	{
+		MappedRegion.Reset(MappedIndex->MapRegion(0, FileSize));
+		Data = MappedRegion.IsValid()? MappedRegion->GetMappedPtr() : nullptr;
+	}
+
+	// No mapping on this platform: the index is small, a copy will do
+	TArray64<uint8> Bytes;
+	if (Data == nullptr)
+	{
+		if (!FFileHelper::LoadFileToArray(Bytes, *IndexPath) || Bytes.Num() < static_cast<int64>(sizeof(FHeader)))
+		{
+			UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Unable to read the board library index %s"), *IndexPath);
+			return false;
+		}
+		Data = Bytes.GetData();
+	}
+
+	FHeader Header;
+	FMemory::Memcpy(&Header, Data, sizeof(Header));
+	if (Header.Magic != MAGIC || Header.Version != VERSION || Header.EntrySize != sizeof(FEntry))
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - %s is not a board library index of version %d"), *IndexPath, VERSION);
+		UnmapIndex();
+		return false;
+	}
+
+	// A partial entry at the end is a crash mid append, it is ignored and overwritten by the next one
+	NumEntries = static_cast<int32>((FileSize - sizeof(FHeader)) / sizeof(FEntry));
+	if (Bytes.Num() > 0)
+	{
+		LoadedEntries.SetNumUninitialized(NumEntries);
+		FMemory::Memcpy(LoadedEntries.GetData(), Data + sizeof(FHeader), NumEntries * sizeof(FEntry));
+		Entries = LoadedEntries.GetData();
+	}
+	else
+	{
+		// Mapped regions are page aligned, entries after the 16 bytes header are aligned too
+		Entries = reinterpret_cast<const FEntry*>(Data + sizeof(FHeader));
+	}
+
+	return true;
+}
+
+void FMinesweeperBoardLibrary::UnmapIndex()
+{
+	MappedRegion.Reset();
+	MappedIndex.Reset();
+	LoadedEntries.Empty();
+	Entries = nullptr;
+	NumEntries = 0;
+}
+
+bool FMinesweeperBoardLibrary::WriteIndex(int64 Offset, const void* Data, int64 Size)
+{
+	// Opened for each write: a writer must never be open while the index is mapped
+	TUniquePtr<IFileHandle> Writer(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*IndexPath, true, false));
+	return Writer.IsValid() && Writer->Seek(Offset) && Writer->Write(static_cast<const uint8*>(Data), Size) && Writer->Flush();
+}
+
+bool FMinesweeperBoardLibrary::ReadRecord(int32 Index, TArray<uint8>& OutRecord) const
+{
+	if (Index < 0 || Index >= NumEntries)
+	{
+		return false;
+	}
+
+	if (!DataReader.IsValid())
+	{
+		DataReader.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenRead(*DataPath, true));
+		if (!DataReader.IsValid())
+		{
+			return false;
+		}
+	}
+
+	const FEntry& Entry = Entries[Index];
+	OutRecord.SetNumUninitialized(Entry.Size);
+	if (!DataReader->Seek(static_cast<int64>(Entry.Offset)) || !DataReader->Read(OutRecord.GetData(), Entry.Size))
+	{
+		UE_LOG(LogSlate, Warning, TEXT("[MineSweeper] - Board %d is missing from %s"), Index, *DataPath);
+		return false;
+	}
+
+	if (FCrc::MemCrc32(OutRecord.GetData(), OutRecord.Num()) != Entry.Checksum)
+	{
+		UE_LOG(LogSlate, Warning, TEXT("[MineSweeper] - Board %d of %s is corrupted"), Index, *DataPath);
+		return false;
+	}
+
+	return true;
+}
+
+int32 FMinesweeperBoardLibrary::FindRecord(TArrayView<const uint8> Record, uint32 Checksum) const
+{
+	TArray<int32, TInlineAllocator<4>> Candidates;
+	ByChecksum.MultiFind(Checksum, Candidates);
+
+	TArray<uint8> Stored;
+	for (const int32 Index : Candidates)
+	{
+		if (Entries[Index].Size == static_cast<uint32>(Record.Num()) && ReadRecord(Index, Stored)
+			&& FMemory::Memcmp(Stored.GetData(), Record.GetData(), Record.Num()) == 0)
+		{
+			return Index;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+void FMinesweeperBoardLibrary::IndexEntries(int32 FirstIndex)
+{
+	// A few boards are inserted in place, bulk adds (and opening) sort the buckets they touched once
+	const bool bInsert = NumEntries - FirstIndex <= 16;
+	TSet<uint32> Touched;
+	for (int32 Index = FirstIndex; Index < NumEntries; ++Index)
+	{
+		const FEntry& Entry = Entries[Index];
+		ByChecksum.Add(Entry.Checksum, Index);
+		NumPlayed += (Entry.Flags & PLAYED_FLAG) != 0? 1 : 0;
+
+		const uint32 SizeKey = MakeSizeKey(Entry.Rows, Entry.Cols);
+		TArray<int32>& Bucket = BySize.FindOrAdd(SizeKey);
+		if (bInsert)
+		{
+			Bucket.Insert(Index, Algo::UpperBoundBy(Bucket, Entry.ThreeBV, [this](int32 Other) { return Entries[Other].ThreeBV; }));
+		}
+		else
+		{
+			Bucket.Add(Index);
+			Touched.Add(SizeKey);
+		}
+	}
+
+	for (const uint32 SizeKey : Touched)
+	{
+		BySize[SizeKey].StableSort([this](int32 A, int32 B) { return Entries[A].ThreeBV < Entries[B].ThreeBV; });
+	}
+}
+
+bool FMinesweeperBoardLibrary::Matches(const FEntry& Entry, const FMinesweeperBoardQuery& Query) const
+{
+	if (Query.bUnplayedOnly && (Entry.Flags & PLAYED_FLAG) != 0)
+	{
+		return false;
+	}
+
+	if ((Query.MinMines > 0 && Entry.Mines < static_cast<uint32>(Query.MinMines)) || (Query.MaxMines > 0 && Entry.Mines > static_cast<uint32>(Query.MaxMines)))
+	{
+		return false;
+	}
+
+	if (Query.MinDensity > 0.f || Query.MaxDensity > 0.f)
+	{
+		const float Density = static_cast<float>(Entry.Mines) / (static_cast<float>(Entry.Rows) * Entry.Cols);
+		if ((Query.MinDensity > 0.f && Density < Query.MinDensity) || (Query.MaxDensity > 0.f && Density > Query.MaxDensity))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
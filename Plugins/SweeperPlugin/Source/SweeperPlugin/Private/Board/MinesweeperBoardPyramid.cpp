@@ -0,0 +1,202 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Board/MinesweeperBoardPyramid.h"
+
+#include "Board/MinesweeperBoard.h"
+#include "SweeperPluginStats.h"
+
+void FMinesweeperBoardPyramid::Build(const FMinesweeperBoard& Board)
+{
+	SWEEPER_SCOPE(UpdateOverview);
+
+	Reset();
+	BoardRows = Board.Rows();
+	BoardCols = Board.Cols();
+	if (BoardRows <= 0 || BoardCols <= 0)
+	{
+		return;
+	}
+
+	// Level 0 straight from the cells, one row of blocks per two board rows
+	FLevel& First = Levels.AddDefaulted_GetRef();
+	First.BlockSize = 2;
+	First.Rows = (BoardRows + 1) / 2;
+	First.Cols = (BoardCols + 1) / 2;
+	First.Blocks.SetNum(First.Rows * First.Cols);
+	for (int32 Row = 0; Row < BoardRows; ++Row)
+	{
+		const FMinesweeperCell* RowData = Board.GetRowData(Row);
+		FBlock* BlockRow = First.Blocks.GetData() + (Row / 2) * First.Cols;
+		for (int32 Col = 0; Col < BoardCols; ++Col)
+		{
+			FBlock& Block = BlockRow[Col / 2];
+			Block.Cells++;
+			Block.Discovered += RowData[Col].IsDiscovered()? 1 : 0;
+			Block.Mines += RowData[Col].IsBomb()? 1 : 0;
+		}
+	}
+
+	while (Levels.Last().Rows > 1 || Levels.Last().Cols > 1)
+	{
+		const FLevel& Previous = Levels.Last();
+		FLevel Next;
+		Next.BlockSize = Previous.BlockSize * 2;
+		Next.Rows = (Previous.Rows + 1) / 2;
+		Next.Cols = (Previous.Cols + 1) / 2;
+		Levels.Add(MoveTemp(Next));
+		BuildFromChildren(Levels.Num() - 1);
+	}
+}
+
+void FMinesweeperBoardPyramid::Reset()
+{
+	Levels.Empty();
+	BoardRows = 0;
+	BoardCols = 0;
+}
+
+void FMinesweeperBoardPyramid::Update(const FMinesweeperBoard& Board, TArrayView<const int32> ChangedIds)
+{
+	SWEEPER_SCOPE(UpdateOverview);
+
+	if (Levels.Num() == 0 || ChangedIds.Num() == 0 || Board.Rows() != BoardRows || Board.Cols() != BoardCols)
+	{
+		return;
+	}
+
+	DirtyBlocks.Reset();
+	const FLevel& First = Levels[0];
+	for (const int32 Id : ChangedIds)
+	{
+		if (Board.Exists(Id))
+		{
+			DirtyBlocks.Add((Id / BoardCols / 2) * First.Cols + (Id % BoardCols) / 2);
+		}
+	}
+	SortUnique(DirtyBlocks);
+
+	// Recounted rather than incremented: undo hides cells again, the change set alone doesn't say which way they went.
+	// Mines never change after Build
+	for (const int32 BlockIndex : DirtyBlocks)
+	{
+		const int32 FirstRow = (BlockIndex / First.Cols) * 2;
+		const int32 FirstCol = (BlockIndex % First.Cols) * 2;
+		int32 Discovered = 0;
+		for (int32 Row = FirstRow; Row < FMath::Min(FirstRow + 2, BoardRows); ++Row)
+		{
+			const FMinesweeperCell* RowData = Board.GetRowData(Row);
+			for (int32 Col = FirstCol; Col < FMath::Min(FirstCol + 2, BoardCols); ++Col)
+			{
+				Discovered += RowData[Col].IsDiscovered()? 1 : 0;
+			}
+		}
+		Levels[0].Blocks[BlockIndex].Discovered = Discovered;
+	}
+
+	for (int32 Level = 1; Level < Levels.Num(); ++Level)
+	{
+		const int32 ChildCols = Levels[Level - 1].Cols;
+		FLevel& Current = Levels[Level];
+
+		NextDirtyBlocks.Reset();
+		for (const int32 ChildIndex : DirtyBlocks)
+		{
+			NextDirtyBlocks.Add((ChildIndex / ChildCols / 2) * Current.Cols + (ChildIndex % ChildCols) / 2);
+		}
+		SortUnique(NextDirtyBlocks);
+
+		for (const int32 BlockIndex : NextDirtyBlocks)
+		{
+			Current.Blocks[BlockIndex] = SumChildren(Level, BlockIndex / Current.Cols, BlockIndex % Current.Cols);
+		}
+		Swap(DirtyBlocks, NextDirtyBlocks);
+	}
+}
+
+int32 FMinesweeperBoardPyramid::NumLevels() const
+{
+	return Levels.Num();
+}
+
+const FMinesweeperBoardPyramid::FLevel& FMinesweeperBoardPyramid::GetLevel(int32 Level) const
+{
+	return Levels[Level];
+}
+
+int32 FMinesweeperBoardPyramid::FindLevel(int32 MaxRows, int32 MaxCols) const
+{
+	for (int32 Level = 0; Level < Levels.Num(); ++Level)
+	{
+		if (Levels[Level].Rows <= MaxRows && Levels[Level].Cols <= MaxCols)
+		{
+			return Level;
+		}
+	}
+
+	return Levels.Num() - 1;
+}
+
+int32 FMinesweeperBoardPyramid::GetBoardRows() const
+{
+	return BoardRows;
+}
+
+int32 FMinesweeperBoardPyramid::GetBoardCols() const
+{
+	return BoardCols;
+}
+
+SIZE_T FMinesweeperBoardPyramid::GetAllocatedSize() const
+{
+	SIZE_T Size = Levels.GetAllocatedSize() + DirtyBlocks.GetAllocatedSize() + NextDirtyBlocks.GetAllocatedSize();
+	for (const FLevel& Level : Levels)
+	{
+		Size += Level.Blocks.GetAllocatedSize();
+	}
+	return Size;
+}
+
+void FMinesweeperBoardPyramid::BuildFromChildren(int32 Level)
+{
+	FLevel& Current = Levels[Level];
+	Current.Blocks.SetNumUninitialized(Current.Rows * Current.Cols);
+	for (int32 Row = 0; Row < Current.Rows; ++Row)
+	{
+		for (int32 Col = 0; Col < Current.Cols; ++Col)
+		{
+			Current.Blocks[Row * Current.Cols + Col] = SumChildren(Level, Row, Col);
+		}
+	}
+}
+
+FMinesweeperBoardPyramid::FBlock FMinesweeperBoardPyramid::SumChildren(int32 Level, int32 Row, int32 Col) const
+{
+	const FLevel& Children = Levels[Level - 1];
+	FBlock Sum;
+	for (int32 ChildRow = Row * 2; ChildRow < FMath::Min(Row * 2 + 2, Children.Rows); ++ChildRow)
+	{
+		for (int32 ChildCol = Col * 2; ChildCol < FMath::Min(Col * 2 + 2, Children.Cols); ++ChildCol)
+		{
+			const FBlock& Child = Children.Blocks[ChildRow * Children.Cols + ChildCol];
+			Sum.Cells += Child.Cells;
+			Sum.Discovered += Child.Discovered;
+			Sum.Mines += Child.Mines;
+		}
+	}
+	return Sum;
+}
+
+void FMinesweeperBoardPyramid::SortUnique(TArray<int32>& Ids)
+{
+	Ids.Sort();
+	int32 Kept = 0;
+	for (int32 i = 0; i < Ids.Num(); ++i)
+	{
+		if (Kept == 0 || Ids[Kept - 1] != Ids[i])
+		{
+			Ids[Kept++] = Ids[i];
+		}
+	}
+	Ids.SetNum(Kept, EAllowShrinking::No);
+}
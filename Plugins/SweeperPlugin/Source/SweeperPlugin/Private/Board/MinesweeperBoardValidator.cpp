@@ -0,0 +1,232 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Board/MinesweeperBoardValidator.h"
+
+#include "SweeperPluginStats.h"
+
+bool FMinesweeperBoardRepairs::HasRepairs() const
+{
+	return bStrippedFences || StrayCharacters > 0 || PaddedRows > 0 || TruncatedRows > 0 || bClampedSize
+		|| AddedMines > 0 || RemovedMines > 0 || bRegenerated;
+}
+
+FString FMinesweeperBoardRepairs::ToString() const
+{
+	TArray<FString> Fixes;
+	if (bRegenerated)
+	{
+		Fixes.Add(TEXT("generated a board locally"));
+	}
+	if (bStrippedFences)
+	{
+		Fixes.Add(TEXT("stripped markdown fences"));
+	}
+	if (StrayCharacters > 0)
+	{
+		Fixes.Add(FString::Printf(TEXT("removed %d stray characters"), StrayCharacters));
+	}
+	if (PaddedRows > 0)
+	{
+		Fixes.Add(FString::Printf(TEXT("padded %d rows"), PaddedRows));
+	}
+	if (TruncatedRows > 0)
+	{
+		Fixes.Add(FString::Printf(TEXT("truncated %d rows"), TruncatedRows));
+	}
+	if (bClampedSize)
+	{
+		Fixes.Add(TEXT("clamped the size"));
+	}
+	if (AddedMines > 0)
+	{
+		Fixes.Add(FString::Printf(TEXT("added %d mines"), AddedMines));
+	}
+	if (RemovedMines > 0)
+	{
+		Fixes.Add(FString::Printf(TEXT("removed %d mines"), RemovedMines));
+	}
+
+	return FString::Join(Fixes, TEXT(", "));
+}
+
+FString FMinesweeperBoardValidator::Normalize(FStringView Text, FMinesweeperBoardRepairs& OutRepairs, const FMinesweeperBoardLimits& Limits)
+{
+	SWEEPER_SCOPE(Validate);
+
+	OutRepairs = FMinesweeperBoardRepairs();
+	FRandomStream Random(GetTypeHash(Text));
+
+	// Markdown fences, with an optional language tag: ```csv ... ```
+	Text = Text.TrimStartAndEnd();
+	if (Text.StartsWith(TEXT("```")))
+	{
+		OutRepairs.bStrippedFences = true;
+		Text.RightChopInline(3);
+		while (Text.Len() > 0 && FChar::IsAlpha(Text[0]))
+		{
+			Text.RightChopInline(1);
+		}
+	}
+	if (Text.EndsWith(TEXT("```")))
+	{
+		OutRepairs.bStrippedFences = true;
+		Text.LeftChopInline(3);
+	}
+
+	// Single pass: cells of all rows back to back, plus each row length
+	TArray<uint8> Cells;
+	TArray<int32> RowLengths;
+	Cells.Reserve(Text.Len() / 2 + 1);
+	int32 RowLength = 0;
+	for (int32 i = 0; i <= Text.Len(); ++i)
+	{
+		const TCHAR Char = i < Text.Len()? Text[i] : TEXT('|');
+		switch (Char)
+		{
+		case TEXT('0'):
+			Cells.Add(0);
+			RowLength++;
+			break;
+		case TEXT('1'):
+			Cells.Add(1);
+			RowLength++;
+			break;
+		case TEXT('|'):
+			// Empty rows are dropped, as the parser always did
+			if (RowLength > 0)
+			{
+				RowLengths.Add(RowLength);
+			}
+			RowLength = 0;
+			break;
+		case TEXT(','): case TEXT(' '): case TEXT('\r'): case TEXT('\n'): case TEXT('\t'):
+			break;
+		default:
+			OutRepairs.StrayCharacters++;
+			break;
+		}
+	}
+
+	// Most common row width wins, ties go to the wider one
+	int32 Cols = 0;
+	{
+		TMap<int32, int32> WidthCounts;
+		int32 BestCount = 0;
+		for (const int32 Length : RowLengths)
+		{
+			const int32 Count = ++WidthCounts.FindOrAdd(Length);
+			if (Count > BestCount || (Count == BestCount && Length > Cols))
+			{
+				BestCount = Count;
+				Cols = Length;
+			}
+		}
+	}
+
+	int32 Rows = RowLengths.Num();
+	const int32 ClampedRows = FMath::Clamp(Rows, Limits.MinSize, Limits.MaxSize);
+	const int32 ClampedCols = FMath::Clamp(Cols, Limits.MinSize, Limits.MaxSize);
+
+	TArray<uint8> Board;
+	if (Rows < Limits.MinSize || Cols < Limits.MinSize)
+	{
+		// Nothing playable came back: a local board instead of another round trip
+		OutRepairs.bRegenerated = true;
+		Rows = Limits.FallbackSize;
+		Cols = Limits.FallbackSize;
+		Regenerate(Rows, Cols, FMath::RoundToInt(Rows * Cols * Limits.FallbackMineDensity), Random, Board);
+	}
+	else
+	{
+		OutRepairs.bClampedSize = ClampedRows != Rows || ClampedCols != Cols;
+		Board.SetNumZeroed(ClampedRows * ClampedCols);
+
+		int32 Offset = 0;
+		for (int32 Row = 0; Row < Rows; ++Row)
+		{
+			const int32 Length = RowLengths[Row];
+			if (Row < ClampedRows)
+			{
+				OutRepairs.PaddedRows += Length < Cols? 1 : 0;
+				OutRepairs.TruncatedRows += Length > Cols? 1 : 0;
+				FMemory::Memcpy(&Board[Row * ClampedCols], &Cells[Offset], FMath::Min(Length, ClampedCols));
+			}
+			Offset += Length;
+		}
+
+		Rows = ClampedRows;
+		Cols = ClampedCols;
+	}
+
+	// Mine count within limits, moving random cells
+	const int32 CellCount = Rows * Cols;
+	const int32 MaxMines = FMath::Clamp(FMath::FloorToInt(CellCount * Limits.MaxMineDensity), 1, CellCount - 1);
+	const int32 MinMines = FMath::Min(Limits.MinMines, MaxMines);
+
+	TArray<int32> Mines;
+	TArray<int32> Empty;
+	for (int32 Id = 0; Id < CellCount; ++Id)
+	{
+		(Board[Id]? Mines : Empty).Add(Id);
+	}
+
+	auto Flip = [&Random, &Board](TArray<int32>& From, int32 Count)
+	{
+		for (int32 i = 0; i < Count; ++i)
+		{
+			From.Swap(i, Random.RandRange(i, From.Num() - 1));
+			Board[From[i]] ^= 1;
+		}
+	};
+
+	if (Mines.Num() < MinMines)
+	{
+		OutRepairs.AddedMines = MinMines - Mines.Num();
+		Flip(Empty, OutRepairs.AddedMines);
+	}
+	else if (Mines.Num() > MaxMines)
+	{
+		OutRepairs.RemovedMines = Mines.Num() - MaxMines;
+		Flip(Mines, OutRepairs.RemovedMines);
+	}
+
+	return ToBoardText(Board, Rows, Cols);
+}
+
+void FMinesweeperBoardValidator::Regenerate(int32 Rows, int32 Cols, int32 Mines, FRandomStream& Random, TArray<uint8>& OutCells)
+{
+	const int32 CellCount = Rows * Cols;
+	OutCells.SetNumZeroed(CellCount);
+
+	TArray<int32> Ids;
+	Ids.Reserve(CellCount);
+	for (int32 Id = 0; Id < CellCount; ++Id)
+	{
+		Ids.Add(Id);
+	}
+
+	Mines = FMath::Clamp(Mines, 1, CellCount - 1);
+	for (int32 i = 0; i < Mines; ++i)
+	{
+		Ids.Swap(i, Random.RandRange(i, CellCount - 1));
+		OutCells[Ids[i]] = 1;
+	}
+}
+
+FString FMinesweeperBoardValidator::ToBoardText(TArrayView<const uint8> Cells, int32 Rows, int32 Cols)
+{
+	FString BoardText;
+	BoardText.Reserve(Rows * Cols * 2);
+	for (int32 Row = 0; Row < Rows; ++Row)
+	{
+		for (int32 Col = 0; Col < Cols; ++Col)
+		{
+			BoardText.AppendChar(Cells[Row * Cols + Col]? TEXT('1') : TEXT('0'));
+			BoardText.AppendChar(Col + 1 < Cols? TEXT(',') : TEXT('|'));
+		}
+	}
+	BoardText.LeftChopInline(1);
+
+	return BoardText;
+}
@@ -0,0 +1,153 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Board/MinesweeperHistory.h"
+
+#include "Board/MinesweeperBoard.h"
+#include "SweeperPluginStats.h"
+
+void FMinesweeperHistory::Reset(int32 CellCount)
+{
+	// A move discovers at least one cell and a run covers at least one: no storage outgrows the cell count
+	const int32 Reserved = FMath::Min(CellCount, FMinesweeperBoard::SCRATCH_RESERVE_CELLS);
+	Runs.Empty(Reserved);
+	Moves.Empty(Reserved);
+	SortedIds.Empty(Reserved);
+	Cursor = 0;
+}
+
+void FMinesweeperHistory::Record(TArrayView<const int32> ChangedIds, int32 CellToDiscoverBefore, int32 CellToDiscoverAfter, bool bEndedGame)
+{
+	if (ChangedIds.Num() <= 0)
+	{
+		return;
+	}
+
+	// A new move drops whatever could have been redone
+	if (Cursor < Moves.Num())
+	{
+		const int32 KeptRuns = Moves.IsValidIndex(Cursor - 1)? Moves[Cursor - 1].FirstRun + Moves[Cursor - 1].NumRuns : 0;
+		Runs.SetNum(KeptRuns, EAllowShrinking::No);
+		Moves.SetNum(Cursor, EAllowShrinking::No);
+	}
+
+	SortedIds.Reset();
+	SortedIds.Append(ChangedIds.GetData(), ChangedIds.Num());
+	SortedIds.Sort();
+
+	FMove Move;
+	Move.FirstRun = Runs.Num();
+	Move.CellToDiscoverBefore = CellToDiscoverBefore;
+	Move.CellToDiscoverAfter = CellToDiscoverAfter;
+	Move.bEndedGame = bEndedGame;
+
+	FIdRun Current{SortedIds[0], 1};
+	for (int32 i = 1; i < SortedIds.Num(); ++i)
+	{
+		const int32 Id = SortedIds[i];
+		if (Id == Current.Start + Current.Num)
+		{
+			Current.Num++;
+		}
+		else if (Id >= Current.Start + Current.Num)
+		{
+			Runs.Add(Current);
+			Current = FIdRun{Id, 1};
+		}
+	}
+	Runs.Add(Current);
+
+	Move.NumRuns = Runs.Num() - Move.FirstRun;
+	Moves.Add(Move);
+	Cursor = Moves.Num();
+}
+
+bool FMinesweeperHistory::CanUndo() const
+{
+	return Cursor > 0;
+}
+
+bool FMinesweeperHistory::CanRedo() const
+{
+	return Cursor < Moves.Num();
+}
+
+const FMinesweeperHistory::FMove* FMinesweeperHistory::Undo(FMinesweeperBoard& Board)
+{
+	if (!CanUndo())
+	{
+		return nullptr;
+	}
+
+	const FMove& Move = Moves[--Cursor];
+	ApplyRuns(Board, Move, false);
+	Board.CellToDiscover = Move.CellToDiscoverBefore;
+	return &Move;
+}
+
+const FMinesweeperHistory::FMove* FMinesweeperHistory::Redo(FMinesweeperBoard& Board)
+{
+	if (!CanRedo())
+	{
+		return nullptr;
+	}
+
+	const FMove& Move = Moves[Cursor++];
+	ApplyRuns(Board, Move, true);
+	Board.CellToDiscover = Move.CellToDiscoverAfter;
+	return &Move;
+}
+
+TArrayView<const FMinesweeperHistory::FIdRun> FMinesweeperHistory::GetRuns(const FMove& Move) const
+{
+	return TArrayView<const FIdRun>(Runs.GetData() + Move.FirstRun, Move.NumRuns);
+}
+
+int32 FMinesweeperHistory::Num() const
+{
+	return Moves.Num();
+}
+
+SIZE_T FMinesweeperHistory::GetAllocatedSize() const
+{
+	return Runs.GetAllocatedSize() + Moves.GetAllocatedSize();
+}
+
+void FMinesweeperHistory::ApplyRuns(FMinesweeperBoard& Board, const FMove& Move, bool bDiscovered) const
+{
+	SWEEPER_SCOPE(History);
+
+	const int32 Cols = Board.Cols();
+	if (Cols <= 0)
+	{
+		return;
+	}
+
+	for (const FIdRun& Run : GetRuns(Move))
+	{
+		// Runs can wrap on the next row, walk them one row span at a time
+		int32 Id = Run.Start;
+		int32 Remaining = Run.Num;
+		while (Remaining > 0)
+		{
+			const int32 Row = Id / Cols;
+			const int32 Col = Id % Cols;
+			const int32 Span = FMath::Min(Remaining, Cols - Col);
+			if (Row >= Board.Rows())
+			{
+				break;
+			}
+
+			// Flags are not recorded: one put on a cell after its undo goes away when the cell is discovered again
+			FMinesweeperCell* Cells = Board.GetRowData(Row) + Col;
+			for (int32 i = 0; i < Span; ++i)
+			{
+				Cells[i].bDiscovered = bDiscovered;
+				Cells[i].bFlagged = Cells[i].bFlagged && !bDiscovered;
+			}
+
+			Id += Span;
+			Remaining -= Span;
+		}
+	}
+}
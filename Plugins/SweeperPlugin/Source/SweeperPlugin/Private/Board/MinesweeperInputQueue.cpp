@@ -0,0 +1,153 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Board/MinesweeperInputQueue.h"
+
+#include "Board/MinesweeperBoard.h"
+
+EMinesweeperCommandResult FMinesweeperInputQueue::Apply(FMinesweeperBoard& Board, EMinesweeperCommand Type, int32 Id, TArray<int32>& OutChangedIds)
+{
+	if (!Board.Exists(Id))
+	{
+		return EMinesweeperCommandResult::Unchanged;
+	}
+
+	const int32 Row = Id / Board.Cols();
+	const int32 Col = Id % Board.Cols();
+
+	if (Type == EMinesweeperCommand::ToggleFlag)
+	{
+		if (!Board.ToggleFlag(Row, Col))
+		{
+			return EMinesweeperCommandResult::Unchanged;
+		}
+
+		OutChangedIds.Add(Id);
+		return EMinesweeperCommandResult::Changed;
+	}
+
+	// Discovered and revealed ids never overlap, a plain array is enough to collect both
+	const int32 FirstChanged = OutChangedIds.Num();
+	bool bHitBomb = false;
+
+	if (Type == EMinesweeperCommand::Chord)
+	{
+		OutChangedIds.Append(Board.Chord(Row, Col, bHitBomb));
+	}
+	else if (Board.IsDiscovered(Row, Col) || Board.IsFlagged(Row, Col))
+	{
+		return EMinesweeperCommandResult::Unchanged;
+	}
+	else if (Board.IsBomb(Row, Col))
+	{
+		bHitBomb = true;
+	}
+	else
+	{
+		OutChangedIds.Append(Board.Discover(Row, Col));
+	}
+
+	if (bHitBomb)
+	{
+		// Reveal Board
+		OutChangedIds.Append(Board.Reveal());
+		return EMinesweeperCommandResult::Lost;
+	}
+
+	if (OutChangedIds.Num() == FirstChanged)
+	{
+		return EMinesweeperCommandResult::Unchanged;
+	}
+
+	if (Board.HasWon())
+	{
+		OutChangedIds.Append(Board.Reveal());
+		return EMinesweeperCommandResult::Won;
+	}
+
+	return EMinesweeperCommandResult::Changed;
+}
+
+bool FMinesweeperInputQueue::Push(EMinesweeperCommand Type, int32 Id, double InputTime)
+{
+	// Walks back to the last command this one can coalesce with, stopping at any command whose outcome depends on what lies between
+	for (int32 i = Commands.Num() - 1; i >= 0; --i)
+	{
+		const FMinesweeperCommand& Queued = Commands[i];
+		const bool bSame = Queued.Type == Type && Queued.Id == Id;
+		if (Type == EMinesweeperCommand::ToggleFlag)
+		{
+			if (bSame)
+			{
+				Commands.RemoveAt(i);
+				NumCoalesced += 2;
+				return false;
+			}
+
+			// Discovers and chords in between saw the flag: a flood fill stops at it, a chord counts it
+			if (Queued.Type != EMinesweeperCommand::ToggleFlag)
+			{
+				break;
+			}
+		}
+		else if (Type == EMinesweeperCommand::Discover)
+		{
+			if (bSame)
+			{
+				NumCoalesced++;
+				return false;
+			}
+
+			// The first Discover may have been blocked by a flag removed since
+			if (Queued.Type == EMinesweeperCommand::ToggleFlag && Queued.Id == Id)
+			{
+				break;
+			}
+		}
+		else
+		{
+			if (bSame)
+			{
+				NumCoalesced++;
+				return false;
+			}
+
+			// A chord depends on the flags around the cell and on the cell being discovered, which any other command can change
+			if (Queued.Type != EMinesweeperCommand::Chord)
+			{
+				break;
+			}
+		}
+	}
+
+	Commands.Add({Type, Id, InputTime});
+	return true;
+}
+
+void FMinesweeperInputQueue::Flush(TArray<FMinesweeperCommand>& OutCommands)
+{
+	OutCommands.Reset();
+	OutCommands.Append(Commands);
+	Commands.Reset();
+}
+
+void FMinesweeperInputQueue::Reset()
+{
+	Commands.Reset();
+	NumCoalesced = 0;
+}
+
+bool FMinesweeperInputQueue::IsEmpty() const
+{
+	return Commands.Num() == 0;
+}
+
+int32 FMinesweeperInputQueue::Num() const
+{
+	return Commands.Num();
+}
+
+int32 FMinesweeperInputQueue::GetNumCoalesced() const
+{
+	return NumCoalesced;
+}
@@ -0,0 +1,200 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Board/MinesweeperSnapshot.h"
+
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Memory/MemoryView.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Board/MinesweeperBoard.h"
+#include "SweeperPluginStats.h"
+
+FArchive& operator<<(FArchive& Ar, FMinesweeperSnapshot::FHeader& Header)
+{
+	Ar << Header.Magic;
+	Ar << Header.Version;
+	Ar << Header.HeaderSize;
+	Ar << Header.RowCount;
+	Ar << Header.ColCount;
+	Ar << Header.CellToDiscover;
+	Ar << Header.TotalBombCount;
+	Ar << Header.PayloadSize;
+	Ar << Header.PayloadChecksum;
+	return Ar;
+}
+
+FString FMinesweeperSnapshot::GetDefaultSnapshotPath(int32 Slot)
+{
+	const FString FileName = Slot > 0? FString::Printf(TEXT("LastGame_%d.sweeper"), Slot) : FString(TEXT("LastGame.sweeper"));
+	return FPaths::ProjectSavedDir() / TEXT("Minesweeper") / FileName;
+}
+
+void FMinesweeperSnapshot::Write(const FMinesweeperBoard& Board, TArray<uint8>& OutBytes)
+{
+	const int64 CellCount = static_cast<int64>(Board.Rows()) * Board.Cols();
+
+	TArray<uint8> Payload;
+	Payload.SetNumUninitialized(CellCount);
+	int64 PayloadIndex = 0;
+	for (int32 i = 0; i < Board.Rows(); ++i)
+	{
+		const FMinesweeperCell* RowData = Board.GetRowData(i);
+		for (int32 j = 0; j < Board.Cols(); ++j)
+		{
+			const FMinesweeperCell& Cell = RowData[j];
+			uint8 Packed = static_cast<uint8>(Cell.GetCount()) & COUNT_MASK;
+			Packed |= Cell.IsBomb()? BOMB_BIT : 0;
+			Packed |= Cell.IsDiscovered()? DISCOVERED_BIT : 0;
+			Packed |= Cell.IsFlagged()? FLAGGED_BIT : 0;
+			Payload[PayloadIndex++] = Packed;
+		}
+	}
+
+	FHeader Header;
+	Header.RowCount = Board.Rows();
+	Header.ColCount = Board.Cols();
+	Header.CellToDiscover = Board.CellToDiscover;
+	Header.TotalBombCount = Board.GetTotalBombCount();
+	Header.PayloadSize = Payload.Num();
+	Header.PayloadChecksum = FCrc::MemCrc32(Payload.GetData(), Payload.Num());
+
+	// Serialize once to know the header size, then for real with the size filled in
+	TArray<uint8> HeaderBytes;
+	FMemoryWriter SizeWriter(HeaderBytes);
+	SizeWriter << Header;
+	Header.HeaderSize = static_cast<uint16>(HeaderBytes.Num());
+
+	OutBytes.Reset(HeaderBytes.Num() + Payload.Num());
+	FMemoryWriter Writer(OutBytes);
+	Writer << Header;
+	Writer.Serialize(Payload.GetData(), Payload.Num());
+}
+
+bool FMinesweeperSnapshot::Read(const uint8* Data, int64 Size, FMinesweeperBoard& OutBoard)
+{
+	if (Data == nullptr || Size <= 0)
+	{
+		return false;
+	}
+
+	FHeader Header;
+	FMemoryReaderView Reader(FMemoryView(Data, Size));
+	Reader << Header;
+	if (Reader.IsError() || Header.Magic != MAGIC)
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Snapshot has no valid header."));
+		return false;
+	}
+
+	if (Header.Version > VERSION)
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Snapshot version %d not supported (max %d)."), Header.Version, VERSION);
+		return false;
+	}
+
+	// The payload starts after the whole header, never inside it
+	const int64 CellCount = static_cast<int64>(Header.RowCount) * Header.ColCount;
+	if (Header.HeaderSize < Reader.Tell() || Header.RowCount < 0 || Header.ColCount < 0 || Header.PayloadSize != CellCount
+		|| Header.HeaderSize + Header.PayloadSize > Size)
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Snapshot truncated or with inconsistent sizes."));
+		return false;
+	}
+
+	const uint8* Payload = Data + Header.HeaderSize;
+	if (FCrc::MemCrc32(Payload, Header.PayloadSize) != Header.PayloadChecksum)
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Snapshot checksum mismatch."));
+		return false;
+	}
+
+	// Counters come from the cells, the CRC doesn't cover the header
+	OutBoard.Init(Header.RowCount, Header.ColCount);
+	int32 CellToDiscover = 0;
+	int32 TotalBombCount = 0;
+	bool bMineDiscovered = false;
+
+	for (int32 i = 0; i < Header.RowCount; ++i)
+	{
+		FMinesweeperCell* Row = OutBoard.GetRowData(i);
+		const uint8* RowData = Payload + static_cast<int64>(i) * Header.ColCount;
+		for (int32 j = 0; j < Header.ColCount; ++j)
+		{
+			const uint8 Packed = RowData[j];
+			FMinesweeperCell& Cell = Row[j];
+			Cell.bIsBomb = (Packed & BOMB_BIT) != 0;
+			Cell.BombCount = Packed & COUNT_MASK;
+			Cell.bDiscovered = (Packed & DISCOVERED_BIT) != 0;
+			Cell.bFlagged = (Packed & FLAGGED_BIT) != 0;
+
+			TotalBombCount += Cell.bIsBomb? 1 : 0;
+			CellToDiscover += !Cell.bIsBomb && !Cell.bDiscovered? 1 : 0;
+			bMineDiscovered = bMineDiscovered || (Cell.bIsBomb && Cell.bDiscovered);
+		}
+	}
+
+	// A discovered mine is a lost game, revealed entirely: it must not read as won
+	OutBoard.TotalBombCount = TotalBombCount;
+	OutBoard.CellToDiscover = bMineDiscovered? FMath::Max(1, CellToDiscover) : CellToDiscover;
+
+	UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Restored board. Rows: %d | Cols: %d | CellToDiscover: %d | BombCount: %d"), OutBoard.RowCount, OutBoard.ColCount, OutBoard.CellToDiscover, OutBoard.TotalBombCount);
+	return true;
+}
+
+bool FMinesweeperSnapshot::SaveToFile(const FMinesweeperBoard& Board, const FString& Path)
+{
+	SWEEPER_SCOPE(Snapshot);
+
+	TArray<uint8> Bytes;
+	Write(Board, Bytes);
+
+	if (!FFileHelper::SaveArrayToFile(Bytes, *Path))
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Unable to save snapshot to %s"), *Path);
+		return false;
+	}
+
+	UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Snapshot saved to %s (%lld bytes)"), *Path, static_cast<int64>(Bytes.Num()));
+	return true;
+}
+
+bool FMinesweeperSnapshot::LoadFromFile(const FString& Path, FMinesweeperBoard& OutBoard)
+{
+	SWEEPER_SCOPE(Snapshot);
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.FileExists(*Path))
+	{
+		return false;
+	}
+
+	// Prefer mapping the file, so restoring is bounded by page-in and not by an extra copy
+	TUniquePtr<IMappedFileHandle> MappedFile(PlatformFile.OpenMapped(*Path));
+	if (MappedFile.IsValid() && MappedFile->GetFileSize() > 0)
+	{
+		TUniquePtr<IMappedFileRegion> Region(MappedFile->MapRegion(0, MappedFile->GetFileSize()));
+		if (Region.IsValid())
+		{
+			return Read(Region->GetMappedPtr(), Region->GetMappedSize(), OutBoard);
+		}
+	}
+
+	TArray64<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path))
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Unable to load snapshot from %s"), *Path);
+		return false;
+	}
+
+	return Read(Bytes.GetData(), Bytes.Num(), OutBoard);
+}
+
+bool FMinesweeperSnapshot::DeleteFile(const FString& Path)
+{
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	return !PlatformFile.FileExists(*Path) || PlatformFile.DeleteFile(*Path);
+}
@@ -0,0 +1,323 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/MinesweeperAllocationsCommandlet.h"
+
+#include "Board/MinesweeperBoard.h"
+#include "Board/MinesweeperHistory.h"
+#include "Board/MinesweeperInputQueue.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTLS.h"
+#include "Simulation/MinesweeperSimulation.h"
+
+namespace MinesweeperAllocations
+{
+	/** Forwards everything to the allocator it wraps, counting the allocations of one thread while enabled */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FCountingMalloc(FMalloc* InInner)
+			: Inner(InInner)
+			, ThreadId(FPlatformTLS::GetCurrentThreadId())
+		{
+		}
+
+		void SetCounting(bool bInCounting)
+		{
+			bCounting = bInCounting;
+		}
+
+		int64 GetAllocations() const { return Allocations; }
+		int64 GetBytes() const { return Bytes; }
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			Track(Count);
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			Track(Count);
+			return Inner->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			Track(Count);
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			Track(Count);
+			return Inner->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override
+		{
+			Inner->Free(Original);
+		}
+
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override
+		{
+			return Inner->QuantizeSize(Count, Alignment);
+		}
+
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override
+		{
+			return Inner->GetAllocationSize(Original, SizeOut);
+		}
+
+		virtual void Trim(bool bTrimThreadCaches) override
+		{
+			Inner->Trim(bTrimThreadCaches);
+		}
+
+		virtual void SetupTLSCachesOnCurrentThread() override
+		{
+			Inner->SetupTLSCachesOnCurrentThread();
+		}
+
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override
+		{
+			Inner->ClearAndDisableTLSCachesOnCurrentThread();
+		}
+
+		virtual bool IsInternallyThreadSafe() const override
+		{
+			return Inner->IsInternallyThreadSafe();
+		}
+
+		virtual const TCHAR* GetDescriptiveName() override
+		{
+			return Inner->GetDescriptiveName();
+		}
+
+	private:
+		void Track(SIZE_T Size)
+		{
+			// Other threads keep allocating (logging, task graph), only clicks matter
+			if (bCounting && Size > 0 && FPlatformTLS::GetCurrentThreadId() == ThreadId)
+			{
+				Allocations++;
+				Bytes += Size;
+			}
+		}
+
+	private:
+		FMalloc* Inner;
+		uint32 ThreadId;
+		bool bCounting = false;
+		int64 Allocations = 0;
+		int64 Bytes = 0;
+	};
+
+	struct FOptions
+	{
+		int32 Rows = 16;
+		int32 Cols = 30;
+		int32 Mines = 99;
+		int32 Games = 1000;
+		int32 WarmUp = 10;
+		int32 Seed = 0;
+	};
+
+	/** What the board widget keeps between clicks, reused game after game */
+	struct FPlayer
+	{
+		FMinesweeperBoard Board;
+		FMinesweeperHistory History;
+		FMinesweeperInputQueue InputQueue;
+		TArray<FMinesweeperCommand> FrameCommands;
+		TArray<int32> FrameChangedIds;
+		TArray<int32> ClickChangedIds;
+
+		/** Same order and recording as SMinesweeperBoard::ProcessCommands. @return true once the game ended */
+		bool ApplyFrame()
+		{
+			InputQueue.Flush(FrameCommands);
+			FrameChangedIds.Reset();
+			for (const FMinesweeperCommand& Command : FrameCommands)
+			{
+				ClickChangedIds.Reset();
+				const int32 CellToDiscoverBefore = Board.CellToDiscover;
+				const EMinesweeperCommandResult Result = FMinesweeperInputQueue::Apply(Board, Command.Type, Command.Id, ClickChangedIds);
+				if (Result == EMinesweeperCommandResult::Unchanged)
+				{
+					continue;
+				}
+
+				FrameChangedIds.Append(ClickChangedIds);
+				if (Command.Type == EMinesweeperCommand::ToggleFlag)
+				{
+					continue;
+				}
+
+				const bool bEnded = Result == EMinesweeperCommandResult::Won || Result == EMinesweeperCommandResult::Lost;
+				History.Record(ClickChangedIds, CellToDiscoverBefore, Board.CellToDiscover, bEnded);
+				if (bEnded)
+				{
+					return true;
+				}
+			}
+
+			return false;
+		}
+	};
+
+	static void CreateBoard(const FOptions& Options, FRandomStream& Random, TArray<int32>& CellIds, FPlayer& Player)
+	{
+		const int32 CellCount = Options.Rows * Options.Cols;
+		CellIds.SetNumUninitialized(CellCount, EAllowShrinking::No);
+		for (int32 i = 0; i < CellCount; ++i)
+		{
+			CellIds[i] = i;
+		}
+
+		const int32 Mines = FMath::Clamp(Options.Mines, 0, CellCount - 1);
+		for (int32 i = 0; i < Mines; ++i)
+		{
+			CellIds.Swap(i, Random.RandRange(i, CellCount - 1));
+		}
+
+		// As the widget does on a new board: model first, then queue, history and scratch sized for it
+		Player.Board.Create(Options.Rows, Options.Cols, TArrayView<const int32>(CellIds.GetData(), Mines));
+		Player.InputQueue.Reset();
+		Player.History.Reset(CellCount);
+		Player.ClickChangedIds.Reserve(FMath::Min(CellCount, FMinesweeperBoard::SCRATCH_RESERVE_CELLS));
+		Player.FrameChangedIds.Reserve(FMath::Min(CellCount, FMinesweeperBoard::SCRATCH_RESERVE_CELLS));
+	}
+
+	static int32 PickHidden(const FMinesweeperBoard& Board, FRandomStream& Random)
+	{
+		const int32 CellCount = Board.Rows() * Board.Cols();
+		for (int32 Attempt = 0; Attempt < 16; ++Attempt)
+		{
+			const int32 Id = Random.RandHelper(CellCount);
+			if (!Board.IsDiscovered(Id))
+			{
+				return Id;
+			}
+		}
+
+		return INDEX_NONE;
+	}
+}
+
+UMinesweeperAllocationsCommandlet::UMinesweeperAllocationsCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UMinesweeperAllocationsCommandlet::Main(const FString& Params)
+{
+	using namespace MinesweeperAllocations;
+
+	FOptions Options;
+	FParse::Value(*Params, TEXT("Rows="), Options.Rows);
+	FParse::Value(*Params, TEXT("Cols="), Options.Cols);
+	FParse::Value(*Params, TEXT("Mines="), Options.Mines);
+	FParse::Value(*Params, TEXT("Games="), Options.Games);
+	FParse::Value(*Params, TEXT("WarmUp="), Options.WarmUp);
+	FParse::Value(*Params, TEXT("Seed="), Options.Seed);
+	Options.Rows = FMath::Max(1, Options.Rows);
+	Options.Cols = FMath::Max(2, Options.Cols);
+	Options.Games = FMath::Max(1, Options.Games);
+	Options.WarmUp = FMath::Max(0, Options.WarmUp);
+
+	FPlayer Player;
+	FMinesweeperSolverStrategy Strategy;
+	FRandomStream Random(Options.Seed);
+	TArray<int32> CellIds;
+
+	FMalloc* InnerMalloc = GMalloc;
+	FCountingMalloc CountingMalloc(InnerMalloc);
+	GMalloc = &CountingMalloc;
+
+	int64 Clicks = 0;
+	int64 Frames = 0;
+	int32 AllocatingGame = INDEX_NONE;
+	for (int32 Game = 0; Game < Options.WarmUp + Options.Games; ++Game)
+	{
+		const bool bMeasured = Game >= Options.WarmUp;
+		CreateBoard(Options, Random, CellIds, Player);
+		Strategy.OnNewGame(Player.Board);
+
+		int32 FlaggedId = INDEX_NONE;
+		int32 LastDiscovered = INDEX_NONE;
+		for (int32 Step = 0; ; ++Step)
+		{
+			// Picking is the player's job, not the click's: outside the counted section
+			const int32 Id = Strategy.PickCell(Player.Board, Random);
+			if (Id == INDEX_NONE)
+			{
+				break;
+			}
+			const int32 FlagId = FlaggedId == INDEX_NONE && Step > 0 && Random.GetFraction() < 0.25f? PickHidden(Player.Board, Random) : INDEX_NONE;
+			const double InputTime = FPlatformTime::Seconds();
+
+			const int64 AllocationsBefore = CountingMalloc.GetAllocations();
+			CountingMalloc.SetCounting(bMeasured);
+
+			// A frame of clicks: a flag put or taken back, a double flag that cancels, a chord and the discover
+			int32 Pushed = 0;
+			if (FlaggedId != INDEX_NONE)
+			{
+				Pushed += Player.InputQueue.Push(EMinesweeperCommand::ToggleFlag, FlaggedId, InputTime)? 1 : 0;
+				FlaggedId = INDEX_NONE;
+			}
+			else if (FlagId != INDEX_NONE && FlagId != Id)
+			{
+				Pushed += Player.InputQueue.Push(EMinesweeperCommand::ToggleFlag, FlagId, InputTime)? 1 : 0;
+				FlaggedId = FlagId;
+			}
+			Player.InputQueue.Push(EMinesweeperCommand::ToggleFlag, Id, InputTime);
+			Player.InputQueue.Push(EMinesweeperCommand::ToggleFlag, Id, InputTime);
+			if (LastDiscovered != INDEX_NONE)
+			{
+				Pushed += Player.InputQueue.Push(EMinesweeperCommand::Chord, LastDiscovered, InputTime)? 1 : 0;
+			}
+			Pushed += Player.InputQueue.Push(EMinesweeperCommand::Discover, Id, InputTime)? 1 : 0;
+
+			bool bEnded = Player.ApplyFrame();
+			if (!bEnded && Step % 8 == 7 && Player.History.CanUndo())
+			{
+				Player.History.Undo(Player.Board);
+				Player.History.Redo(Player.Board);
+			}
+
+			CountingMalloc.SetCounting(false);
+			Clicks += bMeasured? Pushed + 2 : 0;
+			Frames += bMeasured? 1 : 0;
+			if (AllocatingGame == INDEX_NONE && CountingMalloc.GetAllocations() > AllocationsBefore)
+			{
+				AllocatingGame = Game;
+			}
+
+			LastDiscovered = Id;
+			if (bEnded)
+			{
+				break;
+			}
+		}
+	}
+
+	GMalloc = InnerMalloc;
+
+	UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - %dx%d, %d mines | %d games after %d warm up | %lld frames, %lld clicks | %lld allocations, %lld bytes"),
+		Options.Rows, Options.Cols, Options.Mines, Options.Games, Options.WarmUp, Frames, Clicks, CountingMalloc.GetAllocations(), CountingMalloc.GetBytes());
+
+	if (CountingMalloc.GetAllocations() > 0)
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Clicks allocated, first in game %d (replay with -Seed=%d -WarmUp=%d -Games=%d)"),
+			AllocatingGame, Options.Seed, Options.WarmUp, AllocatingGame - Options.WarmUp + 1);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,131 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/MinesweeperConvertCommandlet.h"
+
+#include "Async/ParallelFor.h"
+#include "Board/MinesweeperBoardFormats.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#include <atomic>
+
+UMinesweeperConvertCommandlet::UMinesweeperConvertCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UMinesweeperConvertCommandlet::Main(const FString& Params)
+{
+	FString InputPath;
+	FString OutputPath;
+	FString ToName;
+	FString FromName;
+	FParse::Value(*Params, TEXT("Input="), InputPath);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	FParse::Value(*Params, TEXT("To="), ToName);
+	FParse::Value(*Params, TEXT("From="), FromName);
+	const bool bRecursive = FParse::Param(*Params, TEXT("Recursive"));
+
+	const EMinesweeperBoardFormat To = FMinesweeperBoardFormats::FromName(ToName);
+	const EMinesweeperBoardFormat From = FromName.IsEmpty()? EMinesweeperBoardFormat::Unknown : FMinesweeperBoardFormats::FromName(FromName);
+	if (InputPath.IsEmpty() || OutputPath.IsEmpty() || To == EMinesweeperBoardFormat::Unknown || (!FromName.IsEmpty() && From == EMinesweeperBoardFormat::Unknown))
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Usage: -run=MinesweeperConvert -Input=Dir/Or/File -Output=Dir -To=text|mines|rle|bits [-From=text|mines|rle|bits] [-Recursive]"));
+		return 1;
+	}
+
+	TArray<FString> Files;
+	if (FPaths::DirectoryExists(InputPath))
+	{
+		if (bRecursive)
+		{
+			IFileManager::Get().FindFilesRecursive(Files, *InputPath, TEXT("*.*"), true, false);
+		}
+		else
+		{
+			IFileManager::Get().FindFiles(Files, *(InputPath / TEXT("*.*")), true, false);
+			for (FString& File : Files)
+			{
+				File = InputPath / File;
+			}
+		}
+	}
+	else
+	{
+		Files.Add(InputPath);
+		InputPath = FPaths::GetPath(InputPath);
+	}
+
+	if (Files.Num() == 0)
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - No board files in %s"), *InputPath);
+		return 1;
+	}
+
+	// Output keeps the input tree, directories are made up front so workers only touch files
+	TArray<FString> OutputFiles;
+	OutputFiles.Reserve(Files.Num());
+	for (const FString& File : Files)
+	{
+		FString Relative = File;
+		FPaths::MakePathRelativeTo(Relative, *(InputPath / TEXT("")));
+		FString OutputFile = FPaths::ChangeExtension(OutputPath / Relative, FMinesweeperBoardFormats::GetExtension(To));
+		IFileManager::Get().MakeDirectory(*FPaths::GetPath(OutputFile), true);
+		OutputFiles.Add(MoveTemp(OutputFile));
+	}
+
+	std::atomic<int64> BytesRead{0};
+	std::atomic<int64> BytesWritten{0};
+	std::atomic<int64> Mines{0};
+	std::atomic<int32> Failures{0};
+	const double Start = FPlatformTime::Seconds();
+
+	// One file per task, each with its own buffers: nothing is shared but the counters
+	ParallelFor(Files.Num(), [&](int32 Index)
+	{
+		TArray<uint8> Input;
+		if (!FFileHelper::LoadFileToArray(Input, *Files[Index]))
+		{
+			UE_LOG(LogSlate, Warning, TEXT("[MineSweeper] - Can't read %s"), *Files[Index]);
+			Failures++;
+			return;
+		}
+
+		const EMinesweeperBoardFormat FileFormat = From != EMinesweeperBoardFormat::Unknown? From : FMinesweeperBoardFormats::FromExtension(Files[Index]);
+		FMinesweeperLayout Layout;
+		FString Error;
+		if (!FMinesweeperBoardFormats::Import(Input, FileFormat, Layout, &Error))
+		{
+			UE_LOG(LogSlate, Warning, TEXT("[MineSweeper] - Skipped %s: %s"), *Files[Index], *Error);
+			Failures++;
+			return;
+		}
+
+		TArray<uint8> Output;
+		FMinesweeperBoardFormats::Export(Layout, To, Output);
+		if (!FFileHelper::SaveArrayToFile(Output, *OutputFiles[Index]))
+		{
+			UE_LOG(LogSlate, Warning, TEXT("[MineSweeper] - Can't write %s"), *OutputFiles[Index]);
+			Failures++;
+			return;
+		}
+
+		BytesRead += Input.Num();
+		BytesWritten += Output.Num();
+		Mines += Layout.MineIds.Num();
+	});
+
+	const double Seconds = FMath::Max(FPlatformTime::Seconds() - Start, 0.000001);
+	const int32 Converted = Files.Num() - Failures.load();
+	UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Converted %d/%d boards to %s in %.3fs | %.0f boards/s | read %.2fMB (%.1f MB/s) | written %.2fMB | %lld mines"),
+		Converted, Files.Num(), FMinesweeperBoardFormats::GetExtension(To), Seconds, Converted / Seconds,
+		BytesRead.load() / (1024.0 * 1024.0), BytesRead.load() / (1024.0 * 1024.0) / Seconds, BytesWritten.load() / (1024.0 * 1024.0), Mines.load());
+
+	return Failures.load() > 0? 1 : 0;
+}
@@ -0,0 +1,335 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/MinesweeperCoopCommandlet.h"
+
+#include "Board/MinesweeperBoard.h"
+#include "Coop/MinesweeperCoopSession.h"
+
+namespace MinesweeperCoopCommandlet
+{
+	struct FOptions
+	{
+		int32 Port = 7777;
+		FString Address = TEXT("127.0.0.1");
+		int32 Rows = 64;
+		int32 Cols = 64;
+		float Density = 0.1f;
+		int32 Seed = 1;
+		float Duration = 30.f;
+		int32 TickRate = 60;
+		int32 ActionsPerTick = 4;
+		int32 Clients = 2;
+		int64 Deltas = 1000000;
+		int32 Budget = 64 * 1024;
+	};
+
+	static void MakeBoard(const FOptions& Options, FRandomStream& Random, FMinesweeperBoard& OutBoard)
+	{
+		const int32 CellCount = Options.Rows * Options.Cols;
+		TArray<int32> Ids;
+		Ids.SetNumUninitialized(CellCount);
+		for (int32 i = 0; i < CellCount; ++i)
+		{
+			Ids[i] = i;
+		}
+
+		// Partial Fisher-Yates, only the mines are drawn
+		const int32 Mines = FMath::Clamp(FMath::RoundToInt32(CellCount * Options.Density), 0, CellCount - 1);
+		for (int32 i = 0; i < Mines; ++i)
+		{
+			Ids.Swap(i, Random.RandRange(i, CellCount - 1));
+		}
+
+		OutBoard.Create(Options.Rows, Options.Cols, TArrayView<const int32>(Ids.GetData(), Mines));
+	}
+
+	/** Mostly flags, so a benchmark run isn't dominated by game overs and new boards */
+	static void SubmitRandomAction(FMinesweeperCoopSession& Session, FRandomStream& Random)
+	{
+		const FMinesweeperBoard& Board = Session.GetBoard();
+		const int32 CellCount = Board.Rows() * Board.Cols();
+		if (CellCount <= 0)
+		{
+			return;
+		}
+
+		const int32 Id = Random.RandHelper(CellCount);
+		const float Roll = Random.GetFraction();
+		const EMinesweeperCommand Action = Roll < 0.8f? EMinesweeperCommand::ToggleFlag
+			: Roll < 0.95f? EMinesweeperCommand::Discover : EMinesweeperCommand::Chord;
+		Session.SubmitAction(Action, Id);
+	}
+
+	static void LogSession(const TCHAR* Name, const FMinesweeperCoopSession& Session)
+	{
+		const FMinesweeperCoopStats& Stats = Session.GetStats();
+		UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Co-op %s | epoch %u | sequence %lld | checksum %08x | deltas sent %lld, received %lld | bytes sent %lld, received %lld | snapshots sent %d, received %d"),
+			Name, Session.GetEpoch(), Session.GetSequence(), Session.GetBoardChecksum(), Stats.DeltasSent, Stats.DeltasReceived,
+			Stats.BytesSent, Stats.BytesReceived, Stats.SnapshotsSent, Stats.SnapshotsReceived);
+	}
+
+	static int32 RunHost(const FOptions& Options, const FMinesweeperCoopSettings& Settings)
+	{
+		TUniquePtr<FMinesweeperCoopSession> Host = FMinesweeperCoopSession::Host(Options.Port, Settings);
+		if (!Host.IsValid())
+		{
+			return 1;
+		}
+
+		FRandomStream Random(Options.Seed);
+		FMinesweeperBoard Board;
+		MakeBoard(Options, Random, Board);
+		Host->StartBoard(Board);
+
+		const double End = FPlatformTime::Seconds() + Options.Duration;
+		while (FPlatformTime::Seconds() < End)
+		{
+			Host->Tick();
+			if (Host->IsGameOver())
+			{
+				MakeBoard(Options, Random, Board);
+				Host->StartBoard(Board);
+			}
+			FPlatformProcess::Sleep(1.f / Options.TickRate);
+		}
+
+		LogSession(TEXT("host"), *Host);
+		return 0;
+	}
+
+	static int32 RunClient(const FOptions& Options, const FMinesweeperCoopSettings& Settings)
+	{
+		TUniquePtr<FMinesweeperCoopSession> Client = FMinesweeperCoopSession::Join(Options.Address, Options.Port, Settings);
+		if (!Client.IsValid())
+		{
+			return 1;
+		}
+
+		FRandomStream Random(Options.Seed + 1);
+		const double End = FPlatformTime::Seconds() + Options.Duration;
+		while (FPlatformTime::Seconds() < End)
+		{
+			if (Client->IsReady() && !Client->IsGameOver())
+			{
+				for (int32 i = 0; i < Options.ActionsPerTick; ++i)
+				{
+					SubmitRandomAction(*Client, Random);
+				}
+			}
+
+			Client->Tick();
+			FPlatformProcess::Sleep(1.f / Options.TickRate);
+		}
+
+		// Lets the last answers of the host arrive, the checksum then matches the host one if it stopped playing too
+		const double DrainEnd = FPlatformTime::Seconds() + 1.0;
+		while (FPlatformTime::Seconds() < DrainEnd)
+		{
+			Client->Tick();
+			FPlatformProcess::Sleep(0.01f);
+		}
+
+		LogSession(TEXT("client"), *Client);
+		return Client->IsReady()? 0 : 1;
+	}
+
+	static int32 RunBenchmark(const FOptions& Options, const FMinesweeperCoopSettings& Settings)
+	{
+		TUniquePtr<FMinesweeperCoopSession> Host = FMinesweeperCoopSession::Host(Options.Port, Settings);
+		if (!Host.IsValid())
+		{
+			return 1;
+		}
+
+		TArray<TUniquePtr<FMinesweeperCoopSession>> Clients;
+		for (int32 i = 0; i < Options.Clients; ++i)
+		{
+			TUniquePtr<FMinesweeperCoopSession> Client = FMinesweeperCoopSession::Join(TEXT("127.0.0.1"), Options.Port, Settings);
+			if (!Client.IsValid())
+			{
+				return 1;
+			}
+			Clients.Add(MoveTemp(Client));
+		}
+
+		FRandomStream Random(Options.Seed);
+		FMinesweeperBoard Board;
+		MakeBoard(Options, Random, Board);
+		Host->StartBoard(Board);
+
+		auto TickAll = [&Host, &Clients]()
+		{
+			Host->Tick();
+			for (const TUniquePtr<FMinesweeperCoopSession>& Client : Clients)
+			{
+				Client->Tick();
+			}
+		};
+
+		auto AllCaughtUp = [&Host, &Clients]()
+		{
+			for (const TUniquePtr<FMinesweeperCoopSession>& Client : Clients)
+			{
+				if (!Client->IsReady() || Client->GetEpoch() != Host->GetEpoch() || Client->GetSequence() != Host->GetSequence())
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+
+		// Everyone holds the first board before the clock starts
+		const double Timeout = FPlatformTime::Seconds() + 10.0;
+		while (!AllCaughtUp() && FPlatformTime::Seconds() < Timeout)
+		{
+			TickAll();
+		}
+
+		const double Start = FPlatformTime::Seconds();
+		int64 Applied = 0;
+		int32 Boards = 1;
+		int32 Ticks = 0;
+		while (Applied < Options.Deltas && FPlatformTime::Seconds() - Start < 120.0)
+		{
+			for (int32 i = 0; i < Options.ActionsPerTick; ++i)
+			{
+				SubmitRandomAction(*Host, Random);
+			}
+
+			const int64 Before = Host->GetSequence();
+			const uint32 EpochBefore = Host->GetEpoch();
+			TickAll();
+			Ticks++;
+			Applied += Host->GetEpoch() == EpochBefore? Host->GetSequence() - Before : 0;
+
+			if (Host->IsGameOver())
+			{
+				MakeBoard(Options, Random, Board);
+				Host->StartBoard(Board);
+				Boards++;
+			}
+		}
+
+		while (!AllCaughtUp() && FPlatformTime::Seconds() - Start < 180.0)
+		{
+			TickAll();
+		}
+		const double Seconds = FPlatformTime::Seconds() - Start;
+
+		int32 Mismatches = 0;
+		int64 Received = 0;
+		int64 BytesReceived = 0;
+		for (const TUniquePtr<FMinesweeperCoopSession>& Client : Clients)
+		{
+			Received += Client->GetStats().DeltasReceived;
+			BytesReceived += Client->GetStats().BytesReceived;
+			Mismatches += Client->GetBoardChecksum() != Host->GetBoardChecksum() || Client->IsGameOver() != Host->IsGameOver()? 1 : 0;
+		}
+
+		LogSession(TEXT("host"), *Host);
+		UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Co-op benchmark %dx%d, %d clients, budget %d bytes/tick | %lld deltas applied in %.2fs over %d ticks and %d boards | %.0f deltas/s applied | %.0f deltas/s received per client | %.2f bytes/delta on the wire (snapshots included)"),
+			Options.Rows, Options.Cols, Options.Clients, Settings.MaxBytesPerTick, Applied, Seconds, Ticks, Boards,
+			Applied / Seconds, Received / Seconds / FMath::Max(1, Options.Clients), Received > 0? static_cast<double>(BytesReceived) / Received : 0.0);
+
+		if (Mismatches > 0 || !AllCaughtUp())
+		{
+			UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Co-op benchmark: %d clients out of sync with the host"), Mismatches);
+			return 1;
+		}
+
+		// A client joining a lost board must see it over from the snapshot alone, the board cells read like a game in progress
+		const FMinesweeperBoard& HostBoard = Host->GetBoard();
+		for (int32 Id = 0; Id < HostBoard.Rows() * HostBoard.Cols() && !Host->IsGameOver(); ++Id)
+		{
+			if (HostBoard.IsBomb(Id) && !HostBoard.IsFlagged(Id))
+			{
+				Host->SubmitAction(EMinesweeperCommand::Discover, Id);
+				Host->Tick();
+			}
+		}
+
+		TUniquePtr<FMinesweeperCoopSession> LateClient = FMinesweeperCoopSession::Join(TEXT("127.0.0.1"), Options.Port, Settings);
+		const double LateTimeout = FPlatformTime::Seconds() + 10.0;
+		while (LateClient.IsValid() && !LateClient->IsReady() && FPlatformTime::Seconds() < LateTimeout)
+		{
+			Host->Tick();
+			LateClient->Tick();
+		}
+
+		if (!Host->IsGameOver() || !LateClient.IsValid() || !LateClient->IsGameOver())
+		{
+			UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Co-op benchmark: a client joining a lost board doesn't see the game over"));
+			return 1;
+		}
+
+		return 0;
+	}
+}
+
+UMinesweeperCoopCommandlet::UMinesweeperCoopCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UMinesweeperCoopCommandlet::Main(const FString& Params)
+{
+	using namespace MinesweeperCoopCommandlet;
+
+	FString Role = TEXT("Benchmark");
+	FParse::Value(*Params, TEXT("Role="), Role);
+	const bool bBenchmark = Role.Equals(TEXT("Benchmark"), ESearchCase::IgnoreCase);
+
+	FOptions Options;
+	if (bBenchmark)
+	{
+		// Large board, few mines: long games, so deltas and not snapshots are measured
+		Options.Rows = 1000;
+		Options.Cols = 1000;
+		Options.Density = 0.01f;
+		Options.ActionsPerTick = 4096;
+	}
+
+	FParse::Value(*Params, TEXT("Port="), Options.Port);
+	FParse::Value(*Params, TEXT("Address="), Options.Address);
+	FParse::Value(*Params, TEXT("Rows="), Options.Rows);
+	FParse::Value(*Params, TEXT("Cols="), Options.Cols);
+	FParse::Value(*Params, TEXT("Density="), Options.Density);
+	FParse::Value(*Params, TEXT("Seed="), Options.Seed);
+	FParse::Value(*Params, TEXT("Duration="), Options.Duration);
+	FParse::Value(*Params, TEXT("TickRate="), Options.TickRate);
+	FParse::Value(*Params, TEXT("ActionsPerTick="), Options.ActionsPerTick);
+	FParse::Value(*Params, TEXT("Clients="), Options.Clients);
+	FParse::Value(*Params, TEXT("Deltas="), Options.Deltas);
+	FParse::Value(*Params, TEXT("Budget="), Options.Budget);
+
+	Options.Rows = FMath::Clamp(Options.Rows, 1, 4096);
+	Options.Cols = FMath::Clamp(Options.Cols, 1, 4096);
+	Options.TickRate = FMath::Max(1, Options.TickRate);
+	Options.Clients = FMath::Max(1, Options.Clients);
+
+	FMinesweeperCoopSettings Settings;
+	Settings.MaxBytesPerTick = Options.Budget;
+
+	if (Role.Equals(TEXT("Host"), ESearchCase::IgnoreCase))
+	{
+		return RunHost(Options, Settings);
+	}
+
+	if (Role.Equals(TEXT("Client"), ESearchCase::IgnoreCase))
+	{
+		return RunClient(Options, Settings);
+	}
+
+	if (bBenchmark)
+	{
+		return RunBenchmark(Options, Settings);
+	}
+
+	UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Unknown role %s, expected Host, Client or Benchmark"), *Role);
+	return 1;
+}
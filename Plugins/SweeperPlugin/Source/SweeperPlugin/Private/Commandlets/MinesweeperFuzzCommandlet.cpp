@@ -0,0 +1,902 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/MinesweeperFuzzCommandlet.h"
+
+#include "Async/ParallelFor.h"
+#include "Board/MinesweeperBoard.h"
+#include "Board/MinesweeperFixedBoard.h"
+#include "HAL/PlatformTime.h"
+
+#include <atomic>
+#include <type_traits>
+
+namespace MinesweeperFuzz
+{
+	static constexpr int32 CASES_PER_BATCH = 256;
+	// Workers stop once this many cases failed, the first ones are enough to replay
+	static constexpr int32 MAX_FAILURES = 8;
+
+	struct FFuzzSettings
+	{
+		int64 Cases = 1000000;
+		float Seconds = 0.f;
+		int32 Seed = 0;
+		int32 MaxSize = 24;
+		int32 MaxClicks = 16;
+		int32 Workers = 0;
+	};
+
+	enum class EFuzzOp : uint8
+	{
+		Discover,
+		Flag,
+		Chord,
+		Reveal
+	};
+
+	struct FFuzzOp
+	{
+		EFuzzOp Type = EFuzzOp::Discover;
+		int32 Row = 0;
+		int32 Col = 0;
+	};
+
+	static const TCHAR* GetOpName(EFuzzOp Type)
+	{
+		switch (Type)
+		{
+		case EFuzzOp::Discover: return TEXT("Discover");
+		case EFuzzOp::Flag: return TEXT("Flag");
+		case EFuzzOp::Chord: return TEXT("Chord");
+		case EFuzzOp::Reveal: return TEXT("Reveal");
+		}
+		return TEXT("Unknown");
+	}
+
+	/**
+	 * The rules written the obvious way: flat arrays, every neighbour bounds checked, counts recomputed each time they are read.
+	 * Slow on purpose, nothing in it shares code with the boards it checks.
+	 */
+	class FOracleBoard
+	{
+	public:
+		void Create(int32 InRows, int32 InCols, TArrayView<const int32> MineIds)
+		{
+			Rows = InRows;
+			Cols = InCols;
+			Mines.Init(false, Rows * Cols);
+			Discovered.Init(false, Rows * Cols);
+			Flagged.Init(false, Rows * Cols);
+			for (const int32 Id : MineIds)
+			{
+				if (Id >= 0 && Id < Rows * Cols)
+				{
+					Mines[Id] = true;
+				}
+			}
+		}
+
+		bool Exists(int32 Row, int32 Col) const
+		{
+			return Row >= 0 && Row < Rows && Col >= 0 && Col < Cols;
+		}
+
+		bool IsMine(int32 Row, int32 Col) const
+		{
+			return Exists(Row, Col) && Mines[Row * Cols + Col];
+		}
+
+		int32 CountMines() const
+		{
+			int32 Count = 0;
+			for (const bool bMine : Mines)
+			{
+				Count += bMine? 1 : 0;
+			}
+			return Count;
+		}
+
+		int32 Recount(int32 Row, int32 Col) const
+		{
+			int32 Count = 0;
+			for (int32 RowOffset = -1; RowOffset <= 1; ++RowOffset)
+			{
+				for (int32 ColOffset = -1; ColOffset <= 1; ++ColOffset)
+				{
+					if ((RowOffset != 0 || ColOffset != 0) && IsMine(Row + RowOffset, Col + ColOffset))
+					{
+						Count++;
+					}
+				}
+			}
+			return Count;
+		}
+
+		/** Neighbours set in Cells, one of Mines, Discovered or Flagged */
+		int32 CountNeighbours(int32 Row, int32 Col, const TArray<bool>& Cells) const
+		{
+			int32 Count = 0;
+			ForEachNeighbour(Row, Col, [&Cells, &Count](int32 Id)
+			{
+				Count += Cells[Id]? 1 : 0;
+			});
+			return Count;
+		}
+
+		/** Won when every safe cell is discovered */
+		bool HasWon() const
+		{
+			for (int32 Id = 0; Id < Mines.Num(); ++Id)
+			{
+				if (!Mines[Id] && !Discovered[Id])
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		bool ToggleFlag(int32 Row, int32 Col)
+		{
+			if (!Exists(Row, Col) || Discovered[Row * Cols + Col])
+			{
+				return false;
+			}
+
+			Flagged[Row * Cols + Col] = !Flagged[Row * Cols + Col];
+			return true;
+		}
+
+		void Discover(int32 Row, int32 Col, TArray<int32>& OutIds)
+		{
+			OutIds.Reset();
+			if (!Exists(Row, Col) || Discovered[Row * Cols + Col] || Flagged[Row * Cols + Col])
+			{
+				return;
+			}
+
+			Discovered[Row * Cols + Col] = true;
+			OutIds.Add(Row * Cols + Col);
+			if (!Mines[Row * Cols + Col])
+			{
+				FloodFill(OutIds);
+			}
+		}
+
+		void Chord(int32 Row, int32 Col, TArray<int32>& OutIds, bool& bOutHitMine)
+		{
+			OutIds.Reset();
+			bOutHitMine = false;
+			if (!Exists(Row, Col) || !Discovered[Row * Cols + Col] || Mines[Row * Cols + Col] || Recount(Row, Col) == 0)
+			{
+				return;
+			}
+
+			int32 HiddenFlags = 0;
+			ForEachNeighbour(Row, Col, [this, &HiddenFlags](int32 Id)
+			{
+				HiddenFlags += Flagged[Id] && !Discovered[Id]? 1 : 0;
+			});
+			if (HiddenFlags != Recount(Row, Col))
+			{
+				return;
+			}
+
+			ForEachNeighbour(Row, Col, [this, &OutIds, &bOutHitMine](int32 Id)
+			{
+				if (Discovered[Id] || Flagged[Id])
+				{
+					return;
+				}
+
+				if (Mines[Id])
+				{
+					bOutHitMine = true;
+					return;
+				}
+
+				Discovered[Id] = true;
+				OutIds.Add(Id);
+			});
+			FloodFill(OutIds);
+		}
+
+		void Reveal(TArray<int32>& OutIds)
+		{
+			OutIds.Reset();
+			for (int32 Id = 0; Id < Discovered.Num(); ++Id)
+			{
+				if (!Discovered[Id])
+				{
+					Discovered[Id] = true;
+					OutIds.Add(Id);
+				}
+			}
+		}
+
+	private:
+		template<typename TFunctor>
+		void ForEachNeighbour(int32 Row, int32 Col, TFunctor&& Functor) const
+		{
+			for (int32 RowOffset = -1; RowOffset <= 1; ++RowOffset)
+			{
+				for (int32 ColOffset = -1; ColOffset <= 1; ++ColOffset)
+				{
+					if ((RowOffset != 0 || ColOffset != 0) && Exists(Row + RowOffset, Col + ColOffset))
+					{
+						Functor((Row + RowOffset) * Cols + Col + ColOffset);
+					}
+				}
+			}
+		}
+
+		/** Grows OutIds from the cells already in it: empty cells discover their hidden, unflagged neighbours */
+		void FloodFill(TArray<int32>& OutIds)
+		{
+			for (int32 Head = 0; Head < OutIds.Num(); ++Head)
+			{
+				const int32 Row = OutIds[Head] / Cols;
+				const int32 Col = OutIds[Head] % Cols;
+				if (Recount(Row, Col) != 0)
+				{
+					continue;
+				}
+
+				ForEachNeighbour(Row, Col, [this, &OutIds](int32 Id)
+				{
+					if (!Discovered[Id] && !Flagged[Id])
+					{
+						Discovered[Id] = true;
+						OutIds.Add(Id);
+					}
+				});
+			}
+		}
+
+	public:
+		int32 Rows = 0;
+		int32 Cols = 0;
+		TArray<bool> Mines;
+		TArray<bool> Discovered;
+		TArray<bool> Flagged;
+	};
+
+	struct FWorkerContext
+	{
+		FRandomStream Random;
+		// Recycled case after case, like boards are game after game
+		FMinesweeperBoard Board;
+		FOracleBoard Oracle;
+
+		FString BoardText;
+		TArray<int32> MineIds;
+		TArray<int32> RoundTripIds;
+		TArray<int32> BoardIds;
+		TArray<int32> OracleIds;
+		TArray<int32> Candidates;
+		TArray<FFuzzOp> Ops;
+		bool bRevealed = false;
+		bool bTrace = false;
+		FString Error;
+
+		int64 Cases = 0;
+		int64 Clicks = 0;
+		int64 DiscoveredCells = 0;
+		int64 Wins = 0;
+		int64 MinesHit = 0;
+		int64 FixedCases = 0;
+	};
+
+	static bool Fail(FWorkerContext& Context, const FString& Message)
+	{
+		Context.Error = Message;
+		return false;
+	}
+
+	/**
+	 * Reads a board string the way the format is specified, not through FString::ParseIntoArray like FMinesweeperBoard:
+	 * rows split on '|', elements on ',', empty ones dropped, only "1" is a mine, the widest row sets the column count.
+	 */
+	static void ParseBoardText(const FString& Text, int32& OutRows, int32& OutCols, TArray<int32>& OutMineIds)
+	{
+		TArray<FIntPoint, TInlineAllocator<64>> Mines;
+		OutRows = 0;
+		OutCols = 0;
+		int32 RowLength = 0;
+		int32 Elements = 0;
+		int32 ElementLength = 0;
+		TCHAR ElementFirst = 0;
+		for (int32 i = 0; i <= Text.Len(); ++i)
+		{
+			const TCHAR Char = i < Text.Len()? Text[i] : TEXT('|');
+			if (Char != TEXT('|') && Char != TEXT(','))
+			{
+				ElementFirst = ElementLength == 0? Char : ElementFirst;
+				ElementLength++;
+				RowLength++;
+				continue;
+			}
+
+			if (ElementLength > 0)
+			{
+				if (ElementLength == 1 && ElementFirst == TEXT('1'))
+				{
+					Mines.Add(FIntPoint(OutRows, Elements));
+				}
+				Elements++;
+				ElementLength = 0;
+			}
+
+			if (Char == TEXT(','))
+			{
+				RowLength++;
+				continue;
+			}
+
+			if (RowLength > 0)
+			{
+				OutCols = FMath::Max(OutCols, Elements);
+				OutRows++;
+			}
+			RowLength = 0;
+			Elements = 0;
+		}
+
+		OutMineIds.Reset();
+		for (const FIntPoint& Mine : Mines)
+		{
+			OutMineIds.Add(Mine.X * OutCols + Mine.Y);
+		}
+	}
+
+	static void GenerateBoardText(FRandomStream& Random, int32 Rows, int32 Cols, float Density, bool bMalformed, FString& OutText)
+	{
+		static const TCHAR* NoiseTokens[] = { TEXT(" "), TEXT(" 1"), TEXT("1 "), TEXT("2"), TEXT("11"), TEXT("01"), TEXT("x"), TEXT("-1"), TEXT("\n") };
+
+		OutText.Reset();
+		for (int32 Row = 0; Row < Rows; ++Row)
+		{
+			if (Row != 0)
+			{
+				OutText.AppendChar(TEXT('|'));
+			}
+			if (bMalformed && Random.FRand() < 0.05f)
+			{
+				OutText.AppendChar(TEXT('|'));
+			}
+
+			// Ragged rows: the widest one sets the size, the others are padded with safe cells
+			const int32 RowCols = bMalformed && Random.FRand() < 0.2f? Random.RandRange(0, Cols) : Cols;
+			for (int32 Col = 0; Col < RowCols; ++Col)
+			{
+				if (Col != 0)
+				{
+					OutText.AppendChar(TEXT(','));
+				}
+				if (bMalformed && Random.FRand() < 0.05f)
+				{
+					OutText.AppendChar(TEXT(','));
+				}
+
+				if (bMalformed && Random.FRand() < 0.1f)
+				{
+					OutText.Append(NoiseTokens[Random.RandHelper(UE_ARRAY_COUNT(NoiseTokens))]);
+				}
+				else
+				{
+					OutText.AppendChar(Random.FRand() < Density? TEXT('1') : TEXT('0'));
+				}
+			}
+		}
+
+		if (bMalformed && Random.FRand() < 0.1f)
+		{
+			OutText.AppendChar(Random.FRand() < 0.5f? TEXT('|') : TEXT(','));
+		}
+		if (bMalformed && Random.FRand() < 0.1f)
+		{
+			OutText.InsertAt(0, TEXT('|'));
+		}
+	}
+
+	/** Mine ids as a caller could pass them: duplicates and ids outside the board included, both must be ignored */
+	static void GenerateMineIds(FRandomStream& Random, int32 Rows, int32 Cols, float Density, TArray<int32>& OutMineIds)
+	{
+		OutMineIds.Reset();
+		const int32 CellCount = Rows * Cols;
+		const int32 Mines = FMath::RoundToInt32(CellCount * Density);
+		for (int32 i = 0; i < Mines; ++i)
+		{
+			OutMineIds.Add(Random.RandRange(0, CellCount - 1));
+		}
+		if (Random.FRand() < 0.2f)
+		{
+			OutMineIds.Add(Random.FRand() < 0.5f? -1 : CellCount);
+		}
+	}
+
+	template<typename TBoard>
+	static bool CheckCreated(FWorkerContext& Context, const TBoard& Board)
+	{
+		const FOracleBoard& Oracle = Context.Oracle;
+		if (Board.Rows() != Oracle.Rows || Board.Cols() != Oracle.Cols)
+		{
+			return Fail(Context, FString::Printf(TEXT("Board is %dx%d, expected %dx%d"), Board.Rows(), Board.Cols(), Oracle.Rows, Oracle.Cols));
+		}
+
+		if (Board.GetTotalBombCount() != Oracle.CountMines())
+		{
+			return Fail(Context, FString::Printf(TEXT("Board has %d mines, expected %d"), Board.GetTotalBombCount(), Oracle.CountMines()));
+		}
+
+		for (int32 Row = 0; Row < Oracle.Rows; ++Row)
+		{
+			for (int32 Col = 0; Col < Oracle.Cols; ++Col)
+			{
+				if (Board.IsBomb(Row, Col) != Oracle.IsMine(Row, Col) || Board.IsBomb(Row * Oracle.Cols + Col) != Oracle.IsMine(Row, Col))
+				{
+					return Fail(Context, FString::Printf(TEXT("Cell %d,%d mine mismatch, expected %d"), Row, Col, Oracle.IsMine(Row, Col)? 1 : 0));
+				}
+
+				if (Board.GetCount(Row, Col) != Oracle.Recount(Row, Col))
+				{
+					return Fail(Context, FString::Printf(TEXT("Cell %d,%d counts %d mines, recount is %d"), Row, Col, Board.GetCount(Row, Col), Oracle.Recount(Row, Col)));
+				}
+
+				if (Board.IsDiscovered(Row, Col))
+				{
+					return Fail(Context, FString::Printf(TEXT("Cell %d,%d discovered on a new board"), Row, Col));
+				}
+			}
+		}
+
+		// Around the board: the border cells must never leak through the public API
+		if (Board.Exists(-1) || Board.Exists(Oracle.Rows * Oracle.Cols) || Board.Exists(-1, 0) || Board.Exists(0, Oracle.Cols)
+			|| Board.IsBomb(-1, 0) || Board.IsDiscovered(Oracle.Rows, 0) || Board.IsDiscovered(0, Oracle.Cols) || Board.GetCount(0, -1) != 0)
+		{
+			return Fail(Context, TEXT("A cell outside the board is reported"));
+		}
+
+		if (Board.HasWon() != Oracle.HasWon())
+		{
+			return Fail(Context, FString::Printf(TEXT("New board HasWon is %d"), Board.HasWon()? 1 : 0));
+		}
+
+		return true;
+	}
+
+	/** Ids returned by the board: in range, each once, all hidden before the call. Copied, the view is only valid until the next call */
+	static bool CheckChangedIds(FWorkerContext& Context, TArrayView<const int32> Ids)
+	{
+		const FOracleBoard& Oracle = Context.Oracle;
+		Context.BoardIds.Reset();
+		Context.BoardIds.Append(Ids.GetData(), Ids.Num());
+		for (const int32 Id : Context.BoardIds)
+		{
+			if (static_cast<uint32>(Id) >= static_cast<uint32>(Oracle.Rows * Oracle.Cols))
+			{
+				return Fail(Context, FString::Printf(TEXT("Changed id %d is outside the board"), Id));
+			}
+
+			if (Oracle.Discovered[Id])
+			{
+				return Fail(Context, FString::Printf(TEXT("Changed id %d was already discovered"), Id));
+			}
+		}
+
+		Context.BoardIds.Sort();
+		for (int32 i = 1; i < Context.BoardIds.Num(); ++i)
+		{
+			if (Context.BoardIds[i] == Context.BoardIds[i - 1])
+			{
+				return Fail(Context, FString::Printf(TEXT("Changed id %d returned twice"), Context.BoardIds[i]));
+			}
+		}
+
+		return true;
+	}
+
+	/** Once the oracle played the same step: same changed cells, same state everywhere */
+	template<typename TBoard>
+	static bool CheckState(FWorkerContext& Context, const TBoard& Board)
+	{
+		const FOracleBoard& Oracle = Context.Oracle;
+		Context.OracleIds.Sort();
+		if (Context.BoardIds != Context.OracleIds)
+		{
+			return Fail(Context, FString::Printf(TEXT("%d cells changed, expected %d"), Context.BoardIds.Num(), Context.OracleIds.Num()));
+		}
+
+		for (int32 Id = 0; Id < Oracle.Rows * Oracle.Cols; ++Id)
+		{
+			if (Board.IsDiscovered(Id) != Oracle.Discovered[Id])
+			{
+				return Fail(Context, FString::Printf(TEXT("Cell %d discovered mismatch, expected %d"), Id, Oracle.Discovered[Id]? 1 : 0));
+			}
+
+			if constexpr (std::is_same_v<TBoard, FMinesweeperBoard>)
+			{
+				if (Board.IsFlagged(Id) != Oracle.Flagged[Id])
+				{
+					return Fail(Context, FString::Printf(TEXT("Cell %d flag mismatch, expected %d"), Id, Oracle.Flagged[Id]? 1 : 0));
+				}
+			}
+		}
+
+		// Reveal ends the game, the win counter isn't kept past it
+		if (!Context.bRevealed && Board.HasWon() != Oracle.HasWon())
+		{
+			return Fail(Context, FString::Printf(TEXT("HasWon is %d, expected %d"), Board.HasWon()? 1 : 0, Oracle.HasWon()? 1 : 0));
+		}
+
+		return true;
+	}
+
+	template<typename TBoard>
+	static bool ApplyOp(FWorkerContext& Context, TBoard& Board, const FFuzzOp& Op)
+	{
+		FOracleBoard& Oracle = Context.Oracle;
+		switch (Op.Type)
+		{
+		case EFuzzOp::Discover:
+			if (!CheckChangedIds(Context, Board.Discover(Op.Row, Op.Col)))
+			{
+				return false;
+			}
+			Oracle.Discover(Op.Row, Op.Col, Context.OracleIds);
+			Context.MinesHit += Context.OracleIds.Num() == 1 && Oracle.Mines[Context.OracleIds[0]]? 1 : 0;
+			break;
+
+		case EFuzzOp::Reveal:
+			if (!CheckChangedIds(Context, Board.Reveal()))
+			{
+				return false;
+			}
+			Oracle.Reveal(Context.OracleIds);
+			Context.bRevealed = true;
+			break;
+
+		case EFuzzOp::Flag:
+		case EFuzzOp::Chord:
+			// Fixed boards have neither, they only replay discover only cases
+			Context.BoardIds.Reset();
+			Context.OracleIds.Reset();
+			if constexpr (std::is_same_v<TBoard, FMinesweeperBoard>)
+			{
+				if (Op.Type == EFuzzOp::Flag)
+				{
+					const bool bToggled = Board.ToggleFlag(Op.Row, Op.Col);
+					if (bToggled != Oracle.ToggleFlag(Op.Row, Op.Col))
+					{
+						return Fail(Context, FString::Printf(TEXT("ToggleFlag returned %d"), bToggled? 1 : 0));
+					}
+					break;
+				}
+
+				bool bHitMine = false;
+				bool bOracleHitMine = false;
+				if (!CheckChangedIds(Context, Board.Chord(Op.Row, Op.Col, bHitMine)))
+				{
+					return false;
+				}
+				Oracle.Chord(Op.Row, Op.Col, Context.OracleIds, bOracleHitMine);
+				if (bHitMine != bOracleHitMine)
+				{
+					return Fail(Context, FString::Printf(TEXT("Chord hit mine is %d, expected %d"), bHitMine? 1 : 0, bOracleHitMine? 1 : 0));
+				}
+				Context.MinesHit += bHitMine? 1 : 0;
+			}
+			break;
+		}
+
+		Context.DiscoveredCells += Context.OracleIds.Num();
+		if (Context.bTrace)
+		{
+			UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - %s %d,%d: %d cells changed"), GetOpName(Op.Type), Op.Row, Op.Col, Context.OracleIds.Num());
+		}
+
+		return CheckState(Context, Board);
+	}
+
+	/**
+	 * Mostly cells where the op does something: hidden cells to discover, cells next to discovered ones to flag (mines mostly),
+	 * numbers with as many flags around to chord. Some land anywhere, some around the board
+	 */
+	static FFuzzOp GenerateOp(FWorkerContext& Context, bool bDiscoverOnly)
+	{
+		FRandomStream& Random = Context.Random;
+		const FOracleBoard& Oracle = Context.Oracle;
+
+		FFuzzOp Op;
+		const float Roll = Random.FRand();
+		Op.Type = Roll < 0.04f? EFuzzOp::Reveal : (bDiscoverOnly || Roll < 0.6f)? EFuzzOp::Discover : Roll < 0.8f? EFuzzOp::Flag : EFuzzOp::Chord;
+		if (Op.Type == EFuzzOp::Reveal)
+		{
+			return Op;
+		}
+
+		if (Oracle.Rows * Oracle.Cols == 0 || Random.FRand() < 0.1f)
+		{
+			Op.Row = Random.RandRange(-2, Oracle.Rows + 1);
+			Op.Col = Random.RandRange(-2, Oracle.Cols + 1);
+			return Op;
+		}
+
+		// Wrong flags too, chords must also handle more flags than mines and flagged safe cells
+		const bool bAnyFlag = Random.FRand() < 0.3f;
+		Context.Candidates.Reset();
+		if (Random.FRand() < 0.8f)
+		{
+			for (int32 Id = 0; Id < Oracle.Rows * Oracle.Cols; ++Id)
+			{
+				const bool bHidden = !Oracle.Discovered[Id] && !Oracle.Flagged[Id];
+				const int32 Row = Id / Oracle.Cols;
+				const int32 Col = Id % Oracle.Cols;
+				const bool bCandidate = Op.Type == EFuzzOp::Discover? bHidden
+					: Op.Type == EFuzzOp::Flag? bHidden && (bAnyFlag || Oracle.Mines[Id]) && Oracle.CountNeighbours(Row, Col, Oracle.Discovered) > 0
+					: Oracle.Discovered[Id] && !Oracle.Mines[Id] && Oracle.Recount(Row, Col) > 0 && Oracle.CountNeighbours(Row, Col, Oracle.Flagged) == Oracle.Recount(Row, Col);
+				if (bCandidate)
+				{
+					Context.Candidates.Add(Id);
+				}
+			}
+		}
+
+		const int32 Id = Context.Candidates.Num() > 0? Context.Candidates[Random.RandHelper(Context.Candidates.Num())] : Random.RandHelper(Oracle.Rows * Oracle.Cols);
+		Op.Row = Id / Oracle.Cols;
+		Op.Col = Id % Oracle.Cols;
+		return Op;
+	}
+
+	/** Same mines, same clicks on the board specialized for the size */
+	template<typename TBoard>
+	static bool ReplayOnFixedBoard(FWorkerContext& Context)
+	{
+		const int32 Rows = Context.Oracle.Rows;
+		const int32 Cols = Context.Oracle.Cols;
+		Context.Oracle.Create(Rows, Cols, Context.MineIds);
+		Context.bRevealed = false;
+
+		TBoard Board;
+		Board.Create(Rows, Cols, Context.MineIds);
+		if (!CheckCreated(Context, Board))
+		{
+			return false;
+		}
+
+		for (int32 i = 0; i < Context.Ops.Num(); ++i)
+		{
+			if (!ApplyOp(Context, Board, Context.Ops[i]))
+			{
+				return Fail(Context, FString::Printf(TEXT("Fixed board, step %d (%s %d,%d): %s"), i, GetOpName(Context.Ops[i].Type), Context.Ops[i].Row, Context.Ops[i].Col, *Context.Error));
+			}
+		}
+
+		Context.FixedCases++;
+		return true;
+	}
+
+	static bool RunCase(FWorkerContext& Context, const FFuzzSettings& Settings, int64 CaseIndex)
+	{
+		static const FIntPoint STANDARD_SIZES[] = { {9, 9}, {16, 16}, {16, 30}, {30, 16} };
+
+		FRandomStream& Random = Context.Random;
+		Random.Initialize(static_cast<int32>(HashCombine(GetTypeHash(Settings.Seed), GetTypeHash(CaseIndex))));
+		Context.Ops.Reset();
+		Context.bRevealed = false;
+		Context.Cases++;
+
+		const bool bStandard = Random.FRand() < 0.2f;
+		const FIntPoint StandardSize = STANDARD_SIZES[Random.RandHelper(UE_ARRAY_COUNT(STANDARD_SIZES))];
+		int32 Rows = bStandard? StandardSize.X : Random.RandRange(1, Settings.MaxSize);
+		int32 Cols = bStandard? StandardSize.Y : Random.RandRange(1, Settings.MaxSize);
+		// Empty boards flood everything on the first click
+		const float Density = Random.FRand() < 0.1f? 0.f : Random.FRand() * 0.5f;
+
+		if (Random.FRand() < 0.5f)
+		{
+			// Malformed strings change the size, standard ones stay well formed so the fixed boards replay them
+			const bool bMalformed = !bStandard && Random.FRand() < 0.3f;
+			GenerateBoardText(Random, Rows, Cols, Density, bMalformed, Context.BoardText);
+			ParseBoardText(Context.BoardText, Rows, Cols, Context.MineIds);
+			Context.Board.Create(Context.BoardText);
+		}
+		else
+		{
+			// Boards without cells, a size the model must survive
+			if (!bStandard && Random.FRand() < 0.05f)
+			{
+				if (Random.FRand() < 0.5f)
+				{
+					Rows = 0;
+				}
+				else
+				{
+					Cols = 0;
+				}
+			}
+			GenerateMineIds(Random, Rows, Cols, Density, Context.MineIds);
+			Context.BoardText.Reset();
+			Context.Board.Create(Rows, Cols, Context.MineIds);
+		}
+		Context.Oracle.Create(Rows, Cols, Context.MineIds);
+
+		if (Context.bTrace)
+		{
+			UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Case %lld: %dx%d board, %d mines. Text: %s"), CaseIndex, Rows, Cols, Context.Oracle.CountMines(),
+				Context.BoardText.IsEmpty()? *Context.Board.ToBoardText() : *Context.BoardText);
+		}
+
+		if (!CheckCreated(Context, Context.Board))
+		{
+			return false;
+		}
+
+		// Text round trip, a board without cells writes only separators
+		if (Rows > 0 && Cols > 0)
+		{
+			int32 TextRows = 0;
+			int32 TextCols = 0;
+			ParseBoardText(Context.Board.ToBoardText(), TextRows, TextCols, Context.RoundTripIds);
+			Context.OracleIds.Reset();
+			for (int32 Id = 0; Id < Rows * Cols; ++Id)
+			{
+				if (Context.Oracle.Mines[Id])
+				{
+					Context.OracleIds.Add(Id);
+				}
+			}
+
+			if (TextRows != Rows || TextCols != Cols || Context.RoundTripIds != Context.OracleIds)
+			{
+				return Fail(Context, FString::Printf(TEXT("ToBoardText reads back as %dx%d with %d mines"), TextRows, TextCols, Context.RoundTripIds.Num()));
+			}
+		}
+
+		const bool bDiscoverOnly = Random.FRand() < (bStandard? 0.5f : 0.2f);
+		const int32 OpCount = Random.RandRange(1, Settings.MaxClicks);
+		for (int32 i = 0; i < OpCount; ++i)
+		{
+			const FFuzzOp Op = GenerateOp(Context, bDiscoverOnly);
+			Context.Ops.Add(Op);
+			Context.Clicks++;
+			if (!ApplyOp(Context, Context.Board, Op))
+			{
+				return Fail(Context, FString::Printf(TEXT("Step %d (%s %d,%d): %s"), i, GetOpName(Op.Type), Op.Row, Op.Col, *Context.Error));
+			}
+		}
+		Context.Wins += !Context.bRevealed && Context.Oracle.HasWon()? 1 : 0;
+
+		if (!bDiscoverOnly || !MinesweeperFixedBoard::IsStandardSize(Rows, Cols))
+		{
+			return true;
+		}
+
+		return MinesweeperFixedBoard::Dispatch<FMinesweeperBoard>(Rows, Cols, [&Context](auto BoardType)
+		{
+			return ReplayOnFixedBoard<typename decltype(BoardType)::Type>(Context);
+		});
+	}
+}
+
+UMinesweeperFuzzCommandlet::UMinesweeperFuzzCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UMinesweeperFuzzCommandlet::Main(const FString& Params)
+{
+	using namespace MinesweeperFuzz;
+
+	FFuzzSettings Settings;
+	const bool bCasesSet = FParse::Value(*Params, TEXT("Cases="), Settings.Cases);
+	FParse::Value(*Params, TEXT("Seconds="), Settings.Seconds);
+	FParse::Value(*Params, TEXT("Seed="), Settings.Seed);
+	FParse::Value(*Params, TEXT("MaxSize="), Settings.MaxSize);
+	FParse::Value(*Params, TEXT("MaxClicks="), Settings.MaxClicks);
+	FParse::Value(*Params, TEXT("Workers="), Settings.Workers);
+	Settings.MaxSize = FMath::Clamp(Settings.MaxSize, 1, 1024);
+	Settings.MaxClicks = FMath::Max(1, Settings.MaxClicks);
+	// A time budget alone runs until it's spent
+	if (Settings.Seconds > 0.f && !bCasesSet)
+	{
+		Settings.Cases = MAX_int64;
+	}
+
+	int64 ReplayCase = INDEX_NONE;
+	if (FParse::Value(*Params, TEXT("Case="), ReplayCase))
+	{
+		FWorkerContext Context;
+		Context.bTrace = true;
+		if (!RunCase(Context, Settings, ReplayCase))
+		{
+			UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Case %lld failed: %s"), ReplayCase, *Context.Error);
+			return 1;
+		}
+
+		UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Case %lld passed."), ReplayCase);
+		return 0;
+	}
+
+	TArray<FWorkerContext> Contexts;
+	Contexts.SetNum(Settings.Workers > 0? Settings.Workers : FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+
+	struct FFailure
+	{
+		int64 CaseIndex;
+		FString Error;
+	};
+	TArray<FFailure> Failures;
+	FCriticalSection FailuresLock;
+
+	std::atomic<int64> NextCase{0};
+	std::atomic<bool> bStop{false};
+
+	// Create(FString) logs every board it parses
+	const ELogVerbosity::Type SlateVerbosity = LogSlate.GetVerbosity();
+	LogSlate.SetVerbosity(ELogVerbosity::Warning);
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double EndTime = Settings.Seconds > 0.f? StartTime + Settings.Seconds : MAX_dbl;
+	ParallelFor(Contexts.Num(), [&](int32 WorkerIndex)
+	{
+		FWorkerContext& Context = Contexts[WorkerIndex];
+		while (!bStop)
+		{
+			const int64 First = NextCase.fetch_add(CASES_PER_BATCH);
+			if (First >= Settings.Cases || FPlatformTime::Seconds() >= EndTime)
+			{
+				break;
+			}
+
+			const int64 Last = FMath::Min<int64>(First + CASES_PER_BATCH, Settings.Cases);
+			for (int64 CaseIndex = First; CaseIndex < Last; ++CaseIndex)
+			{
+				if (RunCase(Context, Settings, CaseIndex))
+				{
+					continue;
+				}
+
+				FScopeLock Lock(&FailuresLock);
+				Failures.Add({CaseIndex, MoveTemp(Context.Error)});
+				if (Failures.Num() >= MAX_FAILURES)
+				{
+					bStop = true;
+					break;
+				}
+			}
+		}
+	});
+	const double Seconds = FPlatformTime::Seconds() - StartTime;
+
+	LogSlate.SetVerbosity(SlateVerbosity);
+
+	int64 Cases = 0, Clicks = 0, DiscoveredCells = 0, Wins = 0, MinesHit = 0, FixedCases = 0;
+	for (const FWorkerContext& Context : Contexts)
+	{
+		Cases += Context.Cases;
+		Clicks += Context.Clicks;
+		DiscoveredCells += Context.DiscoveredCells;
+		Wins += Context.Wins;
+		MinesHit += Context.MinesHit;
+		FixedCases += Context.FixedCases;
+	}
+
+	UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Fuzz: %lld cases (%lld replayed on fixed boards), %lld clicks, %lld cells changed in %.2fs | %.2fM cases/min | Workers: %d"),
+		Cases, FixedCases, Clicks, DiscoveredCells, Seconds, Seconds > 0.0? Cases / Seconds * 60.0 / 1e6 : 0.0, Contexts.Num());
+	UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Fuzz: %lld games won, %lld mines hit."), Wins, MinesHit);
+
+	Failures.Sort([](const FFailure& A, const FFailure& B) { return A.CaseIndex < B.CaseIndex; });
+	for (const FFailure& Failure : Failures)
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Case %lld failed: %s. Replay with -run=MinesweeperFuzz -Seed=%d -Case=%lld"),
+			Failure.CaseIndex, *Failure.Error, Settings.Seed, Failure.CaseIndex);
+	}
+
+	return Failures.Num() > 0? 1 : 0;
+}
@@ -0,0 +1,302 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/MinesweeperGeminiCacheCommandlet.h"
+
+#include "HttpManager.h"
+#include "HttpModule.h"
+#include "HttpServerModule.h"
+#include "HttpServerResponse.h"
+#include "IHttpRouter.h"
+#include "AI/BoardProvider.h"
+#include "AI/GeminiContextCache.h"
+#include "AI/GeminiRequestBody.h"
+#include "Containers/Ticker.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace MinesweeperGeminiCacheCommandlet
+{
+	static constexpr double TIMEOUT_SECONDS = 10.0;
+	/** Phases are stamped on HTTP ticks, a few Pump steps apart: closer connect+send times than this match */
+	static constexpr double CONNECT_TOLERANCE_MS = 25.0;
+	static constexpr int32 KEEP_ALIVE_SECONDS = 1;
+
+	/** The Gemini endpoints used by the plugin, answering like the real API, and what they received */
+	class FMockGemini
+	{
+	public:
+		/** Answer cache creations with 400, like a content below the minimum cacheable size */
+		bool bRejectCreate = false;
+		/** Expiration given to created caches, refreshed ones get an hour */
+		double CreateExpireSeconds = 3600.0;
+		/** Names still alive server side, emptied to simulate an expiration */
+		TSet<FString> Caches;
+
+		int32 CreateAttempts = 0;
+		int32 Creates = 0;
+		int32 Refreshes = 0;
+		int32 CachedRequests = 0;
+		int32 InlineRequests = 0;
+		int32 RejectedRequests = 0;
+		/** Model metadata GETs: connection warm-up and keep-alive */
+		int32 Pings = 0;
+		/** Requests referencing a cache that still carried the fixed part, or inline ones without it */
+		int32 MalformedRequests = 0;
+
+		bool Handle(const FHttpServerRequest& Request, const FHttpResultCallback& OnComplete)
+		{
+			const FString Path = Request.RelativePath.GetPath();
+			TSharedPtr<FJsonObject> Body;
+			if (Request.Body.Num() > 0)
+			{
+				const FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Request.Body.GetData()), Request.Body.Num());
+				TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(FString(Converter.Length(), Converter.Get()));
+				FJsonSerializer::Deserialize(Reader, Body);
+			}
+
+			if (Path.EndsWith(TEXT(":generateContent")) && Request.Verb == EHttpServerRequestVerbs::VERB_POST)
+			{
+				return HandleGenerateContent(Body, OnComplete);
+			}
+
+			if (Path.Contains(TEXT("/cachedContents/")) && Request.Verb == EHttpServerRequestVerbs::VERB_PATCH)
+			{
+				const FString Name = Path.RightChop(Path.Find(TEXT("cachedContents/")));
+				if (!Caches.Contains(Name))
+				{
+					return Respond(OnComplete, EHttpServerResponseCodes::NotFound, TEXT("{\"error\": {\"code\": 404, \"message\": \"CachedContent not found\"}}"));
+				}
+
+				Refreshes++;
+				return RespondCachedContent(OnComplete, Name, 3600.0);
+			}
+
+			if (Path.EndsWith(TEXT("/cachedContents")) && Request.Verb == EHttpServerRequestVerbs::VERB_POST)
+			{
+				CreateAttempts++;
+				if (bRejectCreate || !Body.IsValid())
+				{
+					return Respond(OnComplete, EHttpServerResponseCodes::BadRequest, TEXT("{\"error\": {\"code\": 400, \"message\": \"Cached content is too small\"}}"));
+				}
+
+				Creates++;
+				const FString Name = FString::Printf(TEXT("cachedContents/mock-%d"), Creates);
+				Caches.Add(Name);
+				return RespondCachedContent(OnComplete, Name, CreateExpireSeconds);
+			}
+
+			// models/{model}, the connection warm up
+			if (Path.Contains(TEXT("/models/")) && Request.Verb == EHttpServerRequestVerbs::VERB_GET)
+			{
+				Pings++;
+				return Respond(OnComplete, EHttpServerResponseCodes::Ok, TEXT("{\"name\": \"models/mock\"}"));
+			}
+
+			return Respond(OnComplete, EHttpServerResponseCodes::NotFound, TEXT("{}"));
+		}
+
+	private:
+		bool HandleGenerateContent(const TSharedPtr<FJsonObject>& Body, const FHttpResultCallback& OnComplete)
+		{
+			if (!Body.IsValid())
+			{
+				return Respond(OnComplete, EHttpServerResponseCodes::BadRequest, TEXT("{\"error\": {\"code\": 400, \"message\": \"Invalid JSON\"}}"));
+			}
+
+			FString CachedContent;
+			const bool bHasInstruction = Body->HasField(TEXT("systemInstruction"));
+			if (Body->TryGetStringField(TEXT("cachedContent"), CachedContent))
+			{
+				if (!Caches.Contains(CachedContent))
+				{
+					RejectedRequests++;
+					return Respond(OnComplete, EHttpServerResponseCodes::Forbidden, TEXT("{\"error\": {\"code\": 403, \"message\": \"CachedContent not found (or permission denied)\"}}"));
+				}
+
+				CachedRequests++;
+				MalformedRequests += bHasInstruction? 1 : 0;
+			}
+			else
+			{
+				InlineRequests++;
+				MalformedRequests += bHasInstruction? 0 : 1;
+			}
+
+			return Respond(OnComplete, EHttpServerResponseCodes::Ok,
+				TEXT("{\"candidates\": [{\"content\": {\"parts\": [{\"text\": \"0,1,0|0,0,0|1,0,0\"}], \"role\": \"model\"}}]}"));
+		}
+
+		bool RespondCachedContent(const FHttpResultCallback& OnComplete, const FString& Name, double ExpireSeconds)
+		{
+			const FDateTime ExpireTime = FDateTime::UtcNow() + FTimespan::FromSeconds(ExpireSeconds);
+			return Respond(OnComplete, EHttpServerResponseCodes::Ok,
+				FString::Printf(TEXT("{\"name\": \"%s\", \"expireTime\": \"%s\"}"), *Name, *ExpireTime.ToIso8601()));
+		}
+
+		static bool Respond(const FHttpResultCallback& OnComplete, EHttpServerResponseCodes Code, const FString& Json)
+		{
+			TUniquePtr<FHttpServerResponse> Response = FHttpServerResponse::Create(Json, TEXT("application/json"));
+			Response->Code = Code;
+			OnComplete(MoveTemp(Response));
+			return true;
+		}
+	};
+
+	/**
+	 * Ticks HTTP and the core ticker until Done or the timeout.
+	 * @param TickerStep Minimum time given to each ticker tick, so tickers on long intervals run on every loop
+	 */
+	static bool Pump(TFunctionRef<bool()> Done, float TickerStep = 0.f, double Timeout = TIMEOUT_SECONDS)
+	{
+		const double End = FPlatformTime::Seconds() + Timeout;
+		double LastTime = FPlatformTime::Seconds();
+		while (!Done())
+		{
+			const double Now = FPlatformTime::Seconds();
+			if (Now >= End)
+			{
+				return false;
+			}
+
+			const float DeltaTime = static_cast<float>(Now - LastTime);
+			LastTime = Now;
+			FHttpModule::Get().GetHttpManager().Tick(DeltaTime);
+			FTSTicker::GetCoreTicker().Tick(FMath::Max(DeltaTime, TickerStep));
+			FPlatformProcess::Sleep(0.005f);
+		}
+
+		return true;
+	}
+
+	static bool RequestBoard(IBoardProvider& Provider, FBoardProviderResponse& OutResponse)
+	{
+		bool bDone = false;
+		Provider.RequestBoards(TEXT("9x9 board with 10 mines"), 1, FOnBoardProviderResponse::CreateLambda([&](const FBoardProviderResponse& Response)
+		{
+			OutResponse = Response;
+			bDone = true;
+		}));
+
+		return Pump([&bDone]() { return bDone; });
+	}
+}
+
+UMinesweeperGeminiCacheCommandlet::UMinesweeperGeminiCacheCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UMinesweeperGeminiCacheCommandlet::Main(const FString& Params)
+{
+	using namespace MinesweeperGeminiCacheCommandlet;
+
+	int32 Port = 8099;
+	FParse::Value(*Params, TEXT("Port="), Port);
+
+	FMockGemini Mock;
+	TSharedPtr<IHttpRouter> Router = FHttpServerModule::Get().GetHttpRouter(Port, true);
+	if (!Router.IsValid())
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Can't listen on port %d"), Port);
+		return 1;
+	}
+
+	const FHttpRouteHandle Route = Router->BindRoute(FHttpPath(TEXT("/v1beta")),
+		EHttpServerRequestVerbs::VERB_GET | EHttpServerRequestVerbs::VERB_POST | EHttpServerRequestVerbs::VERB_PATCH,
+		FHttpRequestHandler::CreateRaw(&Mock, &FMockGemini::Handle));
+	FHttpServerModule::Get().StartAllListeners();
+
+	UAISettings* Settings = GetMutableDefault<UAISettings>();
+	const int32 ModelMinTokens = Settings->GetContextCacheMinTokens();
+	const FString BaseUrl = FString::Printf(TEXT("http://127.0.0.1:%d/v1beta"), Port);
+	const FString ApiKey = TEXT("local-stand-in");
+
+	int32 Failures = 0;
+	auto Check = [&Failures](bool bCondition, const TCHAR* What)
+	{
+		UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - %s %s"), bCondition? TEXT("PASS") : TEXT("FAIL"), What);
+		Failures += bCondition? 0 : 1;
+	};
+
+	// Connection first, before any request opened one. Instructions below the minimum: no cache, requests are inline
+	{
+		Settings->UseLocalGeminiServer(BaseUrl, FString(), ModelMinTokens, KEEP_ALIVE_SECONDS);
+		TSharedRef<IBoardProvider> Provider = IBoardProvider::Create(EBoardProviderType::Gemini);
+		Provider->WarmUp();
+		Pump([]() { return false; }, KEEP_ALIVE_SECONDS, KEEP_ALIVE_SECONDS * 2.5);
+		Check(Mock.Pings == 0, TEXT("no warm-up nor keep-alive without an API key"));
+
+		Settings->UseLocalGeminiServer(BaseUrl, ApiKey, ModelMinTokens, KEEP_ALIVE_SECONDS);
+		Provider->WarmUp();
+		Check(Pump([&Mock]() { return Mock.Pings == 1; }), TEXT("warm-up reached the endpoint"));
+
+		FBoardProviderResponse First;
+		FBoardProviderResponse Later;
+		Check(RequestBoard(*Provider, First) && First.bSuccess && RequestBoard(*Provider, Later) && Later.bSuccess, TEXT("requests on the warm connection answered"));
+		Check(FMath::Abs(First.ConnectSendMs - Later.ConnectSendMs) <= CONNECT_TOLERANCE_MS,
+			*FString::Printf(TEXT("first request connect+send %.1fms matches a later one, %.1fms"), First.ConnectSendMs, Later.ConnectSendMs));
+
+		Check(Pump([&Mock]() { return Mock.Pings >= 2; }, KEEP_ALIVE_SECONDS), TEXT("keep-alive ping once idle"));
+
+		// What the manager does when the last tab closes
+		Provider->CoolDown();
+		const int32 PingsBefore = Mock.Pings;
+		Pump([]() { return false; }, KEEP_ALIVE_SECONDS, KEEP_ALIVE_SECONDS * 2.5);
+		Check(Mock.Pings == PingsBefore, TEXT("no keep-alive after cool down"));
+		Mock.InlineRequests = 0;
+	}
+
+	Settings->UseLocalGeminiServer(BaseUrl, ApiKey, 0, 0);
+
+	// Created on warm up, then referenced by requests, which leave the fixed part out. Expires soon, so it gets refreshed
+	Mock.CreateExpireSeconds = FGeminiContextCache::REFRESH_MARGIN_SECONDS + 2.0;
+	TSharedRef<IBoardProvider> Provider = IBoardProvider::Create(EBoardProviderType::Gemini);
+	Provider->WarmUp();
+	Check(Pump([&Mock]() { return Mock.Creates == 1; }), TEXT("cache created on warm up"));
+
+	FBoardProviderResponse Response;
+	Check(RequestBoard(*Provider, Response) && Response.bSuccess, TEXT("request with the cache answered"));
+	Check(Mock.CachedRequests == 1 && Mock.InlineRequests == 0, TEXT("request referenced the cache"));
+
+	Check(Pump([&Mock]() { return Mock.Refreshes >= 1; }, FGeminiContextCache::TICK_INTERVAL_SECONDS), TEXT("cache refreshed before it expired"));
+	Check(RequestBoard(*Provider, Response) && Response.bSuccess && Mock.CachedRequests == 2, TEXT("refreshed cache still referenced"));
+
+	// Dropped server side: the request is rejected, sent again with the full prompt, and a new cache is created
+	Mock.Caches.Empty();
+	Check(RequestBoard(*Provider, Response) && Response.bSuccess, TEXT("request with an expired cache answered"));
+	Check(Mock.RejectedRequests == 1 && Mock.InlineRequests == 1, TEXT("expired cache fell back to the full prompt"));
+	Check(Pump([&Mock]() { return Mock.Creates == 2; }, FGeminiContextCache::TICK_INTERVAL_SECONDS), TEXT("cache created again after the fallback"));
+
+	// A client error on creation is permanent: no more attempts, requests stay inline
+	Mock.bRejectCreate = true;
+	const int32 AttemptsBefore = Mock.CreateAttempts;
+	TSharedRef<FGeminiContextCache> RejectedCache = MakeShared<FGeminiContextCache>();
+	RejectedCache->Warm();
+	Check(Pump([&Mock, AttemptsBefore]() { return Mock.CreateAttempts == AttemptsBefore + 1; }), TEXT("rejected creation attempted"));
+	Pump([]() { return false; }, FGeminiContextCache::TICK_INTERVAL_SECONDS, 1.0);
+	Check(Mock.CreateAttempts == AttemptsBefore + 1 && RejectedCache->GetCachedContentName().IsEmpty(), TEXT("rejected creation not retried"));
+
+	// The built-in instructions are below the model minimum: no attempt at all
+	Settings->UseLocalGeminiServer(BaseUrl, ApiKey, ModelMinTokens, 0);
+	const int32 AttemptsBeforeSkip = Mock.CreateAttempts;
+	TSharedRef<FGeminiContextCache> SmallCache = MakeShared<FGeminiContextCache>();
+	SmallCache->Warm();
+	Pump([]() { return false; }, FGeminiContextCache::TICK_INTERVAL_SECONDS, 1.0);
+	Check(Mock.CreateAttempts == AttemptsBeforeSkip && SmallCache->GetCachedContentName().IsEmpty(),
+		*FString::Printf(TEXT("no creation below the minimum (about %d tokens, minimum %d)"), FGeminiRequestBody::EstimatePrefixTokens(), ModelMinTokens));
+
+	Check(Mock.MalformedRequests == 0, TEXT("cached requests without the fixed part, inline ones with it"));
+
+	Router->UnbindRoute(Route);
+	FHttpServerModule::Get().StopAllListeners();
+
+	UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Context cache: %d creations (%d attempts), %d refreshes, %d cached requests, %d inline, %d rejected, %d pings | %d failures"),
+		Mock.Creates, Mock.CreateAttempts, Mock.Refreshes, Mock.CachedRequests, Mock.InlineRequests, Mock.RejectedRequests, Mock.Pings, Failures);
+	return Failures > 0? 1 : 0;
+}
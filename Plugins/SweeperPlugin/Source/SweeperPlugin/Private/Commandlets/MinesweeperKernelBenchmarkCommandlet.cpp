@@ -0,0 +1,339 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/MinesweeperKernelBenchmarkCommandlet.h"
+
+#include "Board/MinesweeperBoard.h"
+#include "Board/MinesweeperFixedBoard.h"
+#include "HAL/PlatformTime.h"
+
+namespace MinesweeperKernelBenchmark
+{
+	// Distinct boards cycled through, generated before timing so the random stream isn't measured
+	static constexpr int32 BOARD_COUNT = 256;
+
+	struct FBoardCase
+	{
+		TArray<int32> BombIds;
+		int32 ClickRow = 0;
+		int32 ClickCol = 0;
+	};
+
+	struct FKernelTimings
+	{
+		double CreateNs = 0.0;
+		double DiscoverNs = 0.0;
+		double HasWonNs = 0.0;
+		double RevealNs = 0.0;
+		int64 DiscoveredCells = 0;
+	};
+
+	/**
+	 * The board layout before the border padding: one TArray per row, every neighbour bounds checked.
+	 * Kept only as the baseline of this benchmark.
+	 */
+	class FNestedBoard
+	{
+	public:
+		void Create(int32 InRows, int32 InCols, TArrayView<const int32> BombIds)
+		{
+			RowCount = InRows;
+			ColCount = InCols;
+			Cells.SetNum(RowCount);
+			for (TArray<FMinesweeperCell>& Row : Cells)
+			{
+				Row.Init(FMinesweeperCell(false), ColCount);
+			}
+
+			int32 Bombs = 0;
+			for (const int32 BombId : BombIds)
+			{
+				const int32 BombRow = BombId / ColCount;
+				const int32 BombCol = BombId % ColCount;
+				if (!Exists(BombRow, BombCol) || Cells[BombRow][BombCol].IsBomb())
+				{
+					continue;
+				}
+
+				Cells[BombRow][BombCol].bIsBomb = true;
+				Bombs++;
+				for (const FMinesweeperBoard::Coordinate& Around : FMinesweeperBoard::GetAroundOffset())
+				{
+					if (Exists(BombRow + Around.Key, BombCol + Around.Value))
+					{
+						Cells[BombRow + Around.Key][BombCol + Around.Value].IncrementBombCount();
+					}
+				}
+			}
+
+			CellToDiscover = RowCount * ColCount - Bombs;
+		}
+
+		TArrayView<const int32> Discover(int32 Row, int32 Col)
+		{
+			ChangedIds.Reset();
+			if (!Exists(Row, Col) || Cells[Row][Col].IsDiscovered())
+			{
+				return ChangedIds;
+			}
+
+			Cells[Row][Col].Discover();
+			ChangedIds.Add(Row * ColCount + Col);
+			if (Cells[Row][Col].IsBomb())
+			{
+				return ChangedIds;
+			}
+
+			for (int32 Head = 0; Head < ChangedIds.Num(); ++Head)
+			{
+				const int32 CurrentRow = ChangedIds[Head] / ColCount;
+				const int32 CurrentCol = ChangedIds[Head] % ColCount;
+				if (!Cells[CurrentRow][CurrentCol].IsEmpty())
+				{
+					continue;
+				}
+
+				for (const FMinesweeperBoard::Coordinate& Around : FMinesweeperBoard::GetAroundOffset())
+				{
+					const int32 AdjacentRow = CurrentRow + Around.Key;
+					const int32 AdjacentCol = CurrentCol + Around.Value;
+					if (Exists(AdjacentRow, AdjacentCol) && !Cells[AdjacentRow][AdjacentCol].IsDiscovered() && !Cells[AdjacentRow][AdjacentCol].IsBomb())
+					{
+						Cells[AdjacentRow][AdjacentCol].Discover();
+						ChangedIds.Add(AdjacentRow * ColCount + AdjacentCol);
+					}
+				}
+			}
+
+			CellToDiscover -= ChangedIds.Num();
+			return ChangedIds;
+		}
+
+		TArrayView<const int32> Reveal()
+		{
+			ChangedIds.Reset();
+			for (int32 i = 0; i < RowCount; ++i)
+			{
+				for (int32 j = 0; j < ColCount; ++j)
+				{
+					if (!Cells[i][j].IsDiscovered())
+					{
+						Cells[i][j].Discover();
+						ChangedIds.Add(i * ColCount + j);
+					}
+				}
+			}
+
+			return ChangedIds;
+		}
+
+		bool HasWon() const
+		{
+			return CellToDiscover <= 0;
+		}
+
+	private:
+		bool Exists(int32 Row, int32 Col) const
+		{
+			return Cells.IsValidIndex(Row) && Cells[Row].IsValidIndex(Col);
+		}
+
+	private:
+		TArray<TArray<FMinesweeperCell>> Cells;
+		TArray<int32> ChangedIds;
+		int32 RowCount = 0;
+		int32 ColCount = 0;
+		int32 CellToDiscover = 0;
+	};
+
+	static int32 GetMineCount(int32 Rows, int32 Cols, float Density)
+	{
+		if (Density > 0.f)
+		{
+			return FMath::Max(1, FMath::RoundToInt32(Rows * Cols * Density));
+		}
+
+		// Classic counts for the standard sizes, expert density otherwise
+		if (Rows == 9 && Cols == 9)
+		{
+			return 10;
+		}
+		if (Rows == 16 && Cols == 16)
+		{
+			return 40;
+		}
+		if (Rows * Cols == 16 * 30)
+		{
+			return 99;
+		}
+		return FMath::Max(1, FMath::RoundToInt32(Rows * Cols * 0.206f));
+	}
+
+	static void GenerateCases(int32 Rows, int32 Cols, float Density, int32 Seed, TArray<FBoardCase>& OutCases)
+	{
+		FRandomStream Random(Seed);
+		const int32 CellCount = Rows * Cols;
+		const int32 Mines = FMath::Min(GetMineCount(Rows, Cols, Density), CellCount - 1);
+
+		TArray<int32> CellIds;
+		OutCases.SetNum(BOARD_COUNT);
+		for (FBoardCase& Case : OutCases)
+		{
+			CellIds.SetNumUninitialized(CellCount, EAllowShrinking::No);
+			for (int32 i = 0; i < CellCount; ++i)
+			{
+				CellIds[i] = i;
+			}
+
+			// Partial shuffle: mines in front, the click is the first cell after them
+			for (int32 i = 0; i <= Mines; ++i)
+			{
+				CellIds.Swap(i, Random.RandRange(i, CellCount - 1));
+			}
+
+			Case.BombIds = TArray<int32>(CellIds.GetData(), Mines);
+			Case.ClickRow = CellIds[Mines] / Cols;
+			Case.ClickCol = CellIds[Mines] % Cols;
+		}
+	}
+
+	template<typename TBoard>
+	static FKernelTimings Measure(int32 Rows, int32 Cols, const TArray<FBoardCase>& Cases, int32 Iterations)
+	{
+		TBoard Board;
+		uint64 CreateCycles = 0;
+		uint64 DiscoverCycles = 0;
+		uint64 HasWonCycles = 0;
+		uint64 RevealCycles = 0;
+		int64 DiscoveredCells = 0;
+		int32 Wins = 0;
+
+		for (int32 Iteration = 0; Iteration < Iterations; ++Iteration)
+		{
+			const FBoardCase& Case = Cases[Iteration % Cases.Num()];
+
+			uint64 Start = FPlatformTime::Cycles64();
+			Board.Create(Rows, Cols, Case.BombIds);
+			uint64 End = FPlatformTime::Cycles64();
+			CreateCycles += End - Start;
+
+			Start = End;
+			DiscoveredCells += Board.Discover(Case.ClickRow, Case.ClickCol).Num();
+			End = FPlatformTime::Cycles64();
+			DiscoverCycles += End - Start;
+
+			Start = End;
+			Wins += Board.HasWon()? 1 : 0;
+			End = FPlatformTime::Cycles64();
+			HasWonCycles += End - Start;
+
+			Start = End;
+			Board.Reveal();
+			RevealCycles += FPlatformTime::Cycles64() - Start;
+		}
+
+		auto ToNs = [Iterations](uint64 Cycles) { return FPlatformTime::ToSeconds64(Cycles) * 1e9 / Iterations; };
+
+		FKernelTimings Timings;
+		Timings.CreateNs = ToNs(CreateCycles);
+		Timings.DiscoverNs = ToNs(DiscoverCycles);
+		Timings.HasWonNs = ToNs(HasWonCycles);
+		Timings.RevealNs = ToNs(RevealCycles);
+		// Keeps the loop results alive, and both kernels must agree on it
+		Timings.DiscoveredCells = DiscoveredCells + Wins;
+		return Timings;
+	}
+
+	static void LogTimings(const TCHAR* Kernel, int32 Rows, int32 Cols, const FKernelTimings& Timings)
+	{
+		UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - %dx%d %-8s Create: %8.1fns | Discover: %8.1fns | HasWon: %5.1fns | Reveal: %8.1fns"),
+			Rows, Cols, Kernel, Timings.CreateNs, Timings.DiscoverNs, Timings.HasWonNs, Timings.RevealNs);
+	}
+}
+
+UMinesweeperKernelBenchmarkCommandlet::UMinesweeperKernelBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UMinesweeperKernelBenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace MinesweeperKernelBenchmark;
+
+	FString SizesString = TEXT("9x9,16x16,16x30,24x24,64x64");
+	int32 Iterations = 20000;
+	int32 Seed = 0;
+	float Density = 0.f;
+	FParse::Value(*Params, TEXT("Sizes="), SizesString);
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("Density="), Density);
+	Iterations = FMath::Max(1, Iterations);
+
+	TArray<FString> Sizes;
+	SizesString.ParseIntoArray(Sizes, TEXT(","), true);
+
+	TArray<FBoardCase> Cases;
+	for (const FString& Size : Sizes)
+	{
+		FString RowsString, ColsString;
+		if (!Size.Split(TEXT("x"), &RowsString, &ColsString))
+		{
+			UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Invalid size %s, expected RowsxCols."), *Size);
+			return 1;
+		}
+
+		const int32 Rows = FCString::Atoi(*RowsString);
+		const int32 Cols = FCString::Atoi(*ColsString);
+		if (Rows <= 0 || Cols <= 0)
+		{
+			UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Invalid size %s, expected RowsxCols."), *Size);
+			return 1;
+		}
+
+		GenerateCases(Rows, Cols, Density, Seed, Cases);
+
+		auto Speedup = [](double BaselineNs, double Ns) { return Ns > 0.0? BaselineNs / Ns : 0.0; };
+
+		const FKernelTimings Nested = Measure<FNestedBoard>(Rows, Cols, Cases, Iterations);
+		LogTimings(TEXT("Nested"), Rows, Cols, Nested);
+
+		const FKernelTimings Dynamic = Measure<FMinesweeperBoard>(Rows, Cols, Cases, Iterations);
+		LogTimings(TEXT("Dynamic"), Rows, Cols, Dynamic);
+
+		if (Nested.DiscoveredCells != Dynamic.DiscoveredCells)
+		{
+			UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - %dx%d nested and padded boards disagree: %lld vs %lld discovered cells."), Rows, Cols, Nested.DiscoveredCells, Dynamic.DiscoveredCells);
+			return 1;
+		}
+
+		UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - %dx%d padding   Create: %.2fx | Discover: %.2fx | Reveal: %.2fx"),
+			Rows, Cols, Speedup(Nested.CreateNs, Dynamic.CreateNs), Speedup(Nested.DiscoverNs, Dynamic.DiscoverNs), Speedup(Nested.RevealNs, Dynamic.RevealNs));
+
+		if (!MinesweeperFixedBoard::IsStandardSize(Rows, Cols))
+		{
+			continue;
+		}
+
+		const FKernelTimings Fixed = MinesweeperFixedBoard::Dispatch<FMinesweeperBoard>(Rows, Cols, [Rows, Cols, &Cases, Iterations](auto BoardType)
+		{
+			return Measure<typename decltype(BoardType)::Type>(Rows, Cols, Cases, Iterations);
+		});
+		LogTimings(TEXT("Fixed"), Rows, Cols, Fixed);
+
+		if (Fixed.DiscoveredCells != Dynamic.DiscoveredCells)
+		{
+			UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - %dx%d fixed and dynamic boards disagree: %lld vs %lld discovered cells."), Rows, Cols, Fixed.DiscoveredCells, Dynamic.DiscoveredCells);
+			return 1;
+		}
+
+		UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - %dx%d fixed     Create: %.2fx | Discover: %.2fx | Reveal: %.2fx"),
+			Rows, Cols, Speedup(Dynamic.CreateNs, Fixed.CreateNs), Speedup(Dynamic.DiscoverNs, Fixed.DiscoverNs), Speedup(Dynamic.RevealNs, Fixed.RevealNs));
+	}
+
+	return 0;
+}
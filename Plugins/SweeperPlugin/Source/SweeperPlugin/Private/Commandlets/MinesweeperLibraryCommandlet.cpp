@@ -0,0 +1,187 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/MinesweeperLibraryCommandlet.h"
+
+#include "Board/MinesweeperBoardFormats.h"
+#include "Board/MinesweeperBoardLibrary.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Simulation/MinesweeperLatencyHistogram.h"
+
+namespace MinesweeperLibraryCommandlet
+{
+	static void ParseSizes(const FString& Text, TArray<FIntPoint>& OutSizes)
+	{
+		TArray<FString> Sizes;
+		Text.ParseIntoArray(Sizes, TEXT(","), true);
+		for (const FString& Size : Sizes)
+		{
+			FString Rows;
+			FString Cols;
+			if (Size.Split(TEXT("x"), &Rows, &Cols, ESearchCase::IgnoreCase))
+			{
+				const FIntPoint Parsed(FCString::Atoi(*Cols), FCString::Atoi(*Rows));
+				if (Parsed.X > 0 && Parsed.Y > 0)
+				{
+					OutSizes.Add(Parsed);
+				}
+			}
+		}
+	}
+
+	static int32 Import(FMinesweeperBoardLibrary& Library, const FString& Path)
+	{
+		TArray<FString> Files;
+		if (FPaths::DirectoryExists(Path))
+		{
+			IFileManager::Get().FindFilesRecursive(Files, *Path, TEXT("*.*"), true, false);
+		}
+		else
+		{
+			Files.Add(Path);
+		}
+
+		TArray<FMinesweeperLayout> Layouts;
+		Layouts.Reserve(Files.Num());
+		for (const FString& File : Files)
+		{
+			FMinesweeperLayout Layout;
+			if (FMinesweeperBoardFormats::LoadFromFile(File, Layout))
+			{
+				Layouts.Add(MoveTemp(Layout));
+			}
+		}
+
+		const int32 Added = Library.Add(Layouts);
+		UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Imported %d boards from %d files (%d already in the library)"), Added, Files.Num(), Layouts.Num() - Added);
+		return Added;
+	}
+
+	static void Fill(FMinesweeperBoardLibrary& Library, TArrayView<const FIntPoint> Sizes, int32 Count, float Density, FRandomStream& Random)
+	{
+		static constexpr int32 BATCH_SIZE = 4096;
+
+		const double Start = FPlatformTime::Seconds();
+		TArray<FMinesweeperLayout> Layouts;
+		TArray<int32> Ids;
+		int32 Added = 0;
+		for (int32 First = 0; First < Count; First += BATCH_SIZE)
+		{
+			Layouts.SetNum(FMath::Min(BATCH_SIZE, Count - First));
+			for (FMinesweeperLayout& Layout : Layouts)
+			{
+				const FIntPoint& Size = Sizes[Random.RandHelper(Sizes.Num())];
+				const int32 CellCount = Size.X * Size.Y;
+				Ids.SetNumUninitialized(CellCount, EAllowShrinking::No);
+				for (int32 i = 0; i < CellCount; ++i)
+				{
+					Ids[i] = i;
+				}
+
+				// Partial Fisher-Yates, mine counts spread around the density so queries on mines have work to do
+				const float BoardDensity = FMath::Clamp(Density * Random.FRandRange(0.7f, 1.3f), 0.01f, 0.6f);
+				const int32 Mines = FMath::Clamp(FMath::RoundToInt32(CellCount * BoardDensity), 1, CellCount - 1);
+				for (int32 i = 0; i < Mines; ++i)
+				{
+					Ids.Swap(i, Random.RandRange(i, CellCount - 1));
+				}
+
+				Layout.Rows = Size.Y;
+				Layout.Cols = Size.X;
+				Layout.MineIds = TArray<int32>(Ids.GetData(), Mines);
+			}
+
+			Added += Library.Add(Layouts);
+		}
+
+		const double Seconds = FMath::Max(FPlatformTime::Seconds() - Start, 0.000001);
+		UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Added %d random boards in %.2fs (%.0f boards/s)"), Added, Seconds, Added / Seconds);
+	}
+
+	static void RunQueries(const FMinesweeperBoardLibrary& Library, int32 Count, FRandomStream& Random)
+	{
+		// Ranges are centered on boards that exist, so most queries hit
+		FMinesweeperLatencyHistogram Latency;
+		int32 Hits = 0;
+		for (int32 i = 0; i < Count; ++i)
+		{
+			const FMinesweeperBoardLibrary::FEntry& Sample = Library.GetEntry(Random.RandHelper(Library.Num()));
+			FMinesweeperBoardQuery Query;
+			Query.Rows = Sample.Rows;
+			Query.Cols = Sample.Cols;
+			Query.Min3BV = FMath::Max(1, static_cast<int32>(Sample.ThreeBV) - 15);
+			Query.Max3BV = static_cast<int32>(Sample.ThreeBV) + 15;
+
+			const uint64 Start = FPlatformTime::Cycles64();
+			const int32 Index = Library.Find(Query);
+			Latency.Add(static_cast<uint64>(FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - Start) * 1e9));
+			Hits += Index != INDEX_NONE? 1 : 0;
+		}
+
+		UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - %d queries, %d hits | mean: %.2fus | p50: %.2fus | p99: %.2fus | max: %.2fus"),
+			Count, Hits, Latency.GetMeanNs() / 1e3, Latency.GetPercentileNs(50.0) / 1e3, Latency.GetPercentileNs(99.0) / 1e3, Latency.MaxNs / 1e3);
+	}
+}
+
+UMinesweeperLibraryCommandlet::UMinesweeperLibraryCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UMinesweeperLibraryCommandlet::Main(const FString& Params)
+{
+	using namespace MinesweeperLibraryCommandlet;
+
+	FString Directory = FMinesweeperBoardLibrary::GetDefaultDirectory();
+	FString ImportPath;
+	FString SizesText = TEXT("9x9,16x16,16x30");
+	int32 FillCount = 0;
+	int32 QueryCount = 0;
+	float Density = 0.15f;
+	int32 Seed = 1;
+	FParse::Value(*Params, TEXT("Directory="), Directory);
+	FParse::Value(*Params, TEXT("Import="), ImportPath);
+	FParse::Value(*Params, TEXT("Sizes="), SizesText);
+	FParse::Value(*Params, TEXT("Fill="), FillCount);
+	FParse::Value(*Params, TEXT("Queries="), QueryCount);
+	FParse::Value(*Params, TEXT("Density="), Density);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+
+	FMinesweeperBoardLibrary Library;
+	if (!Library.Open(Directory))
+	{
+		return 1;
+	}
+
+	FRandomStream Random(Seed);
+	if (!ImportPath.IsEmpty())
+	{
+		Import(Library, ImportPath);
+	}
+
+	if (FillCount > 0)
+	{
+		TArray<FIntPoint> Sizes;
+		ParseSizes(SizesText, Sizes);
+		if (Sizes.Num() == 0)
+		{
+			UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - No valid size in -Sizes=%s"), *SizesText);
+			return 1;
+		}
+		Fill(Library, Sizes, FillCount, Density, Random);
+	}
+
+	if (QueryCount > 0 && Library.Num() > 0)
+	{
+		RunQueries(Library, QueryCount, Random);
+	}
+
+	UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Library %s: %d boards, %d unplayed, %.2fMB of lookups in memory"),
+		*Directory, Library.Num(), Library.GetNumUnplayed(), Library.GetAllocatedSize() / (1024.0 * 1024.0));
+	return 0;
+}
@@ -0,0 +1,103 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/MinesweeperProviderBenchmarkCommandlet.h"
+
+#include "HttpManager.h"
+#include "HttpModule.h"
+#include "AI/BoardProvider.h"
+#include "AI/MockBoardProvider.h"
+#include "Containers/Ticker.h"
+
+UMinesweeperProviderBenchmarkCommandlet::UMinesweeperProviderBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UMinesweeperProviderBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString ProviderName = TEXT("Mock");
+	FString BatchesString = TEXT("1,4,16");
+	FString Prompt = TEXT("9x9 board with 10 mines");
+	int32 Requests = 8;
+	float Latency = 0.8f;
+	float PerBoardLatency = 0.15f;
+	FParse::Value(*Params, TEXT("Provider="), ProviderName);
+	FParse::Value(*Params, TEXT("Batches="), BatchesString);
+	FParse::Value(*Params, TEXT("Prompt="), Prompt);
+	FParse::Value(*Params, TEXT("Requests="), Requests);
+	FParse::Value(*Params, TEXT("Latency="), Latency);
+	FParse::Value(*Params, TEXT("PerBoardLatency="), PerBoardLatency);
+	Requests = FMath::Max(1, Requests);
+
+	const UEnum* ProviderEnum = StaticEnum<EBoardProviderType>();
+	const int64 ProviderValue = ProviderEnum->GetValueByNameString(ProviderName);
+	if (ProviderValue == INDEX_NONE)
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Unknown provider %s"), *ProviderName);
+		return 1;
+	}
+	const EBoardProviderType ProviderType = static_cast<EBoardProviderType>(ProviderValue);
+
+	TArray<FString> BatchStrings;
+	BatchesString.ParseIntoArray(BatchStrings, TEXT(","));
+
+	int32 Failures = 0;
+	for (const FString& BatchString : BatchStrings)
+	{
+		const int32 NumBoards = FMath::Max(1, FCString::Atoi(*BatchString));
+
+		TSharedRef<IBoardProvider> Provider = IBoardProvider::Create(ProviderType);
+		if (ProviderType == EBoardProviderType::Mock)
+		{
+			StaticCastSharedRef<FMockBoardProvider>(Provider)->SetSimulatedLatency(Latency, PerBoardLatency);
+		}
+
+		// One request at a time: latency, not throughput
+		double TotalMs = 0.0;
+		int32 TotalBoards = 0;
+		for (int32 i = 0; i < Requests; ++i)
+		{
+			bool bDone = false;
+			Provider->RequestBoards(Prompt, NumBoards, FOnBoardProviderResponse::CreateLambda([&](const FBoardProviderResponse& Response)
+			{
+				bDone = true;
+				if (!Response.bSuccess)
+				{
+					UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Request failed: %s"), *Response.Error.ToString());
+					Failures++;
+					return;
+				}
+
+				TotalMs += Response.LatencyMs;
+				TotalBoards += Response.Boards.Num();
+			}));
+
+			double LastTime = FPlatformTime::Seconds();
+			while (!bDone)
+			{
+				const double Now = FPlatformTime::Seconds();
+				const float DeltaTime = static_cast<float>(Now - LastTime);
+				LastTime = Now;
+
+				FHttpModule::Get().GetHttpManager().Tick(DeltaTime);
+				FTSTicker::GetCoreTicker().Tick(DeltaTime);
+				FPlatformProcess::Sleep(0.001f);
+			}
+		}
+
+		if (TotalBoards == 0)
+		{
+			continue;
+		}
+
+		UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - %s N=%d | %d requests, %d boards | %.1fms per request | %.1fms per board | %.2f boards/s"),
+			*ProviderName, NumBoards, Requests, TotalBoards, TotalMs / Requests, TotalMs / TotalBoards, TotalBoards / (TotalMs / 1000.0));
+	}
+
+	return Failures > 0? 1 : 0;
+}
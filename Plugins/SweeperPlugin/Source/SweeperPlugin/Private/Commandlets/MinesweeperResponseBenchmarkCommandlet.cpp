@@ -0,0 +1,178 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/MinesweeperResponseBenchmarkCommandlet.h"
+
+#include "AI/GeminiResponseReader.h"
+#include "Dom/JsonObject.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonSerializer.h"
+
+namespace MinesweeperResponseBenchmark
+{
+	/** What SMinesweeperPrompt did before FGeminiResponseReader: full string conversion, DOM, field copies. */
+	static bool ExtractWithDom(const TArray<uint8>& Body, FString& OutText)
+	{
+		const FUTF8ToTCHAR Converter(reinterpret_cast<const ANSICHAR*>(Body.GetData()), Body.Num());
+		const FString BodyString(Converter.Length(), Converter.Get());
+
+		TSharedPtr<FJsonObject> BodyJson;
+		TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(BodyString);
+		if (!FJsonSerializer::Deserialize(Reader, BodyJson) || !BodyJson.IsValid())
+		{
+			return false;
+		}
+
+		const TArray<TSharedPtr<FJsonValue>>* Candidates = nullptr;
+		if (!BodyJson->TryGetArrayField(TEXT("candidates"), Candidates) || Candidates->Num() == 0)
+		{
+			return false;
+		}
+
+		const TSharedPtr<FJsonObject> Content = (*Candidates)[0]->AsObject()->GetObjectField(TEXT("content"));
+		const TArray<TSharedPtr<FJsonValue>>& Parts = Content->GetArrayField(TEXT("parts"));
+		if (Parts.Num() == 0)
+		{
+			return false;
+		}
+
+		OutText = Parts[0]->AsObject()->GetStringField(TEXT("text"));
+		OutText = OutText.Replace(TEXT("\n"), TEXT(""));
+		OutText = OutText.TrimStartAndEnd();
+		return true;
+	}
+
+	static TArray<uint8> SynthesizeResponse(int32 SizeMB)
+	{
+		// Square board, one "0," or "1," per cell, a row separator and an escaped newline per row
+		const int64 TargetBytes = static_cast<int64>(FMath::Max(1, SizeMB)) * 1024 * 1024;
+		const int32 Side = FMath::Max(1, static_cast<int32>(FMath::Sqrt(static_cast<double>(TargetBytes) / 2.0)));
+
+		FRandomStream Random(Side);
+		FString Board;
+		Board.Reserve(Side * (Side * 2 + 3));
+		for (int32 Row = 0; Row < Side; ++Row)
+		{
+			for (int32 Col = 0; Col < Side; ++Col)
+			{
+				Board.AppendChar(Random.FRand() < 0.15f? TEXT('1') : TEXT('0'));
+				if (Col != Side - 1)
+				{
+					Board.AppendChar(TEXT(','));
+				}
+			}
+
+			if (Row != Side - 1)
+			{
+				Board.Append(TEXT("|\\n"));
+			}
+		}
+
+		const FString Json = FString::Printf(TEXT("{\"candidates\": [{\"content\": {\"parts\": [{\"text\": \"%s\\n\"}], \"role\": \"model\"}, ")
+			TEXT("\"finishReason\": \"STOP\", \"avgLogprobs\": -0.01}], \"usageMetadata\": {\"promptTokenCount\": 90, \"candidatesTokenCount\": %d}, ")
+			TEXT("\"modelVersion\": \"gemini-1.5-flash\"}"), *Board, Side * Side);
+
+		const FTCHARToUTF8 Utf8(*Json);
+		return TArray<uint8>(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	}
+}
+
+UMinesweeperResponseBenchmarkCommandlet::UMinesweeperResponseBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UMinesweeperResponseBenchmarkCommandlet::Main(const FString& Params)
+{
+	using namespace MinesweeperResponseBenchmark;
+
+	int32 Iterations = 20;
+	int32 SizeMB = 4;
+	FString ResponsesPath;
+	FParse::Value(*Params, TEXT("Iterations="), Iterations);
+	FParse::Value(*Params, TEXT("SizeMB="), SizeMB);
+	FParse::Value(*Params, TEXT("Responses="), ResponsesPath);
+	Iterations = FMath::Max(1, Iterations);
+
+	TArray<TPair<FString, TArray<uint8>>> Responses;
+	if (ResponsesPath.IsEmpty())
+	{
+		Responses.Emplace(FString::Printf(TEXT("Synthetic %dMB"), SizeMB), SynthesizeResponse(SizeMB));
+	}
+	else
+	{
+		TArray<FString> Files;
+		if (FPaths::DirectoryExists(ResponsesPath))
+		{
+			IFileManager::Get().FindFiles(Files, *(ResponsesPath / TEXT("*.json")), true, false);
+			for (FString& File : Files)
+			{
+				File = ResponsesPath / File;
+			}
+		}
+		else
+		{
+			Files.Add(ResponsesPath);
+		}
+
+		for (const FString& File : Files)
+		{
+			TArray<uint8> Bytes;
+			if (FFileHelper::LoadFileToArray(Bytes, *File))
+			{
+				Responses.Emplace(FPaths::GetCleanFilename(File), MoveTemp(Bytes));
+			}
+		}
+	}
+
+	if (Responses.Num() == 0)
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - No responses to benchmark in %s"), *ResponsesPath);
+		return 1;
+	}
+
+	int32 Mismatches = 0;
+	for (const TPair<FString, TArray<uint8>>& Response : Responses)
+	{
+		const TArray<uint8>& Body = Response.Value;
+
+		FString DomText;
+		FString StreamText;
+		const bool bDomOk = ExtractWithDom(Body, DomText);
+		const bool bStreamOk = FGeminiResponseReader::ExtractFirstCandidateText(Body, StreamText) == EGeminiResponseResult::Success;
+		if (bDomOk != bStreamOk || !DomText.Equals(StreamText, ESearchCase::CaseSensitive))
+		{
+			UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - %s: extraction mismatch (DOM %d, reader %d)"), *Response.Key, bDomOk, bStreamOk);
+			Mismatches++;
+			continue;
+		}
+
+		double DomSeconds = 0.0;
+		double StreamSeconds = 0.0;
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			double Start = FPlatformTime::Seconds();
+			ExtractWithDom(Body, DomText);
+			DomSeconds += FPlatformTime::Seconds() - Start;
+
+			Start = FPlatformTime::Seconds();
+			FGeminiResponseReader::ExtractFirstCandidateText(Body, StreamText);
+			StreamSeconds += FPlatformTime::Seconds() - Start;
+		}
+
+		const double Megabytes = Body.Num() / (1024.0 * 1024.0);
+		const double DomMs = DomSeconds * 1000.0 / Iterations;
+		const double StreamMs = StreamSeconds * 1000.0 / Iterations;
+		UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - %s (%.2fMB, %d iterations) | DOM: %.3fms (%.0f MB/s) | Reader: %.3fms (%.0f MB/s) | x%.1f"),
+			*Response.Key, Megabytes, Iterations, DomMs, Megabytes / (DomSeconds / Iterations), StreamMs, Megabytes / (StreamSeconds / Iterations), DomMs / FMath::Max(StreamMs, 0.001));
+	}
+
+	return Mismatches > 0? 1 : 0;
+}
@@ -0,0 +1,71 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/MinesweeperSimulationCommandlet.h"
+
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Simulation/MinesweeperSimulation.h"
+
+UMinesweeperSimulationCommandlet::UMinesweeperSimulationCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+	ShowErrorCount = true;
+}
+
+int32 UMinesweeperSimulationCommandlet::Main(const FString& Params)
+{
+	FMinesweeperSimulationSettings Settings;
+	FParse::Value(*Params, TEXT("Games="), Settings.Games);
+	FParse::Value(*Params, TEXT("Rows="), Settings.Rows);
+	FParse::Value(*Params, TEXT("Cols="), Settings.Cols);
+	FParse::Value(*Params, TEXT("Mines="), Settings.Mines);
+	FParse::Value(*Params, TEXT("Workers="), Settings.Workers);
+	FParse::Value(*Params, TEXT("Seed="), Settings.Seed);
+	Settings.bFixedSizeBoards = !FParse::Param(*Params, TEXT("DynamicBoard"));
+
+	FString StrategyName = Settings.Strategy.ToString();
+	FParse::Value(*Params, TEXT("Strategy="), StrategyName);
+
+	TArray<FName> Strategies;
+	if (StrategyName.Equals(TEXT("All"), ESearchCase::IgnoreCase))
+	{
+		Strategies = { TEXT("Random"), TEXT("Solver") };
+	}
+	else
+	{
+		Strategies.Add(FName(*StrategyName));
+	}
+
+	FString CsvPath;
+	FParse::Value(*Params, TEXT("Csv="), CsvPath);
+
+	for (const FName& Strategy : Strategies)
+	{
+		Settings.Strategy = Strategy;
+		const FMinesweeperSimulationResult Result = FMinesweeperSimulator::Run(Settings);
+		if (Result.Games <= 0)
+		{
+			return 1;
+		}
+
+		Result.Log();
+
+		if (!CsvPath.IsEmpty())
+		{
+			// Append, so the file tracks the benchmark over time
+			FString Lines;
+			if (!FPaths::FileExists(CsvPath))
+			{
+				Lines = FString(TEXT("Timestamp,")) + FMinesweeperSimulationResult::GetCsvHeader() + LINE_TERMINATOR;
+			}
+			Lines += FString::Printf(TEXT("%s,%s"), *FDateTime::UtcNow().ToIso8601(), *Result.ToCsvRow()) + LINE_TERMINATOR;
+			FFileHelper::SaveStringToFile(Lines, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,161 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Coop/MinesweeperCoopProtocol.h"
+
+int32 FMinesweeperCoopProtocol::BeginFrame(TArray<uint8>& Out, EMinesweeperCoopMessage Type)
+{
+	const int32 FrameStart = Out.AddUninitialized(FRAME_HEADER_SIZE);
+	Out[FrameStart + 4] = static_cast<uint8>(Type);
+	return FrameStart;
+}
+
+void FMinesweeperCoopProtocol::EndFrame(TArray<uint8>& Out, int32 FrameStart)
+{
+	const uint32 PayloadSize = static_cast<uint32>(Out.Num() - FrameStart - FRAME_HEADER_SIZE);
+	for (int32 i = 0; i < 4; ++i)
+	{
+		Out[FrameStart + i] = static_cast<uint8>(PayloadSize >> (i * 8));
+	}
+}
+
+int32 FMinesweeperCoopProtocol::GetMaxPayloadSize(EMinesweeperCoopMessage Type, bool bFromHost)
+{
+	switch (Type)
+	{
+	case EMinesweeperCoopMessage::Hello:
+		return bFromHost? INDEX_NONE : MAX_HELLO_SIZE;
+	case EMinesweeperCoopMessage::Snapshot:
+		return bFromHost? MAX_SNAPSHOT_SIZE : INDEX_NONE;
+	case EMinesweeperCoopMessage::Deltas:
+		return MAX_DELTAS_SIZE;
+	}
+
+	return INDEX_NONE;
+}
+
+int32 FMinesweeperCoopProtocol::PeekFrame(const uint8* Data, int32 Size, bool bFromHost, EMinesweeperCoopMessage& OutType)
+{
+	if (Size < FRAME_HEADER_SIZE)
+	{
+		return 0;
+	}
+
+	const uint32 PayloadSize = Data[0] | (Data[1] << 8) | (Data[2] << 16) | (static_cast<uint32>(Data[3]) << 24);
+	const uint8 Type = Data[4];
+	if (Type < static_cast<uint8>(EMinesweeperCoopMessage::Hello) || Type > static_cast<uint8>(EMinesweeperCoopMessage::Deltas))
+	{
+		return INDEX_NONE;
+	}
+
+	// Checked on the header alone, before the payload is received
+	const int32 MaxPayloadSize = GetMaxPayloadSize(static_cast<EMinesweeperCoopMessage>(Type), bFromHost);
+	if (MaxPayloadSize == INDEX_NONE || PayloadSize > static_cast<uint32>(MaxPayloadSize))
+	{
+		return INDEX_NONE;
+	}
+
+	OutType = static_cast<EMinesweeperCoopMessage>(Type);
+	const int32 FrameSize = FRAME_HEADER_SIZE + static_cast<int32>(PayloadSize);
+	return Size >= FrameSize? FrameSize : 0;
+}
+
+void FMinesweeperCoopProtocol::WriteVarInt(TArray<uint8>& Out, uint64 Value)
+{
+	while (Value >= 0x80)
+	{
+		Out.Add(static_cast<uint8>(Value | 0x80));
+		Value >>= 7;
+	}
+	Out.Add(static_cast<uint8>(Value));
+}
+
+bool FMinesweeperCoopProtocol::ReadVarInt(const uint8*& Ptr, const uint8* End, uint64& OutValue)
+{
+	OutValue = 0;
+	for (int32 Shift = 0; Shift < 64 && Ptr < End; Shift += 7)
+	{
+		const uint8 Byte = *Ptr++;
+		OutValue |= static_cast<uint64>(Byte & 0x7F) << Shift;
+		if ((Byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int32 FMinesweeperCoopProtocol::BeginDeltas(TArray<uint8>& Out, uint32 Epoch, int64 FirstSequence)
+{
+	WriteVarInt(Out, Epoch);
+	WriteVarInt(Out, static_cast<uint64>(FirstSequence));
+
+	// Fixed size count, patched once the batch is known
+	return Out.AddZeroed(4);
+}
+
+void FMinesweeperCoopProtocol::WriteDelta(TArray<uint8>& Out, const FMinesweeperDelta& Delta, int32& InOutPreviousId)
+{
+	const int64 Difference = static_cast<int64>(Delta.Id) - InOutPreviousId;
+	const uint64 ZigZag = (static_cast<uint64>(Difference) << 1) ^ static_cast<uint64>(Difference >> 63);
+	WriteVarInt(Out, (ZigZag << 2) | static_cast<uint64>(Delta.Action));
+	InOutPreviousId = Delta.Id;
+}
+
+void FMinesweeperCoopProtocol::EndDeltas(TArray<uint8>& Out, int32 CountOffset, uint32 Count)
+{
+	for (int32 i = 0; i < 4; ++i)
+	{
+		Out[CountOffset + i] = static_cast<uint8>(Count >> (i * 8));
+	}
+}
+
+bool FMinesweeperCoopProtocol::ReadDeltas(const uint8* Payload, int32 Size, uint32& OutEpoch, int64& OutFirstSequence, TArray<FMinesweeperDelta>& OutDeltas)
+{
+	const uint8* Ptr = Payload;
+	const uint8* End = Payload + Size;
+
+	uint64 Epoch = 0;
+	uint64 FirstSequence = 0;
+	if (!ReadVarInt(Ptr, End, Epoch) || !ReadVarInt(Ptr, End, FirstSequence) || End - Ptr < 4)
+	{
+		return false;
+	}
+
+	const uint32 Count = Ptr[0] | (Ptr[1] << 8) | (Ptr[2] << 16) | (static_cast<uint32>(Ptr[3]) << 24);
+	Ptr += 4;
+
+	// Every delta takes at least a byte, a larger count is a corrupt frame
+	if (Count > static_cast<uint32>(End - Ptr))
+	{
+		return false;
+	}
+
+	OutEpoch = static_cast<uint32>(Epoch);
+	OutFirstSequence = static_cast<int64>(FirstSequence);
+	OutDeltas.Reset(Count);
+
+	int32 PreviousId = 0;
+	for (uint32 i = 0; i < Count; ++i)
+	{
+		uint64 Value = 0;
+		if (!ReadVarInt(Ptr, End, Value) || (Value & 3) > static_cast<uint64>(EMinesweeperCommand::ToggleFlag))
+		{
+			return false;
+		}
+
+		const uint64 ZigZag = Value >> 2;
+		const int64 Difference = static_cast<int64>(ZigZag >> 1) ^ -static_cast<int64>(ZigZag & 1);
+		const int64 Id = PreviousId + Difference;
+		if (Id < 0 || Id > MAX_int32)
+		{
+			return false;
+		}
+
+		PreviousId = static_cast<int32>(Id);
+		OutDeltas.Add({PreviousId, static_cast<EMinesweeperCommand>(Value & 3)});
+	}
+
+	return Ptr == End;
+}
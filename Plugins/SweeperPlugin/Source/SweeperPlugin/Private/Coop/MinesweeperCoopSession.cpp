@@ -0,0 +1,554 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Coop/MinesweeperCoopSession.h"
+
+#include "Common/TcpSocketBuilder.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "Board/MinesweeperSnapshot.h"
+
+namespace MinesweeperCoopSession
+{
+	// Largest read from a socket in one call
+	static constexpr int32 RECEIVE_CHUNK = 64 * 1024;
+}
+
+TUniquePtr<FMinesweeperCoopSession> FMinesweeperCoopSession::Host(int32 Port, const FMinesweeperCoopSettings& Settings)
+{
+	TUniquePtr<FMinesweeperCoopSession> Session(new FMinesweeperCoopSession(true, Settings));
+	Session->ListenSocket = FTcpSocketBuilder(TEXT("SweeperCoopHost"))
+		.AsReusable()
+		.AsNonBlocking()
+		.BoundToEndpoint(FIPv4Endpoint(FIPv4Address::Any, Port))
+		.Listening(8);
+
+	if (Session->ListenSocket == nullptr)
+	{
+		UE_LOG(LogSlate, Error, TEXT("[Minesweeper] - Co-op: unable to listen on port %d"), Port);
+		return nullptr;
+	}
+
+	UE_LOG(LogSlate, Display, TEXT("[Minesweeper] - Co-op: hosting on port %d"), Port);
+	return Session;
+}
+
+TUniquePtr<FMinesweeperCoopSession> FMinesweeperCoopSession::Join(const FString& Address, int32 Port, const FMinesweeperCoopSettings& Settings)
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	TSharedRef<FInternetAddr> HostAddress = SocketSubsystem->CreateInternetAddr();
+	bool bValidAddress = false;
+	HostAddress->SetIp(*Address, bValidAddress);
+	HostAddress->SetPort(Port);
+	if (!bValidAddress)
+	{
+		UE_LOG(LogSlate, Error, TEXT("[Minesweeper] - Co-op: invalid host address %s"), *Address);
+		return nullptr;
+	}
+
+	// Blocking connect, then non blocking like the host side
+	FSocket* Socket = FTcpSocketBuilder(TEXT("SweeperCoopClient")).AsBlocking().Build();
+	if (Socket == nullptr || !Socket->Connect(*HostAddress))
+	{
+		UE_LOG(LogSlate, Error, TEXT("[Minesweeper] - Co-op: unable to connect to %s:%d"), *Address, Port);
+		if (Socket != nullptr)
+		{
+			SocketSubsystem->DestroySocket(Socket);
+		}
+		return nullptr;
+	}
+
+	Socket->SetNonBlocking(true);
+	Socket->SetNoDelay(true);
+
+	TUniquePtr<FMinesweeperCoopSession> Session(new FMinesweeperCoopSession(false, Settings));
+	FPeer& HostPeer = Session->Peers.AddDefaulted_GetRef();
+	HostPeer.Socket = Socket;
+
+	const int32 Frame = FMinesweeperCoopProtocol::BeginFrame(HostPeer.Outbox, EMinesweeperCoopMessage::Hello);
+	FMinesweeperCoopProtocol::WriteVarInt(HostPeer.Outbox, FMinesweeperCoopProtocol::VERSION);
+	FMinesweeperCoopProtocol::EndFrame(HostPeer.Outbox, Frame);
+
+	UE_LOG(LogSlate, Display, TEXT("[Minesweeper] - Co-op: joined %s:%d"), *Address, Port);
+	return Session;
+}
+
+FMinesweeperCoopSession::FMinesweeperCoopSession(bool bInIsHost, const FMinesweeperCoopSettings& InSettings)
+	: bIsHost(bInIsHost), Settings(InSettings)
+{
+	// Deltas frames are sized by the budget, and must stay within what peers accept
+	Settings.MaxBytesPerTick = FMath::Clamp(Settings.MaxBytesPerTick, 256, FMinesweeperCoopProtocol::MAX_DELTAS_SIZE);
+}
+
+FMinesweeperCoopSession::~FMinesweeperCoopSession()
+{
+	ISocketSubsystem* SocketSubsystem = ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM);
+	for (FPeer& Peer : Peers)
+	{
+		if (Peer.Socket != nullptr)
+		{
+			Peer.Socket->Close();
+			SocketSubsystem->DestroySocket(Peer.Socket);
+		}
+	}
+
+	if (ListenSocket != nullptr)
+	{
+		ListenSocket->Close();
+		SocketSubsystem->DestroySocket(ListenSocket);
+	}
+}
+
+bool FMinesweeperCoopSession::IsHost() const
+{
+	return bIsHost;
+}
+
+bool FMinesweeperCoopSession::IsReady() const
+{
+	if (bIsHost)
+	{
+		return ListenSocket != nullptr;
+	}
+
+	return bHasBoard && Peers.Num() > 0 && !Peers[0].bClosed;
+}
+
+int32 FMinesweeperCoopSession::GetNumPeers() const
+{
+	return Peers.Num();
+}
+
+void FMinesweeperCoopSession::StartBoard(const FMinesweeperBoard& InBoard)
+{
+	if (!bIsHost)
+	{
+		return;
+	}
+
+	Board = InBoard;
+	bHasBoard = true;
+	bGameOver = false;
+	Epoch++;
+	Log.Reset();
+	LogStart = 0;
+	Sequence = 0;
+	PendingActions.Reset();
+
+	for (FPeer& Peer : Peers)
+	{
+		if (Peer.bGreeted)
+		{
+			QueueSnapshot(Peer);
+		}
+	}
+
+	BoardChanged.Broadcast(TArrayView<const int32>());
+}
+
+void FMinesweeperCoopSession::SubmitAction(EMinesweeperCommand Action, int32 Id)
+{
+	PendingActions.Add({Id, Action});
+}
+
+void FMinesweeperCoopSession::Tick()
+{
+	if (bIsHost)
+	{
+		AcceptPeers();
+	}
+
+	for (FPeer& Peer : Peers)
+	{
+		Receive(Peer);
+		ProcessFrames(Peer);
+	}
+
+	if (bIsHost)
+	{
+		ApplyPendingActions();
+		for (FPeer& Peer : Peers)
+		{
+			QueueDeltas(Peer);
+		}
+		TrimLog();
+	}
+	else
+	{
+		QueueLocalActions();
+	}
+
+	for (FPeer& Peer : Peers)
+	{
+		Send(Peer);
+	}
+
+	// Host forgets closed peers, a client keeps its host to report it closed
+	if (bIsHost)
+	{
+		for (int32 i = Peers.Num() - 1; i >= 0; --i)
+		{
+			if (Peers[i].bClosed)
+			{
+				ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(Peers[i].Socket);
+				Peers.RemoveAtSwap(i);
+			}
+		}
+	}
+}
+
+const FMinesweeperBoard& FMinesweeperCoopSession::GetBoard() const
+{
+	return Board;
+}
+
+int64 FMinesweeperCoopSession::GetSequence() const
+{
+	return Sequence;
+}
+
+uint32 FMinesweeperCoopSession::GetEpoch() const
+{
+	return Epoch;
+}
+
+bool FMinesweeperCoopSession::IsGameOver() const
+{
+	return bGameOver;
+}
+
+uint32 FMinesweeperCoopSession::GetBoardChecksum() const
+{
+	TArray<uint8> Bytes;
+	FMinesweeperSnapshot::Write(Board, Bytes);
+	return FCrc::MemCrc32(Bytes.GetData(), Bytes.Num());
+}
+
+const FMinesweeperCoopStats& FMinesweeperCoopSession::GetStats() const
+{
+	return Stats;
+}
+
+FMinesweeperCoopSession::FOnBoardChanged& FMinesweeperCoopSession::OnBoardChanged()
+{
+	return BoardChanged;
+}
+
+void FMinesweeperCoopSession::AcceptPeers()
+{
+	bool bPending = false;
+	while (ListenSocket->HasPendingConnection(bPending) && bPending)
+	{
+		FSocket* Socket = ListenSocket->Accept(TEXT("SweeperCoopPeer"));
+		if (Socket == nullptr)
+		{
+			break;
+		}
+
+		Socket->SetNonBlocking(true);
+		Socket->SetNoDelay(true);
+		Peers.AddDefaulted_GetRef().Socket = Socket;
+		UE_LOG(LogSlate, Display, TEXT("[Minesweeper] - Co-op: peer connected (%d peers)"), Peers.Num());
+	}
+}
+
+void FMinesweeperCoopSession::Receive(FPeer& Peer)
+{
+	if (Peer.bClosed)
+	{
+		return;
+	}
+
+	uint32 PendingSize = 0;
+	while (Peer.Socket->HasPendingData(PendingSize) && PendingSize > 0)
+	{
+		const int32 Offset = Peer.Inbox.Num();
+		const int32 ChunkSize = FMath::Min<int32>(PendingSize, MinesweeperCoopSession::RECEIVE_CHUNK);
+		Peer.Inbox.AddUninitialized(ChunkSize);
+
+		int32 BytesRead = 0;
+		const bool bRead = Peer.Socket->Recv(Peer.Inbox.GetData() + Offset, ChunkSize, BytesRead);
+		Peer.Inbox.SetNum(Offset + FMath::Max(0, BytesRead), EAllowShrinking::No);
+		Stats.BytesReceived += FMath::Max(0, BytesRead);
+		if (!bRead || BytesRead <= 0)
+		{
+			break;
+		}
+	}
+
+	if (Peer.Socket->GetConnectionState() == SCS_ConnectionError)
+	{
+		ClosePeer(Peer, TEXT("connection lost"));
+	}
+}
+
+void FMinesweeperCoopSession::ProcessFrames(FPeer& Peer)
+{
+	int32 Consumed = 0;
+	while (!Peer.bClosed)
+	{
+		EMinesweeperCoopMessage Type;
+		const int32 FrameSize = FMinesweeperCoopProtocol::PeekFrame(Peer.Inbox.GetData() + Consumed, Peer.Inbox.Num() - Consumed, !bIsHost, Type);
+		if (FrameSize == INDEX_NONE)
+		{
+			ClosePeer(Peer, TEXT("corrupt frame"));
+			break;
+		}
+
+		if (FrameSize == 0)
+		{
+			break;
+		}
+
+		const uint8* Payload = Peer.Inbox.GetData() + Consumed + FMinesweeperCoopProtocol::FRAME_HEADER_SIZE;
+		HandleFrame(Peer, Type, Payload, FrameSize - FMinesweeperCoopProtocol::FRAME_HEADER_SIZE);
+		Consumed += FrameSize;
+	}
+
+	Peer.Inbox.RemoveAt(0, FMath::Min(Consumed, Peer.Inbox.Num()), EAllowShrinking::No);
+}
+
+void FMinesweeperCoopSession::HandleFrame(FPeer& Peer, EMinesweeperCoopMessage Type, const uint8* Payload, int32 Size)
+{
+	const uint8* Ptr = Payload;
+	const uint8* End = Payload + Size;
+
+	switch (Type)
+	{
+	case EMinesweeperCoopMessage::Hello:
+	{
+		uint64 Version = 0;
+		if (!bIsHost || !FMinesweeperCoopProtocol::ReadVarInt(Ptr, End, Version) || Version != FMinesweeperCoopProtocol::VERSION)
+		{
+			ClosePeer(Peer, TEXT("unexpected hello"));
+			return;
+		}
+
+		Peer.bGreeted = true;
+		if (bHasBoard)
+		{
+			QueueSnapshot(Peer);
+		}
+		return;
+	}
+	case EMinesweeperCoopMessage::Snapshot:
+	{
+		uint64 SnapshotEpoch = 0;
+		uint64 SnapshotSequence = 0;
+		uint64 SnapshotGameOver = 0;
+		if (bIsHost || !FMinesweeperCoopProtocol::ReadVarInt(Ptr, End, SnapshotEpoch) || !FMinesweeperCoopProtocol::ReadVarInt(Ptr, End, SnapshotSequence)
+			|| !FMinesweeperCoopProtocol::ReadVarInt(Ptr, End, SnapshotGameOver) || SnapshotGameOver > 1
+			|| !FMinesweeperSnapshot::Read(Ptr, End - Ptr, Board))
+		{
+			ClosePeer(Peer, TEXT("invalid snapshot"));
+			return;
+		}
+
+		Epoch = static_cast<uint32>(SnapshotEpoch);
+		Sequence = static_cast<int64>(SnapshotSequence);
+		bHasBoard = true;
+		bGameOver = SnapshotGameOver != 0;
+		Stats.SnapshotsReceived++;
+		BoardChanged.Broadcast(TArrayView<const int32>());
+		return;
+	}
+	case EMinesweeperCoopMessage::Deltas:
+	{
+		uint32 DeltasEpoch = 0;
+		int64 FirstSequence = 0;
+		if (!FMinesweeperCoopProtocol::ReadDeltas(Payload, Size, DeltasEpoch, FirstSequence, ReceivedDeltas))
+		{
+			ClosePeer(Peer, TEXT("invalid deltas"));
+			return;
+		}
+
+		Stats.DeltasReceived += ReceivedDeltas.Num();
+
+		// Actions sent before the client got the new board are meaningless on it
+		if (DeltasEpoch != Epoch || !bHasBoard)
+		{
+			return;
+		}
+
+		if (bIsHost)
+		{
+			PendingActions.Append(ReceivedDeltas);
+			return;
+		}
+
+		if (FirstSequence != Sequence)
+		{
+			ClosePeer(Peer, TEXT("out of sequence deltas"));
+			return;
+		}
+
+		ChangedIds.Reset();
+		for (const FMinesweeperDelta& Delta : ReceivedDeltas)
+		{
+			const EMinesweeperCommandResult Result = FMinesweeperInputQueue::Apply(Board, Delta.Action, Delta.Id, ChangedIds);
+			bGameOver = bGameOver || Result == EMinesweeperCommandResult::Won || Result == EMinesweeperCommandResult::Lost;
+		}
+		Sequence += ReceivedDeltas.Num();
+		BoardChanged.Broadcast(ChangedIds);
+		return;
+	}
+	}
+}
+
+void FMinesweeperCoopSession::Send(FPeer& Peer)
+{
+	if (Peer.bClosed || Peer.Outbox.Num() == 0)
+	{
+		return;
+	}
+
+	const int32 ToSend = FMath::Min(Peer.Outbox.Num(), Settings.MaxBytesPerTick);
+	int32 BytesSent = 0;
+	if (!Peer.Socket->Send(Peer.Outbox.GetData(), ToSend, BytesSent))
+	{
+		// Would block is not an error, the rest goes next Tick
+		if (Peer.Socket->GetConnectionState() == SCS_ConnectionError)
+		{
+			ClosePeer(Peer, TEXT("send failed"));
+		}
+		return;
+	}
+
+	Stats.BytesSent += BytesSent;
+	Peer.Outbox.RemoveAt(0, BytesSent, EAllowShrinking::No);
+}
+
+void FMinesweeperCoopSession::ClosePeer(FPeer& Peer, const TCHAR* Reason)
+{
+	if (!Peer.bClosed)
+	{
+		UE_LOG(LogSlate, Warning, TEXT("[Minesweeper] - Co-op: peer closed, %s"), Reason);
+		Peer.bClosed = true;
+		Peer.Socket->Close();
+	}
+}
+
+void FMinesweeperCoopSession::ApplyPendingActions()
+{
+	if (!bHasBoard || PendingActions.Num() == 0)
+	{
+		return;
+	}
+
+	// Arrival order, so every peer replays the same sequence. Actions that change nothing are not logged
+	ChangedIds.Reset();
+	for (const FMinesweeperDelta& Action : PendingActions)
+	{
+		const EMinesweeperCommandResult Result = FMinesweeperInputQueue::Apply(Board, Action.Action, Action.Id, ChangedIds);
+		if (Result != EMinesweeperCommandResult::Unchanged)
+		{
+			Log.Add(Action);
+			Sequence++;
+			bGameOver = bGameOver || Result == EMinesweeperCommandResult::Won || Result == EMinesweeperCommandResult::Lost;
+		}
+	}
+	PendingActions.Reset();
+
+	if (ChangedIds.Num() > 0)
+	{
+		BoardChanged.Broadcast(ChangedIds);
+	}
+}
+
+void FMinesweeperCoopSession::QueueSnapshot(FPeer& Peer)
+{
+	TArray<uint8> SnapshotBytes;
+	FMinesweeperSnapshot::Write(Board, SnapshotBytes);
+
+	const int32 Frame = FMinesweeperCoopProtocol::BeginFrame(Peer.Outbox, EMinesweeperCoopMessage::Snapshot);
+	FMinesweeperCoopProtocol::WriteVarInt(Peer.Outbox, Epoch);
+	FMinesweeperCoopProtocol::WriteVarInt(Peer.Outbox, static_cast<uint64>(Sequence));
+	FMinesweeperCoopProtocol::WriteVarInt(Peer.Outbox, bGameOver? 1 : 0);
+	Peer.Outbox.Append(SnapshotBytes);
+	FMinesweeperCoopProtocol::EndFrame(Peer.Outbox, Frame);
+
+	Peer.NextSequence = Sequence;
+	Stats.SnapshotsSent++;
+}
+
+void FMinesweeperCoopSession::QueueDeltas(FPeer& Peer)
+{
+	const int64 Missing = Sequence - Peer.NextSequence;
+	if (Peer.bClosed || !Peer.bGreeted || !bHasBoard || Missing <= 0)
+	{
+		return;
+	}
+
+	// Bytes still queued from earlier ticks count against this tick's budget: a slow peer gets fewer deltas, not a growing outbox
+	const int32 Budget = Settings.MaxBytesPerTick - Peer.Outbox.Num() - FMinesweeperCoopProtocol::FRAME_HEADER_SIZE - 24;
+	const int32 Count = static_cast<int32>(FMath::Min<int64>(Missing, Budget / FMinesweeperCoopProtocol::MAX_DELTA_SIZE));
+	if (Count <= 0)
+	{
+		return;
+	}
+
+	const int32 Frame = FMinesweeperCoopProtocol::BeginFrame(Peer.Outbox, EMinesweeperCoopMessage::Deltas);
+	const int32 CountOffset = FMinesweeperCoopProtocol::BeginDeltas(Peer.Outbox, Epoch, Peer.NextSequence);
+	int32 PreviousId = 0;
+	const int32 First = static_cast<int32>(Peer.NextSequence - LogStart);
+	for (int32 i = First; i < First + Count; ++i)
+	{
+		FMinesweeperCoopProtocol::WriteDelta(Peer.Outbox, Log[i], PreviousId);
+	}
+	FMinesweeperCoopProtocol::EndDeltas(Peer.Outbox, CountOffset, static_cast<uint32>(Count));
+	FMinesweeperCoopProtocol::EndFrame(Peer.Outbox, Frame);
+
+	Peer.NextSequence += Count;
+	Stats.DeltasSent += Count;
+}
+
+void FMinesweeperCoopSession::QueueLocalActions()
+{
+	if (PendingActions.Num() == 0 || Peers.Num() == 0 || Peers[0].bClosed || !bHasBoard)
+	{
+		return;
+	}
+
+	// Local actions of the tick in one frame within the budget, the host decides what they do. The rest waits for the next Tick
+	FPeer& HostPeer = Peers[0];
+	const int32 Budget = Settings.MaxBytesPerTick - HostPeer.Outbox.Num() - FMinesweeperCoopProtocol::FRAME_HEADER_SIZE - 24;
+	const int32 Count = FMath::Min(PendingActions.Num(), Budget / FMinesweeperCoopProtocol::MAX_DELTA_SIZE);
+	if (Count <= 0)
+	{
+		return;
+	}
+
+	const int32 Frame = FMinesweeperCoopProtocol::BeginFrame(HostPeer.Outbox, EMinesweeperCoopMessage::Deltas);
+	const int32 CountOffset = FMinesweeperCoopProtocol::BeginDeltas(HostPeer.Outbox, Epoch, 0);
+	int32 PreviousId = 0;
+	for (int32 i = 0; i < Count; ++i)
+	{
+		FMinesweeperCoopProtocol::WriteDelta(HostPeer.Outbox, PendingActions[i], PreviousId);
+	}
+	FMinesweeperCoopProtocol::EndDeltas(HostPeer.Outbox, CountOffset, Count);
+	FMinesweeperCoopProtocol::EndFrame(HostPeer.Outbox, Frame);
+
+	Stats.DeltasSent += Count;
+	PendingActions.RemoveAt(0, Count, EAllowShrinking::No);
+}
+
+void FMinesweeperCoopSession::TrimLog()
+{
+	// Entries every peer has are dropped, peers waiting for their hello get a snapshot anyway
+	int64 Oldest = Sequence;
+	for (const FPeer& Peer : Peers)
+	{
+		if (!Peer.bClosed && Peer.bGreeted)
+		{
+			Oldest = FMath::Min(Oldest, Peer.NextSequence);
+		}
+	}
+
+	const int64 Drop = Oldest - LogStart;
+	if (Drop > 0)
+	{
+		Log.RemoveAt(0, static_cast<int32>(Drop), EAllowShrinking::No);
+		LogStart = Oldest;
+	}
+}
@@ -0,0 +1,296 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "MinesweeperManager.h"
+
+#include "AI/BoardProvider.h"
+#include "Algo/Count.h"
+#include "Board/MinesweeperBoardFormats.h"
+#include "Board/MinesweeperBoardLibrary.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Settings/AISettings.h"
+#include "Widgets/SMinesweeperTab.h"
+
+TUniquePtr<FMinesweeperManager> FMinesweeperManager::Instance = nullptr;
+
+static FAutoConsoleCommand GSweeperClickLatencyCommand(
+	TEXT("Sweeper.ClickLatency"),
+	TEXT("Logs p50/p99 click to paint latency of the Minesweeper boards, per board size"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		if (FMinesweeperManager::IsInitialized())
+		{
+			FMinesweeperManager::Get().LogClickLatencyReport();
+		}
+	}));
+
+void FMinesweeperManager::Initialize()
+{
+	if (!Instance.IsValid())
+	{
+		Instance = MakeUnique<FMinesweeperManager>();
+	}
+}
+
+void FMinesweeperManager::Shutdown()
+{
+	if (Instance.IsValid() && Instance->ClickLatencies.Num() > 0)
+	{
+		Instance->LogClickLatencyReport();
+		Instance->AppendClickLatencyCsv(GetDefaultClickLatencyCsvPath());
+	}
+
+	Instance.Reset();
+}
+
+FMinesweeperManager& FMinesweeperManager::Get()
+{
+	check(Instance.IsValid());
+	return *Instance;
+}
+
+bool FMinesweeperManager::IsInitialized()
+{
+	return Instance.IsValid();
+}
+
+TSharedRef<IBoardProvider> FMinesweeperManager::GetProvider()
+{
+	if (!Provider.IsValid())
+	{
+		Provider = IBoardProvider::Create();
+	}
+
+	return Provider.ToSharedRef();
+}
+
+int32 FMinesweeperManager::RegisterTab(const TSharedRef<SMinesweeperTab>& Tab)
+{
+	int32 Slot = Tabs.IndexOfByPredicate([](const TWeakPtr<SMinesweeperTab>& Other) { return !Other.IsValid(); });
+	if (Slot == INDEX_NONE)
+	{
+		Slot = Tabs.Add(Tab);
+	}
+	else
+	{
+		Tabs[Slot] = Tab;
+	}
+
+	LastTabSlot = Slot;
+	return Slot;
+}
+
+void FMinesweeperManager::UnregisterTab(int32 Slot)
+{
+	if (Tabs.IsValidIndex(Slot))
+	{
+		Tabs[Slot].Reset();
+	}
+
+	if (LastTabSlot == Slot)
+	{
+		LastTabSlot = Tabs.FindLastByPredicate([](const TWeakPtr<SMinesweeperTab>& Tab) { return Tab.IsValid(); });
+	}
+
+	// Nobody left to prompt: no more keep-alive pings, the next tab warms up again
+	if (Provider.IsValid() && GetNumTabs() == 0)
+	{
+		Provider->CoolDown();
+	}
+}
+
+TSharedPtr<SMinesweeperTab> FMinesweeperManager::GetLastTab() const
+{
+	return Tabs.IsValidIndex(LastTabSlot)? Tabs[LastTabSlot].Pin() : nullptr;
+}
+
+int32 FMinesweeperManager::GetNumTabs() const
+{
+	return Algo::CountIf(Tabs, [](const TWeakPtr<SMinesweeperTab>& Tab) { return Tab.IsValid(); });
+}
+
+void FMinesweeperManager::AddCachedBoards(const FString& Prompt, TArrayView<const FString> Boards)
+{
+	if (Boards.Num() == 0)
+	{
+		return;
+	}
+
+	const FString Key = MakeCacheKey(Prompt);
+	CachedBoards.FindOrAdd(Key).Append(Boards.GetData(), Boards.Num());
+	TouchCacheKey(Key);
+
+	while (CacheOrder.Num() > MAX_CACHED_PROMPTS)
+	{
+		CachedBoards.Remove(CacheOrder[0]);
+		CacheOrder.RemoveAt(0);
+	}
+}
+
+bool FMinesweeperManager::TakeCachedBoard(const FString& Prompt, FString& OutBoard)
+{
+	const FString Key = MakeCacheKey(Prompt);
+	TArray<FString>* Boards = CachedBoards.Find(Key);
+	if (Boards == nullptr || Boards->Num() == 0)
+	{
+		return false;
+	}
+
+	// Oldest first, as they were generated
+	OutBoard = MoveTemp((*Boards)[0]);
+	Boards->RemoveAt(0);
+
+	// Stored unplayed with its batch, the library must not serve it again
+	FMinesweeperLayout Layout;
+	if (UAISettings::Get()->IsBoardLibraryEnabled() && FMinesweeperBoardFormats::FromBoardText(OutBoard, Layout))
+	{
+		GetLibrary().MarkPlayed(Layout);
+	}
+	if (Boards->Num() == 0)
+	{
+		CachedBoards.Remove(Key);
+		CacheOrder.Remove(Key);
+	}
+	else
+	{
+		TouchCacheKey(Key);
+	}
+
+	return true;
+}
+
+int32 FMinesweeperManager::GetNumCachedBoards(const FString& Prompt) const
+{
+	const TArray<FString>* Boards = CachedBoards.Find(MakeCacheKey(Prompt));
+	return Boards != nullptr? Boards->Num() : 0;
+}
+
+SIZE_T FMinesweeperManager::GetCacheAllocatedSize() const
+{
+	SIZE_T Size = CachedBoards.GetAllocatedSize() + CacheOrder.GetAllocatedSize();
+	for (const TPair<FString, TArray<FString>>& Pair : CachedBoards)
+	{
+		Size += Pair.Key.GetAllocatedSize() + Pair.Value.GetAllocatedSize();
+		for (const FString& Board : Pair.Value)
+		{
+			Size += Board.GetAllocatedSize();
+		}
+	}
+
+	return Size;
+}
+
+FMinesweeperBoardLibrary& FMinesweeperManager::GetLibrary()
+{
+	if (!Library.IsValid())
+	{
+		Library = MakeUnique<FMinesweeperBoardLibrary>();
+		Library->Open(FMinesweeperBoardLibrary::GetDefaultDirectory());
+	}
+
+	return *Library;
+}
+
+bool FMinesweeperManager::TakeLibraryBoard(const FString& Prompt, FString& OutBoard)
+{
+	FMinesweeperBoardQuery Query;
+	if (!UAISettings::Get()->IsBoardLibraryEnabled() || !FMinesweeperBoardQuery::FromPrompt(Prompt, Query))
+	{
+		return false;
+	}
+
+	FMinesweeperLayout Layout;
+	if (!GetLibrary().Take(Query, Layout))
+	{
+		return false;
+	}
+
+	OutBoard = FMinesweeperBoardFormats::ToBoardText(Layout);
+	return true;
+}
+
+void FMinesweeperManager::AddLibraryBoards(TArrayView<const FString> Boards, int32 NumPlayed)
+{
+	if (!UAISettings::Get()->IsBoardLibraryEnabled())
+	{
+		return;
+	}
+
+	TArray<FMinesweeperLayout> Layouts;
+	Layouts.SetNum(Boards.Num());
+	for (int32 i = 0; i < Boards.Num(); ++i)
+	{
+		FMinesweeperBoardFormats::FromBoardText(Boards[i], Layouts[i]);
+	}
+
+	// Failed conversions are left empty, Add skips them
+	NumPlayed = FMath::Clamp(NumPlayed, 0, Layouts.Num());
+	FMinesweeperBoardLibrary& BoardLibrary = GetLibrary();
+	BoardLibrary.Add(MakeArrayView(Layouts).Left(NumPlayed), true);
+	BoardLibrary.Add(MakeArrayView(Layouts).RightChop(NumPlayed), false);
+}
+
+void FMinesweeperManager::AddClickLatency(int32 Rows, int32 Cols, double Seconds)
+{
+	ClickLatencies.FindOrAdd(FIntPoint(Cols, Rows)).Add(static_cast<uint64>(FMath::Max(0.0, Seconds) * 1e9));
+}
+
+void FMinesweeperManager::LogClickLatencyReport() const
+{
+	if (ClickLatencies.Num() == 0)
+	{
+		UE_LOG(LogSlate, Display, TEXT("[Minesweeper] - No click latency recorded yet"));
+		return;
+	}
+
+	for (const TPair<FIntPoint, FMinesweeperLatencyHistogram>& Pair : ClickLatencies)
+	{
+		const FMinesweeperLatencyHistogram& Histogram = Pair.Value;
+		UE_LOG(LogSlate, Display, TEXT("[Minesweeper] - Click to paint %dx%d: clicks: %llu | mean: %.2fms | p50: %.2fms | p99: %.2fms | max: %.2fms"),
+			Pair.Key.Y, Pair.Key.X, Histogram.Count, Histogram.GetMeanNs() / 1e6, Histogram.GetPercentileNs(50.0) / 1e6, Histogram.GetPercentileNs(99.0) / 1e6, Histogram.MaxNs / 1e6);
+	}
+}
+
+bool FMinesweeperManager::AppendClickLatencyCsv(const FString& Path) const
+{
+	const bool bNewFile = !IFileManager::Get().FileExists(*Path);
+	const FString Date = FDateTime::Now().ToString();
+
+	FString Lines;
+	if (bNewFile)
+	{
+		Lines += TEXT("Date,Rows,Cols,Clicks,MeanMs,P50Ms,P99Ms,MaxMs\n");
+	}
+
+	for (const TPair<FIntPoint, FMinesweeperLatencyHistogram>& Pair : ClickLatencies)
+	{
+		const FMinesweeperLatencyHistogram& Histogram = Pair.Value;
+		Lines += FString::Printf(TEXT("%s,%d,%d,%llu,%.3f,%.3f,%.3f,%.3f\n"), *Date, Pair.Key.Y, Pair.Key.X, Histogram.Count,
+			Histogram.GetMeanNs() / 1e6, Histogram.GetPercentileNs(50.0) / 1e6, Histogram.GetPercentileNs(99.0) / 1e6, Histogram.MaxNs / 1e6);
+	}
+
+	if (!FFileHelper::SaveStringToFile(Lines, *Path, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append))
+	{
+		UE_LOG(LogSlate, Warning, TEXT("[Minesweeper] - Couldn't write click latencies to %s"), *Path);
+		return false;
+	}
+
+	return true;
+}
+
+FString FMinesweeperManager::GetDefaultClickLatencyCsvPath()
+{
+	return FPaths::ProjectSavedDir() / TEXT("Minesweeper") / TEXT("ClickLatency.csv");
+}
+
+FString FMinesweeperManager::MakeCacheKey(const FString& Prompt)
+{
+	return Prompt.TrimStartAndEnd().ToLower();
+}
+
+void FMinesweeperManager::TouchCacheKey(const FString& Key)
+{
+	CacheOrder.Remove(Key);
+	CacheOrder.Add(Key);
+}
@@ -3,11 +3,110 @@
 
 #include "Settings/AISettings.h"
 
+EBoardProviderType UAISettings::GetProviderType() const
+{
+	return Provider;
+}
+
+const FBoardProviderSettings& UAISettings::GetProviderSettings(EBoardProviderType Type) const
+{
+	switch (Type)
+	{
+	case EBoardProviderType::OpenAICompatible: return LocalProviderSettings;
+	case EBoardProviderType::Mock: return MockProviderSettings;
+	default: return GeminiProviderSettings;
+	}
+}
+
+bool UAISettings::IsBoardLibraryEnabled() const
+{
+	return bUseBoardLibrary;
+}
+
 FString UAISettings::GetGeminiApiKey() const
 {
 	return GeminiApiKey;
 }
 
+FString UAISettings::GetGeminiModel() const
+{
+	return GeminiModel;
+}
+
+bool UAISettings::IsContextCacheEnabled() const
+{
+	return bUseContextCache;
+}
+
+int32 UAISettings::GetContextCacheTtlSeconds() const
+{
+	return ContextCacheTtlSeconds;
+}
+
+int32 UAISettings::GetContextCacheMinTokens() const
+{
+	return ContextCacheMinTokens;
+}
+
+bool UAISettings::IsConnectionWarmUpEnabled() const
+{
+	return bWarmUpConnection;
+}
+
+int32 UAISettings::GetKeepAliveSeconds() const
+{
+	return KeepAliveSeconds;
+}
+
+FString UAISettings::MakeGeminiUrl(const FString& Path) const
+{
+	FString BaseUrl = GeminiBaseUrl;
+	BaseUrl.RemoveFromEnd(TEXT("/"));
+	return FString::Printf(TEXT("%s/%s?key=%s"), *BaseUrl, *Path, *GeminiApiKey);
+}
+
+void UAISettings::UseLocalGeminiServer(const FString& BaseUrl, const FString& ApiKey, int32 InContextCacheMinTokens, int32 InKeepAliveSeconds)
+{
+	GeminiBaseUrl = BaseUrl;
+	GeminiApiKey = ApiKey;
+	bUseContextCache = true;
+	ContextCacheMinTokens = InContextCacheMinTokens;
+	bWarmUpConnection = true;
+	KeepAliveSeconds = InKeepAliveSeconds;
+}
+
+FString UAISettings::GetLocalBaseUrl() const
+{
+	FString BaseUrl = LocalBaseUrl;
+	BaseUrl.RemoveFromEnd(TEXT("/"));
+	return BaseUrl;
+}
+
+FString UAISettings::GetLocalModel() const
+{
+	return LocalModel;
+}
+
+FString UAISettings::GetLocalApiKey() const
+{
+	return LocalApiKey;
+}
+
+int32 UAISettings::GetMockSeed() const
+{
+	return MockSeed;
+}
+
+float UAISettings::GetMockLatencySeconds() const
+{
+	return MockLatencySeconds;
+}
+
+float UAISettings::GetMockLatencyPerBoardSeconds() const
+{
+	return MockLatencyPerBoardSeconds;
+}
+
 const UAISettings* UAISettings::Get()
 {
 	return GetDefault<UAISettings>();
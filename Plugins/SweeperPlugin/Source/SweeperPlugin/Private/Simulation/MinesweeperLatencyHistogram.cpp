@@ -0,0 +1,51 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Simulation/MinesweeperLatencyHistogram.h"
+
+void FMinesweeperLatencyHistogram::Add(uint64 Ns)
+{
+	const int32 Bucket = FMath::Min(static_cast<int32>(FMath::FloorLog2_64(Ns | 1)), BUCKET_COUNT - 1);
+	Buckets[Bucket]++;
+	Count++;
+	TotalNs += Ns;
+	MaxNs = FMath::Max(MaxNs, Ns);
+}
+
+void FMinesweeperLatencyHistogram::Merge(const FMinesweeperLatencyHistogram& Other)
+{
+	for (int32 i = 0; i < BUCKET_COUNT; ++i)
+	{
+		Buckets[i] += Other.Buckets[i];
+	}
+
+	Count += Other.Count;
+	TotalNs += Other.TotalNs;
+	MaxNs = FMath::Max(MaxNs, Other.MaxNs);
+}
+
+double FMinesweeperLatencyHistogram::GetMeanNs() const
+{
+	return Count > 0? static_cast<double>(TotalNs) / Count : 0.0;
+}
+
+uint64 FMinesweeperLatencyHistogram::GetPercentileNs(double Percentile) const
+{
+	if (Count == 0)
+	{
+		return 0;
+	}
+
+	const uint64 Target = FMath::Max<uint64>(1, static_cast<uint64>(FMath::CeilToDouble(Count * FMath::Clamp(Percentile, 0.0, 100.0) / 100.0)));
+	uint64 Seen = 0;
+	for (int32 i = 0; i < BUCKET_COUNT; ++i)
+	{
+		Seen += Buckets[i];
+		if (Seen >= Target)
+		{
+			return FMath::Min(MaxNs, (2ull << i) - 1);
+		}
+	}
+
+	return MaxNs;
+}
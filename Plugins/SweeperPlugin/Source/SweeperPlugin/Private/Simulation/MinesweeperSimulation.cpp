@@ -0,0 +1,438 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Simulation/MinesweeperSimulation.h"
+
+#include "Async/ParallelFor.h"
+#include "Board/MinesweeperBoard.h"
+#include "Board/MinesweeperFixedBoard.h"
+#include "HAL/PlatformTime.h"
+
+#include <atomic>
+
+namespace MinesweeperSimulation
+{
+	// Games handed to a worker at once, keeps contention on the shared counter low
+	static constexpr int64 GAMES_PER_BATCH = 32;
+
+	static uint64 CyclesToNs(uint64 Cycles)
+	{
+		return static_cast<uint64>(FPlatformTime::ToSeconds64(Cycles) * 1e9);
+	}
+
+	struct FWorkerStats
+	{
+		int64 Games = 0;
+		int64 Wins = 0;
+		int64 Moves = 0;
+		FMinesweeperLatencyHistogram Latencies[static_cast<int32>(EMinesweeperSimulationOp::Count)];
+
+		void AddLatency(EMinesweeperSimulationOp Op, uint64 StartCycles)
+		{
+			Latencies[static_cast<int32>(Op)].Add(CyclesToNs(FPlatformTime::Cycles64() - StartCycles));
+		}
+	};
+
+	/** Board and strategy are concrete types: every call in the game loop is resolved, and inlined, at compile time */
+	template<typename TBoard, typename TStrategy>
+	struct TWorkerContext : FWorkerStats
+	{
+		TBoard Board;
+		TArray<int32> CellIds;
+		TStrategy Strategy;
+		FRandomStream Random;
+	};
+
+	/** Places mines away from the first click, so every game starts with an opening. */
+	template<typename TContext>
+	static void GenerateBoard(TContext& Context, const FMinesweeperSimulationSettings& Settings, int32 FirstClick)
+	{
+		const int32 CellCount = Settings.Rows * Settings.Cols;
+		TArray<int32>& CellIds = Context.CellIds;
+		CellIds.SetNumUninitialized(CellCount, EAllowShrinking::No);
+		for (int32 i = 0; i < CellCount; ++i)
+		{
+			CellIds[i] = i;
+		}
+
+		// Move the excluded cells at the end, then shuffle the mines in front of them
+		int32 Available = CellCount;
+		const int32 FirstRow = FirstClick / Settings.Cols;
+		const int32 FirstCol = FirstClick % Settings.Cols;
+		const bool bExcludeNeighbours = Settings.Mines <= CellCount - 9;
+		for (int32 Row = FirstRow - 1; Row <= FirstRow + 1; ++Row)
+		{
+			for (int32 Col = FirstCol - 1; Col <= FirstCol + 1; ++Col)
+			{
+				const bool bIsFirstClick = Row == FirstRow && Col == FirstCol;
+				if (Row < 0 || Row >= Settings.Rows || Col < 0 || Col >= Settings.Cols || (!bExcludeNeighbours && !bIsFirstClick))
+				{
+					continue;
+				}
+
+				const int32 Position = CellIds.IndexOfByKey(Row * Settings.Cols + Col);
+				Available--;
+				CellIds.Swap(Position, Available);
+			}
+		}
+
+		const int32 Mines = FMath::Clamp(Settings.Mines, 0, Available);
+		for (int32 i = 0; i < Mines; ++i)
+		{
+			CellIds.Swap(i, Context.Random.RandRange(i, Available - 1));
+		}
+
+		Context.Board.Create(Settings.Rows, Settings.Cols, TArrayView<const int32>(CellIds.GetData(), Mines));
+	}
+
+	template<typename TContext>
+	static void PlayGame(TContext& Context, const FMinesweeperSimulationSettings& Settings)
+	{
+		auto& Board = Context.Board;
+		const int32 FirstClick = (Settings.Rows / 2) * Settings.Cols + Settings.Cols / 2;
+
+		uint64 StartCycles = FPlatformTime::Cycles64();
+		GenerateBoard(Context, Settings, FirstClick);
+		Context.AddLatency(EMinesweeperSimulationOp::Create, StartCycles);
+
+		Context.Strategy.OnNewGameOn(Board);
+		Context.Games++;
+
+		int32 Next = FirstClick;
+		while (Next != INDEX_NONE)
+		{
+			Context.Moves++;
+			if (Board.IsBomb(Next))
+			{
+				StartCycles = FPlatformTime::Cycles64();
+				Board.Reveal();
+				Context.AddLatency(EMinesweeperSimulationOp::Reveal, StartCycles);
+				return;
+			}
+
+			StartCycles = FPlatformTime::Cycles64();
+			Board.Discover(Next / Settings.Cols, Next % Settings.Cols);
+			Context.AddLatency(EMinesweeperSimulationOp::Discover, StartCycles);
+
+			if (Board.HasWon())
+			{
+				Context.Wins++;
+				return;
+			}
+
+			StartCycles = FPlatformTime::Cycles64();
+			Next = Context.Strategy.PickCellOn(Board, Context.Random);
+			Context.AddLatency(EMinesweeperSimulationOp::Pick, StartCycles);
+		}
+	}
+
+	template<typename TBoard, typename TStrategy>
+	static void RunGames(const FMinesweeperSimulationSettings& Settings, FMinesweeperSimulationResult& Result)
+	{
+		TArray<TWorkerContext<TBoard, TStrategy>> Contexts;
+		Contexts.SetNum(Result.Workers);
+		for (int32 i = 0; i < Contexts.Num(); ++i)
+		{
+			Contexts[i].Random.Initialize(Settings.Seed + i);
+		}
+
+		std::atomic<int64> NextGame{0};
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		ParallelFor(Contexts.Num(), [&Contexts, &NextGame, &Settings](int32 WorkerIndex)
+		{
+			TWorkerContext<TBoard, TStrategy>& Context = Contexts[WorkerIndex];
+			while (true)
+			{
+				const int64 First = NextGame.fetch_add(GAMES_PER_BATCH);
+				if (First >= Settings.Games)
+				{
+					break;
+				}
+
+				const int64 Last = FMath::Min<int64>(First + GAMES_PER_BATCH, Settings.Games);
+				for (int64 Game = First; Game < Last; ++Game)
+				{
+					PlayGame(Context, Settings);
+				}
+			}
+		});
+		Result.Seconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+
+		for (const FWorkerStats& Context : Contexts)
+		{
+			Result.Games += Context.Games;
+			Result.Wins += Context.Wins;
+			Result.Moves += Context.Moves;
+			for (int32 i = 0; i < static_cast<int32>(EMinesweeperSimulationOp::Count); ++i)
+			{
+				Result.Latencies[i].Merge(Context.Latencies[i]);
+			}
+		}
+	}
+
+	template<typename TBoard>
+	static void RunGames(const FMinesweeperSimulationSettings& Settings, FMinesweeperSimulationResult& Result)
+	{
+		if (Settings.Strategy == TEXT("Random"))
+		{
+			RunGames<TBoard, FMinesweeperRandomStrategy>(Settings, Result);
+		}
+		else
+		{
+			RunGames<TBoard, FMinesweeperSolverStrategy>(Settings, Result);
+		}
+	}
+}
+
+FName FMinesweeperRandomStrategy::GetName() const
+{
+	return TEXT("Random");
+}
+
+int32 FMinesweeperRandomStrategy::PickCell(const FMinesweeperBoard& Board, FRandomStream& Random)
+{
+	return PickCellOn(Board, Random);
+}
+
+template<typename TBoard>
+int32 FMinesweeperRandomStrategy::PickCellOn(const TBoard& Board, FRandomStream& Random)
+{
+	const int32 CellCount = Board.Rows() * Board.Cols();
+	if (CellCount <= 0 || Board.HasWon())
+	{
+		return INDEX_NONE;
+	}
+
+	// Start from a random cell and take the first hidden one
+	const int32 Start = Random.RandRange(0, CellCount - 1);
+	for (int32 i = 0; i < CellCount; ++i)
+	{
+		const int32 Id = (Start + i) % CellCount;
+		if (!Board.IsDiscovered(Id))
+		{
+			return Id;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+FName FMinesweeperSolverStrategy::GetName() const
+{
+	return TEXT("Solver");
+}
+
+void FMinesweeperSolverStrategy::OnNewGame(const FMinesweeperBoard& Board)
+{
+	OnNewGameOn(Board);
+}
+
+int32 FMinesweeperSolverStrategy::PickCell(const FMinesweeperBoard& Board, FRandomStream& Random)
+{
+	return PickCellOn(Board, Random);
+}
+
+template<typename TBoard>
+void FMinesweeperSolverStrategy::OnNewGameOn(const TBoard& Board)
+{
+	KnownMines.Init(false, Board.Rows() * Board.Cols());
+	SafeCells.Reset();
+}
+
+template<typename TBoard>
+int32 FMinesweeperSolverStrategy::PickCellOn(const TBoard& Board, FRandomStream& Random)
+{
+	const int32 CellCount = Board.Rows() * Board.Cols();
+	if (CellCount <= 0 || Board.HasWon())
+	{
+		return INDEX_NONE;
+	}
+
+	for (int32 Pass = 0; Pass < 2; ++Pass)
+	{
+		while (SafeCells.Num() > 0)
+		{
+			const int32 Id = SafeCells.Pop(EAllowShrinking::No);
+			if (!Board.IsDiscovered(Id))
+			{
+				return Id;
+			}
+		}
+
+		if (Pass == 0 && !Deduce(Board))
+		{
+			break;
+		}
+	}
+
+	// Nothing certain, guess among cells not known as mines
+	const int32 Start = Random.RandRange(0, CellCount - 1);
+	for (int32 i = 0; i < CellCount; ++i)
+	{
+		const int32 Id = (Start + i) % CellCount;
+		if (!Board.IsDiscovered(Id) && !KnownMines[Id])
+		{
+			return Id;
+		}
+	}
+
+	return INDEX_NONE;
+}
+
+template<typename TBoard>
+bool FMinesweeperSolverStrategy::Deduce(const TBoard& Board)
+{
+	const int32 Rows = Board.Rows();
+	const int32 Cols = Board.Cols();
+
+	bool bProgress = true;
+	while (bProgress && SafeCells.Num() == 0)
+	{
+		bProgress = false;
+		for (int32 Row = 0; Row < Rows; ++Row)
+		{
+			for (int32 Col = 0; Col < Cols; ++Col)
+			{
+				const int32 Count = Board.GetCount(Row, Col);
+				if (Count == 0 || !Board.IsDiscovered(Row, Col) || Board.IsBomb(Row, Col))
+				{
+					continue;
+				}
+
+				int32 FlaggedCount = 0;
+				HiddenNeighbours.Reset();
+				for (const FMinesweeperBoard::Coordinate& Around : FMinesweeperBoard::GetAroundOffset())
+				{
+					const int32 AdjacentRow = Row + Around.Key;
+					const int32 AdjacentCol = Col + Around.Value;
+					if (!Board.Exists(AdjacentRow, AdjacentCol) || Board.IsDiscovered(AdjacentRow, AdjacentCol))
+					{
+						continue;
+					}
+
+					const int32 AdjacentId = AdjacentRow * Cols + AdjacentCol;
+					if (KnownMines[AdjacentId])
+					{
+						FlaggedCount++;
+					}
+					else
+					{
+						HiddenNeighbours.Add(AdjacentId);
+					}
+				}
+
+				if (HiddenNeighbours.Num() == 0)
+				{
+					continue;
+				}
+
+				if (FlaggedCount == Count)
+				{
+					SafeCells.Append(HiddenNeighbours);
+					bProgress = true;
+				}
+				else if (FlaggedCount + HiddenNeighbours.Num() == Count)
+				{
+					for (const int32 Id : HiddenNeighbours)
+					{
+						KnownMines[Id] = true;
+					}
+					bProgress = true;
+				}
+			}
+		}
+	}
+
+	return SafeCells.Num() > 0;
+}
+
+double FMinesweeperSimulationResult::GetGamesPerSecond() const
+{
+	return Seconds > 0.0? Games / Seconds : 0.0;
+}
+
+double FMinesweeperSimulationResult::GetWinRate() const
+{
+	return Games > 0? static_cast<double>(Wins) / Games : 0.0;
+}
+
+const FMinesweeperLatencyHistogram& FMinesweeperSimulationResult::GetLatency(EMinesweeperSimulationOp Op) const
+{
+	return Latencies[static_cast<int32>(Op)];
+}
+
+void FMinesweeperSimulationResult::Log() const
+{
+	static const TCHAR* OpNames[] = { TEXT("Create"), TEXT("Pick"), TEXT("Discover"), TEXT("Reveal") };
+	static_assert(UE_ARRAY_COUNT(OpNames) == static_cast<int32>(EMinesweeperSimulationOp::Count), "Missing simulation op name");
+
+	UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Simulation %s | %dx%d, %d mines | %s board | Workers: %d"), *Settings.Strategy.ToString(), Settings.Rows, Settings.Cols, Settings.Mines,
+		bFixedSizeBoard? TEXT("Fixed size") : TEXT("Dynamic"), Workers);
+	UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Games: %lld | Wins: %lld (%.2f%%) | Moves: %lld | %.3fs | %.0f games/sec"), Games, Wins, GetWinRate() * 100.0, Moves, Seconds, GetGamesPerSecond());
+	for (int32 i = 0; i < static_cast<int32>(EMinesweeperSimulationOp::Count); ++i)
+	{
+		const FMinesweeperLatencyHistogram& Histogram = Latencies[i];
+		UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - %-8s count: %llu | mean: %.0fns | p50: %lluns | p90: %lluns | p99: %lluns | max: %lluns"),
+			OpNames[i], Histogram.Count, Histogram.GetMeanNs(), Histogram.GetPercentileNs(50.0), Histogram.GetPercentileNs(90.0), Histogram.GetPercentileNs(99.0), Histogram.MaxNs);
+	}
+}
+
+FString FMinesweeperSimulationResult::GetCsvHeader()
+{
+	return TEXT("Strategy,Rows,Cols,Mines,Workers,Games,Wins,WinRate,Seconds,GamesPerSecond,DiscoverP50Ns,DiscoverP99Ns,PickP50Ns,PickP99Ns,CreateP50Ns,CreateP99Ns");
+}
+
+FString FMinesweeperSimulationResult::ToCsvRow() const
+{
+	const FMinesweeperLatencyHistogram& Discover = GetLatency(EMinesweeperSimulationOp::Discover);
+	const FMinesweeperLatencyHistogram& Pick = GetLatency(EMinesweeperSimulationOp::Pick);
+	const FMinesweeperLatencyHistogram& Create = GetLatency(EMinesweeperSimulationOp::Create);
+	return FString::Printf(TEXT("%s,%d,%d,%d,%d,%lld,%lld,%.4f,%.3f,%.1f,%llu,%llu,%llu,%llu,%llu,%llu"),
+		*Settings.Strategy.ToString(), Settings.Rows, Settings.Cols, Settings.Mines, Workers, Games, Wins, GetWinRate(), Seconds, GetGamesPerSecond(),
+		Discover.GetPercentileNs(50.0), Discover.GetPercentileNs(99.0), Pick.GetPercentileNs(50.0), Pick.GetPercentileNs(99.0), Create.GetPercentileNs(50.0), Create.GetPercentileNs(99.0));
+}
+
+TUniquePtr<IMinesweeperStrategy> FMinesweeperSimulator::CreateStrategy(FName Name)
+{
+	if (Name == TEXT("Random"))
+	{
+		return MakeUnique<FMinesweeperRandomStrategy>();
+	}
+
+	if (Name == TEXT("Solver"))
+	{
+		return MakeUnique<FMinesweeperSolverStrategy>();
+	}
+
+	return nullptr;
+}
+
+FMinesweeperSimulationResult FMinesweeperSimulator::Run(const FMinesweeperSimulationSettings& Settings)
+{
+	using namespace MinesweeperSimulation;
+
+	FMinesweeperSimulationResult Result;
+	Result.Settings = Settings;
+	if (Settings.Games <= 0 || Settings.Rows <= 0 || Settings.Cols <= 0 || !CreateStrategy(Settings.Strategy).IsValid())
+	{
+		UE_LOG(LogSlate, Error, TEXT("[MineSweeper] - Invalid simulation settings (strategy: %s)."), *Settings.Strategy.ToString());
+		return Result;
+	}
+
+	Result.Workers = Settings.Workers > 0? Settings.Workers : FPlatformMisc::NumberOfCoresIncludingHyperthreads();
+	Result.bFixedSizeBoard = Settings.bFixedSizeBoards && MinesweeperFixedBoard::IsStandardSize(Settings.Rows, Settings.Cols);
+
+	if (Result.bFixedSizeBoard)
+	{
+		MinesweeperFixedBoard::Dispatch<FMinesweeperBoard>(Settings.Rows, Settings.Cols, [&Settings, &Result](auto BoardType)
+		{
+			RunGames<typename decltype(BoardType)::Type>(Settings, Result);
+		});
+	}
+	else
+	{
+		RunGames<FMinesweeperBoard>(Settings, Result);
+	}
+
+	return Result;
+}
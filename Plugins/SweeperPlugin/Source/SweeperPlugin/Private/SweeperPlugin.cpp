@@ -3,6 +3,7 @@
 #include "SweeperPlugin.h"
 
 #include "IPropertyTable.h"
+#include "MinesweeperManager.h"
 #include "SweeperPluginStyle.h"
 #include "SweeperPluginCommands.h"
 #include "Widgets/Docking/SDockTab.h"
@@ -21,6 +22,8 @@ void FSweeperPluginModule::StartupModule()
 	FSweeperPluginStyle::Initialize();
 	FSweeperPluginStyle::ReloadTextures();
 
+	FMinesweeperManager::Initialize();
+
 	FSweeperPluginCommands::Register();
 	
 	PluginCommands = MakeShareable(new FUICommandList);
@@ -34,6 +37,7 @@ void FSweeperPluginModule::StartupModule()
 	UToolMenus::RegisterStartupCallback(FSimpleMulticastDelegate::FDelegate::CreateRaw(this, &FSweeperPluginModule::RegisterMinesweeperButton));
 	
 	FGlobalTabmanager::Get()->RegisterNomadTabSpawner(SweeperPluginTabName, FOnSpawnTab::CreateRaw(this, &FSweeperPluginModule::OnSpawnMinesweeperTab))
+		.SetReuseTabMethod(FOnFindTabToReuse::CreateRaw(this, &FSweeperPluginModule::OnFindMinesweeperTabToReuse))
 		.SetDisplayName(LOCTEXT("FSweeperPluginTabTitle", "Minesweeper!"))
 		.SetMenuType(ETabSpawnerMenuType::Hidden);
 }
@@ -52,11 +56,28 @@ void FSweeperPluginModule::ShutdownModule()
 	FSweeperPluginCommands::Unregister();
 
 	FGlobalTabmanager::Get()->UnregisterNomadTabSpawner(SweeperPluginTabName);
+
+	FMinesweeperManager::Shutdown();
+}
+
+FSweeperPluginModule& FSweeperPluginModule::Get()
+{
+	return FModuleManager::LoadModuleChecked<FSweeperPluginModule>("SweeperPlugin");
 }
 
 TSharedRef<SDockTab> FSweeperPluginModule::OnSpawnMinesweeperTab(const FSpawnTabArgs& SpawnTabArgs)
 {
-	return SNew(SMinesweeperTab);
+	TSharedRef<SMinesweeperTab> MinesweeperTab = SNew(SMinesweeperTab);
+
+	// Connection setup overlaps with the user typing the first prompt
+	MinesweeperTab->WarmUp();
+	return MinesweeperTab;
+}
+
+TSharedPtr<SDockTab> FSweeperPluginModule::OnFindMinesweeperTabToReuse(const FTabId& TabId)
+{
+	// Nothing to reuse spawns another tab
+	return bSpawnNewTab? nullptr : FMinesweeperManager::Get().GetLastTab();
 }
 
 void FSweeperPluginModule::MinesweeperButtonClicked()
@@ -64,6 +85,12 @@ void FSweeperPluginModule::MinesweeperButtonClicked()
 	FGlobalTabmanager::Get()->TryInvokeTab(SweeperPluginTabName);
 }
 
+void FSweeperPluginModule::OpenNewMinesweeperTab()
+{
+	TGuardValue<bool> SpawnNewTabGuard(bSpawnNewTab, true);
+	FGlobalTabmanager::Get()->TryInvokeTab(SweeperPluginTabName);
+}
+
 void FSweeperPluginModule::RegisterMinesweeperButton()
 {
 	FToolMenuOwnerScoped OwnerScoped(this);
@@ -0,0 +1,36 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SweeperPluginStats.h"
+
+UE_TRACE_CHANNEL_DEFINE(SweeperChannel);
+
+DEFINE_STAT(STAT_SweeperParse);
+DEFINE_STAT(STAT_SweeperCreate);
+DEFINE_STAT(STAT_SweeperDiscover);
+DEFINE_STAT(STAT_SweeperChord);
+DEFINE_STAT(STAT_SweeperReveal);
+DEFINE_STAT(STAT_SweeperHistory);
+DEFINE_STAT(STAT_SweeperSnapshot);
+DEFINE_STAT(STAT_SweeperValidate);
+DEFINE_STAT(STAT_SweeperUpdateOverview);
+DEFINE_STAT(STAT_SweeperLibraryAdd);
+DEFINE_STAT(STAT_SweeperLibraryQuery);
+
+DEFINE_STAT(STAT_SweeperPopulateGrid);
+DEFINE_STAT(STAT_SweeperClick);
+DEFINE_STAT(STAT_SweeperPaintBoard);
+
+DEFINE_STAT(STAT_SweeperBuildRequest);
+DEFINE_STAT(STAT_SweeperParseResponse);
+DEFINE_STAT(STAT_SweeperLastRequestMs);
+DEFINE_STAT(STAT_SweeperRequestsInFlight);
+
+DEFINE_STAT(STAT_SweeperCellsChanged);
+DEFINE_STAT(STAT_SweeperClicksCoalesced);
+
+DEFINE_STAT(STAT_SweeperBoardCells);
+DEFINE_STAT(STAT_SweeperCellWidgets);
+DEFINE_STAT(STAT_SweeperBoardMemory);
+DEFINE_STAT(STAT_SweeperHistoryMemory);
+DEFINE_STAT(STAT_SweeperWidgetMemory);
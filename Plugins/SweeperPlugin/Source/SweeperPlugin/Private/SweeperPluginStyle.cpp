@@ -6,10 +6,12 @@
 #include "Slate/SlateGameResources.h"
 #include "Interfaces/IPluginManager.h"
 #include "Styling/SlateStyleMacros.h"
+#include "Engine/Texture2D.h"
 
 #define RootToContentDir Style->RootToContentDir
 
 TSharedPtr<FSlateStyleSet> FSweeperPluginStyle::StyleInstance = nullptr;
+TStrongObjectPtr<UTexture2D> FSweeperPluginStyle::CellAtlas;
 
 void FSweeperPluginStyle::Initialize()
 {
@@ -25,6 +27,7 @@ void FSweeperPluginStyle::Shutdown()
 	FSlateStyleRegistry::UnRegisterSlateStyle(*StyleInstance);
 	ensure(StyleInstance.IsUnique());
 	StyleInstance.Reset();
+	CellAtlas.Reset();
 }
 
 FName FSweeperPluginStyle::GetStyleSetName()
@@ -51,10 +54,160 @@ TSharedRef< FSlateStyleSet > FSweeperPluginStyle::Create()
 	Style->Set("SweeperPlugin.DefaultBorderColor", FSlateColor(FColor(175, 191, 192)));
 
 	Style->Set("SweeperPlugin.FontItalic", FCoreStyle::GetDefaultFontStyle("Italic", 8));
+
+	CellAtlas.Reset(CreateCellAtlas());
+	const int32 SpriteCount = static_cast<int32>(ESweeperCellSprite::Num);
+	for (int32 i = 0; i < SpriteCount; ++i)
+	{
+		FSlateImageBrush* Sprite = new FSlateImageBrush(CellAtlas.Get(), FVector2D(CELL_SPRITE_SIZE, CELL_SPRITE_SIZE));
+		Sprite->SetUVRegion(FBox2f(FVector2f(static_cast<float>(i) / SpriteCount, 0.f), FVector2f(static_cast<float>(i + 1) / SpriteCount, 1.f)));
+		Style->Set(GetCellSpriteName(static_cast<ESweeperCellSprite>(i)), Sprite);
+	}
 	
 	return Style;
 }
 
+FName FSweeperPluginStyle::GetCellSpriteName(ESweeperCellSprite Sprite)
+{
+	static const TArray<FName> Names = []()
+	{
+		TArray<FName> SpriteNames;
+		for (int32 i = 0; i < static_cast<int32>(ESweeperCellSprite::Num); ++i)
+		{
+			SpriteNames.Add(*FString::Printf(TEXT("SweeperPlugin.Cell.%d"), i));
+		}
+		return SpriteNames;
+	}();
+
+	return Names[static_cast<int32>(Sprite)];
+}
+
+UTexture2D* FSweeperPluginStyle::CreateCellAtlas()
+{
+	// 3x5 digits, drawn 2x
+	static const TCHAR* Digits[8][5] = {
+		{ TEXT(".#."), TEXT("##."), TEXT(".#."), TEXT(".#."), TEXT("###") },
+		{ TEXT("##."), TEXT("..#"), TEXT(".#."), TEXT("#.."), TEXT("###") },
+		{ TEXT("##."), TEXT("..#"), TEXT(".#."), TEXT("..#"), TEXT("##.") },
+		{ TEXT("#.#"), TEXT("#.#"), TEXT("###"), TEXT("..#"), TEXT("..#") },
+		{ TEXT("###"), TEXT("#.."), TEXT("##."), TEXT("..#"), TEXT("##.") },
+		{ TEXT(".##"), TEXT("#.."), TEXT("###"), TEXT("#.#"), TEXT("###") },
+		{ TEXT("###"), TEXT("..#"), TEXT(".#."), TEXT(".#."), TEXT(".#.") },
+		{ TEXT("###"), TEXT("#.#"), TEXT("###"), TEXT("#.#"), TEXT("###") },
+	};
+	static const FColor DigitColors[8] = {
+		FColor::Blue, FColor(0, 128, 0), FColor::Red, FColor(0, 0, 128), FColor(128, 0, 0), FColor(0, 128, 128), FColor::Black, FColor(96, 96, 96)
+	};
+	const FColor HiddenColor(190, 190, 190);
+	const FColor DiscoveredColor(225, 225, 225);
+
+	constexpr int32 Size = CELL_SPRITE_SIZE;
+	const int32 SpriteCount = static_cast<int32>(ESweeperCellSprite::Num);
+	const int32 Width = Size * SpriteCount;
+	TArray<FColor> Pixels;
+	Pixels.SetNumUninitialized(Width * Size);
+
+	auto SetPixel = [&Pixels, Width](int32 Sprite, int32 X, int32 Y, const FColor& Color)
+	{
+		Pixels[Y * Width + Sprite * Size + X] = Color;
+	};
+
+	for (int32 Sprite = 0; Sprite < SpriteCount; ++Sprite)
+	{
+		const ESweeperCellSprite Type = static_cast<ESweeperCellSprite>(Sprite);
+		const bool bHidden = Type == ESweeperCellSprite::Hidden || Type == ESweeperCellSprite::Flag;
+		for (int32 Y = 0; Y < Size; ++Y)
+		{
+			for (int32 X = 0; X < Size; ++X)
+			{
+				FColor Color = bHidden? HiddenColor : DiscoveredColor;
+				if (bHidden && (X == 0 || Y == 0))
+				{
+					Color = FColor::White;
+				}
+				else if (bHidden && (X == Size - 1 || Y == Size - 1))
+				{
+					Color = FColor(120, 120, 120);
+				}
+				else if (!bHidden && (X == Size - 1 || Y == Size - 1))
+				{
+					Color = FColor(160, 160, 160);
+				}
+				SetPixel(Sprite, X, Y, Color);
+			}
+		}
+
+		if (Type >= ESweeperCellSprite::Count1 && Type <= ESweeperCellSprite::Count8)
+		{
+			const int32 Digit = Sprite - static_cast<int32>(ESweeperCellSprite::Count1);
+			const int32 Left = (Size - 6) / 2;
+			const int32 Top = (Size - 10) / 2;
+			for (int32 Row = 0; Row < 5; ++Row)
+			{
+				for (int32 Col = 0; Col < 3; ++Col)
+				{
+					if (Digits[Digit][Row][Col] != TEXT('#'))
+					{
+						continue;
+					}
+
+					for (int32 i = 0; i < 4; ++i)
+					{
+						SetPixel(Sprite, Left + Col * 2 + i % 2, Top + Row * 2 + i / 2, DigitColors[Digit]);
+					}
+				}
+			}
+		}
+		else if (Type == ESweeperCellSprite::Mine)
+		{
+			const float Center = (Size - 1) * 0.5f;
+			for (int32 Y = 1; Y < Size - 1; ++Y)
+			{
+				for (int32 X = 1; X < Size - 1; ++X)
+				{
+					if (FMath::Square(X - Center) + FMath::Square(Y - Center) <= FMath::Square(Size * 0.3f))
+					{
+						SetPixel(Sprite, X, Y, FColor::Black);
+					}
+				}
+			}
+		}
+		else if (Type == ESweeperCellSprite::Flag)
+		{
+			// Pole and a red pennant pointing left
+			for (int32 Y = 3; Y < Size - 3; ++Y)
+			{
+				SetPixel(Sprite, Size / 2 + 1, Y, FColor::Black);
+			}
+			for (int32 Y = 3; Y < 9; ++Y)
+			{
+				const int32 HalfHeight = 3 - FMath::Abs(Y - 6);
+				for (int32 X = Size / 2 - 1 - HalfHeight * 2; X <= Size / 2; ++X)
+				{
+					SetPixel(Sprite, X, Y, FColor::Red);
+				}
+			}
+		}
+	}
+
+	UTexture2D* Texture = UTexture2D::CreateTransient(Width, Size, PF_B8G8R8A8, TEXT("SweeperCellAtlas"));
+	if (Texture == nullptr)
+	{
+		return nullptr;
+	}
+
+	// Pixel art: scaled up or down, cells stay sharp
+	Texture->Filter = TF_Nearest;
+	Texture->SRGB = true;
+	Texture->NeverStream = true;
+
+	void* MipData = Texture->GetPlatformData()->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
+	FMemory::Memcpy(MipData, Pixels.GetData(), Pixels.Num() * sizeof(FColor));
+	Texture->GetPlatformData()->Mips[0].BulkData.Unlock();
+	Texture->UpdateResource();
+	return Texture;
+}
+
 void FSweeperPluginStyle::ReloadTextures()
 {
 	if (FSlateApplication::IsInitialized())
@@ -0,0 +1,260 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Widgets/SMinesweeperAtlasGrid.h"
+
+#include "SlateOptMacros.h"
+#include "SweeperPluginStats.h"
+#include "SweeperPluginStyle.h"
+#include "Board/MinesweeperBoard.h"
+#include "Engine/Texture2D.h"
+
+namespace MinesweeperAtlasGrid
+{
+	// Largest board side drawn through the per cell texture, bigger boards always use sprites
+	static constexpr int32 MAX_TEXTURE_SIZE = 8192;
+
+	/** Overview color of a cell, close to the sprite it stands for */
+	static FColor GetCellColor(const FMinesweeperCell& Cell)
+	{
+		static const FColor CountColors[9] = {
+			FColor(225, 225, 225), FColor(150, 150, 255), FColor(130, 200, 130), FColor(255, 140, 140), FColor(100, 100, 190),
+			FColor(190, 100, 100), FColor(100, 190, 190), FColor(80, 80, 80), FColor(140, 140, 140)
+		};
+
+		if (!Cell.IsDiscovered())
+		{
+			return Cell.IsFlagged()? FColor(230, 120, 40) : FColor(170, 170, 170);
+		}
+
+		if (Cell.IsBomb())
+		{
+			return FColor::Black;
+		}
+
+		return CountColors[FMath::Clamp(Cell.GetCount(), 0, 8)];
+	}
+}
+
+BEGIN_SLATE_FUNCTION_BUILD_OPTIMIZATION
+
+void SMinesweeperAtlasGrid::Construct(const FArguments& InArgs)
+{
+	CellSize = FMath::Clamp(InArgs._CellSize, MIN_CELL_SIZE, MAX_CELL_SIZE);
+	OnCellClicked = InArgs._OnCellClicked;
+
+	const ISlateStyle& Style = FSweeperPluginStyle::Get();
+	for (int32 i = 0; i < static_cast<int32>(ESweeperCellSprite::Num); ++i)
+	{
+		Sprites.Add(Style.GetBrush(FSweeperPluginStyle::GetCellSpriteName(static_cast<ESweeperCellSprite>(i))));
+	}
+
+	CellTextureBrush.DrawAs = ESlateBrushDrawType::Image;
+	CellTextureBrush.Tiling = ESlateBrushTileType::NoTile;
+}
+
+void SMinesweeperAtlasGrid::SetBoard(const FMinesweeperBoard* InBoard)
+{
+	using namespace MinesweeperAtlasGrid;
+
+	Board = InBoard;
+	Texels.Reset();
+	CellTexture.Reset();
+	CellTextureBrush.SetResourceObject(nullptr);
+
+	const int32 Rows = Board != nullptr? Board->Rows() : 0;
+	const int32 Cols = Board != nullptr? Board->Cols() : 0;
+	if (Rows > 0 && Cols > 0 && Rows <= MAX_TEXTURE_SIZE && Cols <= MAX_TEXTURE_SIZE)
+	{
+		Texels.SetNumUninitialized(Rows * Cols);
+		for (int32 Row = 0; Row < Rows; ++Row)
+		{
+			const FMinesweeperCell* RowData = Board->GetRowData(Row);
+			for (int32 Col = 0; Col < Cols; ++Col)
+			{
+				Texels[Row * Cols + Col] = GetCellColor(RowData[Col]);
+			}
+		}
+
+		UTexture2D* Texture = UTexture2D::CreateTransient(Cols, Rows, PF_B8G8R8A8, TEXT("SweeperBoardCells"));
+		if (Texture != nullptr)
+		{
+			Texture->Filter = TF_Nearest;
+			Texture->SRGB = true;
+			Texture->NeverStream = true;
+
+			void* MipData = Texture->GetPlatformData()->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
+			FMemory::Memcpy(MipData, Texels.GetData(), Texels.Num() * sizeof(FColor));
+			Texture->GetPlatformData()->Mips[0].BulkData.Unlock();
+			Texture->UpdateResource();
+
+			CellTexture.Reset(Texture);
+			CellTextureBrush.SetResourceObject(Texture);
+			CellTextureBrush.ImageSize = FVector2D(Cols, Rows);
+		}
+	}
+
+	Invalidate(EInvalidateWidgetReason::Layout);
+}
+
+void SMinesweeperAtlasGrid::NotifyCellsChanged(TArrayView<const int32> ChangedIds)
+{
+	using namespace MinesweeperAtlasGrid;
+
+	if (Board == nullptr || ChangedIds.Num() == 0)
+	{
+		return;
+	}
+
+	// Sprites are picked at paint time, only the per cell texture has state to update
+	const int32 Cols = Board->Cols();
+	if (CellTexture.IsValid() && Texels.Num() == Board->Rows() * Cols)
+	{
+		int32 MinRow = MAX_int32, MaxRow = -1, MinCol = MAX_int32, MaxCol = -1;
+		for (const int32 Id : ChangedIds)
+		{
+			if (!Board->Exists(Id))
+			{
+				continue;
+			}
+
+			const int32 Row = Id / Cols;
+			const int32 Col = Id % Cols;
+			Texels[Id] = GetCellColor(Board->GetRowData(Row)[Col]);
+			MinRow = FMath::Min(MinRow, Row);
+			MaxRow = FMath::Max(MaxRow, Row);
+			MinCol = FMath::Min(MinCol, Col);
+			MaxCol = FMath::Max(MaxCol, Col);
+		}
+
+		if (MaxRow >= 0)
+		{
+			// One region around the change set. The render thread reads it later: it gets its own copy, freed once uploaded
+			const int32 Width = MaxCol - MinCol + 1;
+			const int32 Height = MaxRow - MinRow + 1;
+			FColor* RegionTexels = new FColor[Width * Height];
+			for (int32 Row = 0; Row < Height; ++Row)
+			{
+				FMemory::Memcpy(RegionTexels + Row * Width, Texels.GetData() + (MinRow + Row) * Cols + MinCol, Width * sizeof(FColor));
+			}
+
+			FUpdateTextureRegion2D* Region = new FUpdateTextureRegion2D(MinCol, MinRow, 0, 0, Width, Height);
+			CellTexture->UpdateTextureRegions(0, 1, Region, Width * sizeof(FColor), sizeof(FColor), reinterpret_cast<uint8*>(RegionTexels),
+				[](uint8* SrcData, const FUpdateTextureRegion2D* Regions)
+				{
+					delete[] reinterpret_cast<FColor*>(SrcData);
+					delete Regions;
+				});
+		}
+	}
+
+	// Cell sizes never change with their state
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+void SMinesweeperAtlasGrid::SetCellSize(float InCellSize)
+{
+	const float NewCellSize = FMath::Clamp(InCellSize, MIN_CELL_SIZE, MAX_CELL_SIZE);
+	if (NewCellSize != CellSize)
+	{
+		CellSize = NewCellSize;
+		Invalidate(EInvalidateWidgetReason::Layout);
+	}
+}
+
+float SMinesweeperAtlasGrid::GetCellSize() const
+{
+	return CellSize;
+}
+
+int32 SMinesweeperAtlasGrid::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+	SWEEPER_SCOPE(PaintBoard);
+
+	if (Board == nullptr || Board->Rows() <= 0 || Board->Cols() <= 0)
+	{
+		return LayerId;
+	}
+
+	const ESlateDrawEffect DrawEffects = ShouldBeEnabled(bParentEnabled)? ESlateDrawEffect::None : ESlateDrawEffect::DisabledEffect;
+	const FLinearColor Tint = InWidgetStyle.GetColorAndOpacityTint();
+
+	if (CellSize < MIN_SPRITE_CELL_SIZE && CellTexture.IsValid())
+	{
+		FSlateDrawElement::MakeBox(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(), &CellTextureBrush, DrawEffects, Tint);
+		return LayerId;
+	}
+
+	// Only cells under the culling rect, the rest of a huge board costs nothing
+	const FVector2f TopLeft = AllottedGeometry.AbsoluteToLocal(MyCullingRect.GetTopLeft());
+	const FVector2f BottomRight = AllottedGeometry.AbsoluteToLocal(MyCullingRect.GetBottomRight());
+	const int32 FirstRow = FMath::Clamp(FMath::FloorToInt32(TopLeft.Y / CellSize), 0, Board->Rows());
+	const int32 LastRow = FMath::Clamp(FMath::CeilToInt32(BottomRight.Y / CellSize), 0, Board->Rows());
+	const int32 FirstCol = FMath::Clamp(FMath::FloorToInt32(TopLeft.X / CellSize), 0, Board->Cols());
+	const int32 LastCol = FMath::Clamp(FMath::CeilToInt32(BottomRight.X / CellSize), 0, Board->Cols());
+
+	const FVector2f SpriteSize(CellSize, CellSize);
+	for (int32 Row = FirstRow; Row < LastRow; ++Row)
+	{
+		const FMinesweeperCell* RowData = Board->GetRowData(Row);
+		for (int32 Col = FirstCol; Col < LastCol; ++Col)
+		{
+			const FMinesweeperCell& Cell = RowData[Col];
+			ESweeperCellSprite Sprite = Cell.IsFlagged()? ESweeperCellSprite::Flag : ESweeperCellSprite::Hidden;
+			if (Cell.IsDiscovered())
+			{
+				Sprite = Cell.IsBomb()? ESweeperCellSprite::Mine : static_cast<ESweeperCellSprite>(static_cast<int32>(ESweeperCellSprite::Count0) + FMath::Clamp(Cell.GetCount(), 0, 8));
+			}
+
+			FSlateDrawElement::MakeBox(OutDrawElements, LayerId,
+				AllottedGeometry.ToPaintGeometry(SpriteSize, FSlateLayoutTransform(FVector2f(Col * CellSize, Row * CellSize))),
+				Sprites[static_cast<int32>(Sprite)], DrawEffects, Tint);
+		}
+	}
+
+	return LayerId;
+}
+
+FReply SMinesweeperAtlasGrid::OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	if (Board == nullptr || MouseEvent.GetEffectingButton() != EKeys::LeftMouseButton)
+	{
+		return FReply::Unhandled();
+	}
+
+	// Discovered cells bubble to the parent, a click there is a chord
+	const FVector2f Local = MyGeometry.AbsoluteToLocal(MouseEvent.GetScreenSpacePosition());
+	const int32 Row = FMath::FloorToInt32(Local.Y / CellSize);
+	const int32 Col = FMath::FloorToInt32(Local.X / CellSize);
+	if (!Board->Exists(Row, Col) || Board->IsDiscovered(Row, Col))
+	{
+		return FReply::Unhandled();
+	}
+
+	OnCellClicked.ExecuteIfBound(Row, Col);
+	return FReply::Handled();
+}
+
+FReply SMinesweeperAtlasGrid::OnMouseWheel(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	// Plain wheel scrolls the parent scroll box
+	if (!MouseEvent.IsControlDown())
+	{
+		return FReply::Unhandled();
+	}
+
+	SetCellSize(CellSize * (MouseEvent.GetWheelDelta() > 0.f? 1.25f : 0.8f));
+	return FReply::Handled();
+}
+
+FVector2D SMinesweeperAtlasGrid::ComputeDesiredSize(float LayoutScaleMultiplier) const
+{
+	if (Board == nullptr)
+	{
+		return FVector2D::ZeroVector;
+	}
+
+	return FVector2D(Board->Cols() * CellSize, Board->Rows() * CellSize);
+}
+
+END_SLATE_FUNCTION_BUILD_OPTIMIZATION
@@ -3,549 +3,763 @@
 
 #include "Widgets/SMinesweeperBoard.h"
 
+#include "MinesweeperManager.h"
 #include "SlateOptMacros.h"
+#include "SweeperPluginStats.h"
 #include "SweeperPluginStyle.h"
+#include "Board/MinesweeperBoardFormats.h"
+#include "Board/MinesweeperSnapshot.h"
+#include "Widgets/SMinesweeperAtlasGrid.h"
+#include "Widgets/SMinesweeperMinimap.h"
 #include "Widgets/Layout/SGridPanel.h"
+#include "Widgets/Layout/SScrollBox.h"
+#include "Widgets/Layout/SSpacer.h"
 
 BEGIN_SLATE_FUNCTION_BUILD_OPTIMIZATION
 
-FMinesweeperCell::FMinesweeperCell(bool _bIsBomb)
-	: bIsBomb(_bIsBomb), bDiscovered(false), BombCount(0), Text(FText::GetEmpty())
+SMinesweeperBoard::~SMinesweeperBoard()
 {
+	ReportStats(FBoardStats());
 }
 
-bool FMinesweeperCell::IsBomb() const
+void SMinesweeperBoard::Construct(const FArguments& InArgs)
 {
-	return bIsBomb;
+	OnGameOver = InArgs._OnGameOver;
+	OnGameWin = InArgs._OnGameWin;
+	RenderMode = InArgs._RenderMode;
+	
+	GridPanel = SNew(SGridPanel);
+
+	// Boards larger than the tab scroll, their rows are built from the ones in view outwards
+	GridView = SAssignNew(GridHorizontalScroll, SScrollBox)
+		.Orientation(Orient_Horizontal)
+		+SScrollBox::Slot()
+		[
+			SAssignNew(GridVerticalScroll, SScrollBox)
+			.Orientation(Orient_Vertical)
+			+SScrollBox::Slot()
+			[
+				GridPanel.ToSharedRef()
+			]
+		];
+
+	// Scrolls both ways, big boards don't fit the tab. The minimap shows where the view is
+	AtlasView = SNew(SOverlay)
+		+SOverlay::Slot()
+		[
+			SAssignNew(HorizontalScroll, SScrollBox)
+			.Orientation(Orient_Horizontal)
+			+SScrollBox::Slot()
+			[
+				SAssignNew(VerticalScroll, SScrollBox)
+				.Orientation(Orient_Vertical)
+				+SScrollBox::Slot()
+				[
+					SAssignNew(AtlasGrid, SMinesweeperAtlasGrid)
+					.OnCellClicked_Raw(this, &SMinesweeperBoard::OnAtlasCellClick)
+				]
+			]
+		]
+		+SOverlay::Slot()
+		.HAlign(HAlign_Right)
+		.VAlign(VAlign_Bottom)
+		.Padding(0, 0, 20, 20)
+		[
+			SAssignNew(Minimap, SMinesweeperMinimap)
+			.ViewRect_Raw(this, &SMinesweeperBoard::GetAtlasViewRect)
+			.OnNavigate_Raw(this, &SMinesweeperBoard::OnMinimapNavigate)
+		];
+
+	ChildSlot
+	[
+		SNew(SVerticalBox)
+		+SVerticalBox::Slot()
+		.FillHeight(0.2f)
+		[
+			SNew(SHorizontalBox)
+			+SHorizontalBox::Slot()
+			.HAlign(HAlign_Center)
+			.VAlign(VAlign_Center)
+			[
+				SNew(SHorizontalBox)
+				.Visibility_Lambda([this]() { return HasBoard()? EVisibility::Visible : EVisibility::Collapsed; })
+				+SHorizontalBox::Slot()
+				.AutoWidth()
+				.HAlign(HAlign_Left)
+				.VAlign(VAlign_Center)
+				.Padding(5)
+				[
+					SNew(SBox)
+					.WidthOverride(32)
+					.HeightOverride(32)
+					.MaxDesiredWidth(32)
+					.MaxDesiredHeight(32)
+					[
+						SNew(SImage)
+						.Image(FSweeperPluginStyle::Get().GetBrush(TEXT("SweeperPlugin.ToolBarButton")))
+					]
+				]
+				+SHorizontalBox::Slot()
+				.AutoWidth()
+				.HAlign(HAlign_Left)
+				.VAlign(VAlign_Center)
+				.Padding(5)
+				[
+					SNew(SVerticalBox)
+					+SVerticalBox::Slot()
+					.HAlign(HAlign_Center)
+					.VAlign(VAlign_Center)
+					[
+						SNew(STextBlock)
+						.Justification(ETextJustify::Center)
+						.Text_Lambda([this]() { return FText::FromString(FString::FromInt(BoardModel.GetTotalBombCount())); })
+					]
+				]
+			]
+		]
+		+SVerticalBox::Slot()
+		.FillHeight(0.8f)
+		[
+			SAssignNew(GridContainer, SBox)
+			[
+				GridView.ToSharedRef()
+			]
+		]
+	];
+}
+
+void SMinesweeperBoard::BuildFromString(const FString& BoardText)
+{
+	CurrentBoardText = BoardText;
+	bGameEnded = false;
+	BoardModel.Create(CurrentBoardText);
+	ResetMoves();
+	PopulateGrid();
 }
 
-bool FMinesweeperCell::IsDiscovered() const
+void SMinesweeperBoard::BuildFromLayout(const FMinesweeperLayout& Layout)
 {
-	return bDiscovered;
+	// Board text is rebuilt lazily from the model, see GetCurrentBoardText
+	CurrentBoardText.Empty();
+	bGameEnded = false;
+	FMinesweeperBoardFormats::ToBoard(Layout, BoardModel);
+	ResetMoves();
+	PopulateGrid();
 }
 
-void FMinesweeperCell::Discover()
+void SMinesweeperBoard::Rebuild()
 {
-	bDiscovered = true;
+	if (!HasBoard())
+	{
+		return;
+	}
 
-	const FString TextString = IsBomb()? TEXT("X") : FString::Printf(TEXT("%d"), BombCount);
-	Text = FText::FromString(TextString);
+	// Same mines as before, no need to parse the board text and count bombs again
+	bGameEnded = false;
+	BoardModel.Reset();
+	ResetMoves();
+	PopulateGrid();
 }
 
-void FMinesweeperCell::IncrementBombCount()
+bool SMinesweeperBoard::Undo()
 {
-	BombCount++;
+	SWEEPER_SCOPE(Click);
+
+	const FMinesweeperHistory::FMove* Move = History.Undo(BoardModel);
+	if (Move == nullptr)
+	{
+		return false;
+	}
+
+	bGameEnded = false;
+	InvalidateRuns(History.GetRuns(*Move));
+	return true;
 }
 
-bool FMinesweeperCell::IsEmpty() const
+bool SMinesweeperBoard::Redo()
 {
-	return BombCount == 0;
+	SWEEPER_SCOPE(Click);
+
+	const FMinesweeperHistory::FMove* Move = History.Redo(BoardModel);
+	if (Move == nullptr)
+	{
+		return false;
+	}
+
+	bGameEnded = Move->bEndedGame;
+	InvalidateRuns(History.GetRuns(*Move));
+	return true;
 }
 
-int32 FMinesweeperCell::GetCount() const
+bool SMinesweeperBoard::CanUndo() const
 {
-	return BombCount;
+	return History.CanUndo();
 }
 
-FText FMinesweeperCell::GetText() const
+bool SMinesweeperBoard::CanRedo() const
 {
-	return Text;
+	return History.CanRedo();
 }
 
-FMinesweeperBoard::FMinesweeperBoard()
-	: RowCount(0), ColCount(0), CellToDiscover(0), TotalBombCount(0)
+bool SMinesweeperBoard::SaveSnapshot(const FString& Path) const
 {
-	InnerBoard.Empty();
+	// Only games in progress are worth restoring
+	if (!HasBoard() || bGameEnded)
+	{
+		FMinesweeperSnapshot::DeleteFile(Path);
+		return false;
+	}
+
+	return FMinesweeperSnapshot::SaveToFile(BoardModel, Path);
 }
 
-void FMinesweeperBoard::Create(const FString& BoardText)
+bool SMinesweeperBoard::RestoreSnapshot(const FString& Path)
 {
-	CellToDiscover = 0;
-	TotalBombCount = 0;
-	InnerBoard.Empty();
+	if (!FMinesweeperSnapshot::LoadFromFile(Path, BoardModel))
+	{
+		return false;
+	}
 
-	TArray<Coordinate> BombIndexes;
-	TArray<FString> Rows;
-	BoardText.ParseIntoArray(Rows, TEXT("|"), true);
+	// Board text is rebuilt lazily from the model, see GetCurrentBoardText
+	CurrentBoardText.Empty();
+	bGameEnded = false;
+	ResetMoves();
+	PopulateGrid();
+	return true;
+}
 
-	// Parsing and board creation
-	RowCount = Rows.Num();
-	for (int32 i = 0; i < Rows.Num(); ++i)
+bool SMinesweeperBoard::HasBoard() const
+{
+	return BoardModel.Rows() > 0 && BoardModel.Cols() > 0;
+}
+
+FString SMinesweeperBoard::GetCurrentBoardText() const
+{
+	if (CurrentBoardText.IsEmpty() && HasBoard())
 	{
-		TArray<FMinesweeperCell> NewRow;
-		const FString RowString = Rows[i];
-		
-		TArray<FString> Elements;
-		RowString.ParseIntoArray(Elements, TEXT(","), true);
-		ColCount = Elements.Num();
-		
-		for (int32 j = 0; j < ColCount; ++j)
-		{
-			const FString Element = Elements[j];
-			bool bIsBomb = Element.Equals("1");
-			FMinesweeperCell Cell(bIsBomb);
-			NewRow.Add(Cell);
+		return BoardModel.ToBoardText();
+	}
 
-			if (bIsBomb)
-			{
-				BombIndexes.Add(Coordinate(i, j));
-				TotalBombCount++;
-			}
-			else
-			{
-				CellToDiscover++;
-			}
-		}
+	return CurrentBoardText;
+}
+
+const FMinesweeperBoard& SMinesweeperBoard::GetBoardModel() const
+{
+	return BoardModel;
+}
 
-		InnerBoard.Add(NewRow);
+void SMinesweeperBoard::PopulateGrid()
+{
+	SWEEPER_SCOPE(PopulateGrid);
+
+	const int32 Rows = BoardModel.Rows();
+	const int32 Cols = BoardModel.Cols();
+
+	if (ShouldUseAtlas())
+	{
+		// Atlas boards have no cell widgets, the pool goes with the grid
+		CancelGridBuild();
+		GridPanel->ClearChildren();
+		ResizeCellWidgets(0);
+		GridRows = 0;
+		GridCols = 0;
+
+		// Zoomed out enough for the whole board to fit about 1000 pixels
+		const int32 LongestSide = FMath::Max(Rows, Cols);
+		AtlasGrid->SetCellSize(FMath::Clamp(1000.f / LongestSide, SMinesweeperAtlasGrid::MIN_CELL_SIZE, SMinesweeperAtlasGrid::MAX_CELL_SIZE));
+		AtlasGrid->SetBoard(&BoardModel);
+		BoardPyramid.Build(BoardModel);
+		Minimap->SetPyramid(&BoardPyramid);
+		GridContainer->SetContent(AtlasView.ToSharedRef());
+		UpdateMemoryStats();
+		return;
 	}
 
-	// Bomb counting
-	for (const Coordinate& BombIndex : BombIndexes)
+	AtlasGrid->SetBoard(nullptr);
+	Minimap->SetPyramid(nullptr);
+	BoardPyramid.Reset();
+	GridContainer->SetContent(GridView.ToSharedRef());
+
+	// Same size as the grid (Play Again, or a new board of the same size): every widget reads its cell from the model,
+	// a repaint is all they need. A build still in progress carries on
+	if (Rows == GridRows && Cols == GridCols)
 	{
-		for (const Coordinate& Around : GetAroundOffset())
+		for (const TSharedPtr<SButton>& Button : Buttons)
 		{
-			const int32 Row = BombIndex.Key + Around.Key;
-			const int32 Col = BombIndex.Value + Around.Value;
-			if (Exists(Row, Col))
+			if (Button.IsValid())
 			{
-				InnerBoard[Row][Col].IncrementBombCount();
+				Button->Invalidate(EInvalidateWidgetReason::Paint);
 			}
 		}
+
+		UpdateMemoryStats();
+		return;
 	}
 
-	// Debug logging
-	UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Created board. Rows: %d | Cols: %d | CellToDiscover: %d | BombCount: %d"), RowCount, ColCount, CellToDiscover, TotalBombCount);
-	UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Original string: %s"), *BoardText);
-	for (int32 i = 0; i < RowCount; ++i)
+	// New size: widgets are kept by cell id and placed in their new slots as rows are built
+	CancelGridBuild();
+	GridPanel->ClearChildren();
+	ResizeCellWidgets(Rows * Cols);
+	GridRows = Rows;
+	GridCols = Cols;
+	GridHorizontalScroll->ScrollToStart();
+	GridVerticalScroll->ScrollToStart();
+
+	// Placeholders along the first row and column give the grid its full size at once:
+	// rows built out of order land in place, and clicks find their cell before its widget exists
+	for (int32 j = 0; j < Cols; ++j)
 	{
-		FString RowPrint;
-		for (int32 j = 0; j < ColCount; ++j)
-		{
-			FString ElementString = InnerBoard[i][j].IsBomb() ? TEXT("x") : FString::Printf(TEXT("%d"), InnerBoard[i][j].GetCount());
-			if (j != ColCount - 1)
-			{
-				ElementString.Append(TEXT(","));
-			}
-			RowPrint.Append(ElementString);
-		}
+		GridPanel->AddSlot(j, 0)
+		[
+			SNew(SSpacer)
+			.Size(FVector2D(CELL_WIDGET_SIZE, CELL_WIDGET_SIZE))
+		];
+	}
+	for (int32 i = 1; i < Rows; ++i)
+	{
+		GridPanel->AddSlot(0, i)
+		[
+			SNew(SSpacer)
+			.Size(FVector2D(CELL_WIDGET_SIZE, CELL_WIDGET_SIZE))
+		];
+	}
+
+	ClaimedGridRows.Init(false, Rows);
 
-		UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - [%s]"), *RowPrint);
+	// The rows in view are built in this frame's budget, the rest over the next frames
+	if (!BuildGridCells(FPlatformTime::Seconds() + GRID_BUILD_BUDGET_SECONDS))
+	{
+		BuildGridTimer = RegisterActiveTimer(0.f, FWidgetActiveTimerDelegate::CreateSP(this, &SMinesweeperBoard::ContinueGridBuild));
 	}
-}
 
-int32 FMinesweeperBoard::Rows() const
-{
-	return RowCount;
+	UpdateMemoryStats();
 }
 
-int32 FMinesweeperBoard::Cols() const
+void SMinesweeperBoard::CancelGridBuild()
 {
-	return ColCount;
+	if (BuildGridTimer.IsValid())
+	{
+		UnRegisterActiveTimer(BuildGridTimer.ToSharedRef());
+		BuildGridTimer.Reset();
+	}
+
+	ClaimedGridRows.Reset();
+	NumClaimedGridRows = 0;
+	BuildingRow = INDEX_NONE;
+	BuildingColumn = 0;
 }
 
-int32 FMinesweeperBoard::GetTotalBombCount() const
+bool SMinesweeperBoard::BuildGridCells(double EndTime)
 {
-	return TotalBombCount;
+	const int32 Rows = BoardModel.Rows();
+	const int32 Cols = BoardModel.Cols();
+	while (BuildingRow != INDEX_NONE || NumClaimedGridRows < Rows)
+	{
+		if (BuildingRow == INDEX_NONE)
+		{
+			BuildingRow = ClaimNextGridRow();
+			BuildingColumn = 0;
+		}
+
+		while (BuildingColumn < Cols)
+		{
+			const int32 Column = BuildingColumn++;
+			const int32 Id = BuildingRow * Cols + Column;
+			GridPanel->AddSlot(Column, BuildingRow)
+			[
+				CellWidgets[Id].IsValid()? CellWidgets[Id].ToSharedRef() : CreateCellWidget(Id)
+			];
+
+			// The clock is read every few cells: a single row of a huge board can outlast the budget
+			if ((Column & 31) == 31 && BuildingColumn < Cols && FPlatformTime::Seconds() >= EndTime)
+			{
+				return false;
+			}
+		}
+
+		BuildingRow = INDEX_NONE;
+		if (FPlatformTime::Seconds() >= EndTime)
+		{
+			break;
+		}
+	}
+
+	return NumClaimedGridRows >= Rows;
 }
 
-bool FMinesweeperBoard::IsDiscovered(const int32 Row, const int32 Column) const
+EActiveTimerReturnType SMinesweeperBoard::ContinueGridBuild(double InCurrentTime, float InDeltaTime)
 {
-	if (InnerBoard.IsValidIndex(Row) && InnerBoard[Row].IsValidIndex(Column))
+	SWEEPER_SCOPE(PopulateGrid);
+
+	const bool bBuilt = BuildGridCells(FPlatformTime::Seconds() + GRID_BUILD_BUDGET_SECONDS);
+	UpdateMemoryStats();
+	if (!bBuilt)
 	{
-		return InnerBoard[Row][Column].IsDiscovered();
+		return EActiveTimerReturnType::Continue;
 	}
 
-	return false;
+	BuildGridTimer.Reset();
+	return EActiveTimerReturnType::Stop;
 }
 
-bool FMinesweeperBoard::IsDiscovered(const int32 Index) const
+int32 SMinesweeperBoard::ClaimNextGridRow()
 {
-	const int32 Row = Index / ColCount;
-	const int32 Column = Index % ColCount;
+	auto Claim = [this](int32 Row)
+	{
+		ClaimedGridRows[Row] = true;
+		NumClaimedGridRows++;
+		return Row;
+	};
+
+	// Rows in view first, then one below and one above at a time. The view is read again for every row, scrolling moves the build with it
+	int32 FirstRow, LastRow;
+	GetGridViewRows(FirstRow, LastRow);
+	for (int32 Row = FirstRow; Row <= LastRow; ++Row)
+	{
+		if (!ClaimedGridRows[Row])
+		{
+			return Claim(Row);
+		}
+	}
+
+	const int32 Rows = BoardModel.Rows();
+	for (int32 Distance = 1; LastRow + Distance < Rows || FirstRow - Distance >= 0; ++Distance)
+	{
+		if (LastRow + Distance < Rows && !ClaimedGridRows[LastRow + Distance])
+		{
+			return Claim(LastRow + Distance);
+		}
+		if (FirstRow - Distance >= 0 && !ClaimedGridRows[FirstRow - Distance])
+		{
+			return Claim(FirstRow - Distance);
+		}
+	}
 
-	return IsDiscovered(Row, Column);
+	checkNoEntry();
+	return INDEX_NONE;
 }
 
-bool FMinesweeperBoard::IsBomb(const int32 Index) const
+void SMinesweeperBoard::GetGridViewRows(int32& OutFirstRow, int32& OutLastRow) const
 {
-	const int32 Row = Index / ColCount;
-	const int32 Column = Index % ColCount;
-
-	return IsBomb(Row, Column);
+	const float ViewHeight = GridVerticalScroll->GetCachedGeometry().GetLocalSize().Y;
+	const int32 ViewRows = FMath::CeilToInt32((ViewHeight > 0.f? ViewHeight : 1080.f) / CELL_WIDGET_SIZE);
+	OutFirstRow = FMath::Clamp(FMath::FloorToInt32(GridVerticalScroll->GetScrollOffset() / CELL_WIDGET_SIZE), 0, BoardModel.Rows() - 1);
+	OutLastRow = FMath::Min(OutFirstRow + ViewRows, BoardModel.Rows() - 1);
 }
 
-bool FMinesweeperBoard::Exists(const int32 Index) const
+TSharedRef<SWidget> SMinesweeperBoard::CreateCellWidget(int32 ButtonId)
 {
-	const int32 Row = Index / ColCount;
-	const int32 Column = Index % ColCount;
+	TSharedRef<SButton> Button = SNew(SButton)
+		.OnClicked_Raw(this, &SMinesweeperBoard::OnGridButtonClick, ButtonId)
+		.IsEnabled_Lambda([this, ButtonId]() { return !BoardModel.IsDiscovered(ButtonId); })
+	[
+		SNew(SVerticalBox)
+		+SVerticalBox::Slot()
+		.HAlign(HAlign_Center)
+		.VAlign(VAlign_Center)
+		[
+			SNew(STextBlock)
+			.Justification(ETextJustify::Center)
+			.Text_Lambda([this, ButtonId]() { return BoardModel.GetCellText(ButtonId); })
+			.ColorAndOpacity_Lambda([this, ButtonId]() { return BoardModel.GetCellColor(ButtonId); })
+		]
+	];
+
+	TSharedRef<SWidget> CellWidget = SNew(SBox)
+		.WidthOverride(CELL_WIDGET_SIZE)
+		.HeightOverride(CELL_WIDGET_SIZE)
+		[
+			Button
+		];
 
-	return Exists(Row, Column);
+	Buttons[ButtonId] = Button;
+	CellWidgets[ButtonId] = CellWidget;
+	NumCellWidgets++;
+	return CellWidget;
 }
 
-FText FMinesweeperBoard::GetCellText(const int32 Row, const int32 Column) const
+void SMinesweeperBoard::ResizeCellWidgets(int32 NumCells)
 {
-	if (InnerBoard.IsValidIndex(Row) && InnerBoard[Row].IsValidIndex(Column))
+	for (int32 Id = NumCells; Id < CellWidgets.Num(); ++Id)
 	{
-		return InnerBoard[Row][Column].GetText();
+		NumCellWidgets -= CellWidgets[Id].IsValid()? 1 : 0;
 	}
 
-	return FText::GetEmpty();
+	CellWidgets.SetNum(NumCells);
+	Buttons.SetNum(NumCells);
 }
 
-FText FMinesweeperBoard::GetCellText(const int32 Index) const
+int32 SMinesweeperBoard::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
 {
-	const int32 Row = Index / ColCount;
-	const int32 Column = Index % ColCount;
-	return GetCellText(Row, Column);
+	const int32 MaxLayerId = SCompoundWidget::OnPaint(Args, AllottedGeometry, MyCullingRect, OutDrawElements, LayerId, InWidgetStyle, bParentEnabled);
+
+	// Cells changed by the last commands are painted by now
+	if (PendingInputTimes.Num() > 0 && FMinesweeperManager::IsInitialized())
+	{
+		const double Now = FPlatformTime::Seconds();
+		for (const double InputTime : PendingInputTimes)
+		{
+			FMinesweeperManager::Get().AddClickLatency(BoardModel.Rows(), BoardModel.Cols(), Now - InputTime);
+		}
+	}
+	PendingInputTimes.Reset();
+
+	return MaxLayerId;
 }
 
-FSlateColor FMinesweeperBoard::GetCellColor(const int32 Row, const int32 Column) const
+FReply SMinesweeperBoard::OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
 {
-	const ISlateStyle& Style = FSweeperPluginStyle::Get();
+	const int32 Id = GetCellAt(MouseEvent.GetScreenSpacePosition());
+	if (Id == INDEX_NONE || bGameEnded)
+	{
+		return FReply::Unhandled();
+	}
 
-	if (!InnerBoard.IsValidIndex(Row) || !InnerBoard[Row].IsValidIndex(Column))
+	const FKey Button = MouseEvent.GetEffectingButton();
+	if (Button == EKeys::RightMouseButton)
 	{
-		return Style.GetSlateColor(TEXT("SweeperPlugin.NoDangerColor"));
+		QueueCommand(EMinesweeperCommand::ToggleFlag, Id);
+		return FReply::Handled();
 	}
 
-	const FMinesweeperCell Cell = InnerBoard[Row][Column];
-	FSlateColor Color = Style.GetSlateColor(TEXT("SweeperPlugin.NoDangerColor"));
-	if (Cell.IsBomb())
+	if (Button == EKeys::MiddleMouseButton || (Button == EKeys::LeftMouseButton && BoardModel.IsDiscovered(Id)))
 	{
-		return Style.GetSlateColor(TEXT("SweeperPlugin.BombColor"));
+		QueueCommand(EMinesweeperCommand::Chord, Id);
+		return FReply::Handled();
 	}
 
-	TMap<int32, FSlateColor> AvailableColors = GetAvailableCellColors();
-	if (!AvailableColors.Contains(Cell.BombCount))
+	// Cell widgets take left clicks on hidden cells: one getting here has no widget in the grid yet, it plays like the others
+	if (Button == EKeys::LeftMouseButton && !ShouldUseAtlas())
 	{
-		return Style.GetSlateColor(TEXT("SweeperPlugin.HighDangerColor"));
+		QueueCommand(EMinesweeperCommand::Discover, Id);
+		return FReply::Handled();
 	}
-	
-	return AvailableColors[Cell.BombCount];
-}
 
-FSlateColor FMinesweeperBoard::GetCellColor(const int32 Index) const
-{
-	const int32 Row = Index / ColCount;
-	const int32 Column = Index % ColCount;
-	return GetCellColor(Row, Column);
+	return FReply::Unhandled();
 }
 
-TArray<FMinesweeperBoard::Coordinate> FMinesweeperBoard::GetAroundOffset()
+FReply SMinesweeperBoard::OnGridButtonClick(int32 ButtonId)
 {
-	static TArray<Coordinate> Around{
-		{-1, -1}, //TopLeft
-		{-1, 0}, //Top
-		{-1, 1}, //TopRight
-		{0, 1}, //Right
-		{1, 1}, //BottomRight
-		{1, 0}, //Bottom
-		{1, -1}, //BottomLeft
-		{0, -1}, //Left
-	};
-
-	return Around;
+	QueueCommand(EMinesweeperCommand::Discover, ButtonId);
+	return FReply::Handled();
 }
 
-TMap<int32, FSlateColor> FMinesweeperBoard::GetAvailableCellColors()
+void SMinesweeperBoard::OnAtlasCellClick(int32 Row, int32 Col)
 {
-	static TMap<int32, FSlateColor> AvailableCellColors{
-		{0, FSweeperPluginStyle::Get().GetSlateColor(TEXT("SweeperPlugin.NoDangerColor"))},
-		{1, FSweeperPluginStyle::Get().GetSlateColor(TEXT("SweeperPlugin.LowDangerColor"))},
-		{2, FSweeperPluginStyle::Get().GetSlateColor(TEXT("SweeperPlugin.MediumDangerColor"))},
-		{3, FSweeperPluginStyle::Get().GetSlateColor(TEXT("SweeperPlugin.HighDangerColor"))},
-	};
-
-	return AvailableCellColors;
+	QueueCommand(EMinesweeperCommand::Discover, Row * BoardModel.Cols() + Col);
 }
 
-
-bool FMinesweeperBoard::IsBomb(const int32 Row, const int32 Column) const
+void SMinesweeperBoard::QueueCommand(EMinesweeperCommand Type, int32 Id)
 {
-	if (InnerBoard.IsValidIndex(Row) && InnerBoard[Row].IsValidIndex(Column))
+	if (!InputQueue.Push(Type, Id, FPlatformTime::Seconds()))
 	{
-		return InnerBoard[Row][Column].IsBomb();
+		INC_DWORD_STAT(STAT_SweeperClicksCoalesced);
 	}
 
-	return false;
+	if (!ProcessCommandsTimer.IsValid())
+	{
+		ProcessCommandsTimer = RegisterActiveTimer(0.f, FWidgetActiveTimerDelegate::CreateSP(this, &SMinesweeperBoard::ProcessCommands));
+	}
 }
 
-TArray<int32> FMinesweeperBoard::Discover(const int32 Row, const int32 Column)
+EActiveTimerReturnType SMinesweeperBoard::ProcessCommands(double InCurrentTime, float InDeltaTime)
 {
-	TArray<int32> Discovered;
-	if (!InnerBoard.IsValidIndex(Row) || !InnerBoard[Row].IsValidIndex(Column) || InnerBoard[Row][Column].IsDiscovered())
-	{
-		return Discovered;	
-	}
+	ProcessCommandsTimer.Reset();
 
-	if (InnerBoard[Row][Column].IsBomb())
-	{
-		InnerBoard[Row][Column].Discover();
-		Discovered.Add(Row * RowCount + Column);
-		return Discovered;
-	}
+	bool bHasWon = false;
+	bool bHasLost = false;
 
-	// Recursively discover empty point on board
-	TQueue<Coordinate> ToDiscover;
-	ToDiscover.Enqueue(Coordinate(Row, Column));
-	while (!ToDiscover.IsEmpty())
 	{
-		Coordinate CurrentCoordinate;
-		if (ToDiscover.Dequeue(CurrentCoordinate))
+		SWEEPER_SCOPE(Click);
+
+		InputQueue.Flush(FrameCommands);
+		FrameChangedIds.Reset();
+		for (const FMinesweeperCommand& Command : FrameCommands)
 		{
-			FMinesweeperCell& Cell = InnerBoard[CurrentCoordinate.Key][CurrentCoordinate.Value];
-			if (!Cell.IsBomb())
+			// Clicks queued behind the one ending the game land on a finished board
+			if (bGameEnded)
 			{
-				Cell.Discover();
-
-				const int32 CellIndex = CurrentCoordinate.Key * RowCount + CurrentCoordinate.Value;
-				Discovered.AddUnique(CellIndex);
-				
-				if (!Cell.IsEmpty())
-				{
-					continue;
-				}
-					
-				for (const Coordinate& AdjacentOffset : GetAroundOffset())
-				{
-					const int32 AdjacentRow = AdjacentOffset.Key + CurrentCoordinate.Key;
-					const int32 AdjacentCol = AdjacentOffset.Value + CurrentCoordinate.Value;
-					if (Exists(AdjacentRow, AdjacentCol)
-						&& !IsDiscovered(AdjacentRow, AdjacentCol)
-						&& !IsBomb(AdjacentRow, AdjacentCol)
-					) {
-						ToDiscover.Enqueue(Coordinate(AdjacentRow, AdjacentCol));
-					}
-				}
+				break;
 			}
-		}
-	}
-
-	CellToDiscover = FMath::Max(0, CellToDiscover - Discovered.Num());
-	return Discovered;
-}
 
-TArray<int32> FMinesweeperBoard::Reveal()
-{
-	TArray<int32> Revealed;
-	for (int32 i = 0; i < RowCount; ++i)
-	{
-		for (int32 j = 0; j < ColCount; ++j)
-		{
-			if (!IsDiscovered(i, j))
+			if (ApplyCommand(Command, bHasWon, bHasLost))
 			{
-				InnerBoard[i][j].Discover();
-				Revealed.Add(i * RowCount + j);
+				PendingInputTimes.Add(Command.InputTime);
 			}
 		}
+
+		// One invalidation for the whole frame
+		InvalidateCells(FrameChangedIds);
+
+		INC_DWORD_STAT_BY(STAT_SweeperCellsChanged, FrameChangedIds.Num());
+		UpdateMemoryStats();
 	}
 
-	return Revealed;
-}
+	// Dialogs are modal, notify only once the moves are fully applied and recorded
+	if (bHasWon)
+	{
+		OnGameWin.ExecuteIfBound();
+	}
+	else if (bHasLost)
+	{
+		OnGameOver.ExecuteIfBound();
+	}
 
-bool FMinesweeperBoard::Exists(const int32 Row, const int32 Column) const
-{
-	return InnerBoard.IsValidIndex(Row) && InnerBoard[Row].IsValidIndex(Column);
+	return EActiveTimerReturnType::Stop;
 }
 
-bool FMinesweeperBoard::HasWon() const
+bool SMinesweeperBoard::ApplyCommand(const FMinesweeperCommand& Command, bool& bOutWon, bool& bOutLost)
 {
-	return CellToDiscover <= 0;
-}
+	ClickChangedIds.Reset();
+	const int32 CellToDiscoverBefore = BoardModel.CellToDiscover;
+	const EMinesweeperCommandResult Result = FMinesweeperInputQueue::Apply(BoardModel, Command.Type, Command.Id, ClickChangedIds);
+	if (Result == EMinesweeperCommandResult::Unchanged)
+	{
+		return false;
+	}
 
-FMinesweeperCell FMinesweeperBoard::operator()(const int32 Row, const int32 Column) const
-{
-	return InnerBoard[Row][Column];
-}
+	FrameChangedIds.Append(ClickChangedIds);
 
-FMinesweeperCell& FMinesweeperBoard::operator()(const int32 Row, const int32 Column)
-{
-	return InnerBoard[Row][Column];
+	// Flags are not moves, undo/redo skips them
+	if (Command.Type == EMinesweeperCommand::ToggleFlag)
+	{
+		return true;
+	}
+
+	bOutWon = bOutWon || Result == EMinesweeperCommandResult::Won;
+	bOutLost = bOutLost || Result == EMinesweeperCommandResult::Lost;
+	bGameEnded = bOutWon || bOutLost;
+	History.Record(ClickChangedIds, CellToDiscoverBefore, BoardModel.CellToDiscover, bGameEnded);
+	return true;
 }
 
-FMinesweeperCell& FMinesweeperBoard::operator()(const int32 Index)
+void SMinesweeperBoard::ResetMoves()
 {
-	const int32 Row = Index / ColCount;
-	const int32 Column = Index % ColCount;
+	InputQueue.Reset();
+	PendingInputTimes.Reset();
 
-	return InnerBoard[Row][Column];
+	// Sized before the first click of the board, so clicks don't allocate
+	const int32 CellCount = BoardModel.Rows() * BoardModel.Cols();
+	History.Reset(CellCount);
+	ClickChangedIds.Reserve(FMath::Min(CellCount, FMinesweeperBoard::SCRATCH_RESERVE_CELLS));
+	FrameChangedIds.Reserve(FMath::Min(CellCount, FMinesweeperBoard::SCRATCH_RESERVE_CELLS));
 }
 
-FMinesweeperCell FMinesweeperBoard::operator()(const int32 Index) const
+int32 SMinesweeperBoard::GetCellAt(const FVector2f& ScreenPosition) const
 {
-	const int32 Row = Index / ColCount;
-	const int32 Column = Index % ColCount;
+	if (!HasBoard())
+	{
+		return INDEX_NONE;
+	}
 
-	return InnerBoard[Row][Column];
+	const bool bAtlas = ShouldUseAtlas();
+	const FGeometry& Geometry = bAtlas? AtlasGrid->GetCachedGeometry() : GridPanel->GetCachedGeometry();
+	const float CellSize = bAtlas? AtlasGrid->GetCellSize() : CELL_WIDGET_SIZE;
+	// Scrolled boards extend past the container, under the header
+	if (!Geometry.IsUnderLocation(ScreenPosition) || !GridContainer->GetCachedGeometry().IsUnderLocation(ScreenPosition))
+	{
+		return INDEX_NONE;
+	}
+
+	const FVector2f Local = Geometry.AbsoluteToLocal(ScreenPosition);
+	const int32 Row = FMath::FloorToInt32(Local.Y / CellSize);
+	const int32 Col = FMath::FloorToInt32(Local.X / CellSize);
+	return BoardModel.Exists(Row, Col)? Row * BoardModel.Cols() + Col : INDEX_NONE;
 }
 
-void SMinesweeperBoard::Construct(const FArguments& InArgs)
+void SMinesweeperBoard::OnMinimapNavigate(FVector2f BoardFraction)
 {
-	OnGameOver = InArgs._OnGameOver;
-	OnGameWin = InArgs._OnGameWin;
-	
-	GridPanel = SNew(SGridPanel);
-	ChildSlot
-	[
-		SNew(SVerticalBox)
-		+SVerticalBox::Slot()
-		.FillHeight(0.2f)
-		[
-			SNew(SHorizontalBox)
-			+SHorizontalBox::Slot()
-			.HAlign(HAlign_Center)
-			.VAlign(VAlign_Center)
-			[
-				SNew(SHorizontalBox)
-				.Visibility_Lambda([this]() { return CurrentBoardText.IsEmpty()? EVisibility::Collapsed : EVisibility::Visible; })
-				+SHorizontalBox::Slot()
-				.AutoWidth()
-				.HAlign(HAlign_Left)
-				.VAlign(VAlign_Center)
-				.Padding(5)
-				[
-					SNew(SBox)
-					.WidthOverride(32)
-					.HeightOverride(32)
-					.MaxDesiredWidth(32)
-					.MaxDesiredHeight(32)
-					[
-						SNew(SImage)
-						.Image(FSweeperPluginStyle::Get().GetBrush(TEXT("SweeperPlugin.ToolBarButton")))
-					]
-				]
-				+SHorizontalBox::Slot()
-				.AutoWidth()
-				.HAlign(HAlign_Left)
-				.VAlign(VAlign_Center)
-				.Padding(5)
-				[
-					SNew(SVerticalBox)
-					+SVerticalBox::Slot()
-					.HAlign(HAlign_Center)
-					.VAlign(VAlign_Center)
-					[
-						SNew(STextBlock)
-						.Justification(ETextJustify::Center)
-						.Text_Lambda([this]() { return FText::FromString(FString::FromInt(BoardModel.GetTotalBombCount())); })
-					]
-				]
-			]
-		]
-		+SVerticalBox::Slot()
-		.FillHeight(0.8f)
-		[
-			GridPanel.ToSharedRef()
-		]
-	];
+	// Centers the view on the clicked point
+	const FVector2D BoardSize = AtlasGrid->GetDesiredSize();
+	const FVector2f ViewSize = VerticalScroll->GetCachedGeometry().GetLocalSize();
+	HorizontalScroll->SetScrollOffset(FMath::Max(0.f, BoardFraction.X * BoardSize.X - ViewSize.X * 0.5f));
+	VerticalScroll->SetScrollOffset(FMath::Max(0.f, BoardFraction.Y * BoardSize.Y - ViewSize.Y * 0.5f));
 }
 
-void SMinesweeperBoard::BuildFromString(const FString& BoardText)
+FBox2f SMinesweeperBoard::GetAtlasViewRect() const
 {
-	CurrentBoardText = BoardText;
-	BoardModel.Create(CurrentBoardText);
-	PopulateGrid();
+	const FVector2f Min(HorizontalScroll->GetViewOffsetFraction(), VerticalScroll->GetViewOffsetFraction());
+	const FVector2f Extent(HorizontalScroll->GetViewFraction(), VerticalScroll->GetViewFraction());
+	return FBox2f(Min, Min + Extent);
 }
 
-void SMinesweeperBoard::Rebuild()
+void SMinesweeperBoard::InvalidateCells(TArrayView<const int32> Ids)
 {
-	if (CurrentBoardText.IsEmpty())
+	if (ShouldUseAtlas())
 	{
+		AtlasGrid->NotifyCellsChanged(Ids);
+		BoardPyramid.Update(BoardModel, Ids);
+		Minimap->NotifyCellsChanged(Ids);
 		return;
 	}
-	
-	BuildFromString(CurrentBoardText);
-}
 
-FString SMinesweeperBoard::GetCurrentBoardText() const
-{
-	return CurrentBoardText;
+	for (const int32 Id : Ids)
+	{
+		if (Buttons.IsValidIndex(Id) && Buttons[Id].IsValid())
+		{
+			// Cell sizes never change, the new text and color only need a repaint
+			Buttons[Id]->Invalidate(EInvalidateWidgetReason::Paint);
+		}
+	}
 }
 
-void SMinesweeperBoard::PopulateGrid()
+void SMinesweeperBoard::InvalidateRuns(TArrayView<const FMinesweeperHistory::FIdRun> Runs)
 {
-	Buttons.Empty();
-	GridPanel->ClearChildren();
-	int32 ButtonId = 0;
-	for (int32 i = 0; i < BoardModel.Rows(); ++i)
+	// ClickChangedIds is free outside of clicks
+	ClickChangedIds.Reset();
+	for (const FMinesweeperHistory::FIdRun& Run : Runs)
 	{
-		for (int32 j = 0; j < BoardModel.Cols(); ++j)
+		for (int32 Id = Run.Start; Id < Run.Start + Run.Num; ++Id)
 		{
-			TSharedRef<SButton> Button = CreateButton(ButtonId, i, j);
+			ClickChangedIds.Add(Id);
+		}
+	}
 
-			Buttons.Add(ButtonId, Button);
-			GridPanel->AddSlot(j, i)
-			[
-				SNew(SBox)
-				.WidthOverride(50)
-				.HeightOverride(50)
-				[
-					Button
-				]
-			];
+	InvalidateCells(ClickChangedIds);
+}
 
-			ButtonId++;
-		}
+bool SMinesweeperBoard::ShouldUseAtlas() const
+{
+	if (RenderMode == EMinesweeperRenderMode::Auto)
+	{
+		return BoardModel.Rows() * BoardModel.Cols() >= AUTO_ATLAS_MIN_CELLS;
 	}
+
+	return RenderMode == EMinesweeperRenderMode::Atlas;
 }
 
-TSharedRef<SButton> SMinesweeperBoard::CreateButton(int32 ButtonId, int32 Row, int32 Column)
+void SMinesweeperBoard::UpdateMemoryStats()
 {
-	TSharedRef<SButton> Button = SNew(SButton)
-		.OnClicked_Raw(this, &SMinesweeperBoard::OnGridButtonClick, ButtonId, Row, Column)
-		.IsEnabled_Lambda([this, ButtonId]() { return !BoardModel.IsDiscovered(ButtonId); })
-	[
-		SNew(SVerticalBox)
-		+SVerticalBox::Slot()
-		.HAlign(HAlign_Center)
-		.VAlign(VAlign_Center)
-		[
-			SNew(STextBlock)
-			.Justification(ETextJustify::Center)
-			.Text_Lambda([this, ButtonId]() { return BoardModel.GetCellText(ButtonId); })
-			.ColorAndOpacity_Lambda([this, ButtonId]() { return BoardModel.GetCellColor(ButtonId); })
-		]
-	];
+#if STATS
+	// Widget memory is an estimate: the shared pointers don't expose their allocations
+	static constexpr SIZE_T CellWidgetSize = sizeof(SBox) + sizeof(SButton) + sizeof(SVerticalBox) + sizeof(STextBlock);
 
-	Buttons.Add(ButtonId, Button);
-	return Button;
+	FBoardStats Current;
+	Current.Cells = BoardModel.Rows() * BoardModel.Cols();
+	Current.Widgets = NumCellWidgets;
+	Current.BoardMemory = BoardModel.GetAllocatedSize() + BoardPyramid.GetAllocatedSize();
+	Current.HistoryMemory = History.GetAllocatedSize() + ClickChangedIds.GetAllocatedSize();
+	Current.WidgetMemory = CellWidgets.GetAllocatedSize() + Buttons.GetAllocatedSize() + NumCellWidgets * CellWidgetSize;
+	ReportStats(Current);
+#endif
 }
 
-FReply SMinesweeperBoard::OnGridButtonClick(int32 ButtonId, int32 Row, int32 Col)
+void SMinesweeperBoard::ReportStats(const FBoardStats& Current)
 {
-	TSet<int32> UpdateButtons;
-	
-	const FMinesweeperCell StartingCell = BoardModel(Row, Col);
-	if (!BoardModel.IsBomb(Row, Col))
-	{
-		const TArray<int32> DiscoveredIds = BoardModel.Discover(Row, Col);
-		UpdateButtons.Append(DiscoveredIds);
-		
-		if (BoardModel.HasWon())
-		{
-			const TArray<int32> RevealedIds = BoardModel.Reveal();
-			UpdateButtons.Append(RevealedIds);
-			OnGameWin.ExecuteIfBound();
-		}
-	}
-	else
-	{
-		// Reveal Board
-		const TArray<int32> RevealedIds = BoardModel.Reveal();
-		UpdateButtons.Append(RevealedIds);
-		OnGameOver.ExecuteIfBound();
-	}
+	// Stats are shared by every board, report the difference with what this board reported last time
+	DEC_DWORD_STAT_BY(STAT_SweeperBoardCells, ReportedStats.Cells);
+	DEC_DWORD_STAT_BY(STAT_SweeperCellWidgets, ReportedStats.Widgets);
+	DEC_MEMORY_STAT_BY(STAT_SweeperBoardMemory, ReportedStats.BoardMemory);
+	DEC_MEMORY_STAT_BY(STAT_SweeperHistoryMemory, ReportedStats.HistoryMemory);
+	DEC_MEMORY_STAT_BY(STAT_SweeperWidgetMemory, ReportedStats.WidgetMemory);
 
-	for (const int32& Id : UpdateButtons)
-	{
-		if (Buttons.Contains(Id))
-		{
-			Buttons[Id]->Invalidate(EInvalidateWidgetReason::LayoutAndVolatility);
-		}
-	}
-	
-	return FReply::Handled();
+	INC_DWORD_STAT_BY(STAT_SweeperBoardCells, Current.Cells);
+	INC_DWORD_STAT_BY(STAT_SweeperCellWidgets, Current.Widgets);
+	INC_MEMORY_STAT_BY(STAT_SweeperBoardMemory, Current.BoardMemory);
+	INC_MEMORY_STAT_BY(STAT_SweeperHistoryMemory, Current.HistoryMemory);
+	INC_MEMORY_STAT_BY(STAT_SweeperWidgetMemory, Current.WidgetMemory);
+
+	ReportedStats = Current;
 }
 
 END_SLATE_FUNCTION_BUILD_OPTIMIZATION
@@ -0,0 +1,213 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Widgets/SMinesweeperMinimap.h"
+
+#include "SlateOptMacros.h"
+#include "SweeperPluginStats.h"
+#include "Board/MinesweeperBoardPyramid.h"
+#include "Engine/Texture2D.h"
+
+BEGIN_SLATE_FUNCTION_BUILD_OPTIMIZATION
+
+void SMinesweeperMinimap::Construct(const FArguments& InArgs)
+{
+	Size = InArgs._Size;
+	MaxTexels = FMath::Max(1, InArgs._MaxTexels);
+	bShowMineDensity = InArgs._ShowMineDensity;
+	ViewRect = InArgs._ViewRect;
+	OnNavigate = InArgs._OnNavigate;
+
+	TextureBrush.DrawAs = ESlateBrushDrawType::Image;
+	TextureBrush.Tiling = ESlateBrushTileType::NoTile;
+}
+
+void SMinesweeperMinimap::SetPyramid(const FMinesweeperBoardPyramid* InPyramid)
+{
+	Pyramid = InPyramid;
+	Level = Pyramid != nullptr? Pyramid->FindLevel(MaxTexels, MaxTexels) : INDEX_NONE;
+	Texels.Reset();
+	Texture.Reset();
+	TextureBrush.SetResourceObject(nullptr);
+
+	if (Level != INDEX_NONE)
+	{
+		const FMinesweeperBoardPyramid::FLevel& Blocks = Pyramid->GetLevel(Level);
+		Texels.SetNumUninitialized(Blocks.Blocks.Num());
+		for (int32 i = 0; i < Texels.Num(); ++i)
+		{
+			Texels[i] = GetBlockColor(i);
+		}
+
+		UTexture2D* NewTexture = UTexture2D::CreateTransient(Blocks.Cols, Blocks.Rows, PF_B8G8R8A8, TEXT("SweeperMinimap"));
+		if (NewTexture != nullptr)
+		{
+			NewTexture->Filter = TF_Nearest;
+			NewTexture->SRGB = true;
+			NewTexture->NeverStream = true;
+
+			void* MipData = NewTexture->GetPlatformData()->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
+			FMemory::Memcpy(MipData, Texels.GetData(), Texels.Num() * sizeof(FColor));
+			NewTexture->GetPlatformData()->Mips[0].BulkData.Unlock();
+			NewTexture->UpdateResource();
+
+			Texture.Reset(NewTexture);
+			TextureBrush.SetResourceObject(NewTexture);
+			TextureBrush.ImageSize = FVector2D(Blocks.Cols, Blocks.Rows);
+		}
+	}
+
+	Invalidate(EInvalidateWidgetReason::Layout);
+}
+
+void SMinesweeperMinimap::NotifyCellsChanged(TArrayView<const int32> ChangedIds)
+{
+	if (Level == INDEX_NONE || !Texture.IsValid() || ChangedIds.Num() == 0)
+	{
+		return;
+	}
+
+	const FMinesweeperBoardPyramid::FLevel& Blocks = Pyramid->GetLevel(Level);
+	const int32 BoardCols = Pyramid->GetBoardCols();
+	const int32 CellCount = Pyramid->GetBoardRows() * BoardCols;
+
+	int32 MinRow = MAX_int32, MaxRow = -1, MinCol = MAX_int32, MaxCol = -1;
+	for (const int32 Id : ChangedIds)
+	{
+		if (Id < 0 || Id >= CellCount)
+		{
+			continue;
+		}
+
+		const int32 Row = Id / BoardCols / Blocks.BlockSize;
+		const int32 Col = (Id % BoardCols) / Blocks.BlockSize;
+		MinRow = FMath::Min(MinRow, Row);
+		MaxRow = FMath::Max(MaxRow, Row);
+		MinCol = FMath::Min(MinCol, Col);
+		MaxCol = FMath::Max(MaxCol, Col);
+	}
+
+	if (MaxRow < 0)
+	{
+		return;
+	}
+
+	// A click changes a handful of blocks at this level, recoloring the whole bounding region is cheaper than tracking them
+	const int32 Width = MaxCol - MinCol + 1;
+	const int32 Height = MaxRow - MinRow + 1;
+	FColor* RegionTexels = new FColor[Width * Height];
+	for (int32 Row = 0; Row < Height; ++Row)
+	{
+		for (int32 Col = 0; Col < Width; ++Col)
+		{
+			const int32 BlockIndex = (MinRow + Row) * Blocks.Cols + MinCol + Col;
+			Texels[BlockIndex] = GetBlockColor(BlockIndex);
+			RegionTexels[Row * Width + Col] = Texels[BlockIndex];
+		}
+	}
+
+	FUpdateTextureRegion2D* Region = new FUpdateTextureRegion2D(MinCol, MinRow, 0, 0, Width, Height);
+	Texture->UpdateTextureRegions(0, 1, Region, Width * sizeof(FColor), sizeof(FColor), reinterpret_cast<uint8*>(RegionTexels),
+		[](uint8* SrcData, const FUpdateTextureRegion2D* Regions)
+		{
+			delete[] reinterpret_cast<FColor*>(SrcData);
+			delete Regions;
+		});
+
+	Invalidate(EInvalidateWidgetReason::Paint);
+}
+
+int32 SMinesweeperMinimap::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const
+{
+	SWEEPER_SCOPE(PaintBoard);
+
+	if (!Texture.IsValid())
+	{
+		return LayerId;
+	}
+
+	FSlateDrawElement::MakeBox(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(), &TextureBrush, ESlateDrawEffect::None, InWidgetStyle.GetColorAndOpacityTint());
+
+	const FBox2f View = ViewRect.Get(FBox2f(FVector2f::ZeroVector, FVector2f::UnitVector));
+	const FVector2f LocalSize = AllottedGeometry.GetLocalSize();
+	const FVector2f Min = View.Min * LocalSize;
+	const FVector2f Max = View.Max * LocalSize;
+	const TArray<FVector2f> Outline = { Min, FVector2f(Max.X, Min.Y), Max, FVector2f(Min.X, Max.Y), Min };
+	FSlateDrawElement::MakeLines(OutDrawElements, LayerId + 1, AllottedGeometry.ToPaintGeometry(), Outline, ESlateDrawEffect::None, FLinearColor::Yellow, true, 1.5f);
+
+	return LayerId + 1;
+}
+
+FReply SMinesweeperMinimap::OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	if (MouseEvent.GetEffectingButton() != EKeys::LeftMouseButton || !Texture.IsValid())
+	{
+		return FReply::Unhandled();
+	}
+
+	Navigate(MyGeometry, MouseEvent);
+	return FReply::Handled().CaptureMouse(SharedThis(this));
+}
+
+FReply SMinesweeperMinimap::OnMouseButtonUp(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	if (MouseEvent.GetEffectingButton() != EKeys::LeftMouseButton || !HasMouseCapture())
+	{
+		return FReply::Unhandled();
+	}
+
+	return FReply::Handled().ReleaseMouseCapture();
+}
+
+FReply SMinesweeperMinimap::OnMouseMove(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent)
+{
+	if (!HasMouseCapture())
+	{
+		return FReply::Unhandled();
+	}
+
+	Navigate(MyGeometry, MouseEvent);
+	return FReply::Handled();
+}
+
+FVector2D SMinesweeperMinimap::ComputeDesiredSize(float LayoutScaleMultiplier) const
+{
+	if (Pyramid == nullptr || Pyramid->GetBoardRows() <= 0 || Pyramid->GetBoardCols() <= 0)
+	{
+		return FVector2D::ZeroVector;
+	}
+
+	// Board aspect ratio, longest side at Size
+	const float Scale = Size / FMath::Max(Pyramid->GetBoardRows(), Pyramid->GetBoardCols());
+	return FVector2D(Pyramid->GetBoardCols() * Scale, Pyramid->GetBoardRows() * Scale);
+}
+
+FColor SMinesweeperMinimap::GetBlockColor(int32 BlockIndex) const
+{
+	static const FLinearColor Hidden(0.4f, 0.4f, 0.4f);
+	static const FLinearColor Revealed(0.85f, 0.85f, 0.85f);
+	static const FLinearColor Mines(0.9f, 0.1f, 0.1f);
+
+	const FMinesweeperBoardPyramid::FBlock& Block = Pyramid->GetLevel(Level).Blocks[BlockIndex];
+	FLinearColor Color = FMath::Lerp(Hidden, Revealed, Block.GetRevealedFraction());
+	if (bShowMineDensity)
+	{
+		// Densities past a third are already unplayable, they get the full tint
+		Color = FMath::Lerp(Color, Mines, FMath::Min(1.f, Block.GetMineDensity() * 3.f));
+	}
+	return Color.ToFColor(true);
+}
+
+void SMinesweeperMinimap::Navigate(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) const
+{
+	const FVector2f LocalSize = MyGeometry.GetLocalSize();
+	if (LocalSize.X <= 0.f || LocalSize.Y <= 0.f)
+	{
+		return;
+	}
+
+	const FVector2f Local = MyGeometry.AbsoluteToLocal(MouseEvent.GetScreenSpacePosition());
+	OnNavigate.ExecuteIfBound(FVector2f(FMath::Clamp(Local.X / LocalSize.X, 0.f, 1.f), FMath::Clamp(Local.Y / LocalSize.Y, 0.f, 1.f)));
+}
+
+END_SLATE_FUNCTION_BUILD_OPTIMIZATION
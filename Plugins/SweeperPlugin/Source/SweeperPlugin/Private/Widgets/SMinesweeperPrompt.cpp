@@ -3,11 +3,14 @@
 
 #include "Widgets/SMinesweeperPrompt.h"
 
-#include "HttpModule.h"
+#include "MinesweeperManager.h"
+#include "AI/BoardProvider.h"
+#include "Board/MinesweeperBoardValidator.h"
 #include "SlateOptMacros.h"
 #include "SweeperPluginStyle.h"
-#include "Interfaces/IHttpResponse.h"
-#include "Settings/AISettings.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
 #include "Widgets/Text/SRichTextBlock.h"
 #include "Widgets/Views/SListView.h"
 
@@ -15,40 +18,35 @@
 
 BEGIN_SLATE_FUNCTION_BUILD_OPTIMIZATION
 
-const FString SMinesweeperPrompt::NOT_RELATED_RESPONSE = TEXT("[]");
-const FString SMinesweeperPrompt::GEMINI_PROMPT_BASE_URL = TEXT("https://generativelanguage.googleapis.com/v1beta/models/gemini-1.5-flash:generateContent");
+void FPromptMessage::SetContent(const FText& InContent)
+{
+	Content = InContent;
+	if (const TSharedPtr<STextBlock> TextBlock = ContentTextBlock.Pin())
+	{
+		TextBlock->SetText(Content);
+	}
+}
 
 void SMinesweeperPrompt::Construct(const FArguments& InArgs)
 {
 	OnBoardRequestCompleted = InArgs._OnBoardRequestCompleted;
 	OnBoardRequestFailed = InArgs._OnBoardRequestFailed;
-	
+
 	FText HintText = LOCTEXT("SweeperPromptHint", "Waiting your mAInesweeper request...");
 	ChildSlot
 	[
 		SNew(SVerticalBox)
 		+SVerticalBox::Slot()
-		.VAlign(VAlign_Bottom)
+		.VAlign(VAlign_Fill)
 		.HAlign(HAlign_Fill)
 		.FillHeight(1.f)
 		[
-			SNew(SScrollBox)
-			.Orientation(Orient_Vertical)
-			.Style(&FScrollBoxStyle()
-				.SetTopShadowBrush(FSlateNoResource())
-				.SetBottomShadowBrush(FSlateNoResource()) 
-				.SetLeftShadowBrush(FSlateNoResource())
-				.SetRightShadowBrush(FSlateNoResource())
-			)
-			.Clipping(EWidgetClipping::ClipToBounds)
-			+SScrollBox::Slot()
-			[
-				SAssignNew(ChatListView, SListView<TSharedPtr<FPromptMessage>>)
-					.ListItemsSource(&PromptMessages)
-					.Orientation(Orient_Vertical)
-					.SelectionMode(ESelectionMode::Type::None)
-					.OnGenerateRow_Raw(this, &SMinesweeperPrompt::OnGenerateChatRow)
-			]
+			// The list scrolls itself: inside a scroll box it would generate every row instead of the visible ones
+			SAssignNew(ChatListView, SListView<TSharedPtr<FPromptMessage>>)
+				.ListItemsSource(&PromptMessages)
+				.Orientation(Orient_Vertical)
+				.SelectionMode(ESelectionMode::Type::None)
+				.OnGenerateRow_Raw(this, &SMinesweeperPrompt::OnGenerateChatRow)
 		]
 		+SVerticalBox::Slot()
 		.HAlign(HAlign_Fill)
@@ -93,46 +91,9 @@ void SMinesweeperPrompt::Construct(const FArguments& InArgs)
 	];
 }
 
-TSharedRef<IHttpRequest> SMinesweeperPrompt::BuildBoardRequest(const FString& Prompt)
-{
-	const FString ApiKey = GetGeminiApiKey();
-	
-	TSharedRef<IHttpRequest> Request = FHttpModule::Get().CreateRequest();
-	Request->OnProcessRequestComplete().BindRaw(this, &SMinesweeperPrompt::OnBoardRequestCompletedCallback);
-
-	const FString Url = FString::Printf(TEXT("%s?key=%s"), *GEMINI_PROMPT_BASE_URL, *ApiKey);
-	const FString RequestBody = BuildRequestBody(Prompt);
-	
-	Request->SetURL(Url);
-	Request->SetVerb("POST");
-	Request->SetHeader("User-Agent", "X-UnrealEngine-Agent");
-	Request->SetHeader("Content-Type", "application/json");
-	Request->SetContentAsString(RequestBody);
-
-	UE_LOG(LogSlate, Display, TEXT("[Minesweeper] - AI Request: %s"), *RequestBody);
-	return Request;
-}
-
-FString SMinesweeperPrompt::BuildRequestBody(const FString& Prompt) const
+void SMinesweeperPrompt::WarmUp()
 {
-	FString Base = TEXT("{ "
-	"\"contents\": [ "
-		"{ "
-			"\"role\": \"model\", "
-			"\"parts\": [ "
-				"{ \"text\": \"You are an assistant specialized in generating grids for the Minesweeper game. "
-					"Respond with only 0 (empty) and 1 (mine), with each cell separated by commas and each row separated by a |. "
-					"No extra text or explanations. Each time, generate a different field. "
-					"If the request is not related to Minesweeper, respond with: {0}.\" "
-				"} "
-			"] "
-		"}, "
-		"{ \"role\": \"user\", "
-			"\"parts\": [ { \"text\": \"{1}\" } ] "
-		"} "
-	"] "
-	"}");
-	return FString::Format(*Base, {NOT_RELATED_RESPONSE, Prompt});
+	FMinesweeperManager::Get().GetProvider()->WarmUp();
 }
 
 FReply SMinesweeperPrompt::OnPromptButtonClick()
@@ -166,100 +127,99 @@ bool SMinesweeperPrompt::HandlePrompt()
 	PromptEditableText->SetText(FText::GetEmpty());
 
 	TSharedPtr<FPromptMessage> UserMessage = MakeShared<FPromptMessage>(Prompt, true);
-	TSharedPtr<FPromptMessage> ServerMessage = MakeShared<FPromptMessage>(LOCTEXT("GeminiGeneratingText", "Generating..."), false);
-	LastServerMessage = ServerMessage;
-	PromptMessages.Add(UserMessage);
-	PromptMessages.Add(ServerMessage);
 
-	ChatListView->RequestListRefresh();
+	// Same prompt as one already answered by any tab: play a board left from that batch, no request
+	FMinesweeperManager& Manager = FMinesweeperManager::Get();
+	FString CachedBoard;
+	if (Manager.TakeCachedBoard(CurrentPromptText, CachedBoard))
+	{
+		TSharedPtr<FPromptMessage> ServerMessage = MakeShared<FPromptMessage>(FText::Format(LOCTEXT("CachedBoardText", "Board served from the ones already generated ({0} left)."), Manager.GetNumCachedBoards(CurrentPromptText)), false);
+		AddMessages({ UserMessage, ServerMessage });
+		OnBoardRequestCompleted.ExecuteIfBound(CurrentPromptText, CachedBoard);
+		return true;
+	}
+
+	// Then an unplayed board stored by an earlier request, when the prompt asks for a size the library can look up
+	FString LibraryBoard;
+	if (Manager.TakeLibraryBoard(CurrentPromptText, LibraryBoard))
+	{
+		TSharedPtr<FPromptMessage> ServerMessage = MakeShared<FPromptMessage>(FText::Format(LOCTEXT("LibraryBoardText", "Board served from the local library ({0} unplayed boards left)."), Manager.GetLibrary().GetNumUnplayed()), false);
+		AddMessages({ UserMessage, ServerMessage });
+		OnBoardRequestCompleted.ExecuteIfBound(CurrentPromptText, LibraryBoard);
+		return true;
+	}
 
-	TSharedRef<IHttpRequest> Request = BuildBoardRequest(CurrentPromptText);
-	Request->ProcessRequest();
+	TSharedPtr<FPromptMessage> ServerMessage = MakeShared<FPromptMessage>(LOCTEXT("GeminiGeneratingText", "Generating..."), false);
+	ServerMessage->bPending = true;
+	AddMessages({ UserMessage, ServerMessage });
+
+	Manager.GetProvider()->RequestBoard(CurrentPromptText, FOnBoardProviderResponse::CreateSP(this, &SMinesweeperPrompt::OnBoardResponse, ServerMessage, CurrentPromptText));
 	
 	return true;
 }
 
-void SMinesweeperPrompt::OnBoardRequestCompletedCallback(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
+void SMinesweeperPrompt::OnBoardResponse(const FBoardProviderResponse& Response, TSharedPtr<FPromptMessage> ServerMessage, FString Prompt)
 {
-	check(IsInGameThread());
-	
-	if (!bWasSuccessful || !Response.IsValid() || Response->GetResponseCode() > EHttpResponseCodes::PartialContent)
-	{
-		UE_LOG(LogSlate, Error, TEXT("[Minesweeper] - Error contacting Gemini: %d"), Response->GetResponseCode());
-		
-		const FText ErrorText = FText::Format(LOCTEXT("GeminiGenericError", "Error contacting Gemini: {0}"), Response->GetResponseCode());
-		LastServerMessage->Content = ErrorText;
-		ChatListView->RequestListRefresh();
-		
-		OnBoardRequestFailed.ExecuteIfBound(ErrorText.ToString());
-		return;
-	}
-	
-	TSharedPtr<FJsonObject> BodyJson;
-	const FString Body = Response->GetContentAsString();
-	TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Body);
-	FJsonSerializer::Deserialize(Reader, BodyJson);
-	if (!BodyJson.IsValid())
+	ServerMessage->bPending = false;
+	if (!Response.bSuccess)
 	{
-		UE_LOG(LogSlate, Error, TEXT("[Minesweeper] - AI response not valid, no JSON"));
-		
-		const FText ErrorText = FText::Format(LOCTEXT("GeminiJsonFailed", "Failed to deserialize Gemini response: {0}"), FText::FromString(Body));
-		LastServerMessage->Content = ErrorText;
-		ChatListView->RequestListRefresh();
+		ServerMessage->SetContent(Response.Error);
 
-		OnBoardRequestFailed.ExecuteIfBound(ErrorText.ToString());
+		OnBoardRequestFailed.ExecuteIfBound(Response.Error.ToString());
 		return;
 	}
 
-	if (BodyJson->HasField(TEXT("candidates")))
+	UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Board: %s"), *Response.Boards[0]);
+
+	FText NewServerMessage = LOCTEXT("GeminiGeneratedText", "Board generated correctly.");
+	if (Response.Boards[0].Equals(IBoardProvider::NOT_RELATED_RESPONSE))
+	{
+		NewServerMessage = LOCTEXT("GeminiNotRelatedResponse", "Out of Minesweeper scope, I'm sorry.");
+		OnBoardRequestFailed.ExecuteIfBound(NewServerMessage.ToString());
+	}
+	else
 	{
-		TArray<TSharedPtr<FJsonValue>> Candidates = BodyJson->GetArrayField(TEXT("candidates"));
-		if (Candidates.Num() > 0)
+		// Never trust the model output: fix it here rather than paying another round trip
+		TArray<FString> Boards;
+		Boards.Reserve(Response.Boards.Num());
+		FString RepairsText;
+		for (const FString& BoardText : Response.Boards)
 		{
-			TSharedPtr<FJsonValue> Candidate = Candidates[0];
-			TSharedPtr<FJsonObject> Content = Candidate->AsObject()->GetObjectField(TEXT("content"));
-			if (Content.IsValid())
+			FMinesweeperBoardRepairs Repairs;
+			Boards.Add(FMinesweeperBoardValidator::Normalize(BoardText, Repairs));
+			if (Repairs.HasRepairs())
 			{
-				TArray<TSharedPtr<FJsonValue>> Parts = Content->GetArrayField(TEXT("parts"));
-				if (Parts.Num() > 0)
-				{
-					TSharedPtr<FJsonObject> Text = Parts[0]->AsObject();
-					FString BoardText = Text->GetStringField(TEXT("text"));
-					BoardText = ClearResponse(BoardText);
-					UE_LOG(LogSlate, Display, TEXT("[MineSweeper] - Board: %s"), *BoardText);
-
-					FText NewServerMessage = LOCTEXT("GeminiGeneratedText", "Board generated correctly.");
-					if (BoardText.Equals(NOT_RELATED_RESPONSE))
-					{
-						NewServerMessage = LOCTEXT("GeminiNotRelatedResponse", "Out of Minesweeper scope, I'm sorry.");
-						OnBoardRequestFailed.ExecuteIfBound(NewServerMessage.ToString());
-					}
-					else
-					{
-						OnBoardRequestCompleted.ExecuteIfBound(BoardText);
-					}
-
-					LastServerMessage->Content = NewServerMessage;
-					ChatListView->RequestListRefresh();
-					return;
-				}
+				UE_LOG(LogSlate, Warning, TEXT("[MineSweeper] - Board %d repaired: %s"), Boards.Num(), *Repairs.ToString());
+				RepairsText = Repairs.ToString();
 			}
 		}
-	}
 
-	FText ErrorText = LOCTEXT("GeminiMalformedResponseText", "Gemini response malformed.");
-	LastServerMessage->Content = ErrorText;
-	ChatListView->RequestListRefresh();
+		if (Boards.Num() > 1)
+		{
+			NewServerMessage = FText::Format(LOCTEXT("GeminiGeneratedBatchText", "{0} boards generated, the next ones are queued for Play Again and any tab asking the same."), Boards.Num());
+		}
+		if (!RepairsText.IsEmpty())
+		{
+			NewServerMessage = FText::Format(LOCTEXT("GeminiRepairedText", "{0} Fixed: {1}."), NewServerMessage, FText::FromString(RepairsText));
+		}
+		// Shared with every tab, not only this one. The library keeps them all, the first one is played now
+		FMinesweeperManager& Manager = FMinesweeperManager::Get();
+		Manager.AddLibraryBoards(Boards, 1);
+		Manager.AddCachedBoards(Prompt, MakeArrayView(Boards).RightChop(1));
+		OnBoardRequestCompleted.ExecuteIfBound(Prompt, Boards[0]);
+	}
 
-	OnBoardRequestFailed.ExecuteIfBound(ErrorText.ToString());
+	ServerMessage->SetContent(NewServerMessage);
 }
 
 TSharedRef<ITableRow> SMinesweeperPrompt::OnGenerateChatRow(TSharedPtr<FPromptMessage> Message, const TSharedRef<STableViewBase>& Owner)
 {
 	const EHorizontalAlignment Alignment = Message->bIsUser ? HAlign_Right : HAlign_Left;
-	const FText Author = Message->bIsUser ? LOCTEXT("PromptUserAuthorText", "You say:") : LOCTEXT("PromptAgentAuthorText", "Gemini says:");
-	
-	return SNew(STableRow<TSharedPtr<FPromptMessage>>, Owner)
+	const FText Author = Message->bIsUser ? LOCTEXT("PromptUserAuthorText", "You say:") : FText::Format(LOCTEXT("PromptAgentAuthorText", "{0} says:"), FMinesweeperManager::Get().GetProvider()->GetDisplayName());
+
+	// Content is pushed to the row when it changes, nothing polls it every frame
+	TSharedPtr<STextBlock> ContentTextBlock;
+	TSharedRef<ITableRow> Row = SNew(STableRow<TSharedPtr<FPromptMessage>>, Owner)
 		.Padding(5)
 		[
 			SNew(SVerticalBox)
@@ -284,24 +244,58 @@ TSharedRef<ITableRow> SMinesweeperPrompt::OnGenerateChatRow(TSharedPtr<FPromptMe
 					.HAlign(Alignment)
 					.VAlign(VAlign_Center)
 					[
-						SNew(STextBlock)
-						.Text_Lambda([Message]() { return Message->Content; })
+						SAssignNew(ContentTextBlock, STextBlock)
+						.Text(Message->Content)
 					]
 				]
 			]
 		];
+
+	Message->ContentTextBlock = ContentTextBlock;
+	return Row;
 }
 
+void SMinesweeperPrompt::AddMessages(TArrayView<const TSharedPtr<FPromptMessage>> Messages)
+{
+	PromptMessages.Append(Messages.GetData(), Messages.Num());
+	TrimHistory();
+
+	// New rows only, existing ones are kept
+	ChatListView->RequestListRefresh();
+	ChatListView->ScrollToBottom();
+}
 
-FString SMinesweeperPrompt::ClearResponse(FString Response)
+void SMinesweeperPrompt::TrimHistory()
 {
-	Response = Response.Replace(TEXT("\n"), TEXT(""));
-	return Response.TrimStartAndEnd();
+	// Trimmed in chunks, not one message per prompt
+	const int32 Overflow = PromptMessages.Num() - MAX_CHAT_MESSAGES;
+	if (Overflow < MAX_CHAT_MESSAGES / 4)
+	{
+		return;
+	}
+
+	// A pending answer would be archived as "Generating...", and its real content lost: the trim waits for it
+	FString Lines;
+	int32 Trimmed = 0;
+	for (; Trimmed < Overflow && !PromptMessages[Trimmed]->bPending; ++Trimmed)
+	{
+		const FPromptMessage& Message = *PromptMessages[Trimmed];
+		Lines += FString::Printf(TEXT("%s: %s"), Message.bIsUser? TEXT("User") : TEXT("AI"), *Message.Content.ToString()) + LINE_TERMINATOR;
+	}
+
+	if (Trimmed == 0)
+	{
+		return;
+	}
+
+	FFileHelper::SaveStringToFile(Lines, *GetHistoryPath(), FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append);
+	PromptMessages.RemoveAt(0, Trimmed);
+	UE_LOG(LogSlate, Display, TEXT("[Minesweeper] - %d chat messages moved to %s"), Trimmed, *GetHistoryPath());
 }
 
-FString SMinesweeperPrompt::GetGeminiApiKey() const
+FString SMinesweeperPrompt::GetHistoryPath()
 {
-	return UAISettings::Get()->GetGeminiApiKey();
+	return FPaths::ProjectSavedDir() / TEXT("Minesweeper") / TEXT("ChatHistory.txt");
 }
 
 END_SLATE_FUNCTION_BUILD_OPTIMIZATION
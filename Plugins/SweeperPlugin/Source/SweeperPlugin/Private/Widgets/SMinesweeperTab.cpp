@@ -3,13 +3,25 @@
 
 #include "Widgets/SMinesweeperTab.h"
 
+#include "MinesweeperManager.h"
 #include "SlateOptMacros.h"
+#include "SweeperPlugin.h"
 #include "Dialog/SCustomDialog.h"
+#include "Board/MinesweeperBoardFormats.h"
+#include "Board/MinesweeperSnapshot.h"
+#include "DesktopPlatformModule.h"
+#include "Framework/Application/SlateApplication.h"
+#include "IDesktopPlatform.h"
 #include "Widgets/SMinesweeperBoard.h"
 #include "Widgets/SMinesweeperPrompt.h"
 
 #define LOCTEXT_NAMESPACE "FSweeperPluginModule"
 
+namespace MinesweeperTab
+{
+	static const TCHAR* BOARD_FILE_TYPES = TEXT("Board text (*.txt;*.board)|*.txt;*.board|Mine coordinates (*.mines)|*.mines|Run length (*.rle)|*.rle|Bit packed (*.msb)|*.msb");
+}
+
 BEGIN_SLATE_FUNCTION_BUILD_OPTIMIZATION
 
 void SMinesweeperTab::Construct(const FArguments& InArgs)
@@ -35,18 +47,121 @@ void SMinesweeperTab::Construct(const FArguments& InArgs)
 					.VAlign(VAlign_Fill)
 					.Padding(5)
 					[
-						SNew(SButton)
-						.OnClicked_Raw(this, &SMinesweeperTab::OnPlayAgainClick)
-						.Visibility_Lambda([this]() { return MinesweeperBoard->GetCurrentBoardText().IsEmpty()? EVisibility::Collapsed : EVisibility::Visible; })
+						SNew(SHorizontalBox)
+						+SHorizontalBox::Slot()
+						.AutoWidth()
+						.Padding(0, 0, 5, 0)
+						[
+							SNew(SButton)
+							.OnClicked_Raw(this, &SMinesweeperTab::OnPlayAgainClick)
+							.Visibility_Raw(this, &SMinesweeperTab::GetBoardButtonsVisibility)
+							[
+								SNew(SVerticalBox)
+								+SVerticalBox::Slot()
+								.HAlign(HAlign_Center)
+								.VAlign(VAlign_Center)
+								[
+									SNew(STextBlock)
+									.Text_Raw(this, &SMinesweeperTab::GetPlayAgainText)
+									.Justification(ETextJustify::Center)
+								]
+							]
+						]
+						+SHorizontalBox::Slot()
+						.AutoWidth()
+						.Padding(0, 0, 5, 0)
+						[
+							SNew(SButton)
+							.OnClicked_Raw(this, &SMinesweeperTab::OnUndoClick)
+							.Visibility_Raw(this, &SMinesweeperTab::GetBoardButtonsVisibility)
+							.IsEnabled_Lambda([this]() { return MinesweeperBoard->CanUndo(); })
+							[
+								SNew(SVerticalBox)
+								+SVerticalBox::Slot()
+								.HAlign(HAlign_Center)
+								.VAlign(VAlign_Center)
+								[
+									SNew(STextBlock)
+									.Text(LOCTEXT("UndoButtonText", "Undo"))
+									.Justification(ETextJustify::Center)
+								]
+							]
+						]
+						+SHorizontalBox::Slot()
+						.AutoWidth()
+						.Padding(0, 0, 5, 0)
+						[
+							SNew(SButton)
+							.OnClicked_Raw(this, &SMinesweeperTab::OnRedoClick)
+							.Visibility_Raw(this, &SMinesweeperTab::GetBoardButtonsVisibility)
+							.IsEnabled_Lambda([this]() { return MinesweeperBoard->CanRedo(); })
+							[
+								SNew(SVerticalBox)
+								+SVerticalBox::Slot()
+								.HAlign(HAlign_Center)
+								.VAlign(VAlign_Center)
+								[
+									SNew(STextBlock)
+									.Text(LOCTEXT("RedoButtonText", "Redo"))
+									.Justification(ETextJustify::Center)
+								]
+							]
+						]
+						+SHorizontalBox::Slot()
+						.AutoWidth()
+						.Padding(0, 0, 5, 0)
 						[
-							SNew(SVerticalBox)
-							+SVerticalBox::Slot()
-							.HAlign(HAlign_Center)
-							.VAlign(VAlign_Center)
+							SNew(SButton)
+							.OnClicked_Raw(this, &SMinesweeperTab::OnNewTabClick)
+							.ToolTipText(LOCTEXT("NewTabButtonTooltip", "Opens another game next to this one"))
 							[
-								SNew(STextBlock)
-								.Text(LOCTEXT("PlayAgainButtonText", "Play Again"))
-								.Justification(ETextJustify::Center)
+								SNew(SVerticalBox)
+								+SVerticalBox::Slot()
+								.HAlign(HAlign_Center)
+								.VAlign(VAlign_Center)
+								[
+									SNew(STextBlock)
+									.Text(LOCTEXT("NewTabButtonText", "New Tab"))
+									.Justification(ETextJustify::Center)
+								]
+							]
+						]
+						+SHorizontalBox::Slot()
+						.AutoWidth()
+						.Padding(0, 0, 5, 0)
+						[
+							SNew(SButton)
+							.OnClicked_Raw(this, &SMinesweeperTab::OnImportClick)
+							.ToolTipText(LOCTEXT("ImportButtonTooltip", "Loads a board from a .txt, .mines, .rle or .msb file"))
+							[
+								SNew(SVerticalBox)
+								+SVerticalBox::Slot()
+								.HAlign(HAlign_Center)
+								.VAlign(VAlign_Center)
+								[
+									SNew(STextBlock)
+									.Text(LOCTEXT("ImportButtonText", "Import"))
+									.Justification(ETextJustify::Center)
+								]
+							]
+						]
+						+SHorizontalBox::Slot()
+						.AutoWidth()
+						[
+							SNew(SButton)
+							.OnClicked_Raw(this, &SMinesweeperTab::OnExportClick)
+							.Visibility_Raw(this, &SMinesweeperTab::GetBoardButtonsVisibility)
+							.ToolTipText(LOCTEXT("ExportButtonTooltip", "Saves the mines of this board, the format follows the file extension"))
+							[
+								SNew(SVerticalBox)
+								+SVerticalBox::Slot()
+								.HAlign(HAlign_Center)
+								.VAlign(VAlign_Center)
+								[
+									SNew(STextBlock)
+									.Text(LOCTEXT("ExportButtonText", "Export"))
+									.Justification(ETextJustify::Center)
+								]
 							]
 						]
 					]
@@ -87,14 +202,107 @@ void SMinesweeperTab::Construct(const FArguments& InArgs)
 			]
 		]
 	);
+
+	SetOnTabClosed(SDockTab::FOnTabClosedCallback::CreateSP(this, &SMinesweeperTab::OnTabClosed));
+
+	Slot = FMinesweeperManager::Get().RegisterTab(SharedThis(this));
+
+	// Resume the game left open last time in this slot, if any
+	MinesweeperBoard->RestoreSnapshot(FMinesweeperSnapshot::GetDefaultSnapshotPath(Slot));
+}
+
+void SMinesweeperTab::WarmUp()
+{
+	MinesweeperPrompt->WarmUp();
 }
 
 FReply SMinesweeperTab::OnPlayAgainClick()
 {
+	FString BoardText;
+	if (!LastPrompt.IsEmpty() && FMinesweeperManager::Get().TakeCachedBoard(LastPrompt, BoardText))
+	{
+		MinesweeperBoard->BuildFromString(BoardText);
+		return FReply::Handled();
+	}
+
 	MinesweeperBoard->Rebuild();
 	return FReply::Handled();
 }
 
+FReply SMinesweeperTab::OnNewTabClick()
+{
+	FSweeperPluginModule::Get().OpenNewMinesweeperTab();
+	return FReply::Handled();
+}
+
+FReply SMinesweeperTab::OnUndoClick()
+{
+	MinesweeperBoard->Undo();
+	return FReply::Handled();
+}
+
+FReply SMinesweeperTab::OnRedoClick()
+{
+	MinesweeperBoard->Redo();
+	return FReply::Handled();
+}
+
+FReply SMinesweeperTab::OnImportClick()
+{
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if (DesktopPlatform == nullptr)
+	{
+		return FReply::Handled();
+	}
+
+	TArray<FString> Files;
+	const void* ParentWindow = FSlateApplication::Get().FindBestParentWindowHandleForDialogs(SharedThis(this));
+	if (!DesktopPlatform->OpenFileDialog(ParentWindow, LOCTEXT("ImportDialogTitle", "Import Board").ToString(), FPaths::ProjectSavedDir(), TEXT(""),
+		MinesweeperTab::BOARD_FILE_TYPES, EFileDialogFlags::None, Files) || Files.Num() == 0)
+	{
+		return FReply::Handled();
+	}
+
+	FMinesweeperLayout Layout;
+	FString Error;
+	if (!FMinesweeperBoardFormats::LoadFromFile(Files[0], Layout, &Error))
+	{
+		ShowFileError(LOCTEXT("ImportFailedDialog", "Import Failed"), FString::Printf(TEXT("%s: %s"), *FPaths::GetCleanFilename(Files[0]), *Error));
+		return FReply::Handled();
+	}
+
+	// Not an AI board, Play Again must not serve boards cached for the previous prompt
+	LastPrompt.Empty();
+	MinesweeperBoard->BuildFromLayout(Layout);
+	return FReply::Handled();
+}
+
+FReply SMinesweeperTab::OnExportClick()
+{
+	IDesktopPlatform* DesktopPlatform = FDesktopPlatformModule::Get();
+	if (DesktopPlatform == nullptr || !MinesweeperBoard->HasBoard())
+	{
+		return FReply::Handled();
+	}
+
+	TArray<FString> Files;
+	const void* ParentWindow = FSlateApplication::Get().FindBestParentWindowHandleForDialogs(SharedThis(this));
+	if (!DesktopPlatform->SaveFileDialog(ParentWindow, LOCTEXT("ExportDialogTitle", "Export Board").ToString(), FPaths::ProjectSavedDir(), TEXT("Board.txt"),
+		MinesweeperTab::BOARD_FILE_TYPES, EFileDialogFlags::None, Files) || Files.Num() == 0)
+	{
+		return FReply::Handled();
+	}
+
+	FMinesweeperLayout Layout;
+	FMinesweeperBoardFormats::FromBoard(MinesweeperBoard->GetBoardModel(), Layout);
+	FString Error;
+	if (!FMinesweeperBoardFormats::SaveToFile(Files[0], Layout, &Error))
+	{
+		ShowFileError(LOCTEXT("ExportFailedDialog", "Export Failed"), FString::Printf(TEXT("%s: %s"), *FPaths::GetCleanFilename(Files[0]), *Error));
+	}
+	return FReply::Handled();
+}
+
 void SMinesweeperTab::OnGameOver()
 {
 	TSharedRef<SCustomDialog> GameOverDialog = SNew(SCustomDialog)
@@ -129,11 +337,51 @@ void SMinesweeperTab::OnGameWin()
 	GameWonDialog->ShowModal();
 }
 
-void SMinesweeperTab::OnBoardRequestCompleted(FString BoardText)
+void SMinesweeperTab::ShowFileError(const FText& Title, const FString& Error)
+{
+	TSharedRef<SCustomDialog> ErrorDialog = SNew(SCustomDialog)
+	.Title(Title)
+	.Content()
+	[
+		SNew(STextBlock)
+		.Text(FText::FromString(Error))
+		.Justification(ETextJustify::Center)
+	]
+	.Buttons({
+		SCustomDialog::FButton(LOCTEXT("CloseText", "Close")),
+	});
+
+	ErrorDialog->ShowModal();
+}
+
+void SMinesweeperTab::OnTabClosed(TSharedRef<SDockTab> ClosedTab)
 {
+	MinesweeperBoard->SaveSnapshot(FMinesweeperSnapshot::GetDefaultSnapshotPath(Slot));
+	FMinesweeperManager::Get().UnregisterTab(Slot);
+}
+
+void SMinesweeperTab::OnBoardRequestCompleted(const FString& Prompt, const FString& BoardText)
+{
+	LastPrompt = Prompt;
 	MinesweeperBoard->BuildFromString(BoardText);
 }
 
+FText SMinesweeperTab::GetPlayAgainText() const
+{
+	const int32 NumCachedBoards = LastPrompt.IsEmpty()? 0 : FMinesweeperManager::Get().GetNumCachedBoards(LastPrompt);
+	if (NumCachedBoards > 0)
+	{
+		return FText::Format(LOCTEXT("NextBoardButtonText", "Next Board ({0} left)"), NumCachedBoards);
+	}
+
+	return LOCTEXT("PlayAgainButtonText", "Play Again");
+}
+
+EVisibility SMinesweeperTab::GetBoardButtonsVisibility() const
+{
+	return MinesweeperBoard->HasBoard()? EVisibility::Visible : EVisibility::Collapsed;
+}
+
 END_SLATE_FUNCTION_BUILD_OPTIMIZATION
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
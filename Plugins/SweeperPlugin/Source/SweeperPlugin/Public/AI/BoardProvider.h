@@ -0,0 +1,107 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Settings/AISettings.h"
+
+struct FBoardProviderResponse
+{
+	bool bSuccess = false;
+	/** Boards as the model wrote them, rows split by '|'. Not empty on success. */
+	TArray<FString> Boards;
+	/** Why it failed, shown in the chat */
+	FText Error;
+	double LatencyMs = 0.0;
+	/** Connection setup plus upload of the request that answered, 0 if the provider doesn't measure it */
+	double ConnectSendMs = 0.0;
+};
+
+DECLARE_DELEGATE_OneParam(FOnBoardProviderResponse, const FBoardProviderResponse&);
+
+/**
+ * Source of boards generated from a user prompt: Gemini, an OpenAI compatible local server or the offline mock.
+ * Responses are delivered on the game thread, in completion order.
+ */
+class SWEEPERPLUGIN_API IBoardProvider : public TSharedFromThis<IBoardProvider>
+{
+public:
+	virtual ~IBoardProvider() = default;
+
+	/** What the model answers to prompts unrelated to Minesweeper, instead of a board */
+	static const FString NOT_RELATED_RESPONSE;
+
+	/** Provider selected in UAISettings */
+	static TSharedRef<IBoardProvider> Create();
+	static TSharedRef<IBoardProvider> Create(EBoardProviderType Type);
+
+	/** Author of the answers in the chat */
+	virtual FText GetDisplayName() const = 0;
+
+	/** Gets ready for the first prompt (connections, caches). Optional. */
+	virtual void WarmUp() {}
+
+	/** Stops what WarmUp keeps running (keep-alive pings) once no tab uses the provider. Optional. */
+	virtual void CoolDown() {}
+
+	/** Asks for GetBoardsPerRequest() boards */
+	void RequestBoard(const FString& Prompt, FOnBoardProviderResponse OnResponse);
+
+	/** Asks for NumBoards boards in a single request */
+	virtual void RequestBoards(const FString& Prompt, int32 NumBoards, FOnBoardProviderResponse OnResponse) = 0;
+
+	virtual int32 GetBoardsPerRequest() const = 0;
+
+	/** Requests running plus queued */
+	virtual int32 GetNumPending() const = 0;
+};
+
+/**
+ * Queue shared by the providers: runs at most MaxConcurrentRequests at a time, tracks stats and latency.
+ * Subclasses start a request in StartRequest and end it with FinishRequest, exactly once per id.
+ */
+class SWEEPERPLUGIN_API FBoardProviderBase : public IBoardProvider
+{
+public:
+	explicit FBoardProviderBase(EBoardProviderType InType);
+	virtual ~FBoardProviderBase() override;
+
+	virtual void RequestBoards(const FString& Prompt, int32 NumBoards, FOnBoardProviderResponse OnResponse) override;
+	virtual int32 GetBoardsPerRequest() const override;
+	virtual int32 GetNumPending() const override;
+
+	/** Boards separator in a batched answer */
+	static constexpr TCHAR BOARD_SEPARATOR = TEXT(';');
+
+	/** Prompt asking for NumBoards boards, Prompt itself for one */
+	static FString MakeBatchPrompt(const FString& Prompt, int32 NumBoards);
+	/** Splits a batched answer in one pass, dropping empty entries */
+	static void SplitBoards(FStringView ResponseText, TArray<FString>& OutBoards);
+
+protected:
+	virtual void StartRequest(uint32 RequestId, const FString& Prompt, int32 NumBoards) = 0;
+	/** Success, ResponseText holds the boards as the model wrote them */
+	void FinishRequest(uint32 RequestId, const FString& ResponseText, double ConnectSendMs = 0.0);
+	void FailRequest(uint32 RequestId, const FText& Error);
+
+	const FBoardProviderSettings& GetSettings() const;
+
+private:
+	void CompleteRequest(uint32 RequestId, FBoardProviderResponse&& Response);
+	void StartQueued();
+
+private:
+	struct FPendingRequest
+	{
+		uint32 Id;
+		FString Prompt;
+		int32 NumBoards;
+		FOnBoardProviderResponse OnResponse;
+		double StartTime;
+	};
+
+	EBoardProviderType Type;
+	TArray<FPendingRequest> Queued;
+	TArray<FPendingRequest> Running;
+	uint32 NextRequestId = 1;
+};
@@ -0,0 +1,35 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AI/BoardProvider.h"
+#include "Interfaces/IHttpRequest.h"
+
+class FGeminiConnection;
+class FGeminiContextCache;
+struct FHttpPhaseTimings;
+
+/** Boards from Gemini generateContent, with a warm connection and the fixed prompt in a context cache when possible */
+class SWEEPERPLUGIN_API FGeminiBoardProvider : public FBoardProviderBase
+{
+public:
+	FGeminiBoardProvider();
+
+	virtual FText GetDisplayName() const override;
+	virtual void WarmUp() override;
+	virtual void CoolDown() override;
+
+protected:
+	virtual void StartRequest(uint32 RequestId, const FString& Prompt, int32 NumBoards) override;
+
+private:
+	/** @param bAllowCachedContent false to always send the whole prompt */
+	void SendRequest(uint32 RequestId, const FString& Prompt, bool bAllowCachedContent);
+	void OnRequestCompleted(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful,
+		uint32 RequestId, FString Prompt, FString CachedContentName, TSharedRef<FHttpPhaseTimings> Timings);
+
+private:
+	TSharedRef<FGeminiConnection> Connection;
+	TSharedPtr<FGeminiContextCache> ContextCache;
+};
@@ -0,0 +1,59 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Interfaces/IHttpRequest.h"
+
+/**
+ * Wall clock phases of one HTTP request, stamped from its delegates.
+ * Delegates fire on the HTTP tick, so every phase has about a frame of resolution.
+ */
+struct SWEEPERPLUGIN_API FHttpPhaseTimings
+{
+	double StartTime = 0.0;
+	/** Body fully sent: connection setup (DNS, TCP, TLS) plus upload */
+	double SentTime = 0.0;
+	/** First response header received */
+	double FirstByteTime = 0.0;
+	double EndTime = 0.0;
+
+	/** Binds the progress and header delegates of Request. Call right before ProcessRequest. */
+	static TSharedRef<FHttpPhaseTimings> Track(const TSharedRef<IHttpRequest>& Request);
+
+	void Finish();
+	/** Connection setup plus upload, once finished */
+	double GetConnectSendMs() const { return (SentTime - StartTime) * 1000.0; }
+	void Log(const TCHAR* Label) const;
+};
+
+/**
+ * Keeps a connection to the configured Gemini endpoint open between prompts, so no board request pays connection setup.
+ * The HTTP module pools connections per host: Warm opens one with a small request, then a keep-alive ping goes out
+ * whenever it has been idle long enough to risk being closed. Nothing is sent without an API key, and pings stop with Stop.
+ */
+class SWEEPERPLUGIN_API FGeminiConnection : public TSharedFromThis<FGeminiConnection>
+{
+public:
+	~FGeminiConnection();
+
+	/** Opens the connection now and keeps it alive until Stop */
+	void Warm();
+
+	/** No more keep-alive pings, until the next Warm */
+	void Stop();
+
+	/** Any request to the endpoint, postpones the next ping */
+	void NotifyActivity();
+
+private:
+	bool Tick(float DeltaTime);
+	void SendPing(const TCHAR* Label);
+
+private:
+	double LastActivityTime = 0.0;
+	bool bPingPending = false;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+};
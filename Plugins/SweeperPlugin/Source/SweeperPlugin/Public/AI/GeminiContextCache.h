@@ -0,0 +1,55 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Interfaces/IHttpRequest.h"
+
+/**
+ * Server side cache (cachedContents) of the fixed part of every board request: system instruction and few-shot examples.
+ * Created on Warm, refreshed before it expires and referenced by name in board requests, which then only ship the prompt.
+ * Whenever there's no usable handle the name is empty and requests inline the fixed part, as before.
+ */
+class SWEEPERPLUGIN_API FGeminiContextCache : public TSharedFromThis<FGeminiContextCache>
+{
+public:
+	/** Refresh this long before the expiration, so a board request never references an expired cache */
+	static constexpr double REFRESH_MARGIN_SECONDS = 120.0;
+	static constexpr float TICK_INTERVAL_SECONDS = 15.f;
+	static constexpr double RETRY_DELAY_SECONDS = 300.0;
+
+	~FGeminiContextCache();
+
+	/** Creates the cache if there's none and keeps it alive from now on */
+	void Warm();
+
+	/** Drops the handle, e.g. when a request using it was rejected. A new one is created on the next tick. */
+	void Invalidate();
+
+	/** @return cachedContents/... to reference in requests, empty when the fixed part has to be sent inline */
+	FString GetCachedContentName() const;
+
+private:
+	bool Tick(float DeltaTime);
+
+	void SendCreate();
+	void SendRefresh();
+	TSharedRef<IHttpRequest> CreateRequest(const FString& Url, const FString& Verb, TArray<uint8>&& Body);
+
+	void OnCreateCompleted(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
+	void OnRefreshCompleted(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
+	/** Reads name and expireTime of a CachedContent response */
+	bool ReadCachedContent(const FHttpResponsePtr& Response);
+	void OnCreateFailed(const FHttpResponsePtr& Response);
+
+private:
+	FString Name;
+	FDateTime ExpireTime;
+
+	// No create attempts before this, set after failures
+	FDateTime RetryTime;
+	bool bRequestPending = false;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+};
@@ -0,0 +1,63 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Appends JSON straight into a UTF-8 byte buffer, escaping strings on the way. */
+class SWEEPERPLUGIN_API FJsonUtf8Writer
+{
+public:
+	explicit FJsonUtf8Writer(TArray<uint8>& InBuffer);
+
+	/** Appends JSON as is, no escaping */
+	FJsonUtf8Writer& Raw(const ANSICHAR* Json);
+	FJsonUtf8Writer& Raw(TArrayView<const uint8> Json);
+	/** Appends Text as a quoted JSON string */
+	FJsonUtf8Writer& String(FStringView Text);
+	/** Appends Text escaped, without quotes: for string values split around a template */
+	FJsonUtf8Writer& Escaped(FStringView Text);
+
+private:
+	void AppendCodepoint(uint32 Codepoint);
+
+private:
+	TArray<uint8>& Buffer;
+};
+
+/**
+ * generateContent body for a board request.
+ * The fixed part (system instruction, few-shot examples and everything up to the user text) is serialized once and
+ * reused byte for byte. When it lives in a server side cache (see FGeminiContextCache) the body only references the
+ * cache and carries the user turn. Each request only escapes and appends the prompt.
+ */
+class SWEEPERPLUGIN_API FGeminiRequestBody
+{
+public:
+	struct FExample
+	{
+		const TCHAR* Request;
+		/** nullptr for a request out of Minesweeper scope */
+		const TCHAR* Board;
+	};
+
+	/** Shared with every provider, so they all get the same instructions */
+	static FString GetSystemInstruction();
+	static TArrayView<const FExample> GetFewShotExamples();
+	static const TArray<uint8>& GetPrefix();
+	static const TArray<uint8>& GetSuffix();
+	/** Rough token count of the fixed part, about 4 bytes of JSON per token */
+	static int32 EstimatePrefixTokens();
+
+	/** @param CachedContentName cachedContents/... holding the fixed part, empty to send it inline */
+	static void Build(FStringView Prompt, TArray<uint8>& OutBody, FStringView CachedContentName = FStringView());
+	/** cachedContents create body: the fixed part of every request, kept alive for TtlSeconds */
+	static void BuildCacheCreate(FStringView Model, int32 TtlSeconds, TArray<uint8>& OutBody);
+	/** cachedContents patch body, extends the expiration */
+	static void BuildCacheRefresh(int32 TtlSeconds, TArray<uint8>& OutBody);
+
+private:
+	static void WriteSystemInstruction(FJsonUtf8Writer& Writer);
+	/** Example turns, written as elements of "contents" followed by a comma */
+	static void WriteFewShotContents(FJsonUtf8Writer& Writer);
+};
@@ -0,0 +1,51 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+enum class EGeminiResponseResult : uint8
+{
+	Success,
+	/** Body is not valid JSON */
+	InvalidJson,
+	/** Valid JSON, but the text field is missing */
+	MissingText
+};
+
+/**
+ * Forward only reader of a generateContent response.
+ * Walks the UTF-8 body once, skipping everything but candidates[0].content.parts[0].text, and decodes that string
+ * straight into the output (newlines dropped and trimmed, as the board parser expects). No DOM, no intermediate strings.
+ * Reads OpenAI compatible chat completions (choices[0].message.content) the same way.
+ */
+class SWEEPERPLUGIN_API FGeminiResponseReader
+{
+public:
+	static EGeminiResponseResult ExtractFirstCandidateText(const uint8* Utf8, int64 Size, FString& OutText);
+	static EGeminiResponseResult ExtractFirstCandidateText(TArrayView<const uint8> Utf8, FString& OutText);
+	static EGeminiResponseResult ExtractFirstChoiceContent(TArrayView<const uint8> Utf8, FString& OutText);
+
+private:
+	struct FCursor
+	{
+		const uint8* Ptr;
+		const uint8* End;
+	};
+
+	/** Positions the cursor on the root object, false if the body can't be JSON */
+	static bool Begin(const uint8* Utf8, int64 Size, FCursor& OutCursor);
+	/** Cursor past the path lookups: decodes the string there */
+	static EGeminiResponseResult Finish(FCursor& Cursor, bool bFound, bool bError, FString& OutText);
+
+	static void SkipWhitespace(FCursor& Cursor);
+	static bool Consume(FCursor& Cursor, uint8 Char);
+	static bool SkipString(FCursor& Cursor);
+	static bool SkipValue(FCursor& Cursor);
+	/** Cursor on an object: moves to the value of Key and returns true, or past the object and returns false */
+	static bool FindMember(FCursor& Cursor, const ANSICHAR* Key, bool& bOutError);
+	/** Cursor on an array: moves to its first element, false when empty or not an array */
+	static bool EnterFirstElement(FCursor& Cursor);
+	static bool DecodeString(FCursor& Cursor, FString& OutText);
+	static void AppendCodepoint(FString& OutText, uint32 Codepoint);
+};
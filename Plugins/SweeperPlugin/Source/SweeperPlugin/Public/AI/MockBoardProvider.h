@@ -0,0 +1,37 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AI/BoardProvider.h"
+
+/**
+ * Offline provider: answers on the next tick (plus the simulated latency) with boards generated from the prompt.
+ * Reads the prompt like the board library (FMinesweeperBoardQuery::FromPrompt): "<Rows>x<Cols>", "<N> mines" or "<D>% density",
+ * defaults to 9x9. Prompts with no numbers and no Minesweeper words get the not related answer.
+ * Same seed and same prompts give the same boards, run after run.
+ */
+class SWEEPERPLUGIN_API FMockBoardProvider : public FBoardProviderBase
+{
+public:
+	static constexpr int32 DEFAULT_SIZE = 9;
+	static constexpr int32 MAX_SIZE = 30;
+
+	FMockBoardProvider();
+
+	virtual FText GetDisplayName() const override;
+
+	/** @param Index Boards already generated, so the same prompt twice gives two different boards */
+	static FString GenerateBoardText(const FString& Prompt, int32 Seed, int32 Index);
+
+	/** Overrides the latency from UAISettings: Seconds per request plus PerBoardSeconds per board */
+	void SetSimulatedLatency(float Seconds, float PerBoardSeconds);
+
+protected:
+	virtual void StartRequest(uint32 RequestId, const FString& Prompt, int32 NumBoards) override;
+
+private:
+	int32 NumGenerated = 0;
+	TOptional<float> LatencySeconds;
+	TOptional<float> LatencyPerBoardSeconds;
+};
@@ -0,0 +1,30 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AI/BoardProvider.h"
+#include "Interfaces/IHttpRequest.h"
+
+struct FHttpPhaseTimings;
+
+/**
+ * Boards from an OpenAI compatible /chat/completions endpoint, typically a model served on localhost (llama.cpp, Ollama...).
+ * Same instructions and examples as Gemini, sent as system and chat turns.
+ */
+class SWEEPERPLUGIN_API FOpenAIBoardProvider : public FBoardProviderBase
+{
+public:
+	FOpenAIBoardProvider();
+
+	virtual FText GetDisplayName() const override;
+
+	static void BuildBody(FStringView Model, FStringView Prompt, TArray<uint8>& OutBody);
+
+protected:
+	virtual void StartRequest(uint32 RequestId, const FString& Prompt, int32 NumBoards) override;
+
+private:
+	void OnRequestCompleted(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful,
+		uint32 RequestId, TSharedRef<FHttpPhaseTimings> Timings);
+};
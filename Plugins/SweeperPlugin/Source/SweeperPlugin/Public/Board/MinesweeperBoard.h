@@ -0,0 +1,108 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Styling/SlateColor.h"
+
+struct FMinesweeperCell
+{
+	bool bIsBomb;
+	bool bDiscovered;
+	bool bFlagged;
+	int32 BombCount;
+	
+	FMinesweeperCell(bool _bIsBomb);
+	bool IsBomb() const;
+	bool IsEmpty() const;
+	bool IsDiscovered() const;
+	bool IsFlagged() const;
+	void Discover();
+	void IncrementBombCount();
+	int32 GetCount() const;
+	FText GetText() const;
+};
+
+/**
+ * Cells are stored row by row in one array, with a one cell border around the board.
+ * Border cells are discovered and never mines, so neighbour loops step by NeighbourDeltas with no bounds test:
+ * the flood fill stops on them like on any discovered cell. Ids outside the board (Row * Cols + Col) never see the border.
+ */
+struct FMinesweeperBoard
+{
+	typedef TArray<FMinesweeperCell> Board;
+	typedef TPair<int32, int32> Coordinate;
+	
+	Board PaddedCells;
+	int32 RowCount;
+	int32 ColCount;
+	int32 CellToDiscover;
+	int32 TotalBombCount;
+
+	// Cols + 2, distance between two rows of PaddedCells
+	int32 Stride;
+	// PaddedCells offsets of the neighbours, in GetAroundOffset order
+	int32 NeighbourDeltas[8];
+
+	/** Boards up to this many cells reserve their click scratch when sized, so no click allocates. Bigger boards grow it on demand */
+	static constexpr int32 SCRATCH_RESERVE_CELLS = 16384;
+
+	// Per board scratch reused by every click, so steady state play doesn't allocate
+	TArray<int32> ChangedIds;
+	
+	FMinesweeperBoard();
+	void Create(const FString& BoardText);
+	void Create(const int32 InRows, const int32 InCols, TArrayView<const int32> BombIds);
+	/** Sizes the board with hidden, empty cells inside the border */
+	void Init(const int32 InRows, const int32 InCols);
+	void Reset();
+	FString ToBoardText() const;
+	SIZE_T GetAllocatedSize() const;
+	int32 Rows() const;
+	int32 Cols() const;
+	int32 GetTotalBombCount() const;
+	bool IsDiscovered(const int32 Row, const int32 Column) const;
+	bool IsDiscovered(const int32 Index) const;
+	bool IsBomb(const int32 Row, const int32 Column) const;
+	bool IsBomb(const int32 Index) const;
+	int32 GetCount(const int32 Row, const int32 Column) const;
+	bool IsFlagged(const int32 Row, const int32 Column) const;
+	bool IsFlagged(const int32 Index) const;
+	/** Flags or unflags a hidden cell. @return false if the cell can't be flagged */
+	bool ToggleFlag(const int32 Row, const int32 Column);
+	/** @return Ids discovered by the call, flagged cells are left hidden. The view points into the board scratch buffer, valid until the next Discover/Reveal */
+	TArrayView<const int32> Discover(const int32 Row, const int32 Column);
+	/**
+	 * Opens the hidden, unflagged neighbours of a discovered number once as many neighbours are flagged, flood filling from empty ones.
+	 * Mines among them are left hidden and reported by bOutHitBomb: the caller ends the game.
+	 * @return Ids discovered by the call. The view points into the board scratch buffer, valid until the next Discover/Reveal
+	 */
+	TArrayView<const int32> Chord(const int32 Row, const int32 Column, bool& bOutHitBomb);
+	/** @return Ids revealed by the call. The view points into the board scratch buffer, valid until the next Discover/Reveal */
+	TArrayView<const int32> Reveal();
+	bool Exists(const int32 Row, const int32 Column) const;
+	bool Exists(const int32 Index) const;
+	FText GetCellText(const int32 Row, const int32 Column) const;
+	FText GetCellText(const int32 Index) const;
+	FSlateColor GetCellColor(const int32 Row, const int32 Column) const;
+	FSlateColor GetCellColor(const int32 Index) const;
+	static const TArray<Coordinate>& GetAroundOffset();
+	static const TMap<int32, FSlateColor>& GetAvailableCellColors();
+	bool HasWon() const;
+	FMinesweeperCell operator()(const int32 Row, const int32 Column) const;
+	FMinesweeperCell& operator()(const int32 Row, const int32 Column);
+	FMinesweeperCell operator()(const int32 Index) const;
+	FMinesweeperCell& operator()(const int32 Index);
+
+	/** First cell of a row, the row's Cols() cells follow. Row must exist */
+	FMinesweeperCell* GetRowData(const int32 Row);
+	const FMinesweeperCell* GetRowData(const int32 Row) const;
+
+	int32 ToPaddedIndex(const int32 Row, const int32 Column) const { return (Row + 1) * Stride + Column + 1; }
+	int32 ToPaddedIndex(const int32 Index) const { return Index + (Index / ColCount) * 2 + Stride + 1; }
+	int32 ToCellId(const int32 PaddedIndex) const { return (PaddedIndex / Stride - 1) * ColCount + PaddedIndex % Stride - 1; }
+
+private:
+	/** Flood fills from the padded indexes queued in ChangedIds, then turns them into ids */
+	void FloodFillChanged();
+};
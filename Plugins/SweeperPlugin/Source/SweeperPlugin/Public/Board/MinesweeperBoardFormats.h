@@ -0,0 +1,76 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FMinesweeperBoard;
+
+enum class EMinesweeperBoardFormat : uint8
+{
+	/** "0,1,0|1,0,0", the format of generated boards (.txt, .board) */
+	BoardText,
+	/** "RowsxCols" line, then one "Row,Col" line per mine, '#' comments (.mines) */
+	Coordinates,
+	/** Golly style run length encoding: "x = Cols, y = Rows" header, 'b' empty, 'o' mine, '$' end of row, '!' end (.rle) */
+	Rle,
+	/** "MSBP", version, rows and cols as uint32 little endian, then one bit per cell row major, low bit first (.msb) */
+	BitPacked,
+	Unknown
+};
+
+/** Size and mines of a board, what every format stores: no play state */
+struct FMinesweeperLayout
+{
+	int32 Rows = 0;
+	int32 Cols = 0;
+	/** Row * Cols + Col, sorted */
+	TArray<int32> MineIds;
+
+	bool IsValid() const { return Rows > 0 && Cols > 0; }
+};
+
+/**
+ * Importers and exporters of board layouts. Every reader is a single pass over the raw bytes,
+ * no intermediate strings, so directories of boards convert at disk speed (see UMinesweeperConvertCommandlet).
+ */
+struct SWEEPERPLUGIN_API FMinesweeperBoardFormats
+{
+	/** Largest side accepted on import */
+	static constexpr int32 MAX_SIDE = 4096;
+
+	static bool Import(TArrayView<const uint8> Bytes, EMinesweeperBoardFormat Format, FMinesweeperLayout& OutLayout, FString* OutError = nullptr);
+	static void Export(const FMinesweeperLayout& Layout, EMinesweeperBoardFormat Format, TArray<uint8>& OutBytes);
+
+	/** Guesses the format from the content */
+	static EMinesweeperBoardFormat Detect(TArrayView<const uint8> Bytes);
+	static EMinesweeperBoardFormat FromExtension(const FString& Path);
+	static EMinesweeperBoardFormat FromName(const FString& Name);
+	/** Extension without the dot */
+	static const TCHAR* GetExtension(EMinesweeperBoardFormat Format);
+
+	/** Layout of boards kept as text (provider answers, prompt cache) */
+	static bool FromBoardText(const FString& BoardText, FMinesweeperLayout& OutLayout);
+	static FString ToBoardText(const FMinesweeperLayout& Layout);
+
+	static void FromBoard(const FMinesweeperBoard& Board, FMinesweeperLayout& OutLayout);
+	static void ToBoard(const FMinesweeperLayout& Layout, FMinesweeperBoard& OutBoard);
+
+	/** Format from the extension, detected from the content when the extension is unknown. OutError says why it failed */
+	static bool LoadFromFile(const FString& Path, FMinesweeperLayout& OutLayout, FString* OutError = nullptr);
+	/** Format from the extension, board text when unknown. OutError says why it failed */
+	static bool SaveToFile(const FString& Path, const FMinesweeperLayout& Layout, FString* OutError = nullptr);
+
+private:
+	static bool ImportBoardText(TArrayView<const uint8> Bytes, FMinesweeperLayout& OutLayout, FString& OutError);
+	static bool ImportCoordinates(TArrayView<const uint8> Bytes, FMinesweeperLayout& OutLayout, FString& OutError);
+	static bool ImportRle(TArrayView<const uint8> Bytes, FMinesweeperLayout& OutLayout, FString& OutError);
+	static bool ImportBitPacked(TArrayView<const uint8> Bytes, FMinesweeperLayout& OutLayout, FString& OutError);
+
+	static void ExportBoardText(const FMinesweeperLayout& Layout, TArray<uint8>& OutBytes);
+	static void ExportCoordinates(const FMinesweeperLayout& Layout, TArray<uint8>& OutBytes);
+	static void ExportRle(const FMinesweeperLayout& Layout, TArray<uint8>& OutBytes);
+	static void ExportBitPacked(const FMinesweeperLayout& Layout, TArray<uint8>& OutBytes);
+
+	static bool CheckSize(int32 Rows, int32 Cols, FString& OutError);
+};
@@ -0,0 +1,144 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FMinesweeperLayout;
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/** Boards wanted from the library, zero or negative bounds are open */
+struct SWEEPERPLUGIN_API FMinesweeperBoardQuery
+{
+	int32 Rows = 0;
+	int32 Cols = 0;
+	int32 MinMines = 0;
+	int32 MaxMines = 0;
+	float MinDensity = 0.f;
+	float MaxDensity = 0.f;
+	int32 Min3BV = 0;
+	int32 Max3BV = 0;
+	bool bUnplayedOnly = true;
+
+	/**
+	 * Reads a query from a prompt: "<Rows>x<Cols>", "<N> mines", "3BV <A>-<B>" or "3BV between <A> and <B>", "<D>% density".
+	 * OutQuery holds the terms read even when it returns false, e.g. for a provider generating boards from them.
+	 * @return false without a size, or when the prompt asks for anything else ("9x9 shaped like a heart"): those are left to the board provider
+	 */
+	static bool FromPrompt(const FString& Prompt, FMinesweeperBoardQuery& OutQuery);
+};
+
+/**
+ * Every generated board, on disk, queried by size, mines, density and difficulty (3BV: clicks needed to clear the board).
+ * Two append-only files in the library directory:
+ * - Boards.dat: the boards, bit packed (FMinesweeperBoardFormats::BitPacked), one after the other
+ * - Boards.idx: a header then one fixed size FEntry per board
+ * Queries read the entries straight from the memory-mapped index, nothing is parsed. Writes (new boards, played flags)
+ * release the mapping, write the file and map it again, so the mapping is never shared with a writer.
+ * Boards are grouped per size and sorted by 3BV, so a query is a map lookup, a binary search and a short scan.
+ * A crash mid append leaves at most an orphan record: the board is written before its index entry.
+ */
+class SWEEPERPLUGIN_API FMinesweeperBoardLibrary
+{
+public:
+	static constexpr uint32 MAGIC = 0x494C534D; // "MSLI"
+	static constexpr uint16 VERSION = 1;
+
+	struct FEntry
+	{
+		uint64 Offset;
+		uint32 Size;
+		uint16 Rows;
+		uint16 Cols;
+		uint32 Mines;
+		uint32 ThreeBV;
+		uint32 Checksum;
+		uint32 Flags;
+	};
+	static_assert(sizeof(FEntry) == 32, "Index entries are read straight from the mapped file");
+
+	static constexpr uint32 PLAYED_FLAG = 1 << 0;
+
+	FMinesweeperBoardLibrary() = default;
+	~FMinesweeperBoardLibrary();
+
+	FMinesweeperBoardLibrary(const FMinesweeperBoardLibrary&) = delete;
+	FMinesweeperBoardLibrary& operator=(const FMinesweeperBoardLibrary&) = delete;
+
+	static FString GetDefaultDirectory();
+
+	/** Opens or creates the library in Directory */
+	bool Open(const FString& Directory);
+	void Close();
+	bool IsOpen() const;
+
+	/** @return Index of the board, the existing one if already stored, INDEX_NONE on failure */
+	int32 Add(const FMinesweeperLayout& Layout, bool bPlayed = false);
+	/** Same as Add for each layout, the index is written and mapped once. @return Boards added */
+	int32 Add(TArrayView<const FMinesweeperLayout> Layouts, bool bPlayed = false, TArray<int32>* OutIndexes = nullptr);
+	/** @return Index of the first board matching, lowest 3BV first, INDEX_NONE if none */
+	int32 Find(const FMinesweeperBoardQuery& Query) const;
+	/** Find, Load and MarkPlayed in one call */
+	bool Take(const FMinesweeperBoardQuery& Query, FMinesweeperLayout& OutLayout);
+
+	bool Load(int32 Index, FMinesweeperLayout& OutLayout) const;
+	void MarkPlayed(int32 Index);
+	/** Marks the stored copy of Layout played, if any */
+	void MarkPlayed(const FMinesweeperLayout& Layout);
+	bool IsPlayed(int32 Index) const;
+
+	int32 Num() const;
+	/** Points into the mapped index, valid until the next Add or MarkPlayed */
+	const FEntry& GetEntry(int32 Index) const;
+	int32 GetNumUnplayed() const;
+	SIZE_T GetAllocatedSize() const;
+
+	/** Number of clicks to clear the board without flags: one per opening plus one per number not bordering an opening */
+	static int32 Compute3BV(const FMinesweeperLayout& Layout);
+
+private:
+	struct FHeader
+	{
+		uint32 Magic;
+		uint16 Version;
+		uint16 EntrySize;
+		uint32 Reserved[2];
+	};
+	static_assert(sizeof(FHeader) == 16, "Index header is read straight from the mapped file");
+
+	static uint32 MakeSizeKey(int32 Rows, int32 Cols) { return (static_cast<uint32>(Rows) << 16) | static_cast<uint32>(Cols); }
+	/** Maps the index, or loads it when the platform can't map files */
+	bool MapIndex();
+	void UnmapIndex();
+	/** Writes at Offset of the index file, Offset past the entries appends */
+	bool WriteIndex(int64 Offset, const void* Data, int64 Size);
+	/** Bit packed board as stored, checked against the entry checksum */
+	bool ReadRecord(int32 Index, TArray<uint8>& OutRecord) const;
+	/** Index of the board stored as Record, INDEX_NONE if none */
+	int32 FindRecord(TArrayView<const uint8> Record, uint32 Checksum) const;
+	/** Adds the entries from FirstIndex on to the size and checksum lookups */
+	void IndexEntries(int32 FirstIndex);
+	bool Matches(const FEntry& Entry, const FMinesweeperBoardQuery& Query) const;
+
+private:
+	FString DataPath;
+	FString IndexPath;
+
+	TUniquePtr<IMappedFileHandle> MappedIndex;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+	// Index copy used when mapping fails
+	TArray<FEntry> LoadedEntries;
+	const FEntry* Entries = nullptr;
+	int32 NumEntries = 0;
+
+	TUniquePtr<IFileHandle> DataWriter;
+	mutable TUniquePtr<IFileHandle> DataReader;
+
+	int32 NumPlayed = 0;
+	// Board indexes per size (MakeSizeKey), sorted by 3BV
+	TMap<uint32, TArray<int32>> BySize;
+	// Board indexes per checksum, to skip duplicates
+	TMultiMap<uint32, int32> ByChecksum;
+};
@@ -0,0 +1,65 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FMinesweeperBoard;
+
+/**
+ * Mip pyramid of a board for overviews: level 0 sums blocks of 2x2 cells, each next level sums 2x2 blocks of the previous one,
+ * down to a single block. Every block counts its cells, discovered cells and mines.
+ * Built once per board, then kept up to date from the change sets of clicks and undo/redo: only the blocks above
+ * the changed ids are recounted, so drawing the whole board zoomed out reads a level about the size of the view, not the cells.
+ */
+class SWEEPERPLUGIN_API FMinesweeperBoardPyramid
+{
+public:
+	struct FBlock
+	{
+		int32 Cells = 0;
+		int32 Discovered = 0;
+		int32 Mines = 0;
+
+		float GetRevealedFraction() const { return Cells > 0? static_cast<float>(Discovered) / Cells : 0.f; }
+		float GetMineDensity() const { return Cells > 0? static_cast<float>(Mines) / Cells : 0.f; }
+	};
+
+	struct FLevel
+	{
+		int32 Rows = 0;
+		int32 Cols = 0;
+		// Side of a block, in board cells
+		int32 BlockSize = 0;
+		TArray<FBlock> Blocks;
+	};
+
+	/** Counts every cell of Board, O(cells) */
+	void Build(const FMinesweeperBoard& Board);
+	void Reset();
+
+	/** Recounts the blocks above ChangedIds, in any order, duplicates allowed */
+	void Update(const FMinesweeperBoard& Board, TArrayView<const int32> ChangedIds);
+
+	int32 NumLevels() const;
+	const FLevel& GetLevel(int32 Level) const;
+	/** Finest level fitting MaxRows x MaxCols blocks, INDEX_NONE without a board */
+	int32 FindLevel(int32 MaxRows, int32 MaxCols) const;
+	int32 GetBoardRows() const;
+	int32 GetBoardCols() const;
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	void BuildFromChildren(int32 Level);
+	FBlock SumChildren(int32 Level, int32 Row, int32 Col) const;
+	static void SortUnique(TArray<int32>& Ids);
+
+private:
+	TArray<FLevel> Levels;
+	int32 BoardRows = 0;
+	int32 BoardCols = 0;
+
+	// Dirty block indexes of the level being updated and of the next one, reused by every Update
+	TArray<int32> DirtyBlocks;
+	TArray<int32> NextDirtyBlocks;
+};
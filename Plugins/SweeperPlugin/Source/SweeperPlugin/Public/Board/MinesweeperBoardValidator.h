@@ -0,0 +1,53 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Size and density a generated board must respect to be played */
+struct FMinesweeperBoardLimits
+{
+	int32 MinSize = 2;
+	int32 MaxSize = 64;
+	int32 MinMines = 1;
+	/** Keeps the board playable, an all-mine grid is lost on the first click */
+	float MaxMineDensity = 0.6f;
+	/** Size of the board generated locally when nothing usable came back */
+	int32 FallbackSize = 9;
+	float FallbackMineDensity = 0.15f;
+};
+
+/** What FMinesweeperBoardValidator had to fix */
+struct SWEEPERPLUGIN_API FMinesweeperBoardRepairs
+{
+	bool bStrippedFences = false;
+	int32 StrayCharacters = 0;
+	int32 PaddedRows = 0;
+	int32 TruncatedRows = 0;
+	bool bClampedSize = false;
+	int32 AddedMines = 0;
+	int32 RemovedMines = 0;
+	bool bRegenerated = false;
+
+	bool HasRepairs() const;
+	/** e.g. "stripped markdown fences, padded 2 rows, removed 40 mines", empty without repairs */
+	FString ToString() const;
+};
+
+/**
+ * Turns whatever text came back from the model into a board Create can trust, without another request.
+ * A single pass reads cells ('1' mine, '0' empty, commas optional) and rows ('|'), skipping fences and any
+ * other character. Ragged rows are padded or truncated to the most common width, size is clamped, mine count is
+ * brought within limits by adding or removing mines at random, and a board is generated locally when nothing is usable.
+ * Repairs are deterministic: the same text always gives the same board.
+ */
+class SWEEPERPLUGIN_API FMinesweeperBoardValidator
+{
+public:
+	/** @return Board text in the canonical "0,1,0|1,0,0" form */
+	static FString Normalize(FStringView Text, FMinesweeperBoardRepairs& OutRepairs, const FMinesweeperBoardLimits& Limits = FMinesweeperBoardLimits());
+
+private:
+	static void Regenerate(int32 Rows, int32 Cols, int32 Mines, FRandomStream& Random, TArray<uint8>& OutCells);
+	static FString ToBoardText(TArrayView<const uint8> Cells, int32 Rows, int32 Cols);
+};
@@ -0,0 +1,244 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+#include <array>
+
+struct FMinesweeperNeighbourList
+{
+	uint16 Ids[8];
+	int32 Num;
+};
+
+/** Ids around every cell of a Rows x Cols board, in FMinesweeperBoard::GetAroundOffset order, built by the compiler */
+template<int32 InRows, int32 InCols>
+struct TMinesweeperNeighbourTable
+{
+	std::array<FMinesweeperNeighbourList, InRows * InCols> Lists;
+
+	constexpr TMinesweeperNeighbourTable()
+		: Lists{}
+	{
+		constexpr int32 Offsets[8][2] = { {-1, -1}, {-1, 0}, {-1, 1}, {0, 1}, {1, 1}, {1, 0}, {1, -1}, {0, -1} };
+		for (int32 Id = 0; Id < InRows * InCols; ++Id)
+		{
+			FMinesweeperNeighbourList& List = Lists[Id];
+			for (const auto& Offset : Offsets)
+			{
+				const int32 Row = Id / InCols + Offset[0];
+				const int32 Column = Id % InCols + Offset[1];
+				if (Row >= 0 && Row < InRows && Column >= 0 && Column < InCols)
+				{
+					List.Ids[List.Num++] = static_cast<uint16>(Row * InCols + Column);
+				}
+			}
+		}
+	}
+};
+
+/**
+ * Board with its size known at compile time, for the standard sizes (9x9, 16x16, 16x30).
+ * One byte per cell in a std::array (count, mine and discovered bits) and a constexpr neighbour table,
+ * so loops have constant bounds, need no bounds checks and inline completely.
+ * Same read API as FMinesweeperBoard: code templated on the board type works with both, see MinesweeperFixedBoard::Dispatch.
+ */
+template<int32 InRows, int32 InCols>
+class TMinesweeperFixedBoard
+{
+public:
+	static constexpr int32 ROWS = InRows;
+	static constexpr int32 COLS = InCols;
+	static constexpr int32 CELL_COUNT = InRows * InCols;
+	static_assert(InRows > 0 && InCols > 0 && CELL_COUNT <= MAX_uint16, "Fixed boards store neighbour ids as uint16");
+
+	TMinesweeperFixedBoard()
+	{
+		Cells.fill(0);
+		ChangedIds.Reserve(CELL_COUNT);
+	}
+
+	/** Sizes are checked, not used: they are in the type */
+	void Create(const int32 InRowCount, const int32 InColCount, TArrayView<const int32> BombIds)
+	{
+		check(InRowCount == InRows && InColCount == InCols);
+
+		Cells.fill(0);
+		TotalBombCount = 0;
+		for (const int32 BombId : BombIds)
+		{
+			if (!Exists(BombId) || (Cells[BombId] & BOMB_BIT) != 0)
+			{
+				continue;
+			}
+
+			Cells[BombId] |= BOMB_BIT;
+			TotalBombCount++;
+
+			const FNeighbourList& Neighbours = NEIGHBOURS.Lists[BombId];
+			for (int32 i = 0; i < Neighbours.Num; ++i)
+			{
+				Cells[Neighbours.Ids[i]]++;
+			}
+		}
+
+		CellToDiscover = CELL_COUNT - TotalBombCount;
+	}
+
+	void Reset()
+	{
+		for (uint8& Cell : Cells)
+		{
+			Cell &= ~DISCOVERED_BIT;
+		}
+		CellToDiscover = CELL_COUNT - TotalBombCount;
+	}
+
+	constexpr int32 Rows() const { return InRows; }
+	constexpr int32 Cols() const { return InCols; }
+	int32 GetTotalBombCount() const { return TotalBombCount; }
+	bool HasWon() const { return CellToDiscover <= 0; }
+
+	static constexpr bool Exists(const int32 Row, const int32 Column)
+	{
+		return static_cast<uint32>(Row) < static_cast<uint32>(InRows) && static_cast<uint32>(Column) < static_cast<uint32>(InCols);
+	}
+	static constexpr bool Exists(const int32 Index) { return static_cast<uint32>(Index) < static_cast<uint32>(CELL_COUNT); }
+
+	bool IsDiscovered(const int32 Index) const { return Exists(Index) && (Cells[Index] & DISCOVERED_BIT) != 0; }
+	bool IsDiscovered(const int32 Row, const int32 Column) const { return Exists(Row, Column) && (Cells[Row * InCols + Column] & DISCOVERED_BIT) != 0; }
+	bool IsBomb(const int32 Index) const { return Exists(Index) && (Cells[Index] & BOMB_BIT) != 0; }
+	bool IsBomb(const int32 Row, const int32 Column) const { return Exists(Row, Column) && (Cells[Row * InCols + Column] & BOMB_BIT) != 0; }
+	int32 GetCount(const int32 Row, const int32 Column) const { return Exists(Row, Column)? Cells[Row * InCols + Column] & COUNT_MASK : 0; }
+
+	/** @return Ids discovered by the call. The view points into the board scratch buffer, valid until the next Discover/Reveal */
+	TArrayView<const int32> Discover(const int32 Row, const int32 Column)
+	{
+		ChangedIds.Reset();
+		if (!Exists(Row, Column))
+		{
+			return ChangedIds;
+		}
+
+		const int32 Id = Row * InCols + Column;
+		if ((Cells[Id] & DISCOVERED_BIT) != 0)
+		{
+			return ChangedIds;
+		}
+
+		Cells[Id] |= DISCOVERED_BIT;
+		ChangedIds.Add(Id);
+		if ((Cells[Id] & BOMB_BIT) != 0)
+		{
+			return ChangedIds;
+		}
+
+		// Same flood fill as FMinesweeperBoard. Neighbours of an empty cell are never mines, only the discovered bit is tested
+		for (int32 Head = 0; Head < ChangedIds.Num(); ++Head)
+		{
+			const int32 Current = ChangedIds[Head];
+			if ((Cells[Current] & COUNT_MASK) != 0)
+			{
+				continue;
+			}
+
+			const FNeighbourList& Neighbours = NEIGHBOURS.Lists[Current];
+			for (int32 i = 0; i < Neighbours.Num; ++i)
+			{
+				const int32 Adjacent = Neighbours.Ids[i];
+				if ((Cells[Adjacent] & DISCOVERED_BIT) == 0)
+				{
+					Cells[Adjacent] |= DISCOVERED_BIT;
+					ChangedIds.Add(Adjacent);
+				}
+			}
+		}
+
+		CellToDiscover = FMath::Max(0, CellToDiscover - ChangedIds.Num());
+		return ChangedIds;
+	}
+
+	/** @return Ids revealed by the call. The view points into the board scratch buffer, valid until the next Discover/Reveal */
+	TArrayView<const int32> Reveal()
+	{
+		ChangedIds.Reset();
+		for (int32 Id = 0; Id < CELL_COUNT; ++Id)
+		{
+			if ((Cells[Id] & DISCOVERED_BIT) == 0)
+			{
+				Cells[Id] |= DISCOVERED_BIT;
+				ChangedIds.Add(Id);
+			}
+		}
+
+		return ChangedIds;
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return ChangedIds.GetAllocatedSize();
+	}
+
+private:
+	static constexpr uint8 COUNT_MASK = 0x0F;
+	static constexpr uint8 BOMB_BIT = 0x10;
+	static constexpr uint8 DISCOVERED_BIT = 0x20;
+
+	using FNeighbourList = FMinesweeperNeighbourList;
+	static constexpr TMinesweeperNeighbourTable<InRows, InCols> NEIGHBOURS{};
+
+	std::array<uint8, CELL_COUNT> Cells;
+	int32 CellToDiscover = 0;
+	int32 TotalBombCount = 0;
+
+	// Scratch reused by every click, sized once for the whole board
+	TArray<int32> ChangedIds;
+};
+
+namespace MinesweeperFixedBoard
+{
+	using FBeginner = TMinesweeperFixedBoard<9, 9>;
+	using FIntermediate = TMinesweeperFixedBoard<16, 16>;
+	using FExpert = TMinesweeperFixedBoard<16, 30>;
+	/** Expert board asked as 30 rows of 16 */
+	using FExpertTall = TMinesweeperFixedBoard<30, 16>;
+
+	template<typename TBoard>
+	struct TBoardType
+	{
+		using Type = TBoard;
+	};
+
+	inline bool IsStandardSize(const int32 Rows, const int32 Cols)
+	{
+		return (Rows == 9 && Cols == 9) || (Rows == 16 && Cols == 16) || (Rows == 16 && Cols == 30) || (Rows == 30 && Cols == 16);
+	}
+
+	/**
+	 * Calls Functor with the board type matching the size: a fixed board for the standard sizes, TFallback otherwise.
+	 * Functor is a generic lambda receiving a TBoardType, e.g. [](auto BoardType) { typename decltype(BoardType)::Type Board; }
+	 */
+	template<typename TFallback, typename TFunctor>
+	auto Dispatch(const int32 Rows, const int32 Cols, TFunctor&& Functor)
+	{
+		if (Rows == 9 && Cols == 9)
+		{
+			return Functor(TBoardType<FBeginner>());
+		}
+		if (Rows == 16 && Cols == 16)
+		{
+			return Functor(TBoardType<FIntermediate>());
+		}
+		if (Rows == 16 && Cols == 30)
+		{
+			return Functor(TBoardType<FExpert>());
+		}
+		if (Rows == 30 && Cols == 16)
+		{
+			return Functor(TBoardType<FExpertTall>());
+		}
+
+		return Functor(TBoardType<TFallback>());
+	}
+}
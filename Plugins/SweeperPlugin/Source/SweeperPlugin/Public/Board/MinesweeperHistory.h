@@ -0,0 +1,63 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FMinesweeperBoard;
+
+/**
+ * Unlimited undo/redo of board clicks.
+ * Each move stores only the cells it discovered, as sorted runs of consecutive ids, plus the counters before and after it.
+ * Recorded data grows with the changed cells (a flood fill collapses into roughly one run per row). Reset reserves storage for
+ * a whole game on boards up to FMinesweeperBoard::SCRATCH_RESERVE_CELLS, so recording moves doesn't allocate.
+ */
+class SWEEPERPLUGIN_API FMinesweeperHistory
+{
+public:
+	struct FIdRun
+	{
+		int32 Start;
+		int32 Num;
+	};
+
+	struct FMove
+	{
+		int32 FirstRun;
+		int32 NumRuns;
+		int32 CellToDiscoverBefore;
+		int32 CellToDiscoverAfter;
+		bool bEndedGame;
+	};
+
+	/** Clears the history and reserves it for a board of CellCount cells (up to FMinesweeperBoard::SCRATCH_RESERVE_CELLS), so recording moves doesn't allocate */
+	void Reset(int32 CellCount = 0);
+
+	/** Records a move done on Board. ChangedIds are the ids discovered by the move, in any order. */
+	void Record(TArrayView<const int32> ChangedIds, int32 CellToDiscoverBefore, int32 CellToDiscoverAfter, bool bEndedGame);
+
+	bool CanUndo() const;
+	bool CanRedo() const;
+
+	/** Hides again the cells of the last move. @return The move undone, nullptr if nothing to undo */
+	const FMove* Undo(FMinesweeperBoard& Board);
+	/** Discovers again the cells of the last undone move, dropping flags put on them since. @return The move redone, nullptr if nothing to redo */
+	const FMove* Redo(FMinesweeperBoard& Board);
+
+	TArrayView<const FIdRun> GetRuns(const FMove& Move) const;
+	int32 Num() const;
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	void ApplyRuns(FMinesweeperBoard& Board, const FMove& Move, bool bDiscovered) const;
+
+private:
+	TArray<FIdRun> Runs;
+	TArray<FMove> Moves;
+
+	// Sorting scratch, reused by every Record
+	TArray<int32> SortedIds;
+
+	// Moves before the cursor are applied, moves from the cursor on can be redone
+	int32 Cursor = 0;
+};
@@ -0,0 +1,63 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FMinesweeperBoard;
+
+enum class EMinesweeperCommand : uint8
+{
+	Discover,
+	Chord,
+	ToggleFlag
+};
+
+enum class EMinesweeperCommandResult : uint8
+{
+	Unchanged,
+	Changed,
+	Won,
+	Lost
+};
+
+struct FMinesweeperCommand
+{
+	EMinesweeperCommand Type;
+	int32 Id;
+	/** FPlatformTime::Seconds() when the input arrived */
+	double InputTime;
+};
+
+/**
+ * Board commands received during a frame, applied together once per frame.
+ * Repeated clicks coalesce while queued, only when it can't change the outcome of the commands in between:
+ * a second Discover of a cell is dropped unless the cell's flag was toggled since, a second Chord of a cell is dropped
+ * if only chords were queued since, a second ToggleFlag of a cell cancels the first one if only flags were toggled since.
+ */
+class SWEEPERPLUGIN_API FMinesweeperInputQueue
+{
+public:
+	/**
+	 * Applies a command with the game rules: a mine ends the game and reveals the board, the last safe cell wins it and reveals the board.
+	 * Shared by the board widget and the co-op session, so every copy of a board ends in the same state.
+	 * @param OutChangedIds Appended with the ids whose state changed
+	 */
+	static EMinesweeperCommandResult Apply(FMinesweeperBoard& Board, EMinesweeperCommand Type, int32 Id, TArray<int32>& OutChangedIds);
+
+	/** @return false if the command was coalesced with a queued one */
+	bool Push(EMinesweeperCommand Type, int32 Id, double InputTime);
+	/** Moves the queued commands to OutCommands, in input order */
+	void Flush(TArray<FMinesweeperCommand>& OutCommands);
+	void Reset();
+
+	bool IsEmpty() const;
+	int32 Num() const;
+	/** Commands dropped or cancelled since the last Reset */
+	int32 GetNumCoalesced() const;
+
+private:
+	// A frame holds a handful of commands, a linear scan beats any lookup structure
+	TArray<FMinesweeperCommand> Commands;
+	int32 NumCoalesced = 0;
+};
@@ -0,0 +1,51 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FMinesweeperBoard;
+
+/**
+ * Versioned binary snapshot of a board in progress.
+ * Layout: fixed size header followed by one packed byte per cell (row major).
+ * The payload is validated with a CRC32 before being used, and loading memory-maps the file
+ * so restoring a huge board is a single pass over the mapped bytes: no string parsing, no bomb recount.
+ * The header counters are only informative, the same pass recounts them from the cells.
+ */
+struct SWEEPERPLUGIN_API FMinesweeperSnapshot
+{
+	static constexpr uint32 MAGIC = 0x5057534D; // "MSWP"
+	static constexpr uint16 VERSION = 1;
+
+	// Packed cell layout
+	static constexpr uint8 COUNT_MASK = 0x0F;
+	static constexpr uint8 BOMB_BIT = 1 << 4;
+	static constexpr uint8 DISCOVERED_BIT = 1 << 5;
+	static constexpr uint8 FLAGGED_BIT = 1 << 6;
+
+	struct FHeader
+	{
+		uint32 Magic = MAGIC;
+		uint16 Version = VERSION;
+		uint16 HeaderSize = 0;
+		int32 RowCount = 0;
+		int32 ColCount = 0;
+		int32 CellToDiscover = 0;
+		int32 TotalBombCount = 0;
+		int64 PayloadSize = 0;
+		uint32 PayloadChecksum = 0;
+
+		friend FArchive& operator<<(FArchive& Ar, FHeader& Header);
+	};
+
+	/** @param Slot Tab slot (FMinesweeperManager), each open tab resumes its own game */
+	static FString GetDefaultSnapshotPath(int32 Slot = 0);
+
+	static void Write(const FMinesweeperBoard& Board, TArray<uint8>& OutBytes);
+	static bool Read(const uint8* Data, int64 Size, FMinesweeperBoard& OutBoard);
+
+	static bool SaveToFile(const FMinesweeperBoard& Board, const FString& Path);
+	static bool LoadFromFile(const FString& Path, FMinesweeperBoard& OutBoard);
+	static bool DeleteFile(const FString& Path);
+};
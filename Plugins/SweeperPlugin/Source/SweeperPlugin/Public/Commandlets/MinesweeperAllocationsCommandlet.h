@@ -0,0 +1,25 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MinesweeperAllocationsCommandlet.generated.h"
+
+/**
+ * Counts heap allocations done by clicks in steady state play, fails if there's any.
+ * Plays solver games through the same path as the board widget (input queue, FMinesweeperInputQueue::Apply, undo history),
+ * with flags, chords and undo/redo mixed in. Allocations are counted by a GMalloc wrapper, on this thread only,
+ * while clicks are applied: picking cells and creating boards are not clicks. The first games warm the buffers up.
+ * UnrealEditor-Cmd mAInesweeper.uproject -run=MinesweeperAllocations [-Rows=16] [-Cols=30] [-Mines=99] [-Games=1000] [-WarmUp=10] [-Seed=0]
+ */
+UCLASS()
+class SWEEPERPLUGIN_API UMinesweeperAllocationsCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMinesweeperAllocationsCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,24 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MinesweeperConvertCommandlet.generated.h"
+
+/**
+ * Converts board files between the formats of FMinesweeperBoardFormats, files spread over the task graph workers.
+ * The input format comes from each file extension (content detection when unknown) unless -From is given.
+ * Formats: text (.txt/.board), mines (.mines), rle (.rle), bits (.msb)
+ *     UnrealEditor-Cmd mAInesweeper.uproject -run=MinesweeperConvert -Input=Dir/Or/File -Output=Dir -To=rle [-From=text] [-Recursive]
+ */
+UCLASS()
+class SWEEPERPLUGIN_API UMinesweeperConvertCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMinesweeperConvertCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,26 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MinesweeperCoopCommandlet.generated.h"
+
+/**
+ * Runs co-op sessions (FMinesweeperCoopSession) without the editor UI.
+ * Two processes on one machine, the client playing random actions, both log the board checksum at the end:
+ *     UnrealEditor-Cmd mAInesweeper.uproject -run=MinesweeperCoop -Role=Host [-Port=7777] [-Rows=64] [-Cols=64] [-Density=0.1] [-Duration=30]
+ *     UnrealEditor-Cmd mAInesweeper.uproject -run=MinesweeperCoop -Role=Client [-Address=127.0.0.1] [-Port=7777] [-ActionsPerTick=4] [-Duration=20]
+ * Throughput of deltas/sec, host and clients in one process over loopback:
+ *     UnrealEditor-Cmd mAInesweeper.uproject -run=MinesweeperCoop -Role=Benchmark [-Clients=2] [-Deltas=1000000] [-Budget=65536] [-Rows=1000] [-Cols=1000]
+ */
+UCLASS()
+class SWEEPERPLUGIN_API UMinesweeperCoopCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMinesweeperCoopCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,26 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MinesweeperFuzzCommandlet.generated.h"
+
+/**
+ * Property test of the board model: random board strings (malformed ones too) and mine lists go through Create,
+ * random click sequences through Discover, ToggleFlag, Chord and Reveal, and every step is checked against a brute force oracle:
+ * counts match a recount, changed ids are unique, in range and were hidden, the win condition matches, the text round trips.
+ * Standard sizes replay their clicks on TMinesweeperFixedBoard too. Every case is seeded from -Seed and its index,
+ * failures print the -Case that replays them with a trace of every step.
+ * UnrealEditor-Cmd mAInesweeper.uproject -run=MinesweeperFuzz [-Cases=1000000] [-Seconds=0] [-Seed=0] [-MaxSize=24] [-MaxClicks=16] [-Workers=0] [-Case=N]
+ */
+UCLASS()
+class SWEEPERPLUGIN_API UMinesweeperFuzzCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMinesweeperFuzzCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
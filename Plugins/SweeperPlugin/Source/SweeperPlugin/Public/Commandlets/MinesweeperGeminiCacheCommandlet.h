@@ -0,0 +1,25 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MinesweeperGeminiCacheCommandlet.generated.h"
+
+/**
+ * End to end run of the Gemini connection and context cache against a local stand-in of the endpoints (HTTP server in the same process):
+ * no ping without an API key, warm-up making the first request as quick to connect as later ones, keep-alive pings stopped by CoolDown,
+ * cache creation, a request referencing it, refresh before expiration, fallback to the full prompt when the server dropped
+ * the cache, no retry after a permanent creation failure, and no creation at all below the model's minimum cacheable size.
+ * UnrealEditor-Cmd mAInesweeper.uproject -run=MinesweeperGeminiCache [-Port=8099]
+ */
+UCLASS()
+class SWEEPERPLUGIN_API UMinesweeperGeminiCacheCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMinesweeperGeminiCacheCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
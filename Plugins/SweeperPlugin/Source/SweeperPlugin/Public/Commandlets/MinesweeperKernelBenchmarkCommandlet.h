@@ -0,0 +1,24 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MinesweeperKernelBenchmarkCommandlet.generated.h"
+
+/**
+ * Times Create, Discover (flood fill from a safe cell), HasWon and Reveal on the same boards with the former nested rows layout,
+ * FMinesweeperBoard and, for standard sizes, TMinesweeperFixedBoard, and reports the speedups.
+ * -Density sets the mine ratio (classic counts by default), low values flood most of the board on the first click.
+ * UnrealEditor-Cmd mAInesweeper.uproject -run=MinesweeperKernelBenchmark [-Sizes=9x9,16x16,16x30,24x24,64x64] [-Iterations=20000] [-Density=0.05] [-Seed=0]
+ */
+UCLASS()
+class SWEEPERPLUGIN_API UMinesweeperKernelBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMinesweeperKernelBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,25 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MinesweeperLibraryCommandlet.generated.h"
+
+/**
+ * Fills the board library (FMinesweeperBoardLibrary) and measures its queries.
+ * -Import adds board files of any FMinesweeperBoardFormats format, -Fill adds random boards of the given sizes,
+ * -Queries runs random size + 3BV range lookups and logs their latency:
+ *     UnrealEditor-Cmd mAInesweeper.uproject -run=MinesweeperLibrary [-Directory=Path/To/Library] [-Import=Dir/Or/File]
+ *         [-Fill=100000] [-Sizes=9x9,16x16,16x30] [-Density=0.15] [-Seed=1] [-Queries=100000]
+ */
+UCLASS()
+class SWEEPERPLUGIN_API UMinesweeperLibraryCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMinesweeperLibraryCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,24 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MinesweeperProviderBenchmarkCommandlet.generated.h"
+
+/**
+ * Measures per board latency of a board provider when asking for 1, 4, 16... boards per request.
+ * Defaults to the offline mock, whose simulated latency models a fixed round trip plus a generation time per board.
+ * UnrealEditor-Cmd mAInesweeper.uproject -run=MinesweeperProviderBenchmark [-Provider=Mock|Gemini|OpenAICompatible]
+ *     [-Batches=1,4,16] [-Requests=8] [-Latency=0.8] [-PerBoardLatency=0.15] [-Prompt="9x9 board with 10 mines"]
+ */
+UCLASS()
+class SWEEPERPLUGIN_API UMinesweeperProviderBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMinesweeperProviderBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
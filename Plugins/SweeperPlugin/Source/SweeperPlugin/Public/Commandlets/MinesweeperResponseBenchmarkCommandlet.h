@@ -0,0 +1,23 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MinesweeperResponseBenchmarkCommandlet.generated.h"
+
+/**
+ * Compares the DOM based extraction of the board from a Gemini response with FGeminiResponseReader.
+ * Uses recorded responses when given, otherwise synthesizes one holding a board of the requested size.
+ * UnrealEditor-Cmd mAInesweeper.uproject -run=MinesweeperResponseBenchmark [-Responses=Dir/Or/File.json] [-SizeMB=4] [-Iterations=20]
+ */
+UCLASS()
+class SWEEPERPLUGIN_API UMinesweeperResponseBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMinesweeperResponseBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
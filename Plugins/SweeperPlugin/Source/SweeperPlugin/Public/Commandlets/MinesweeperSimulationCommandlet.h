@@ -0,0 +1,24 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "MinesweeperSimulationCommandlet.generated.h"
+
+/**
+ * Plays games offline and reports throughput, win rate and per operation latencies. Doubles as the plugin benchmark.
+ * UnrealEditor-Cmd mAInesweeper.uproject -run=MinesweeperSimulation [-Games=100000] [-Rows=16] [-Cols=30] [-Mines=99]
+ *     [-Strategy=Solver|Random|All] [-Workers=0] [-Seed=0] [-Csv=Path/To/Results.csv] [-DynamicBoard]
+ * -DynamicBoard plays standard sizes on FMinesweeperBoard too, to compare with the fixed size boards.
+ */
+UCLASS()
+class SWEEPERPLUGIN_API UMinesweeperSimulationCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UMinesweeperSimulationCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
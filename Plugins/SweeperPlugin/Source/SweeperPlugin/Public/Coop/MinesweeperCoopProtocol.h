@@ -0,0 +1,57 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Board/MinesweeperInputQueue.h"
+
+enum class EMinesweeperCoopMessage : uint8
+{
+	/** Client to host: Version */
+	Hello = 1,
+	/** Host to client: Epoch, Sequence, GameOver (0 or 1, a lost board reads like one in progress), then a FMinesweeperSnapshot of the board */
+	Snapshot = 2,
+	/** Both ways: Epoch, FirstSequence, Count (fixed 4 bytes), then the deltas. Clients send their actions with FirstSequence 0 */
+	Deltas = 3
+};
+
+/** One board mutation: what the host applies, and what every peer replays to stay identical */
+struct FMinesweeperDelta
+{
+	int32 Id;
+	EMinesweeperCommand Action;
+};
+
+/**
+ * Wire format of co-op sessions. Frames are a 4 bytes little endian payload size, a message type, then the payload.
+ * Numbers are LEB128 varints. A delta is one varint: the zigzagged difference with the previous delta id, shifted left
+ * twice, with the action in the low bits. Neighbouring clicks and flood fills cost 1 or 2 bytes per delta.
+ */
+struct SWEEPERPLUGIN_API FMinesweeperCoopProtocol
+{
+	static constexpr uint32 VERSION = 2;
+	static constexpr int32 FRAME_HEADER_SIZE = 5;
+	/** Largest payload per message type: a frame announcing more is corrupt and never buffered. Only the host sends boards */
+	static constexpr int32 MAX_HELLO_SIZE = 16;
+	static constexpr int32 MAX_DELTAS_SIZE = 1024 * 1024;
+	static constexpr int32 MAX_SNAPSHOT_SIZE = 256 * 1024 * 1024;
+	/** Worst case size of one delta */
+	static constexpr int32 MAX_DELTA_SIZE = 6;
+
+	/** @return Offset of the frame in Out, to be passed to EndFrame once the payload is written */
+	static int32 BeginFrame(TArray<uint8>& Out, EMinesweeperCoopMessage Type);
+	static void EndFrame(TArray<uint8>& Out, int32 FrameStart);
+	/** @return Largest payload of Type sent by the host (bFromHost) or a client, INDEX_NONE if that side never sends it */
+	static int32 GetMaxPayloadSize(EMinesweeperCoopMessage Type, bool bFromHost);
+	/** @return Size of the first frame in Data with its header, 0 if not fully received yet, INDEX_NONE if the stream is corrupt */
+	static int32 PeekFrame(const uint8* Data, int32 Size, bool bFromHost, EMinesweeperCoopMessage& OutType);
+
+	static void WriteVarInt(TArray<uint8>& Out, uint64 Value);
+	static bool ReadVarInt(const uint8*& Ptr, const uint8* End, uint64& OutValue);
+
+	/** Writes the deltas header and returns the offset of its count, for the deltas appended with WriteDelta */
+	static int32 BeginDeltas(TArray<uint8>& Out, uint32 Epoch, int64 FirstSequence);
+	static void WriteDelta(TArray<uint8>& Out, const FMinesweeperDelta& Delta, int32& InOutPreviousId);
+	static void EndDeltas(TArray<uint8>& Out, int32 CountOffset, uint32 Count);
+	static bool ReadDeltas(const uint8* Payload, int32 Size, uint32& OutEpoch, int64& OutFirstSequence, TArray<FMinesweeperDelta>& OutDeltas);
+};
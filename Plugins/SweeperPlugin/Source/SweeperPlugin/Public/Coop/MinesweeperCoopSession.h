@@ -0,0 +1,122 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Board/MinesweeperBoard.h"
+#include "Coop/MinesweeperCoopProtocol.h"
+
+class FSocket;
+
+struct FMinesweeperCoopSettings
+{
+	/** Bytes sent to each peer per Tick at most (256 to FMinesweeperCoopProtocol::MAX_DELTAS_SIZE), deltas past it wait for the next Tick */
+	int32 MaxBytesPerTick = 64 * 1024;
+};
+
+struct FMinesweeperCoopStats
+{
+	int64 DeltasSent = 0;
+	int64 DeltasReceived = 0;
+	int64 BytesSent = 0;
+	int64 BytesReceived = 0;
+	int32 SnapshotsSent = 0;
+	int32 SnapshotsReceived = 0;
+};
+
+/**
+ * Two or more people on one board over TCP.
+ * The host owns the board: clients send their actions (discover, flag, chord) as deltas, the host applies them in arrival order
+ * and logs the ones that changed something. Every Tick each peer gets the log entries it misses in one batched frame,
+ * within the bandwidth budget, and replays them on its copy: the rules are deterministic, so copies stay identical.
+ * Peers joining late, or when the host starts a new board, get a snapshot of the board plus the deltas after it.
+ * Nothing ticks by itself: call Tick once per frame (or as fast as wanted in a commandlet).
+ */
+class SWEEPERPLUGIN_API FMinesweeperCoopSession
+{
+public:
+	/** Empty ChangedIds means the whole board was replaced */
+	DECLARE_MULTICAST_DELEGATE_OneParam(FOnBoardChanged, TArrayView<const int32> /*ChangedIds*/);
+
+	static TUniquePtr<FMinesweeperCoopSession> Host(int32 Port, const FMinesweeperCoopSettings& Settings = FMinesweeperCoopSettings());
+	static TUniquePtr<FMinesweeperCoopSession> Join(const FString& Address, int32 Port, const FMinesweeperCoopSettings& Settings = FMinesweeperCoopSettings());
+
+	~FMinesweeperCoopSession();
+
+	bool IsHost() const;
+	/** Host: listening. Client: connected to the host and holding its board */
+	bool IsReady() const;
+	int32 GetNumPeers() const;
+
+	/** Host only: replaces the board and sends it to every peer */
+	void StartBoard(const FMinesweeperBoard& InBoard);
+	/** Applied by the host on its next Tick, sent to the host by clients */
+	void SubmitAction(EMinesweeperCommand Action, int32 Id);
+	void Tick();
+
+	const FMinesweeperBoard& GetBoard() const;
+	/** Deltas applied to the board since it was started */
+	int64 GetSequence() const;
+	uint32 GetEpoch() const;
+	/** A mine was opened or the board is cleared, further actions change nothing */
+	bool IsGameOver() const;
+	/** CRC of the board state, equal on every peer once they caught up */
+	uint32 GetBoardChecksum() const;
+	const FMinesweeperCoopStats& GetStats() const;
+	FOnBoardChanged& OnBoardChanged();
+
+private:
+	struct FPeer
+	{
+		FSocket* Socket = nullptr;
+		TArray<uint8> Inbox;
+		TArray<uint8> Outbox;
+		// Host: next log sequence to send
+		int64 NextSequence = 0;
+		bool bGreeted = false;
+		bool bClosed = false;
+	};
+
+	FMinesweeperCoopSession(bool bInIsHost, const FMinesweeperCoopSettings& InSettings);
+
+	void AcceptPeers();
+	void Receive(FPeer& Peer);
+	void ProcessFrames(FPeer& Peer);
+	void HandleFrame(FPeer& Peer, EMinesweeperCoopMessage Type, const uint8* Payload, int32 Size);
+	void Send(FPeer& Peer);
+	void ClosePeer(FPeer& Peer, const TCHAR* Reason);
+
+	void ApplyPendingActions();
+	void QueueSnapshot(FPeer& Peer);
+	void QueueDeltas(FPeer& Peer);
+	void QueueLocalActions();
+	void TrimLog();
+
+private:
+	bool bIsHost = false;
+	FMinesweeperCoopSettings Settings;
+	FMinesweeperCoopStats Stats;
+
+	FSocket* ListenSocket = nullptr;
+	// Host: the clients. Client: the host
+	TArray<FPeer> Peers;
+
+	FMinesweeperBoard Board;
+	bool bHasBoard = false;
+	bool bGameOver = false;
+	uint32 Epoch = 0;
+
+	// Host: applied deltas not yet sent to every peer, Log[0] has sequence LogStart
+	TArray<FMinesweeperDelta> Log;
+	int64 LogStart = 0;
+	int64 Sequence = 0;
+
+	// Actions waiting for the next Tick: host applies them, client sends them
+	TArray<FMinesweeperDelta> PendingActions;
+
+	// Scratch reused by every Tick
+	TArray<FMinesweeperDelta> ReceivedDeltas;
+	TArray<int32> ChangedIds;
+
+	FOnBoardChanged BoardChanged;
+};
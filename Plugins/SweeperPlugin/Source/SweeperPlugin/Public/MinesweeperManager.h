@@ -0,0 +1,82 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Simulation/MinesweeperLatencyHistogram.h"
+
+class IBoardProvider;
+class FMinesweeperBoardLibrary;
+class SMinesweeperTab;
+
+/**
+ * Everything Minesweeper tabs share, so opening more games doesn't multiply memory and tick time:
+ * - one board provider, so one connection, one context cache and one request queue for every tab
+ * - a cache of generated boards not played yet, per prompt: any tab asking the same prompt is served from it
+ * - the board library on disk (FMinesweeperBoardLibrary), every generated board, served to prompts asking for a size
+ * - the list of open tabs, each with a slot that picks its snapshot file
+ * - click to paint latencies of every board, per board size ("Sweeper.ClickLatency" logs them, shutdown appends them to a CSV)
+ * Cell texts, colors and brushes are already shared statics (FMinesweeperCell, FSweeperPluginStyle).
+ * Board models stay in their tab, each tab plays its own game. There's no worker pool: clicks are applied on the game thread
+ * and board requests wait on HTTP, the provider queue already bounds them.
+ */
+class SWEEPERPLUGIN_API FMinesweeperManager
+{
+public:
+	/** Prompts with cached boards, the least recently used one is dropped past this */
+	static constexpr int32 MAX_CACHED_PROMPTS = 32;
+
+	static void Initialize();
+	static void Shutdown();
+	static FMinesweeperManager& Get();
+	static bool IsInitialized();
+
+	TSharedRef<IBoardProvider> GetProvider();
+
+	/** @return Slot of the tab, the lowest one free */
+	int32 RegisterTab(const TSharedRef<SMinesweeperTab>& Tab);
+	void UnregisterTab(int32 Slot);
+	/** Last tab opened and still alive, nullptr without tabs */
+	TSharedPtr<SMinesweeperTab> GetLastTab() const;
+	int32 GetNumTabs() const;
+
+	void AddCachedBoards(const FString& Prompt, TArrayView<const FString> Boards);
+	bool TakeCachedBoard(const FString& Prompt, FString& OutBoard);
+	int32 GetNumCachedBoards(const FString& Prompt) const;
+	SIZE_T GetCacheAllocatedSize() const;
+
+	/** Opened on first use, in FMinesweeperBoardLibrary::GetDefaultDirectory */
+	FMinesweeperBoardLibrary& GetLibrary();
+	/** Unplayed library board matching what Prompt asks (FMinesweeperBoardQuery::FromPrompt), marked played */
+	bool TakeLibraryBoard(const FString& Prompt, FString& OutBoard);
+	/** Stores generated boards, the first NumPlayed are being played */
+	void AddLibraryBoards(TArrayView<const FString> Boards, int32 NumPlayed);
+
+	/** Time from a click to the paint of its result on a Rows x Cols board */
+	void AddClickLatency(int32 Rows, int32 Cols, double Seconds);
+	void LogClickLatencyReport() const;
+	/** One line per board size, prefixed with the current date, so runs can be compared over time */
+	bool AppendClickLatencyCsv(const FString& Path) const;
+	static FString GetDefaultClickLatencyCsvPath();
+
+private:
+	static FString MakeCacheKey(const FString& Prompt);
+	void TouchCacheKey(const FString& Key);
+
+private:
+	static TUniquePtr<FMinesweeperManager> Instance;
+
+	TSharedPtr<IBoardProvider> Provider;
+
+	TArray<TWeakPtr<SMinesweeperTab>> Tabs;
+	int32 LastTabSlot = INDEX_NONE;
+
+	TMap<FString, TArray<FString>> CachedBoards;
+	// Least recently used first
+	TArray<FString> CacheOrder;
+
+	TUniquePtr<FMinesweeperBoardLibrary> Library;
+
+	// Keyed by (Cols, Rows)
+	TMap<FIntPoint, FMinesweeperLatencyHistogram> ClickLatencies;
+};
@@ -6,6 +6,37 @@
 #include "Engine/DeveloperSettings.h"
 #include "AISettings.generated.h"
 
+UENUM(BlueprintType)
+enum class EBoardProviderType : uint8
+{
+	Gemini,
+	/** Any server exposing /chat/completions, e.g. llama.cpp or Ollama on localhost */
+	OpenAICompatible UMETA(DisplayName="OpenAI Compatible"),
+	/** Deterministic boards generated offline, no network */
+	Mock UMETA(DisplayName="Offline Mock")
+};
+
+USTRUCT(BlueprintType)
+struct FBoardProviderSettings
+{
+	GENERATED_BODY()
+
+	FBoardProviderSettings() = default;
+	FBoardProviderSettings(float InTimeoutSeconds, int32 InMaxConcurrentRequests, int32 InBoardsPerRequest)
+		: TimeoutSeconds(InTimeoutSeconds), MaxConcurrentRequests(InMaxConcurrentRequests), BoardsPerRequest(InBoardsPerRequest) {}
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(ClampMin=1, Units="s"))
+	float TimeoutSeconds = 30.f;
+
+	/** Prompts beyond this wait in a queue */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(ClampMin=1))
+	int32 MaxConcurrentRequests = 2;
+
+	/** Boards asked in a single request. The first one is played, the others are queued for the next games. */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta=(ClampMin=1, ClampMax=16))
+	int32 BoardsPerRequest = 1;
+};
+
 /**
  * 
  */
@@ -15,12 +46,132 @@ class SWEEPERPLUGIN_API UAISettings : public UDeveloperSettings
 	GENERATED_BODY()
 
 public:
+	UFUNCTION(BlueprintPure)
+	EBoardProviderType GetProviderType() const;
+
+	const FBoardProviderSettings& GetProviderSettings(EBoardProviderType Type) const;
+
+	UFUNCTION(BlueprintPure)
+	bool IsBoardLibraryEnabled() const;
+
 	UFUNCTION(BlueprintPure)
 	FString GetGeminiApiKey() const;
 
+	UFUNCTION(BlueprintPure)
+	FString GetGeminiModel() const;
+
+	UFUNCTION(BlueprintPure)
+	bool IsContextCacheEnabled() const;
+
+	UFUNCTION(BlueprintPure)
+	int32 GetContextCacheTtlSeconds() const;
+
+	UFUNCTION(BlueprintPure)
+	int32 GetContextCacheMinTokens() const;
+
+	UFUNCTION(BlueprintPure)
+	bool IsConnectionWarmUpEnabled() const;
+
+	UFUNCTION(BlueprintPure)
+	int32 GetKeepAliveSeconds() const;
+
+	/** BaseUrl/Path?key=ApiKey */
+	FString MakeGeminiUrl(const FString& Path) const;
+
+	/** Points Gemini requests to a local stand-in with the context cache and warm-up on, for this session only (not saved) */
+	void UseLocalGeminiServer(const FString& BaseUrl, const FString& ApiKey, int32 InContextCacheMinTokens, int32 InKeepAliveSeconds);
+
+	UFUNCTION(BlueprintPure)
+	FString GetLocalBaseUrl() const;
+
+	UFUNCTION(BlueprintPure)
+	FString GetLocalModel() const;
+
+	UFUNCTION(BlueprintPure)
+	FString GetLocalApiKey() const;
+
+	UFUNCTION(BlueprintPure)
+	int32 GetMockSeed() const;
+
+	UFUNCTION(BlueprintPure)
+	float GetMockLatencySeconds() const;
+
+	UFUNCTION(BlueprintPure)
+	float GetMockLatencyPerBoardSeconds() const;
+
 	static const UAISettings* Get();
 
 private:
+	/** Where boards come from */
+	UPROPERTY(Config, EditAnywhere, Category="Provider")
+	EBoardProviderType Provider = EBoardProviderType::Gemini;
+
+	/** Keep every generated board in a local library, and serve prompts asking for a size from it before asking the provider */
+	UPROPERTY(Config, EditAnywhere, Category="Provider")
+	bool bUseBoardLibrary = true;
+
 	UPROPERTY(Config, EditAnywhere, Category="Gemini")
 	FString GeminiApiKey;
+
+	UPROPERTY(Config, EditAnywhere, Category="Gemini")
+	FBoardProviderSettings GeminiProviderSettings;
+
+	/** Point it to a local server to run against a stand-in of the Gemini endpoints */
+	UPROPERTY(Config, EditAnywhere, Category="Gemini")
+	FString GeminiBaseUrl = TEXT("https://generativelanguage.googleapis.com/v1beta");
+
+	/** Context caching needs an explicit model version */
+	UPROPERTY(Config, EditAnywhere, Category="Gemini")
+	FString GeminiModel = TEXT("gemini-1.5-flash-002");
+
+	/**
+	 * Keep the system instruction and examples in a server side cache, so requests only send the prompt.
+	 * Off by default: the built-in instructions are far below the minimum size Gemini caches.
+	 */
+	UPROPERTY(Config, EditAnywhere, Category="Gemini|Context Cache")
+	bool bUseContextCache = false;
+
+	UPROPERTY(Config, EditAnywhere, Category="Gemini|Context Cache", meta=(EditCondition="bUseContextCache", ClampMin=120, Units="s"))
+	int32 ContextCacheTtlSeconds = 3600;
+
+	/** Smallest content the model accepts in a cache (32768 tokens for Gemini 1.5). Smaller instructions are sent inline without trying */
+	UPROPERTY(Config, EditAnywhere, Category="Gemini|Context Cache", meta=(EditCondition="bUseContextCache", ClampMin=0))
+	int32 ContextCacheMinTokens = 32768;
+
+	/** Open the connection to the endpoint when the tab spawns, so the first request doesn't pay DNS, TCP and TLS setup. Needs an API key */
+	UPROPERTY(Config, EditAnywhere, Category="Gemini|Connection")
+	bool bWarmUpConnection = true;
+
+	/** Idle time before pinging the endpoint to keep the connection open while a Minesweeper tab is open, 0 to let it close */
+	UPROPERTY(Config, EditAnywhere, Category="Gemini|Connection", meta=(EditCondition="bWarmUpConnection", ClampMin=0, Units="s"))
+	int32 KeepAliveSeconds = 45;
+
+	UPROPERTY(Config, EditAnywhere, Category="OpenAI Compatible")
+	FString LocalBaseUrl = TEXT("http://localhost:8080/v1");
+
+	/** Sent as is, most local servers ignore it and use the loaded model */
+	UPROPERTY(Config, EditAnywhere, Category="OpenAI Compatible")
+	FString LocalModel = TEXT("local");
+
+	/** Bearer token, leave empty if the server doesn't check it */
+	UPROPERTY(Config, EditAnywhere, Category="OpenAI Compatible")
+	FString LocalApiKey;
+
+	UPROPERTY(Config, EditAnywhere, Category="OpenAI Compatible")
+	FBoardProviderSettings LocalProviderSettings = { 120.f, 1, 1 };
+
+	/** Same seed and prompts, same boards */
+	UPROPERTY(Config, EditAnywhere, Category="Offline Mock")
+	int32 MockSeed = 0;
+
+	/** Simulated round trip, above the timeout the request fails like a network one would */
+	UPROPERTY(Config, EditAnywhere, Category="Offline Mock", meta=(ClampMin=0, Units="s"))
+	float MockLatencySeconds = 0.f;
+
+	/** Simulated generation time of each board, on top of MockLatencySeconds */
+	UPROPERTY(Config, EditAnywhere, Category="Offline Mock", meta=(ClampMin=0, Units="s"))
+	float MockLatencyPerBoardSeconds = 0.f;
+
+	UPROPERTY(Config, EditAnywhere, Category="Offline Mock")
+	FBoardProviderSettings MockProviderSettings = { 5.f, 8, 4 };
 };
@@ -0,0 +1,22 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Power of two buckets of nanoseconds, cheap enough to be filled on every board operation. */
+struct SWEEPERPLUGIN_API FMinesweeperLatencyHistogram
+{
+	static constexpr int32 BUCKET_COUNT = 40;
+
+	uint64 Buckets[BUCKET_COUNT] = {};
+	uint64 Count = 0;
+	uint64 TotalNs = 0;
+	uint64 MaxNs = 0;
+
+	void Add(uint64 Ns);
+	void Merge(const FMinesweeperLatencyHistogram& Other);
+	double GetMeanNs() const;
+	/** @return Upper bound of the bucket holding the given percentile (0-100) */
+	uint64 GetPercentileNs(double Percentile) const;
+};
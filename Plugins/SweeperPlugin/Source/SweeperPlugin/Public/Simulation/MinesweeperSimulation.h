@@ -0,0 +1,120 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Simulation/MinesweeperLatencyHistogram.h"
+
+struct FMinesweeperBoard;
+
+enum class EMinesweeperSimulationOp : uint8
+{
+	Create,
+	Pick,
+	Discover,
+	Reveal,
+	Count
+};
+
+/** Decides which cell a simulated player opens next. One instance per worker, never shared between threads. */
+class SWEEPERPLUGIN_API IMinesweeperStrategy
+{
+public:
+	virtual ~IMinesweeperStrategy() = default;
+
+	virtual FName GetName() const = 0;
+	virtual void OnNewGame(const FMinesweeperBoard& Board) {}
+	/** @return Id of the hidden cell to open, INDEX_NONE to give up */
+	virtual int32 PickCell(const FMinesweeperBoard& Board, FRandomStream& Random) = 0;
+};
+
+/**
+ * Strategies below also expose their logic templated on the board type (OnNewGameOn, PickCellOn),
+ * so the simulator calls them without virtual dispatch on fixed size boards (TMinesweeperFixedBoard).
+ */
+
+/** Opens a random hidden cell. */
+class SWEEPERPLUGIN_API FMinesweeperRandomStrategy : public IMinesweeperStrategy
+{
+public:
+	virtual FName GetName() const override;
+	virtual int32 PickCell(const FMinesweeperBoard& Board, FRandomStream& Random) override;
+
+	template<typename TBoard>
+	void OnNewGameOn(const TBoard& Board) {}
+	template<typename TBoard>
+	int32 PickCellOn(const TBoard& Board, FRandomStream& Random);
+};
+
+/**
+ * Single point solver: a number whose hidden neighbours are all mines flags them,
+ * a number whose mines are all flagged makes its other hidden neighbours safe.
+ * Guesses a random unflagged cell when nothing can be deduced.
+ */
+class SWEEPERPLUGIN_API FMinesweeperSolverStrategy : public IMinesweeperStrategy
+{
+public:
+	virtual FName GetName() const override;
+	virtual void OnNewGame(const FMinesweeperBoard& Board) override;
+	virtual int32 PickCell(const FMinesweeperBoard& Board, FRandomStream& Random) override;
+
+	template<typename TBoard>
+	void OnNewGameOn(const TBoard& Board);
+	template<typename TBoard>
+	int32 PickCellOn(const TBoard& Board, FRandomStream& Random);
+
+private:
+	template<typename TBoard>
+	bool Deduce(const TBoard& Board);
+
+private:
+	// Buffers are reused game after game
+	TBitArray<> KnownMines;
+	TArray<int32> SafeCells;
+	TArray<int32> HiddenNeighbours;
+};
+
+struct SWEEPERPLUGIN_API FMinesweeperSimulationSettings
+{
+	int32 Games = 10000;
+	int32 Rows = 16;
+	int32 Cols = 30;
+	int32 Mines = 99;
+	/** 0 uses every core */
+	int32 Workers = 0;
+	int32 Seed = 0;
+	FName Strategy = TEXT("Solver");
+	/** Plays standard sizes (9x9, 16x16, 16x30) on TMinesweeperFixedBoard, false forces FMinesweeperBoard */
+	bool bFixedSizeBoards = true;
+};
+
+struct SWEEPERPLUGIN_API FMinesweeperSimulationResult
+{
+	FMinesweeperSimulationSettings Settings;
+	int32 Workers = 0;
+	bool bFixedSizeBoard = false;
+	int64 Games = 0;
+	int64 Wins = 0;
+	int64 Moves = 0;
+	double Seconds = 0.0;
+	FMinesweeperLatencyHistogram Latencies[static_cast<int32>(EMinesweeperSimulationOp::Count)];
+
+	double GetGamesPerSecond() const;
+	double GetWinRate() const;
+	const FMinesweeperLatencyHistogram& GetLatency(EMinesweeperSimulationOp Op) const;
+
+	void Log() const;
+	static FString GetCsvHeader();
+	FString ToCsvRow() const;
+};
+
+/**
+ * Headless self-play over the board model, no Slate involved.
+ * Games are spread over all cores, each worker owns its board, strategy and buffers and recycles them for every game.
+ */
+class SWEEPERPLUGIN_API FMinesweeperSimulator
+{
+public:
+	static TUniquePtr<IMinesweeperStrategy> CreateStrategy(FName Name);
+	static FMinesweeperSimulationResult Run(const FMinesweeperSimulationSettings& Settings);
+};
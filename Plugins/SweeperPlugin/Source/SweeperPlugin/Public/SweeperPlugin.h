@@ -9,6 +9,7 @@ class FToolBarBuilder;
 class FMenuBuilder;
 class FUICommandList;
 class FSpawnTabArgs;
+struct FTabId;
 
 class FSweeperPluginModule : public IModuleInterface
 {
@@ -18,14 +19,21 @@ public:
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
 	
+	static FSweeperPluginModule& Get();
+
 	void MinesweeperButtonClicked();
+	/** Opens another Minesweeper tab, MinesweeperButtonClicked focuses the last one instead */
+	void OpenNewMinesweeperTab();
 
 // Callbacks
 private:
 	void RegisterMinesweeperButton();
 	TSharedRef<SDockTab> OnSpawnMinesweeperTab(const FSpawnTabArgs& SpawnTabArgs);
+	TSharedPtr<SDockTab> OnFindMinesweeperTabToReuse(const FTabId& TabId);
 
 // Properties
 private:
 	TSharedPtr<FUICommandList> PluginCommands;
+
+	bool bSpawnNewTab = false;
 };
@@ -0,0 +1,54 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/MiscTrace.h"
+#include "Trace/Trace.h"
+
+/** "stat Sweeper" shows these in the viewport, "-trace=cpu,Sweeper" records the scopes in Unreal Insights */
+DECLARE_STATS_GROUP(TEXT("Sweeper"), STATGROUP_Sweeper, STATCAT_Advanced);
+
+UE_TRACE_CHANNEL_EXTERN(SweeperChannel, SWEEPERPLUGIN_API);
+
+// Board model
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Board Parse"), STAT_SweeperParse, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Board Create"), STAT_SweeperCreate, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Board Discover"), STAT_SweeperDiscover, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Board Chord"), STAT_SweeperChord, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Board Reveal"), STAT_SweeperReveal, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Board Undo/Redo"), STAT_SweeperHistory, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Board Snapshot"), STAT_SweeperSnapshot, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Board Validate"), STAT_SweeperValidate, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Board Overview Update"), STAT_SweeperUpdateOverview, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Library Add"), STAT_SweeperLibraryAdd, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Library Query"), STAT_SweeperLibraryQuery, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+
+// Widgets
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Populate Grid"), STAT_SweeperPopulateGrid, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Cell Click"), STAT_SweeperClick, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Paint Board"), STAT_SweeperPaintBoard, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+
+// AI requests
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Request"), STAT_SweeperBuildRequest, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Parse Response"), STAT_SweeperParseResponse, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_FLOAT_ACCUMULATOR_STAT_EXTERN(TEXT("Last Request (ms)"), STAT_SweeperLastRequestMs, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Requests In Flight"), STAT_SweeperRequestsInFlight, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+
+// Per frame counters
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Cells Changed"), STAT_SweeperCellsChanged, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Clicks Coalesced"), STAT_SweeperClicksCoalesced, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+
+// Sizes
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Board Cells"), STAT_SweeperBoardCells, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Cell Widgets"), STAT_SweeperCellWidgets, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Board Memory"), STAT_SweeperBoardMemory, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("History Memory"), STAT_SweeperHistoryMemory, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+DECLARE_MEMORY_STAT_EXTERN(TEXT("Grid Widgets Memory (approx)"), STAT_SweeperWidgetMemory, STATGROUP_Sweeper, SWEEPERPLUGIN_API);
+
+/** Cycle counter for the stat overlay plus a CPU scope on the Sweeper trace channel. Name matches the STAT_Sweeper<Name> stat. */
+#define SWEEPER_SCOPE(Name) \
+	SCOPE_CYCLE_COUNTER(STAT_Sweeper##Name); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Sweeper_##Name, SweeperChannel)
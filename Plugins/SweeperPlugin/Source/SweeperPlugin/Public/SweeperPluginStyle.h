@@ -4,11 +4,35 @@
 
 #include "CoreMinimal.h"
 #include "Styling/SlateStyle.h"
+#include "UObject/StrongObjectPtr.h"
+
+class UTexture2D;
+
+/** Sprites of the cell atlas, in atlas order */
+enum class ESweeperCellSprite : uint8
+{
+	Hidden,
+	// Discovered cells, one per mine count from 0 to 8
+	Count0,
+	Count1,
+	Count2,
+	Count3,
+	Count4,
+	Count5,
+	Count6,
+	Count7,
+	Count8,
+	Mine,
+	Flag,
+	Num
+};
 
 /**  */
 class FSweeperPluginStyle
 {
 public:
+	/** Size in pixels of one sprite of the cell atlas */
+	static constexpr int32 CELL_SPRITE_SIZE = 16;
 
 	static void Initialize();
 
@@ -22,11 +46,19 @@ public:
 
 	static FName GetStyleSetName();
 
+	/** Brush name of a cell sprite. Every sprite is a region of the same atlas texture, so cells drawn with them batch together */
+	static FName GetCellSpriteName(ESweeperCellSprite Sprite);
+
 private:
 
 	static TSharedRef< class FSlateStyleSet > Create();
 
+	/** Draws the cell sprites into one transient texture, no asset needed */
+	static UTexture2D* CreateCellAtlas();
+
 private:
 
 	static TSharedPtr< class FSlateStyleSet > StyleInstance;
+
+	static TStrongObjectPtr<UTexture2D> CellAtlas;
 };
\ No newline at end of file
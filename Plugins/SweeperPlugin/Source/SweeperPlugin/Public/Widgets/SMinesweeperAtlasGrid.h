@@ -0,0 +1,65 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SLeafWidget.h"
+#include "UObject/StrongObjectPtr.h"
+
+struct FMinesweeperBoard;
+class UTexture2D;
+
+DECLARE_DELEGATE_TwoParams(FOnAtlasCellClicked, int32 /*Row*/, int32 /*Column*/);
+
+/**
+ * Whole board drawn by one widget, for boards too big for a widget per cell.
+ * Close up, every visible cell is a box with its sprite from the cell atlas (FSweeperPluginStyle): same texture, same layer,
+ * so Slate batches them in one draw call. Zoomed out, the board is one box over a texture with a texel per cell,
+ * updated only where cells changed. Neither path lays out text.
+ * Ctrl + mouse wheel zooms.
+ */
+class SWEEPERPLUGIN_API SMinesweeperAtlasGrid : public SLeafWidget
+{
+public:
+	/** Cells smaller than this, in pixels, are drawn from the per cell texture */
+	static constexpr float MIN_SPRITE_CELL_SIZE = 6.f;
+	static constexpr float MIN_CELL_SIZE = 1.f;
+	static constexpr float MAX_CELL_SIZE = 50.f;
+
+	SLATE_BEGIN_ARGS(SMinesweeperAtlasGrid)
+		: _CellSize(24.f)
+	{ }
+		SLATE_ARGUMENT(float, CellSize)
+		SLATE_EVENT(FOnAtlasCellClicked, OnCellClicked)
+	SLATE_END_ARGS()
+
+	/** Constructs this widget with InArgs */
+	void Construct(const FArguments& InArgs);
+
+	/** Board to draw, must outlive the widget. Rebuilds the per cell texture */
+	void SetBoard(const FMinesweeperBoard* InBoard);
+	/** Updates the given cells only */
+	void NotifyCellsChanged(TArrayView<const int32> ChangedIds);
+
+	void SetCellSize(float InCellSize);
+	float GetCellSize() const;
+
+	// SWidget
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+	virtual FReply OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual FReply OnMouseWheel(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+
+private:
+	const FMinesweeperBoard* Board = nullptr;
+	float CellSize = 24.f;
+
+	TArray<const FSlateBrush*> Sprites;
+
+	// One texel per cell, mirrors the texture so changed regions can be uploaded
+	TArray<FColor> Texels;
+	TStrongObjectPtr<UTexture2D> CellTexture;
+	FSlateBrush CellTextureBrush;
+
+	FOnAtlasCellClicked OnCellClicked;
+};
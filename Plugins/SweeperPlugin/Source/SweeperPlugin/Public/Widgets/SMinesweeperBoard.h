@@ -4,64 +4,30 @@
 
 #include "CoreMinimal.h"
 #include "Widgets/SCompoundWidget.h"
+#include "Board/MinesweeperBoard.h"
+#include "Board/MinesweeperHistory.h"
+#include "Board/MinesweeperBoardPyramid.h"
+#include "Board/MinesweeperInputQueue.h"
 
+struct FMinesweeperLayout;
+
+class SBox;
 class SGridPanel;
+class SScrollBox;
+class SMinesweeperAtlasGrid;
+class SMinesweeperMinimap;
 
 DECLARE_DELEGATE(FOnGameOverDelegate);
 DECLARE_DELEGATE(FOnGameWinDelegate);
 
-struct FMinesweeperCell
+enum class EMinesweeperRenderMode : uint8
 {
-	bool bIsBomb;
-	bool bDiscovered;
-	int32 BombCount;
-	FText Text;
-	
-	FMinesweeperCell(bool _bIsBomb);
-	bool IsBomb() const;
-	bool IsEmpty() const;
-	bool IsDiscovered() const;
-	void Discover();
-	void IncrementBombCount();
-	int32 GetCount() const;
-	FText GetText() const;
-};
-
-struct FMinesweeperBoard
-{
-	typedef TArray<TArray<FMinesweeperCell>> Board;
-	typedef TPair<int32, int32> Coordinate;
-	
-	Board InnerBoard;
-	int32 RowCount;
-	int32 ColCount;
-	int32 CellToDiscover;
-	int32 TotalBombCount;
-	
-	FMinesweeperBoard();
-	void Create(const FString& BoardText);
-	int32 Rows() const;
-	int32 Cols() const;
-	int32 GetTotalBombCount() const;
-	bool IsDiscovered(const int32 Row, const int32 Column) const;
-	bool IsDiscovered(const int32 Index) const;
-	bool IsBomb(const int32 Row, const int32 Column) const;
-	bool IsBomb(const int32 Index) const;
-	TArray<int32> Discover(const int32 Row, const int32 Column);
-	TArray<int32> Reveal();
-	bool Exists(const int32 Row, const int32 Column) const;
-	bool Exists(const int32 Index) const;
-	FText GetCellText(const int32 Row, const int32 Column) const;
-	FText GetCellText(const int32 Index) const;
-	FSlateColor GetCellColor(const int32 Row, const int32 Column) const;
-	FSlateColor GetCellColor(const int32 Index) const;
-	static TArray<Coordinate> GetAroundOffset();
-	static TMap<int32, FSlateColor> GetAvailableCellColors();
-	bool HasWon() const;
-	FMinesweeperCell operator()(const int32 Row, const int32 Column) const;
-	FMinesweeperCell& operator()(const int32 Row, const int32 Column);
-	FMinesweeperCell operator()(const int32 Index) const;
-	FMinesweeperCell& operator()(const int32 Index);
+	/** Widgets up to SMinesweeperBoard::AUTO_ATLAS_MIN_CELLS cells, atlas above */
+	Auto,
+	/** A button per cell */
+	Widgets,
+	/** One widget drawing sprites from the cell atlas, see SMinesweeperAtlasGrid */
+	Atlas
 };
 
 /**
@@ -70,31 +36,142 @@ struct FMinesweeperBoard
 class SWEEPERPLUGIN_API SMinesweeperBoard : public SCompoundWidget
 {
 public:
-	SLATE_BEGIN_ARGS(SMinesweeperBoard) { }
+	/** Boards with at least this many cells are drawn by the atlas in Auto mode */
+	static constexpr int32 AUTO_ATLAS_MIN_CELLS = 32 * 32;
+	/** Side of a cell button, in Widgets mode */
+	static constexpr float CELL_WIDGET_SIZE = 50.f;
+	/**
+	 * Game thread time spent building cell widgets per frame, in seconds. Bigger boards finish over the next frames.
+	 * In Auto mode that's boards under AUTO_ATLAS_MIN_CELLS, built in a frame or two: spreading the build matters for big boards in Widgets mode
+	 */
+	static constexpr double GRID_BUILD_BUDGET_SECONDS = 0.004;
+
+	SLATE_BEGIN_ARGS(SMinesweeperBoard)
+		: _RenderMode(EMinesweeperRenderMode::Auto)
+	{ }
+		SLATE_ARGUMENT(EMinesweeperRenderMode, RenderMode)
 		SLATE_EVENT(FOnGameOverDelegate, OnGameOver);
 		SLATE_EVENT(FOnGameWinDelegate, OnGameWin);
 	SLATE_END_ARGS()
 
+	virtual ~SMinesweeperBoard() override;
+
 	/** Constructs this widget with InArgs */
 	void Construct(const FArguments& InArgs);
 
 	void BuildFromString(const FString& BoardText);
+	/** Board imported from a file, see FMinesweeperBoardFormats */
+	void BuildFromLayout(const FMinesweeperLayout& Layout);
 	void Rebuild();
 
+	bool Undo();
+	bool Redo();
+	bool CanUndo() const;
+	bool CanRedo() const;
+
+	bool SaveSnapshot(const FString& Path) const;
+	bool RestoreSnapshot(const FString& Path);
+
+	bool HasBoard() const;
 	FString GetCurrentBoardText() const;
+	const FMinesweeperBoard& GetBoardModel() const;
+
+	// SWidget
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+	/** Right click flags, middle click or left click on a number chords. Cells handle left clicks on hidden cells themselves */
+	virtual FReply OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
 
 private:
 	void PopulateGrid();
-	TSharedRef<SButton> CreateButton(int32 ButtonId, int32 Row, int32 Column);
-	FReply OnGridButtonClick(int32 ButtonId, int32 Row, int32 Col);
+	/** Stops building the widgets of the previous board, if it was still in progress */
+	void CancelGridBuild();
+	/** Builds cell widgets until EndTime. @return true once every row is built */
+	bool BuildGridCells(double EndTime);
+	EActiveTimerReturnType ContinueGridBuild(double InCurrentTime, float InDeltaTime);
+	/** Next row to build, the nearest to the view. Marks it built */
+	int32 ClaimNextGridRow();
+	/** Rows in the scrolled view of the grid, a screen worth from the top before the first layout */
+	void GetGridViewRows(int32& OutFirstRow, int32& OutLastRow) const;
+	/** Sized box around the cell button. Bound to the cell id only, so it serves any board with that many cells */
+	TSharedRef<SWidget> CreateCellWidget(int32 ButtonId);
+	/** Keeps the cell widgets of the first NumCells ids, releases the others */
+	void ResizeCellWidgets(int32 NumCells);
+	FReply OnGridButtonClick(int32 ButtonId);
+	void OnAtlasCellClick(int32 Row, int32 Col);
+	/** Clicks are applied once per frame, see ProcessCommands */
+	void QueueCommand(EMinesweeperCommand Type, int32 Id);
+	EActiveTimerReturnType ProcessCommands(double InCurrentTime, float InDeltaTime);
+	/** @return true if the command changed the board */
+	bool ApplyCommand(const FMinesweeperCommand& Command, bool& bOutWon, bool& bOutLost);
+	/** Drops queued clicks and undo history, and sizes the click scratch for the current board */
+	void ResetMoves();
+	/** Id of the cell under ScreenPosition, INDEX_NONE if none */
+	int32 GetCellAt(const FVector2f& ScreenPosition) const;
+	void OnMinimapNavigate(FVector2f BoardFraction);
+	FBox2f GetAtlasViewRect() const;
+	void InvalidateCells(TArrayView<const int32> Ids);
+	void InvalidateRuns(TArrayView<const FMinesweeperHistory::FIdRun> Runs);
+	bool ShouldUseAtlas() const;
+
+	struct FBoardStats
+	{
+		uint32 Cells = 0;
+		uint32 Widgets = 0;
+		SIZE_T BoardMemory = 0;
+		SIZE_T HistoryMemory = 0;
+		SIZE_T WidgetMemory = 0;
+	};
+
+	void UpdateMemoryStats();
+	void ReportStats(const FBoardStats& Current);
 	
 // Properties
 private:
+	TSharedPtr<SBox> GridContainer;
 	TSharedPtr<SGridPanel> GridPanel;
-	TMap<int32, TSharedRef<SButton>> Buttons;
+	TSharedPtr<SWidget> GridView;
+	TSharedPtr<SScrollBox> GridHorizontalScroll;
+	TSharedPtr<SScrollBox> GridVerticalScroll;
+	TSharedPtr<SMinesweeperAtlasGrid> AtlasGrid;
+	TSharedPtr<SMinesweeperMinimap> Minimap;
+	TSharedPtr<SScrollBox> HorizontalScroll;
+	TSharedPtr<SScrollBox> VerticalScroll;
+	TSharedPtr<SWidget> AtlasView;
+	// Cell widgets by id, kept across boards and null until built. Buttons are the ones inside CellWidgets
+	TArray<TSharedPtr<SWidget>> CellWidgets;
+	TArray<TSharedPtr<SButton>> Buttons;
+	int32 NumCellWidgets = 0;
+	// Size the grid slots are laid out for, 0 when the grid is empty
+	int32 GridRows = 0;
+	int32 GridCols = 0;
+	EMinesweeperRenderMode RenderMode = EMinesweeperRenderMode::Auto;
+
+	// Cell widgets are built a few rows per frame, see BuildGridCells. Rows are claimed when their build starts
+	TBitArray<> ClaimedGridRows;
+	int32 NumClaimedGridRows = 0;
+	// Row being built when the last frame ran out of time, and its next column
+	int32 BuildingRow = INDEX_NONE;
+	int32 BuildingColumn = 0;
+	TSharedPtr<FActiveTimerHandle> BuildGridTimer;
 
 	FString CurrentBoardText;
 	FMinesweeperBoard BoardModel;
+	FMinesweeperHistory History;
+	// Overview of the board for the minimap, only kept in atlas mode
+	FMinesweeperBoardPyramid BoardPyramid;
+
+	// Ids changed by the current click, reused across clicks
+	TArray<int32> ClickChangedIds;
+
+	FMinesweeperInputQueue InputQueue;
+	TSharedPtr<FActiveTimerHandle> ProcessCommandsTimer;
+	// Scratch of ProcessCommands: the frame commands and every id they changed
+	TArray<FMinesweeperCommand> FrameCommands;
+	TArray<int32> FrameChangedIds;
+	// Input times of the commands applied since the last paint, for the click to paint latency
+	mutable TArray<double> PendingInputTimes;
+	bool bGameEnded = false;
+	FBoardStats ReportedStats;
 
 	FOnGameOverDelegate OnGameOver;
 	FOnGameWinDelegate OnGameWin;
@@ -0,0 +1,71 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SLeafWidget.h"
+#include "UObject/StrongObjectPtr.h"
+
+class FMinesweeperBoardPyramid;
+class UTexture2D;
+
+DECLARE_DELEGATE_OneParam(FOnMinimapNavigate, FVector2f /*BoardFraction*/);
+
+/**
+ * Overview of a whole board, drawn from one level of a FMinesweeperBoardPyramid: a texel per block, hidden to revealed
+ * by the block revealed fraction, tinted by its mine density when ShowMineDensity is set.
+ * The level is the finest one fitting MaxTexels, so the texture never grows with the board.
+ * Draws the visible part of the board as a rectangle, clicking or dragging moves it.
+ */
+class SWEEPERPLUGIN_API SMinesweeperMinimap : public SLeafWidget
+{
+public:
+	SLATE_BEGIN_ARGS(SMinesweeperMinimap)
+		: _Size(200.f)
+		, _MaxTexels(256)
+		, _ShowMineDensity(false)
+	{ }
+		/** Longest side of the widget */
+		SLATE_ARGUMENT(float, Size)
+		/** Longest side of the texture, in blocks */
+		SLATE_ARGUMENT(int32, MaxTexels)
+		SLATE_ARGUMENT(bool, ShowMineDensity)
+		/** Visible part of the board, as fractions of its size */
+		SLATE_ATTRIBUTE(FBox2f, ViewRect)
+		SLATE_EVENT(FOnMinimapNavigate, OnNavigate)
+	SLATE_END_ARGS()
+
+	/** Constructs this widget with InArgs */
+	void Construct(const FArguments& InArgs);
+
+	/** Pyramid to draw, must outlive the widget. Picks the level and rebuilds the texture */
+	void SetPyramid(const FMinesweeperBoardPyramid* InPyramid);
+	/** Uploads the blocks above ChangedIds, call once the pyramid is updated */
+	void NotifyCellsChanged(TArrayView<const int32> ChangedIds);
+
+	// SWidget
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+	virtual FReply OnMouseButtonDown(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual FReply OnMouseButtonUp(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual FReply OnMouseMove(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) override;
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+
+private:
+	FColor GetBlockColor(int32 BlockIndex) const;
+	void Navigate(const FGeometry& MyGeometry, const FPointerEvent& MouseEvent) const;
+
+private:
+	const FMinesweeperBoardPyramid* Pyramid = nullptr;
+	int32 Level = INDEX_NONE;
+
+	float Size = 200.f;
+	int32 MaxTexels = 256;
+	bool bShowMineDensity = false;
+	TAttribute<FBox2f> ViewRect;
+	FOnMinimapNavigate OnNavigate;
+
+	// One texel per block of Level, mirrors the texture so changed regions can be uploaded
+	TArray<FColor> Texels;
+	TStrongObjectPtr<UTexture2D> Texture;
+	FSlateBrush TextureBrush;
+};
@@ -3,19 +3,31 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "Interfaces/IHttpRequest.h"
 #include "Widgets/SCompoundWidget.h"
 
-DECLARE_DELEGATE_OneParam(FOnBoardRequestCompletedDelegate, FString);
+struct FBoardProviderResponse;
+
+/** Board to play for Prompt, the other boards of a batched request wait in FMinesweeperManager */
+DECLARE_DELEGATE_TwoParams(FOnBoardRequestCompletedDelegate, const FString& /*Prompt*/, const FString& /*BoardText*/);
 DECLARE_DELEGATE_OneParam(FOnBoardRequestFailedDelegate, FString);
 
+class STextBlock;
+
 struct FPromptMessage
 {
 	FText Content;
 	bool bIsUser;
+	/** Answer still being generated: its content changes when the request completes, so it stays in the chat until then */
+	bool bPending = false;
+
+	/** Text of the row showing this message, only while the row is generated (the list is virtualized) */
+	TWeakPtr<STextBlock> ContentTextBlock;
 
 	FPromptMessage() : Content(FText::GetEmpty()), bIsUser(false) {}
 	FPromptMessage(const FText& InContent, bool InIsUser) : Content(InContent), bIsUser(InIsUser) {}
+
+	/** Updates the content and the row showing it, if any, without refreshing the list */
+	void SetContent(const FText& InContent);
 };
 
 /**
@@ -27,8 +39,8 @@ public:
 	typedef TArray<TSharedPtr<FPromptMessage>> TPromptList;
 	typedef SListView<TSharedPtr<FPromptMessage>> TPromptListWidget;
 
-	static const FString NOT_RELATED_RESPONSE;
-	static const FString GEMINI_PROMPT_BASE_URL;
+	/** Messages kept in the chat, older ones are moved to the history file */
+	static constexpr int32 MAX_CHAT_MESSAGES = 200;
 	
 	SLATE_BEGIN_ARGS(SMinesweeperPrompt) {}
 		SLATE_EVENT(FOnBoardRequestCompletedDelegate, OnBoardRequestCompleted)
@@ -38,27 +50,30 @@ public:
 	/** Constructs this widget with InArgs */
 	void Construct(const FArguments& InArgs);
 
+	/** Gets the board provider ready (connection, context cache) ahead of the first prompt */
+	void WarmUp();
+
 private:
-	TSharedRef<IHttpRequest> BuildBoardRequest(const FString& Prompt);
-	FString BuildRequestBody(const FString& Prompt) const;
-	
 	FReply OnPromptButtonClick();
 	void OnPromptCommit(const FText& PromptText, ETextCommit::Type CommitType);
 	bool HandlePrompt();
 
-	void OnBoardRequestCompletedCallback(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
-	static FString ClearResponse(FString Response);
+	/** @param ServerMessage Chat row of the request, rows of concurrent requests are updated independently */
+	void OnBoardResponse(const FBoardProviderResponse& Response, TSharedPtr<FPromptMessage> ServerMessage, FString Prompt);
 
 	TSharedRef<ITableRow> OnGenerateChatRow(TSharedPtr<FPromptMessage> Message, const TSharedRef<STableViewBase>& Owner); 
 
-	FString GetGeminiApiKey() const;
+	void AddMessages(TArrayView<const TSharedPtr<FPromptMessage>> Messages);
+	/** Appends the oldest messages to the history file and drops them, once the chat grows past MAX_CHAT_MESSAGES. Stops at the first pending one */
+	void TrimHistory();
+
+	static FString GetHistoryPath();
 
 private:
 	TSharedPtr<SEditableText> PromptEditableText;
 
 	TPromptList PromptMessages;
 	TSharedPtr<TPromptListWidget> ChatListView;
-	TSharedPtr<FPromptMessage> LastServerMessage;
 	
 	FString CurrentPromptText;
 
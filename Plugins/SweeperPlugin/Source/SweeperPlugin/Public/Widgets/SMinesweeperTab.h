@@ -20,17 +20,37 @@ public:
 	/** Constructs this widget with InArgs */
 	void Construct(const FArguments& InArgs);
 
+	/** Gets the AI endpoint ready, so the first prompt is as fast as the next ones */
+	void WarmUp();
+
 // Callbacks
 private:
 	FReply OnPlayAgainClick();
+	FReply OnNewTabClick();
+	FReply OnUndoClick();
+	FReply OnRedoClick();
+	FReply OnImportClick();
+	FReply OnExportClick();
 
 	void OnGameOver();
 	void OnGameWin();
+	/** Import or export failure, Error says why */
+	void ShowFileError(const FText& Title, const FString& Error);
+
+	void OnTabClosed(TSharedRef<SDockTab> ClosedTab);
 
-	void OnBoardRequestCompleted(FString BoardText);
+	void OnBoardRequestCompleted(const FString& Prompt, const FString& BoardText);
+	FText GetPlayAgainText() const;
+	EVisibility GetBoardButtonsVisibility() const;
 
 // Properties
 private:
 	TSharedPtr<SMinesweeperBoard> MinesweeperBoard;
 	TSharedPtr<SMinesweeperPrompt> MinesweeperPrompt;
+
+	/** Prompt of the board played, Play Again takes the boards left for it from FMinesweeperManager before replaying */
+	FString LastPrompt;
+
+	/** FMinesweeperManager slot, picks the snapshot file */
+	int32 Slot = INDEX_NONE;
 };
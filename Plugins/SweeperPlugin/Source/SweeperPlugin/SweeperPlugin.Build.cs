@@ -47,7 +47,11 @@ public class SweeperPlugin : ModuleRules
 				"ToolWidgets",
 				"Json",
 				"JsonUtilities",
-				"DeveloperSettings"
+				"DeveloperSettings",
+				"Sockets",
+				"Networking",
+				"HTTPServer",
+				"DesktopPlatform"
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);